@@ -4,6 +4,49 @@
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
+// Most separate regions pushed per frame before they are merged into one
+const int MAX_DIRTY_RECTS = 16;
+
+// Screen regions changed since the last present
+class LDirtyRects
+{
+    public:
+        // Initializes variables
+        LDirtyRects();
+
+        // Records a region, clipped to the screen and merged with overlapping ones
+        void add(const SDL_Rect* rect);
+
+        // Records the whole screen
+        void addAll();
+
+        // Blits like SDL_BlitSurface and records the region actually written
+        int blitSurface(SDL_Surface* src, const SDL_Rect* srcRect, SDL_Surface* dst, SDL_Rect* dstRect);
+
+        // Checks whether anything is waiting to be pushed
+        bool isEmpty();
+
+        // Pushes the recorded regions to the window and forgets them
+        void present(SDL_Window* window);
+
+        // Prints the share of pixels pushed per frame
+        void printStats();
+
+    private:
+        // Merges every pair of touching rects until none are left
+        void merge();
+
+        // Regions to push
+        SDL_Rect mRects[MAX_DIRTY_RECTS];
+        int mCount;
+
+        // Statistics
+        Uint32 mFrames;
+        Uint32 mIdleFrames;
+        Uint32 mRectsPushed;
+        Uint64 mPixelsPushed;
+};
+
 // The window we'll be rendering to
 SDL_Window* gWindow = NULL;
 
@@ -13,6 +56,9 @@ SDL_Surface* gScreenSurface = NULL;
 // The image we will load and show on the screen
 SDL_Surface* gHelloWorld = NULL;
 
+// Regions of the window surface changed this frame
+LDirtyRects gDirtyRects;
+
 // Starts up SDL and creates window
 bool init();
 
@@ -22,6 +68,108 @@ bool loadMedia();
 // Frees media and shuts down SDL
 void close();
 
+LDirtyRects::LDirtyRects() {
+    // Initialize
+    mCount = 0;
+    mFrames = 0;
+    mIdleFrames = 0;
+    mRectsPushed = 0;
+    mPixelsPushed = 0;
+}
+
+void LDirtyRects::add(const SDL_Rect* rect) {
+    // Clip to the screen
+    SDL_Rect screen = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
+    SDL_Rect clipped;
+    if (!SDL_IntersectRect(rect, &screen, &clipped)) {
+        return;
+    }
+
+    // Out of slots, cover everything with one rect
+    if (mCount == MAX_DIRTY_RECTS) {
+        for (int i = 1; i < mCount; ++i) {
+            SDL_UnionRect(&mRects[0], &mRects[i], &mRects[0]);
+        }
+        mCount = 1;
+    }
+
+    mRects[mCount++] = clipped;
+    merge();
+}
+
+void LDirtyRects::addAll() {
+    mRects[0].x = 0;
+    mRects[0].y = 0;
+    mRects[0].w = SCREEN_WIDTH;
+    mRects[0].h = SCREEN_HEIGHT;
+    mCount = 1;
+}
+
+void LDirtyRects::merge() {
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i = 0; i < mCount && !merged; ++i) {
+            for (int j = i + 1; j < mCount && !merged; ++j) {
+                // Grow by one pixel so edge-adjacent rects merge too
+                SDL_Rect grown = { mRects[i].x - 1, mRects[i].y - 1, mRects[i].w + 2, mRects[i].h + 2 };
+                if (SDL_HasIntersection(&grown, &mRects[j])) {
+                    SDL_UnionRect(&mRects[i], &mRects[j], &mRects[i]);
+                    mRects[j] = mRects[--mCount];
+                    merged = true;
+                }
+            }
+        }
+    }
+}
+
+int LDirtyRects::blitSurface(SDL_Surface* src, const SDL_Rect* srcRect, SDL_Surface* dst, SDL_Rect* dstRect) {
+    // SDL writes the clipped destination back into the rect
+    SDL_Rect written = { 0, 0, 0, 0 };
+    if (dstRect != NULL) {
+        written = *dstRect;
+    }
+    int result = SDL_BlitSurface(src, srcRect, dst, &written);
+    if (result == 0) {
+        add(&written);
+    }
+    if (dstRect != NULL) {
+        *dstRect = written;
+    }
+    return result;
+}
+
+bool LDirtyRects::isEmpty() {
+    return mCount == 0;
+}
+
+void LDirtyRects::present(SDL_Window* window) {
+    ++mFrames;
+
+    // Nothing changed, push nothing
+    if (mCount == 0) {
+        ++mIdleFrames;
+        return;
+    }
+
+    for (int i = 0; i < mCount; ++i) {
+        mPixelsPushed += (Uint64)mRects[i].w * mRects[i].h;
+    }
+    mRectsPushed += mCount;
+    SDL_UpdateWindowSurfaceRects(window, mRects, mCount);
+    mCount = 0;
+}
+
+void LDirtyRects::printStats() {
+    if (mFrames == 0) {
+        return;
+    }
+
+    double pushed = 100.0 * mPixelsPushed / ((double)SCREEN_WIDTH * SCREEN_HEIGHT * mFrames);
+    double rects = mFrames > mIdleFrames ? (double)mRectsPushed / (mFrames - mIdleFrames) : 0.0;
+    printf("Pushed %.2f%% of the window per frame over %u frames (%u pushed nothing, %.2f rects per push)\n", pushed, mFrames, mIdleFrames, rects);
+}
+
 int main(int argc, char* args[]) {
     // Start up SDL and create window
     if (!init()) {
@@ -31,14 +179,17 @@ int main(int argc, char* args[]) {
         if (!loadMedia()) {
             printf("Failed to load media!\n");
         } else {
-            // Apply the image
-            SDL_BlitSurface(gHelloWorld, NULL, gScreenSurface, NULL);
+            // Apply the image, recording the region it covers
+            gDirtyRects.blitSurface(gHelloWorld, NULL, gScreenSurface, NULL);
 
-            // Update the surface
-            SDL_UpdateWindowSurface(gWindow);
+            // Update only that region of the surface
+            gDirtyRects.present(gWindow);
 
             // Wait two seconds
             SDL_Delay(2000);
+
+            // Report how much of the window was pushed
+            gDirtyRects.printStats();
         }
     }
 
@@ -1,5 +1,6 @@
 #include <SDL2/SDL.h>
 #include <stdio.h>
+#include <string.h>
 #include <iostream>
 
 // Key press surfaces constants
@@ -16,6 +17,50 @@ enum KeyPressSurfaces
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
+// Most separate regions pushed per frame before they are merged into one
+const int MAX_DIRTY_RECTS = 16;
+
+// Screen regions changed since the last present
+class LDirtyRects
+{
+    public:
+        // Initializes variables
+        LDirtyRects();
+
+        // Records a region, clipped to the screen and merged with overlapping ones
+        void add(const SDL_Rect* rect);
+
+        // Records the whole screen
+        void addAll();
+
+        // Blits like SDL_BlitSurface/SDL_BlitScaled and records the region actually written
+        int blitSurface(SDL_Surface* src, const SDL_Rect* srcRect, SDL_Surface* dst, SDL_Rect* dstRect);
+        int blitScaled(SDL_Surface* src, const SDL_Rect* srcRect, SDL_Surface* dst, SDL_Rect* dstRect);
+
+        // Checks whether anything is waiting to be pushed
+        bool isEmpty();
+
+        // Pushes the recorded regions to the window and forgets them
+        void present(SDL_Window* window);
+
+        // Prints the share of pixels pushed per frame
+        void printStats();
+
+    private:
+        // Merges every pair of touching rects until none are left
+        void merge();
+
+        // Regions to push
+        SDL_Rect mRects[MAX_DIRTY_RECTS];
+        int mCount;
+
+        // Statistics
+        Uint32 mFrames;
+        Uint32 mIdleFrames;
+        Uint32 mRectsPushed;
+        Uint64 mPixelsPushed;
+};
+
 // The window we'll be rendering to
 SDL_Window* gWindow = NULL;
 
@@ -28,6 +73,22 @@ SDL_Surface* gKeyPressSurfaces[KEY_PRESS_SURFACE_TOTAL];
 // Current displayed image
 SDL_Surface* gCurrentSurface = NULL;
 
+// Regions of the window surface changed this frame
+LDirtyRects gDirtyRects;
+
+// The current image stretched to the screen, kept to repaint what the sprite uncovers
+SDL_Surface* gBackgroundSurface = NULL;
+
+// Whether a small copy of the default image bounces over the scene
+bool gMovingSprite = false;
+
+// Moving sprite size, speed in pixels per move and time between moves
+const int SPRITE_WIDTH = 80;
+const int SPRITE_HEIGHT = 60;
+const int SPRITE_SPEED_X = 3;
+const int SPRITE_SPEED_Y = 2;
+const Uint32 SPRITE_STEP_MS = 16;
+
 // Starts up SDL and creates window
 bool init();
 
@@ -40,7 +101,132 @@ void close();
 // Loads individual image
 SDL_Surface* loadSurface(std::string path);
 
+LDirtyRects::LDirtyRects() {
+    // Initialize
+    mCount = 0;
+    mFrames = 0;
+    mIdleFrames = 0;
+    mRectsPushed = 0;
+    mPixelsPushed = 0;
+}
+
+void LDirtyRects::add(const SDL_Rect* rect) {
+    // Clip to the screen
+    SDL_Rect screen = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
+    SDL_Rect clipped;
+    if (!SDL_IntersectRect(rect, &screen, &clipped)) {
+        return;
+    }
+
+    // Out of slots, cover everything with one rect
+    if (mCount == MAX_DIRTY_RECTS) {
+        for (int i = 1; i < mCount; ++i) {
+            SDL_UnionRect(&mRects[0], &mRects[i], &mRects[0]);
+        }
+        mCount = 1;
+    }
+
+    mRects[mCount++] = clipped;
+    merge();
+}
+
+void LDirtyRects::addAll() {
+    mRects[0].x = 0;
+    mRects[0].y = 0;
+    mRects[0].w = SCREEN_WIDTH;
+    mRects[0].h = SCREEN_HEIGHT;
+    mCount = 1;
+}
+
+void LDirtyRects::merge() {
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i = 0; i < mCount && !merged; ++i) {
+            for (int j = i + 1; j < mCount && !merged; ++j) {
+                // Grow by one pixel so edge-adjacent rects merge too
+                SDL_Rect grown = { mRects[i].x - 1, mRects[i].y - 1, mRects[i].w + 2, mRects[i].h + 2 };
+                if (SDL_HasIntersection(&grown, &mRects[j])) {
+                    SDL_UnionRect(&mRects[i], &mRects[j], &mRects[i]);
+                    mRects[j] = mRects[--mCount];
+                    merged = true;
+                }
+            }
+        }
+    }
+}
+
+int LDirtyRects::blitSurface(SDL_Surface* src, const SDL_Rect* srcRect, SDL_Surface* dst, SDL_Rect* dstRect) {
+    // SDL writes the clipped destination back into the rect
+    SDL_Rect written = { 0, 0, 0, 0 };
+    if (dstRect != NULL) {
+        written = *dstRect;
+    }
+    int result = SDL_BlitSurface(src, srcRect, dst, &written);
+    if (result == 0) {
+        add(&written);
+    }
+    if (dstRect != NULL) {
+        *dstRect = written;
+    }
+    return result;
+}
+
+int LDirtyRects::blitScaled(SDL_Surface* src, const SDL_Rect* srcRect, SDL_Surface* dst, SDL_Rect* dstRect) {
+    // A NULL destination stretches over the whole surface
+    SDL_Rect written = { 0, 0, dst->w, dst->h };
+    if (dstRect != NULL) {
+        written = *dstRect;
+    }
+    int result = SDL_BlitScaled(src, srcRect, dst, &written);
+    if (result == 0) {
+        add(&written);
+    }
+    if (dstRect != NULL) {
+        *dstRect = written;
+    }
+    return result;
+}
+
+bool LDirtyRects::isEmpty() {
+    return mCount == 0;
+}
+
+void LDirtyRects::present(SDL_Window* window) {
+    ++mFrames;
+
+    // Nothing changed, push nothing
+    if (mCount == 0) {
+        ++mIdleFrames;
+        return;
+    }
+
+    for (int i = 0; i < mCount; ++i) {
+        mPixelsPushed += (Uint64)mRects[i].w * mRects[i].h;
+    }
+    mRectsPushed += mCount;
+    SDL_UpdateWindowSurfaceRects(window, mRects, mCount);
+    mCount = 0;
+}
+
+void LDirtyRects::printStats() {
+    if (mFrames == 0) {
+        return;
+    }
+
+    double pushed = 100.0 * mPixelsPushed / ((double)SCREEN_WIDTH * SCREEN_HEIGHT * mFrames);
+    double rects = mFrames > mIdleFrames ? (double)mRectsPushed / (mFrames - mIdleFrames) : 0.0;
+    printf("Pushed %.2f%% of the window per frame over %u frames (%u pushed nothing, %.2f rects per push)\n", pushed, mFrames, mIdleFrames, rects);
+}
+
 int main(int argc, char* args[]) {
+    // Check for the moving sprite
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(args[i], "--moving-sprite") == 0) {
+            gMovingSprite = true;
+        }
+    }
+
     // Start up SDL and create window
     if (!init()) {
         printf("Failed to initialize!\n");
@@ -58,13 +244,36 @@ int main(int argc, char* args[]) {
             // Set default current surface
             gCurrentSurface = gKeyPressSurfaces[KEY_PRESS_SURFACE_DEFAULT];
 
+            // Surface currently shown in the window
+            SDL_Surface* shownSurface = NULL;
+
+            // Sprite position, whether it is on screen and when it moves next
+            SDL_Rect spriteRect = { 0, 0, SPRITE_WIDTH, SPRITE_HEIGHT };
+            int spriteVelX = SPRITE_SPEED_X;
+            int spriteVelY = SPRITE_SPEED_Y;
+            bool spriteDrawn = false;
+            Uint32 nextSpriteMove = SDL_GetTicks();
+
             // While application is running
             while (!quit) {
+                // With nothing to push, sleep until an event arrives or the sprite is due to move
+                bool hasEvent;
+                if (gCurrentSurface != shownSurface || !gDirtyRects.isEmpty()) {
+                    hasEvent = SDL_PollEvent(&e) != 0;
+                } else if (gMovingSprite) {
+                    Sint32 wait = (Sint32)(nextSpriteMove - SDL_GetTicks());
+                    hasEvent = (wait > 0 ? SDL_WaitEventTimeout(&e, wait) : SDL_PollEvent(&e)) != 0;
+                } else {
+                    hasEvent = SDL_WaitEvent(&e) != 0;
+                }
+
                 // Handle events on queue
-                while (SDL_PollEvent(&e) != 0) {
+                while (hasEvent) {
                     // User requests quit
                     if (e.type == SDL_QUIT) {
                         quit = true;
+                    } else if (e.type == SDL_WINDOWEVENT) { // The window may have lost its contents
+                        gDirtyRects.addAll();
                     } else if(e.type == SDL_KEYDOWN) { //User presses a key
                         // Select surfaces based on key press
                         switch (e.key.keysym.sym) {
@@ -89,19 +298,58 @@ int main(int argc, char* args[]) {
                                 break;
                         }
                     }
+
+                    hasEvent = SDL_PollEvent(&e) != 0;
+                }
+
+                // Apply the image only when it changed, the window surface keeps old pixels
+                if (gCurrentSurface != shownSurface) {
+                    SDL_BlitScaled(gCurrentSurface, NULL, gBackgroundSurface, NULL);
+                    gDirtyRects.blitSurface(gBackgroundSurface, NULL, gScreenSurface, NULL);
+                    shownSurface = gCurrentSurface;
+                    spriteDrawn = false;
                 }
 
-                // Apply the image
-                SDL_Rect stretchRect;
-                stretchRect.x = 0;
-                stretchRect.y = 0;
-                stretchRect.w = SCREEN_WIDTH;
-                stretchRect.h = SCREEN_HEIGHT;
-                SDL_BlitScaled(gCurrentSurface, NULL, gScreenSurface, &stretchRect);
+                // Move the sprite when it is due, repainting the background it leaves
+                if (gMovingSprite && (Sint32)(SDL_GetTicks() - nextSpriteMove) >= 0) {
+                    if (spriteDrawn) {
+                        SDL_Rect uncovered = spriteRect;
+                        gDirtyRects.blitSurface(gBackgroundSurface, &spriteRect, gScreenSurface, &uncovered);
+                        spriteDrawn = false;
+                    }
+
+                    // Bounce off the window edges
+                    spriteRect.x += spriteVelX;
+                    spriteRect.y += spriteVelY;
+                    if (spriteRect.x < 0 || spriteRect.x + SPRITE_WIDTH > SCREEN_WIDTH) {
+                        spriteVelX = -spriteVelX;
+                        spriteRect.x += 2 * spriteVelX;
+                    }
+                    if (spriteRect.y < 0 || spriteRect.y + SPRITE_HEIGHT > SCREEN_HEIGHT) {
+                        spriteVelY = -spriteVelY;
+                        spriteRect.y += 2 * spriteVelY;
+                    }
 
-                // Update the surface
-                SDL_UpdateWindowSurface(gWindow);
+                    // Keep the schedule, skipping moves missed while the window was busy
+                    nextSpriteMove += SPRITE_STEP_MS;
+                    if ((Sint32)(SDL_GetTicks() - nextSpriteMove) > 0) {
+                        nextSpriteMove = SDL_GetTicks() + SPRITE_STEP_MS;
+                    }
+                }
+
+                // Draw the sprite as a scaled down copy of the default image
+                if (gMovingSprite && !spriteDrawn) {
+                    SDL_Rect drawRect = spriteRect;
+                    gDirtyRects.blitScaled(gKeyPressSurfaces[KEY_PRESS_SURFACE_DEFAULT], NULL, gScreenSurface, &drawRect);
+                    spriteDrawn = true;
+                }
+
+                // Update the changed regions of the surface
+                gDirtyRects.present(gWindow);
             }
+
+            // Report how much of the window was pushed
+            gDirtyRects.printStats();
         }
     }
 
@@ -136,6 +384,13 @@ bool init() {
         } else {
             // Get window surface
             gScreenSurface = SDL_GetWindowSurface(gWindow);
+
+            // Screen sized copy of the background in the same format
+            gBackgroundSurface = SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, gScreenSurface->format->BitsPerPixel, gScreenSurface->format->format);
+            if (gBackgroundSurface == NULL) {
+                printf("Background surface could not be created! SDL_Error: %s\n", SDL_GetError());
+                success = false;
+            }
         }
     }
 
@@ -194,6 +449,9 @@ void close() {
     SDL_FreeSurface(gCurrentSurface);
     gCurrentSurface = NULL;
 
+    SDL_FreeSurface(gBackgroundSurface);
+    gBackgroundSurface = NULL;
+
     // Destroy window
     SDL_DestroyWindow(gWindow);
     gWindow = NULL;
@@ -1,6 +1,7 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <stdio.h>
+#include <string.h>
 #include <string>
 
 // Key press surfaces constants
@@ -17,6 +18,49 @@ enum KeyPressSurfaces
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
+// Most separate regions pushed per frame before they are merged into one
+const int MAX_DIRTY_RECTS = 16;
+
+// Screen regions changed since the last present
+class LDirtyRects
+{
+    public:
+        // Initializes variables
+        LDirtyRects();
+
+        // Records a region, clipped to the screen and merged with overlapping ones
+        void add(const SDL_Rect* rect);
+
+        // Records the whole screen
+        void addAll();
+
+        // Blits like SDL_BlitSurface and records the region actually written
+        int blitSurface(SDL_Surface* src, const SDL_Rect* srcRect, SDL_Surface* dst, SDL_Rect* dstRect);
+
+        // Checks whether anything is waiting to be pushed
+        bool isEmpty();
+
+        // Pushes the recorded regions to the window and forgets them
+        void present(SDL_Window* window);
+
+        // Prints the share of pixels pushed per frame
+        void printStats();
+
+    private:
+        // Merges every pair of touching rects until none are left
+        void merge();
+
+        // Regions to push
+        SDL_Rect mRects[MAX_DIRTY_RECTS];
+        int mCount;
+
+        // Statistics
+        Uint32 mFrames;
+        Uint32 mIdleFrames;
+        Uint32 mRectsPushed;
+        Uint64 mPixelsPushed;
+};
+
 // The window we'll be rendering to
 SDL_Window* gWindow = NULL;
 
@@ -29,6 +73,23 @@ SDL_Surface* gKeyPressSurfaces[KEY_PRESS_SURFACE_TOTAL];
 // Current displayed image
 SDL_Surface* gCurrentSurface = NULL;
 
+// Color keyed sprite drawn over the current image
+SDL_Surface* gSpriteSurface = NULL;
+
+// Regions of the window surface changed this frame
+LDirtyRects gDirtyRects;
+
+// The current image stretched to the screen, kept to repaint what the sprite uncovers
+SDL_Surface* gBackgroundSurface = NULL;
+
+// Whether the sprite bounces around instead of staying centered
+bool gMovingSprite = false;
+
+// Moving sprite speed in pixels per move and time between moves
+const int SPRITE_SPEED_X = 3;
+const int SPRITE_SPEED_Y = 2;
+const Uint32 SPRITE_STEP_MS = 16;
+
 // Starts up SDL and creates window
 bool init();
 
@@ -41,7 +102,125 @@ void close();
 // Loads individual image
 SDL_Surface* loadSurface(std::string path);
 
+// Loads a sprite with transparent spans, run-length encoding them when rle is set
+SDL_Surface* loadSpriteSurface(std::string path, bool rle);
+
+// Times RLE sprite blits against per-pixel color key blits
+void runRleBenchmark();
+
+LDirtyRects::LDirtyRects() {
+    // Initialize
+    mCount = 0;
+    mFrames = 0;
+    mIdleFrames = 0;
+    mRectsPushed = 0;
+    mPixelsPushed = 0;
+}
+
+void LDirtyRects::add(const SDL_Rect* rect) {
+    // Clip to the screen
+    SDL_Rect screen = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
+    SDL_Rect clipped;
+    if (!SDL_IntersectRect(rect, &screen, &clipped)) {
+        return;
+    }
+
+    // Out of slots, cover everything with one rect
+    if (mCount == MAX_DIRTY_RECTS) {
+        for (int i = 1; i < mCount; ++i) {
+            SDL_UnionRect(&mRects[0], &mRects[i], &mRects[0]);
+        }
+        mCount = 1;
+    }
+
+    mRects[mCount++] = clipped;
+    merge();
+}
+
+void LDirtyRects::addAll() {
+    mRects[0].x = 0;
+    mRects[0].y = 0;
+    mRects[0].w = SCREEN_WIDTH;
+    mRects[0].h = SCREEN_HEIGHT;
+    mCount = 1;
+}
+
+void LDirtyRects::merge() {
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i = 0; i < mCount && !merged; ++i) {
+            for (int j = i + 1; j < mCount && !merged; ++j) {
+                // Grow by one pixel so edge-adjacent rects merge too
+                SDL_Rect grown = { mRects[i].x - 1, mRects[i].y - 1, mRects[i].w + 2, mRects[i].h + 2 };
+                if (SDL_HasIntersection(&grown, &mRects[j])) {
+                    SDL_UnionRect(&mRects[i], &mRects[j], &mRects[i]);
+                    mRects[j] = mRects[--mCount];
+                    merged = true;
+                }
+            }
+        }
+    }
+}
+
+int LDirtyRects::blitSurface(SDL_Surface* src, const SDL_Rect* srcRect, SDL_Surface* dst, SDL_Rect* dstRect) {
+    // SDL writes the clipped destination back into the rect
+    SDL_Rect written = { 0, 0, 0, 0 };
+    if (dstRect != NULL) {
+        written = *dstRect;
+    }
+    int result = SDL_BlitSurface(src, srcRect, dst, &written);
+    if (result == 0) {
+        add(&written);
+    }
+    if (dstRect != NULL) {
+        *dstRect = written;
+    }
+    return result;
+}
+
+bool LDirtyRects::isEmpty() {
+    return mCount == 0;
+}
+
+void LDirtyRects::present(SDL_Window* window) {
+    ++mFrames;
+
+    // Nothing changed, push nothing
+    if (mCount == 0) {
+        ++mIdleFrames;
+        return;
+    }
+
+    for (int i = 0; i < mCount; ++i) {
+        mPixelsPushed += (Uint64)mRects[i].w * mRects[i].h;
+    }
+    mRectsPushed += mCount;
+    SDL_UpdateWindowSurfaceRects(window, mRects, mCount);
+    mCount = 0;
+}
+
+void LDirtyRects::printStats() {
+    if (mFrames == 0) {
+        return;
+    }
+
+    double pushed = 100.0 * mPixelsPushed / ((double)SCREEN_WIDTH * SCREEN_HEIGHT * mFrames);
+    double rects = mFrames > mIdleFrames ? (double)mRectsPushed / (mFrames - mIdleFrames) : 0.0;
+    printf("Pushed %.2f%% of the window per frame over %u frames (%u pushed nothing, %.2f rects per push)\n", pushed, mFrames, mIdleFrames, rects);
+}
+
 int main(int argc, char* args[]) {
+    // Check for benchmark mode and the moving sprite
+    bool benchmark = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(args[i], "--rle-bench") == 0) {
+            benchmark = true;
+        } else if (strcmp(args[i], "--moving-sprite") == 0) {
+            gMovingSprite = true;
+        }
+    }
+
     // Start up SDL and create window
     if (!init()) {
         printf("Failed to initialize!\n");
@@ -49,6 +228,8 @@ int main(int argc, char* args[]) {
         // Load media
         if (!loadMedia()) {
             printf("Failed to load media!\n");
+        } else if (benchmark) {
+            runRleBenchmark();
         } else {
             // Main loop flag
             bool quit = false;
@@ -59,13 +240,40 @@ int main(int argc, char* args[]) {
             // Set default current surface
             gCurrentSurface = gKeyPressSurfaces[KEY_PRESS_SURFACE_DEFAULT];
 
+            // Surface currently shown in the window
+            SDL_Surface* shownSurface = NULL;
+
+            // Sprite position, centered unless it moves, whether it is on screen and when it moves next
+            SDL_Rect spriteRect;
+            spriteRect.x = (SCREEN_WIDTH - gSpriteSurface->w) / 2;
+            spriteRect.y = (SCREEN_HEIGHT - gSpriteSurface->h) / 2;
+            spriteRect.w = gSpriteSurface->w;
+            spriteRect.h = gSpriteSurface->h;
+            int spriteVelX = SPRITE_SPEED_X;
+            int spriteVelY = SPRITE_SPEED_Y;
+            bool spriteDrawn = false;
+            Uint32 nextSpriteMove = SDL_GetTicks();
+
             // While application is running
             while (!quit) {
+                // With nothing to push, sleep until an event arrives or the sprite is due to move
+                bool hasEvent;
+                if (gCurrentSurface != shownSurface || !gDirtyRects.isEmpty()) {
+                    hasEvent = SDL_PollEvent(&e) != 0;
+                } else if (gMovingSprite) {
+                    Sint32 wait = (Sint32)(nextSpriteMove - SDL_GetTicks());
+                    hasEvent = (wait > 0 ? SDL_WaitEventTimeout(&e, wait) : SDL_PollEvent(&e)) != 0;
+                } else {
+                    hasEvent = SDL_WaitEvent(&e) != 0;
+                }
+
                 // Handle events on queue
-                while (SDL_PollEvent(&e) != 0) {
+                while (hasEvent) {
                     // User requests quit
                     if (e.type == SDL_QUIT) {
                         quit = true;
+                    } else if (e.type == SDL_WINDOWEVENT) { // The window may have lost its contents
+                        gDirtyRects.addAll();
                     } else if(e.type == SDL_KEYDOWN) { // User presses a key
                         // Select surfaces based on key press
                         switch (e.key.keysym.sym) {
@@ -90,19 +298,58 @@ int main(int argc, char* args[]) {
                                 break;
                         }
                     }
+
+                    hasEvent = SDL_PollEvent(&e) != 0;
                 }
 
-                // Apply the image
-                SDL_Rect stretchRect;
-                stretchRect.x = 0;
-                stretchRect.y = 0;
-                stretchRect.w = SCREEN_WIDTH;
-                stretchRect.h = SCREEN_HEIGHT;
-                SDL_BlitScaled(gCurrentSurface, NULL, gScreenSurface, &stretchRect);
+                // Apply the image only when it changed, stretched once into the background copy
+                if (gCurrentSurface != shownSurface) {
+                    SDL_BlitScaled(gCurrentSurface, NULL, gBackgroundSurface, NULL);
+                    gDirtyRects.blitSurface(gBackgroundSurface, NULL, gScreenSurface, NULL);
+                    shownSurface = gCurrentSurface;
+                    spriteDrawn = false;
+                }
 
-                // Update the surface
-                SDL_UpdateWindowSurface(gWindow);
+                // Move the sprite when it is due, repainting the background it leaves
+                if (gMovingSprite && (Sint32)(SDL_GetTicks() - nextSpriteMove) >= 0) {
+                    if (spriteDrawn) {
+                        SDL_Rect uncovered = spriteRect;
+                        gDirtyRects.blitSurface(gBackgroundSurface, &spriteRect, gScreenSurface, &uncovered);
+                        spriteDrawn = false;
+                    }
+
+                    // Bounce off the window edges
+                    spriteRect.x += spriteVelX;
+                    spriteRect.y += spriteVelY;
+                    if (spriteRect.x < 0 || spriteRect.x + spriteRect.w > SCREEN_WIDTH) {
+                        spriteVelX = -spriteVelX;
+                        spriteRect.x += 2 * spriteVelX;
+                    }
+                    if (spriteRect.y < 0 || spriteRect.y + spriteRect.h > SCREEN_HEIGHT) {
+                        spriteVelY = -spriteVelY;
+                        spriteRect.y += 2 * spriteVelY;
+                    }
+
+                    // Keep the schedule, skipping moves missed while the window was busy
+                    nextSpriteMove += SPRITE_STEP_MS;
+                    if ((Sint32)(SDL_GetTicks() - nextSpriteMove) > 0) {
+                        nextSpriteMove = SDL_GetTicks() + SPRITE_STEP_MS;
+                    }
+                }
+
+                // Apply the sprite unscaled, scaled blits would decode the RLE data every frame
+                if (!spriteDrawn) {
+                    SDL_Rect drawRect = spriteRect;
+                    gDirtyRects.blitSurface(gSpriteSurface, NULL, gScreenSurface, &drawRect);
+                    spriteDrawn = true;
+                }
+
+                // Update the changed regions of the surface
+                gDirtyRects.present(gWindow);
             }
+
+            // Report how much of the window was pushed
+            gDirtyRects.printStats();
         }
     }
 
@@ -135,6 +382,13 @@ bool init() {
             } else {
                 // Get window surface
                 gScreenSurface = SDL_GetWindowSurface(gWindow);
+
+                // Screen sized copy of the background in the same format
+                gBackgroundSurface = SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, gScreenSurface->format->BitsPerPixel, gScreenSurface->format->format);
+                if (gBackgroundSurface == NULL) {
+                    printf("Background surface could not be created! SDL Error: %s\n", SDL_GetError());
+                    success = false;
+                }
             }
         }
     }
@@ -186,6 +440,14 @@ bool loadMedia() {
         success = false;
     }
 
+    // Load sprite surface
+    gSpriteSurface = loadSpriteSurface("foo.png", true);
+    if (gSpriteSurface == NULL) {
+        puts("Failed to load sprite image!");
+        puts("Please run this binary on your directory.");
+        success = false;
+    }
+
     return success;
 }
 
@@ -194,6 +456,12 @@ void close() {
     SDL_FreeSurface(gCurrentSurface);
     gCurrentSurface = NULL;
 
+    SDL_FreeSurface(gSpriteSurface);
+    gSpriteSurface = NULL;
+
+    SDL_FreeSurface(gBackgroundSurface);
+    gBackgroundSurface = NULL;
+
     // Destroy window
     SDL_DestroyWindow(gWindow);
     gWindow = NULL;
@@ -224,3 +492,109 @@ SDL_Surface* loadSurface( std::string path )
 
     return optimizedSurface;
 }
+
+SDL_Surface* loadSpriteSurface(std::string path, bool rle)
+{
+    // The final sprite
+    SDL_Surface* spriteSurface = NULL;
+
+    // Load image at specified path
+    SDL_Surface* loadedSurface = IMG_Load(path.c_str());
+    if (loadedSurface == NULL) {
+        printf("Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError());
+        return NULL;
+    }
+
+    bool hasAlpha = loadedSurface->format->Amask != 0;
+    if (hasAlpha) {
+        // Keep per-pixel alpha, alpha 0 spans become the transparent runs
+        spriteSurface = SDL_ConvertSurfaceFormat(loadedSurface, SDL_PIXELFORMAT_ARGB8888, 0);
+    } else {
+        // Convert surface to screen format
+        spriteSurface = SDL_ConvertSurface(loadedSurface, gScreenSurface->format, 0);
+    }
+
+    // Get rid of old loaded surface
+    SDL_FreeSurface(loadedSurface);
+
+    if (spriteSurface == NULL) {
+        printf("Unable to optimize image %s! SDL Error: %s\n", path.c_str(), SDL_GetError());
+        return NULL;
+    }
+
+    Uint32 colorKey = SDL_MapRGB(spriteSurface->format, 0, 0xFF, 0xFF);
+    if (hasAlpha) {
+        SDL_SetSurfaceBlendMode(spriteSurface, SDL_BLENDMODE_BLEND);
+    } else {
+        // Color key image
+        SDL_SetColorKey(spriteSurface, SDL_TRUE, colorKey);
+    }
+
+    // Count transparent pixels before encoding, RLE surfaces can't be read directly
+    int transparent = 0;
+    if (spriteSurface->format->BytesPerPixel == 4) {
+        Uint32 rgbMask = spriteSurface->format->Rmask | spriteSurface->format->Gmask | spriteSurface->format->Bmask;
+        for (int y = 0; y < spriteSurface->h; ++y) {
+            Uint32* row = (Uint32*)((Uint8*)spriteSurface->pixels + y * spriteSurface->pitch);
+            for (int x = 0; x < spriteSurface->w; ++x) {
+                if (hasAlpha ? (row[x] & spriteSurface->format->Amask) == 0 : (row[x] & rgbMask) == (colorKey & rgbMask)) {
+                    ++transparent;
+                }
+            }
+        }
+    }
+
+    // Encode transparent spans as runs, done by SDL on the first blit
+    if (rle) {
+        SDL_SetSurfaceRLE(spriteSurface, 1);
+    }
+
+    printf("%s: %dx%d, %.1f%% transparent, %s\n", path.c_str(), spriteSurface->w, spriteSurface->h,
+           100.0 * transparent / (spriteSurface->w * spriteSurface->h), rle ? "RLE" : "per-pixel");
+
+    return spriteSurface;
+}
+
+void runRleBenchmark()
+{
+    const int BENCH_FRAMES = 200;
+
+    SDL_Surface* sprites[2];
+    sprites[0] = loadSpriteSurface("foo.png", false);
+    sprites[1] = loadSpriteSurface("foo.png", true);
+    if (sprites[0] == NULL || sprites[1] == NULL) {
+        SDL_FreeSurface(sprites[0]);
+        SDL_FreeSurface(sprites[1]);
+        return;
+    }
+
+    double frameMs[2];
+    for (int pass = 0; pass < 2; ++pass) {
+        SDL_Surface* sprite = sprites[pass];
+
+        // The first blit builds the RLE data, keep it out of the timing
+        SDL_BlitSurface(sprite, NULL, gScreenSurface, NULL);
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int frame = 0; frame < BENCH_FRAMES; ++frame) {
+            SDL_FillRect(gScreenSurface, NULL, SDL_MapRGB(gScreenSurface->format, 0xFF, 0xFF, 0xFF));
+
+            // Cover the screen with sprites
+            for (int y = 0; y + sprite->h <= SCREEN_HEIGHT; y += sprite->h / 2) {
+                for (int x = 0; x + sprite->w <= SCREEN_WIDTH; x += sprite->w / 2) {
+                    SDL_Rect spriteRect = { x, y, sprite->w, sprite->h };
+                    SDL_BlitSurface(sprite, NULL, gScreenSurface, &spriteRect);
+                }
+            }
+        }
+        frameMs[pass] = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency() / BENCH_FRAMES;
+
+        SDL_UpdateWindowSurface(gWindow);
+    }
+
+    printf("Per-pixel color key: %.3f ms/frame, RLE: %.3f ms/frame, speedup %.2fx\n",
+           frameMs[0], frameMs[1], frameMs[1] > 0.0 ? frameMs[0] / frameMs[1] : 0.0);
+
+    SDL_FreeSurface(sprites[0]);
+    SDL_FreeSurface(sprites[1]);
+}
@@ -1,7 +1,9 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <stdio.h>
+#include <string.h>
 #include <string>
+#include <vector>
 
 // Key press textures constants
 enum KeyPressTextures
@@ -17,6 +19,18 @@ enum KeyPressTextures
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
+// Frames of draw workload timed per render driver
+const int PROBE_FRAMES = 30;
+
+// Sprite copies and filled rects drawn per probe frame
+const int PROBE_SPRITES = 400;
+
+// Size of the probe sprite
+const int PROBE_SPRITE_SIZE = 64;
+
+// File in the preferences directory remembering the fastest driver per host
+const char* RENDERER_CACHE_FILE = "renderer.cache";
+
 // The window we'll be rendering to
 SDL_Window* gWindow = NULL;
 
@@ -29,6 +43,12 @@ SDL_Texture* gKeyPressTextures[KEY_PRESS_TEXTURE_TOTAL];
 // Current displayed image
 SDL_Texture* gCurrentTexture = NULL;
 
+// Whether to pick the render driver by benchmark
+bool gAutoRenderer = false;
+
+// Whether to ignore the cached driver choice and benchmark again
+bool gReprobe = false;
+
 // Starts up SDL and creates window
 bool init();
 
@@ -41,7 +61,20 @@ void close();
 // Loads individual image
 SDL_Texture* loadTexture(std::string path);
 
+// Picks the fastest render driver for this host, from cache or by benchmark
+int selectRenderDriver();
+
 int main(int argc, char* args[]) {
+    // Check for renderer selection options
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(args[i], "--auto-renderer") == 0) {
+            gAutoRenderer = true;
+        } else if (strcmp(args[i], "--reprobe") == 0) {
+            gAutoRenderer = true;
+            gReprobe = true;
+        }
+    }
+
     // Start up SDL and create window
     if (!init()) {
         printf("Failed to initialize!\n");
@@ -130,12 +163,27 @@ bool init() {
             printf("Window could not be created! SDL Error: %s\n", SDL_GetError());
             success = false;
         } else {
-            // Create renderer for window
-            gRenderer = SDL_CreateRenderer(gWindow, -1, SDL_RENDERER_ACCELERATED);
+            // Create renderer for window, letting the benchmark choose the driver if asked
+            int driver = -1;
+            Uint32 flags = SDL_RENDERER_ACCELERATED;
+            if (gAutoRenderer) {
+                driver = selectRenderDriver();
+                if (driver >= 0) {
+                    // The winner may be the software driver
+                    flags = 0;
+                }
+            }
+            gRenderer = SDL_CreateRenderer(gWindow, driver, flags);
             if (gRenderer == NULL) {
                 printf("Renderer could not be created! SDL Error: %s\n", SDL_GetError());
                 success = false;
             } else {
+                // Report which driver ended up in use
+                SDL_RendererInfo info;
+                if (gAutoRenderer && SDL_GetRendererInfo(gRenderer, &info) == 0) {
+                    printf("Using render driver %s\n", info.name);
+                }
+
                 // Initialize renderer color
                 SDL_SetRenderDrawColor(gRenderer, 0xFF, 0xFF, 0xFF, 0xFF);
 
@@ -237,3 +285,181 @@ SDL_Texture* loadTexture(std::string path)
 
     return newTexture;
 }
+
+// Builds a string identifying this host's hardware, platform and available drivers
+std::string getHostFingerprint() {
+    char buffer[256];
+    const char* video = SDL_GetCurrentVideoDriver();
+    SDL_version linked;
+    SDL_GetVersion(&linked);
+    snprintf(buffer, sizeof(buffer), "%s/%s/%dcpu/%dMB/%d.%d.%d", SDL_GetPlatform(), video != NULL ? video : "none",
+             SDL_GetCPUCount(), SDL_GetSystemRAM(), linked.major, linked.minor, linked.patch);
+    std::string fingerprint = buffer;
+
+    for (int i = 0; i < SDL_GetNumRenderDrivers(); ++i) {
+        SDL_RendererInfo info;
+        if (SDL_GetRenderDriverInfo(i, &info) == 0) {
+            fingerprint += "/";
+            fingerprint += info.name;
+        }
+    }
+
+    // Hash so the cache line has no spaces
+    Uint32 hash = 2166136261u;
+    for (size_t i = 0; i < fingerprint.size(); ++i) {
+        hash = (hash ^ (Uint8)fingerprint[i]) * 16777619u;
+    }
+    snprintf(buffer, sizeof(buffer), "%08x", hash);
+
+    return buffer;
+}
+
+// Gets the full path of the renderer cache, empty if there is nowhere to write it
+std::string getRendererCachePath() {
+    std::string path;
+    char* prefPath = SDL_GetPrefPath("lazyfoo", "sdl2-tutorial");
+    if (prefPath != NULL) {
+        path = std::string(prefPath) + RENDERER_CACHE_FILE;
+        SDL_free(prefPath);
+    }
+
+    return path;
+}
+
+// Finds a render driver index by name, -1 if it isn't available
+int findRenderDriver(const std::string& name) {
+    for (int i = 0; i < SDL_GetNumRenderDrivers(); ++i) {
+        SDL_RendererInfo info;
+        if (SDL_GetRenderDriverInfo(i, &info) == 0 && name == info.name) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// Times the probe workload on one render driver in milliseconds, negative if the driver can't be used
+double probeRenderDriver(int driver) {
+    SDL_Renderer* renderer = SDL_CreateRenderer(gWindow, driver, 0);
+    if (renderer == NULL) {
+        return -1.0;
+    }
+
+    // Sprite with alpha so copies go through blending like the tutorial's images
+    double elapsed = -1.0;
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, PROBE_SPRITE_SIZE, PROBE_SPRITE_SIZE, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Texture* sprite = NULL;
+    if (surface != NULL) {
+        SDL_FillRect(surface, NULL, SDL_MapRGBA(surface->format, 0x40, 0x80, 0xC0, 0xA0));
+        sprite = SDL_CreateTextureFromSurface(renderer, surface);
+        SDL_FreeSurface(surface);
+    }
+
+    if (sprite != NULL) {
+        SDL_SetTextureBlendMode(sprite, SDL_BLENDMODE_BLEND);
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int frame = 0; frame < PROBE_FRAMES; ++frame) {
+            SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xFF);
+            SDL_RenderClear(renderer);
+
+            // Scaled sprite copies and filled rects spread over the screen
+            for (int i = 0; i < PROBE_SPRITES; ++i) {
+                int x = (i * 37 + frame * 5) % SCREEN_WIDTH;
+                int y = (i * 53 + frame * 3) % SCREEN_HEIGHT;
+                SDL_Rect dest = { x, y, PROBE_SPRITE_SIZE + i % 32, PROBE_SPRITE_SIZE + i % 32 };
+                SDL_RenderCopy(renderer, sprite, NULL, &dest);
+
+                SDL_Rect fill = { SCREEN_WIDTH - x, SCREEN_HEIGHT - y, 16, 16 };
+                SDL_SetRenderDrawColor(renderer, (Uint8)i, (Uint8)(i * 3), (Uint8)(i * 7), 0xFF);
+                SDL_RenderFillRect(renderer, &fill);
+            }
+
+            SDL_RenderPresent(renderer);
+        }
+
+        // Reading a pixel back waits for queued GPU work to finish
+        Uint32 pixel;
+        SDL_Rect one = { 0, 0, 1, 1 };
+        SDL_RenderReadPixels(renderer, &one, SDL_PIXELFORMAT_ARGB8888, &pixel, sizeof(pixel));
+        elapsed = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+
+        SDL_DestroyTexture(sprite);
+    }
+
+    SDL_DestroyRenderer(renderer);
+
+    return elapsed;
+}
+
+int selectRenderDriver() {
+    std::string fingerprint = getHostFingerprint();
+    std::string cachePath = getRendererCachePath();
+
+    // Read cached choices, keeping other hosts' lines for rewriting
+    std::vector<std::string> otherHosts;
+    if (!cachePath.empty()) {
+        FILE* file = fopen(cachePath.c_str(), "r");
+        if (file != NULL) {
+            char line[256];
+            while (fgets(line, sizeof(line), file) != NULL) {
+                char host[64];
+                char name[64];
+                if (sscanf(line, "%63s %63s", host, name) != 2) {
+                    continue;
+                }
+
+                if (fingerprint != host) {
+                    otherHosts.push_back(line);
+                } else if (!gReprobe) {
+                    int driver = findRenderDriver(name);
+                    if (driver >= 0) {
+                        printf("Render driver %s cached for host %s\n", name, host);
+                        fclose(file);
+                        return driver;
+                    }
+                }
+            }
+            fclose(file);
+        }
+    }
+
+    // Benchmark every driver that can render to the window
+    int best = -1;
+    double bestTime = 0.0;
+    for (int i = 0; i < SDL_GetNumRenderDrivers(); ++i) {
+        SDL_RendererInfo info;
+        if (SDL_GetRenderDriverInfo(i, &info) != 0) {
+            continue;
+        }
+
+        double time = probeRenderDriver(i);
+        if (time < 0.0) {
+            printf("Render driver %s unavailable: %s\n", info.name, SDL_GetError());
+            continue;
+        }
+
+        printf("Render driver %s: %.2f ms for %d frames\n", info.name, time, PROBE_FRAMES);
+        if (best < 0 || time < bestTime) {
+            best = i;
+            bestTime = time;
+        }
+    }
+
+    // Remember the winner for later launches
+    SDL_RendererInfo info;
+    if (best >= 0 && !cachePath.empty() && SDL_GetRenderDriverInfo(best, &info) == 0) {
+        FILE* file = fopen(cachePath.c_str(), "w");
+        if (file != NULL) {
+            for (size_t i = 0; i < otherHosts.size(); ++i) {
+                fputs(otherHosts[i].c_str(), file);
+            }
+            fprintf(file, "%s %s\n", fingerprint.c_str(), info.name);
+            fclose(file);
+        } else {
+            printf("Unable to write renderer cache %s!\n", cachePath.c_str());
+        }
+    }
+
+    return best;
+}
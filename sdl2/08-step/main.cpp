@@ -1,22 +1,943 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <string>
+#include <vector>
+#include <algorithm>
+
+//Kinds of recorded draws
+enum LDrawType
+{
+    DRAW_FILL_RECT,
+    DRAW_RECT,
+    DRAW_LINE,
+    DRAW_POINT,
+    DRAW_TEXTURE
+};
+
+//One recorded draw and the renderer state it needs
+struct LDrawCommand
+{
+    //Packed layer, blend mode, texture and color that commands are ordered by
+    Uint64 key;
+
+    //Submission order, keeps commands with equal keys in the order they were recorded
+    Uint32 sequence;
+
+    //What to draw
+    LDrawType type;
+
+    //Draw color for primitives, color and alpha modulation for textures
+    SDL_Color color;
+    SDL_BlendMode blendMode;
+
+    //Texture for texture copies
+    SDL_Texture* texture;
+
+    //Destination rect, line endpoints as x1, y1, x2, y2, or point as x, y
+    SDL_Rect rect;
+
+    //Optional source clip for texture copies
+    bool clipped;
+    SDL_Rect clip;
+};
+
+//Gathers primitives drawn with the same renderer state and submits them in as few calls as possible
+class LPrimitiveBatch
+{
+    public:
+        //Initializes variables
+        LPrimitiveBatch();
+
+        //Adds primitives to the batch
+        void addPoint( int x, int y );
+        void addLine( int x1, int y1, int x2, int y2 );
+        void addRect( const SDL_Rect& rect );
+        void addFillRect( const SDL_Rect& rect );
+
+        //Draws everything gathered with the renderer's current state and empties the batch
+        void submit( SDL_Renderer* renderer );
+
+        //Gets totals since creation
+        Uint64 getPrimitiveCount();
+        Uint64 getCallCount();
+
+    private:
+        //Points
+        std::vector<SDL_Point> mPoints;
+
+        //Filled rects, including outlines and axis-aligned lines split into one pixel wide rects
+        std::vector<SDL_Rect> mRects;
+
+        //Connected polylines of diagonal lines, each run ends where mLineEnds says
+        std::vector<SDL_Point> mLinePoints;
+        std::vector<int> mLineEnds;
+
+        //Statistics
+        Uint64 mPrimitives;
+        Uint64 mCalls;
+};
+
+//Records draws with a sort key and replays them ordered to minimize renderer state changes
+class LCommandBuffer
+{
+    public:
+        //Initializes variables
+        LCommandBuffer();
+
+        //Sets the layer following draws go to, layers are always drawn in increasing order
+        void setLayer( int layer );
+
+        //Sets draw color for following primitives and modulation for following texture copies
+        void setColor( Uint8 r, Uint8 g, Uint8 b, Uint8 a = 0xFF );
+
+        //Sets blend mode for following draws
+        void setBlendMode( SDL_BlendMode blendMode );
+
+        //Records primitives
+        void fillRect( const SDL_Rect& rect );
+        void drawRect( const SDL_Rect& rect );
+        void drawLine( int x1, int y1, int x2, int y2 );
+        void drawPoint( int x, int y );
+
+        //Records a texture copy
+        void copy( SDL_Texture* texture, SDL_Rect* clip, const SDL_Rect& dest );
+
+        //Sorts recorded draws within each layer unless told not to and replays them, then empties the buffer
+        void flush( SDL_Renderer* renderer, bool sorted = true );
+
+        //Sets whether primitives are batched or issued one call each
+        void setBatching( bool batching );
+
+        //Gets state changes saved by sorting during the last flush
+        int getLastRemoved();
+
+        //Prints state change statistics
+        void printStats();
+
+    private:
+        //Adds a command with the current state
+        LDrawCommand& record( LDrawType type );
+
+        //Packs layer, blend mode, texture and color into a command's sort key
+        Uint64 makeKey( const LDrawCommand& command );
+
+        //Counts state changes replaying commands in order, issuing them if a renderer is given
+        int replay( SDL_Renderer* renderer );
+
+        //Gets a small id for a texture, stable for the current frame
+        Uint32 getTextureId( SDL_Texture* texture );
+
+        //Recorded draws
+        std::vector<LDrawCommand> mCommands;
+
+        //Textures seen this frame, id is index plus one
+        std::vector<SDL_Texture*> mTextures;
+
+        //Primitives waiting for the current state to change
+        LPrimitiveBatch mBatch;
+        bool mBatching;
+
+        //Current recording state
+        int mLayer;
+        SDL_Color mColor;
+        SDL_BlendMode mBlendMode;
+
+        //Statistics
+        int mFrames;
+        int mLastRemoved;
+        Uint64 mTotalCommands;
+        Uint64 mTotalUnsorted;
+        Uint64 mTotalSorted;
+        Uint64 mUnbatchedCalls;
+};
+
+//What the readback worker does with each frame
+enum LReadbackMode
+{
+    READBACK_HASH,
+    READBACK_RAW,
+    READBACK_PNG
+};
+
+//Reads rendered frames back into memory and hashes or dumps them on a worker thread
+class LFrameReadback
+{
+    public:
+        //Initializes variables
+        LFrameReadback();
+
+        //Deallocates memory
+        ~LFrameReadback();
+
+        //Allocates frame slots and starts the worker
+        bool start( int width, int height, LReadbackMode mode, bool printHashes );
+
+        //Copies the current render target into a free slot and queues it for the worker
+        void capture( SDL_Renderer* renderer, int frame );
+
+        //Waits for queued frames to finish and stops the worker
+        void stop();
+
+        //Gets a hash over every frame's hash in order
+        Uint64 getCombinedHash();
+
+    private:
+        //Hashes or dumps queued frames until stopped
+        static int workerThread( void* data );
+
+        //Handles one read back frame
+        void process( int slot );
+
+        //Frame slots shared between the renderer and the worker
+        std::vector<Uint32> mPixels[ 3 ];
+        int mFrameNumbers[ 3 ];
+
+        //Slot the renderer fills next and slot the worker handles next
+        int mCaptureSlot;
+        int mProcessSlot;
+
+        //Counts of empty and filled slots
+        SDL_sem* mFreeSlots;
+        SDL_sem* mFilledSlots;
+
+        SDL_Thread* mWorker;
+
+        //Frame dimensions and handling
+        int mWidth;
+        int mHeight;
+        LReadbackMode mMode;
+        bool mPrintHashes;
+
+        Uint64 mCombinedHash;
+};
 
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
+//Highest layer a command can be recorded on
+const int MAX_DRAW_LAYER = 255;
+
+//Colors the debug overlay cycles through
+const SDL_Color OVERLAY_COLORS[] = {
+    { 0xFF, 0x00, 0xFF, 0xFF },
+    { 0x00, 0xFF, 0xFF, 0xFF },
+    { 0x80, 0x80, 0x80, 0xFF },
+    { 0x00, 0x00, 0x00, 0xFF }
+};
+const int OVERLAY_COLOR_COUNT = sizeof( OVERLAY_COLORS ) / sizeof( OVERLAY_COLORS[ 0 ] );
+
+//Overlay primitives each get a grid cell so none overlap within a layer, sorting can't change what ends up on top
+const int OVERLAY_CELL_SIZE = 12;
+const int OVERLAY_COLUMNS = SCREEN_WIDTH / OVERLAY_CELL_SIZE;
+const int OVERLAY_CELLS = OVERLAY_COLUMNS * ( SCREEN_HEIGHT / OVERLAY_CELL_SIZE );
+
+//Stride through the cells, coprime with the cell count so every cell is used before one repeats
+const int OVERLAY_CELL_STRIDE = 797;
+
+//First layer of the debug overlay, each full grid moves on to the next layer up to MAX_DRAW_LAYER
+const int OVERLAY_LAYER = 4;
+
+//Frames in flight between the renderer and the readback worker
+const int READBACK_SLOTS = 3;
+
 // The window we'll be rendering to
 SDL_Window* gWindow = NULL;
 
 // The window renderer
 SDL_Renderer* gRenderer = NULL;
 
+//Offscreen target and the surface backing the software renderer in headless mode
+SDL_Texture* gOffscreen = NULL;
+SDL_Surface* gFrameSurface = NULL;
+
+//Draws recorded each frame
+LCommandBuffer gCommands;
+
+//Number of debug overlay primitives drawn over the scene
+int gOverlayCount = 0;
+
+LPrimitiveBatch::LPrimitiveBatch() {
+    //Initialize
+    mPrimitives = 0;
+    mCalls = 0;
+}
+
+void LPrimitiveBatch::addPoint( int x, int y ) {
+    SDL_Point point = { x, y };
+    mPoints.push_back( point );
+    ++mPrimitives;
+}
+
+void LPrimitiveBatch::addLine( int x1, int y1, int x2, int y2 ) {
+    ++mPrimitives;
+
+    int dx = abs( x2 - x1 );
+    int dy = abs( y2 - y1 );
+
+    //Axis-aligned lines are exactly one pixel wide rects, endpoints included
+    if( dx == 0 || dy == 0 )
+    {
+        SDL_Rect rect = { x1 < x2 ? x1 : x2, y1 < y2 ? y1 : y2, dx + 1, dy + 1 };
+        mRects.push_back( rect );
+        return;
+    }
+
+    //Diagonals extend the last polyline when they continue it
+    SDL_Point start = { x1, y1 };
+    SDL_Point end = { x2, y2 };
+    bool continues = !mLineEnds.empty() && mLineEnds.back() == (int)mLinePoints.size()
+        && mLinePoints.back().x == x1 && mLinePoints.back().y == y1;
+    if( continues )
+    {
+        mLinePoints.push_back( end );
+        mLineEnds.back() = mLinePoints.size();
+    }
+    else
+    {
+        mLinePoints.push_back( start );
+        mLinePoints.push_back( end );
+        mLineEnds.push_back( mLinePoints.size() );
+    }
+}
+
+void LPrimitiveBatch::addRect( const SDL_Rect& rect ) {
+    ++mPrimitives;
+    if( rect.w <= 0 || rect.h <= 0 )
+    {
+        return;
+    }
+
+    //Outline as top and bottom rows plus the columns between them
+    SDL_Rect top = { rect.x, rect.y, rect.w, 1 };
+    mRects.push_back( top );
+    if( rect.h > 1 )
+    {
+        SDL_Rect bottom = { rect.x, rect.y + rect.h - 1, rect.w, 1 };
+        mRects.push_back( bottom );
+    }
+    if( rect.h > 2 )
+    {
+        SDL_Rect left = { rect.x, rect.y + 1, 1, rect.h - 2 };
+        mRects.push_back( left );
+        if( rect.w > 1 )
+        {
+            SDL_Rect right = { rect.x + rect.w - 1, rect.y + 1, 1, rect.h - 2 };
+            mRects.push_back( right );
+        }
+    }
+}
+
+void LPrimitiveBatch::addFillRect( const SDL_Rect& rect ) {
+    mRects.push_back( rect );
+    ++mPrimitives;
+}
+
+void LPrimitiveBatch::submit( SDL_Renderer* renderer ) {
+    if( !mRects.empty() )
+    {
+        SDL_RenderFillRects( renderer, &mRects[ 0 ], mRects.size() );
+        ++mCalls;
+    }
+    if( !mPoints.empty() )
+    {
+        SDL_RenderDrawPoints( renderer, &mPoints[ 0 ], mPoints.size() );
+        ++mCalls;
+    }
+
+    int start = 0;
+    for( size_t i = 0; i < mLineEnds.size(); ++i )
+    {
+        SDL_RenderDrawLines( renderer, &mLinePoints[ start ], mLineEnds[ i ] - start );
+        start = mLineEnds[ i ];
+        ++mCalls;
+    }
+
+    mRects.clear();
+    mPoints.clear();
+    mLinePoints.clear();
+    mLineEnds.clear();
+}
+
+Uint64 LPrimitiveBatch::getPrimitiveCount() {
+    return mPrimitives;
+}
+
+Uint64 LPrimitiveBatch::getCallCount() {
+    return mCalls;
+}
+
+LCommandBuffer::LCommandBuffer() {
+    //Initialize
+    mLayer = 0;
+    mColor.r = 0xFF;
+    mColor.g = 0xFF;
+    mColor.b = 0xFF;
+    mColor.a = 0xFF;
+    mBlendMode = SDL_BLENDMODE_NONE;
+    mFrames = 0;
+    mLastRemoved = 0;
+    mTotalCommands = 0;
+    mTotalUnsorted = 0;
+    mTotalSorted = 0;
+    mBatching = true;
+    mUnbatchedCalls = 0;
+}
+
+void LCommandBuffer::setLayer( int layer ) {
+    //Clamp to the bits the sort key has for layers
+    mLayer = layer < 0 ? 0 : ( layer > MAX_DRAW_LAYER ? MAX_DRAW_LAYER : layer );
+}
+
+void LCommandBuffer::setColor( Uint8 r, Uint8 g, Uint8 b, Uint8 a ) {
+    mColor.r = r;
+    mColor.g = g;
+    mColor.b = b;
+    mColor.a = a;
+}
+
+void LCommandBuffer::setBlendMode( SDL_BlendMode blendMode ) {
+    mBlendMode = blendMode;
+}
+
+Uint32 LCommandBuffer::getTextureId( SDL_Texture* texture ) {
+    if( texture == NULL )
+    {
+        return 0;
+    }
+
+    //Few textures per frame, so a linear search is enough
+    for( size_t i = 0; i < mTextures.size(); ++i )
+    {
+        if( mTextures[ i ] == texture )
+        {
+            return i + 1;
+        }
+    }
+
+    mTextures.push_back( texture );
+    return mTextures.size();
+}
+
+//Orders by sort key, then by submission order
+bool compareDrawCommands( const LDrawCommand& a, const LDrawCommand& b )
+{
+    if( a.key != b.key )
+    {
+        return a.key < b.key;
+    }
+    return a.sequence < b.sequence;
+}
+
+//Maps blend modes onto the four bits the sort key has for them
+Uint64 getBlendKey( SDL_BlendMode blendMode )
+{
+    switch( blendMode )
+    {
+        case SDL_BLENDMODE_NONE: return 0;
+        case SDL_BLENDMODE_BLEND: return 1;
+        case SDL_BLENDMODE_ADD: return 2;
+        case SDL_BLENDMODE_MOD: return 3;
+        default: return 15;
+    }
+}
+
+Uint64 LCommandBuffer::makeKey( const LDrawCommand& command ) {
+    const SDL_Color& c = command.color;
+    return ( (Uint64)mLayer << 56 )
+         | ( getBlendKey( command.blendMode ) << 52 )
+         | ( (Uint64)( getTextureId( command.texture ) & 0xFFFFF ) << 32 )
+         | ( (Uint64)c.r << 24 ) | ( (Uint64)c.g << 16 ) | ( (Uint64)c.b << 8 ) | c.a;
+}
+
+LDrawCommand& LCommandBuffer::record( LDrawType type ) {
+    LDrawCommand command;
+    memset( &command, 0, sizeof( command ) );
+    command.type = type;
+    command.color = mColor;
+    command.blendMode = mBlendMode;
+    command.sequence = mCommands.size();
+    command.key = makeKey( command );
+    mCommands.push_back( command );
+    return mCommands.back();
+}
+
+void LCommandBuffer::fillRect( const SDL_Rect& rect ) {
+    record( DRAW_FILL_RECT ).rect = rect;
+}
+
+void LCommandBuffer::drawRect( const SDL_Rect& rect ) {
+    record( DRAW_RECT ).rect = rect;
+}
+
+void LCommandBuffer::drawLine( int x1, int y1, int x2, int y2 ) {
+    SDL_Rect endpoints = { x1, y1, x2, y2 };
+    record( DRAW_LINE ).rect = endpoints;
+}
+
+void LCommandBuffer::drawPoint( int x, int y ) {
+    SDL_Rect point = { x, y, 0, 0 };
+    record( DRAW_POINT ).rect = point;
+}
+
+void LCommandBuffer::copy( SDL_Texture* texture, SDL_Rect* clip, const SDL_Rect& dest ) {
+    LDrawCommand& command = record( DRAW_TEXTURE );
+    command.texture = texture;
+    command.key = makeKey( command );
+    command.rect = dest;
+    if( clip != NULL )
+    {
+        command.clipped = true;
+        command.clip = *clip;
+    }
+}
+
+int LCommandBuffer::replay( SDL_Renderer* renderer ) {
+    int changes = 0;
+
+    //Primitive state
+    bool haveDrawState = false;
+    SDL_Color drawColor = { 0, 0, 0, 0 };
+    SDL_BlendMode drawBlend = SDL_BLENDMODE_NONE;
+
+    //Texture state, modulation is reapplied whenever the bound texture changes
+    SDL_Texture* texture = NULL;
+    SDL_Color textureColor = { 0, 0, 0, 0 };
+    SDL_BlendMode textureBlend = SDL_BLENDMODE_NONE;
+
+    for( size_t i = 0; i < mCommands.size(); ++i )
+    {
+        const LDrawCommand& command = mCommands[ i ];
+        const SDL_Color& c = command.color;
+
+        if( command.type == DRAW_TEXTURE )
+        {
+            //Primitives gathered so far were recorded before this copy
+            if( renderer != NULL )
+            {
+                mBatch.submit( renderer );
+            }
+            haveDrawState = false;
+
+            bool rebound = command.texture != texture;
+            if( rebound )
+            {
+                texture = command.texture;
+                ++changes;
+            }
+            if( rebound || memcmp( &c, &textureColor, sizeof( c ) ) != 0 )
+            {
+                textureColor = c;
+                ++changes;
+                if( renderer != NULL )
+                {
+                    SDL_SetTextureColorMod( texture, c.r, c.g, c.b );
+                    SDL_SetTextureAlphaMod( texture, c.a );
+                }
+            }
+            if( rebound || command.blendMode != textureBlend )
+            {
+                textureBlend = command.blendMode;
+                ++changes;
+                if( renderer != NULL )
+                {
+                    SDL_SetTextureBlendMode( texture, textureBlend );
+                }
+            }
+            if( renderer != NULL )
+            {
+                SDL_RenderCopy( renderer, texture, command.clipped ? &command.clip : NULL, &command.rect );
+            }
+            continue;
+        }
+
+        //Draw what was gathered with the old state before changing it
+        bool colorChanged = !haveDrawState || memcmp( &c, &drawColor, sizeof( c ) ) != 0;
+        bool blendChanged = !haveDrawState || command.blendMode != drawBlend;
+        if( renderer != NULL && ( colorChanged || blendChanged ) )
+        {
+            mBatch.submit( renderer );
+        }
+
+        if( colorChanged )
+        {
+            drawColor = c;
+            ++changes;
+            if( renderer != NULL )
+            {
+                SDL_SetRenderDrawColor( renderer, c.r, c.g, c.b, c.a );
+            }
+        }
+        if( blendChanged )
+        {
+            drawBlend = command.blendMode;
+            ++changes;
+            if( renderer != NULL )
+            {
+                SDL_SetRenderDrawBlendMode( renderer, drawBlend );
+            }
+        }
+        haveDrawState = true;
+
+        if( renderer == NULL )
+        {
+            continue;
+        }
+
+        //Issue each primitive with its own call, the way the scene drew before batching
+        const SDL_Rect& r = command.rect;
+        if( !mBatching )
+        {
+            switch( command.type )
+            {
+                case DRAW_FILL_RECT:
+                SDL_RenderFillRect( renderer, &r );
+                break;
+
+                case DRAW_RECT:
+                SDL_RenderDrawRect( renderer, &r );
+                break;
+
+                case DRAW_LINE:
+                SDL_RenderDrawLine( renderer, r.x, r.y, r.w, r.h );
+                break;
+
+                case DRAW_POINT:
+                SDL_RenderDrawPoint( renderer, r.x, r.y );
+                break;
+
+                default:
+                break;
+            }
+            ++mUnbatchedCalls;
+            continue;
+        }
+
+        switch( command.type )
+        {
+            case DRAW_FILL_RECT:
+            mBatch.addFillRect( r );
+            break;
+
+            case DRAW_RECT:
+            mBatch.addRect( r );
+            break;
+
+            case DRAW_LINE:
+            mBatch.addLine( r.x, r.y, r.w, r.h );
+            break;
+
+            case DRAW_POINT:
+            mBatch.addPoint( r.x, r.y );
+            break;
+
+            default:
+            break;
+        }
+    }
+
+    //Draw the last state's primitives
+    if( renderer != NULL )
+    {
+        mBatch.submit( renderer );
+    }
+
+    return changes;
+}
+
+void LCommandBuffer::flush( SDL_Renderer* renderer, bool sorted ) {
+    //State changes the draws would cost in submission order
+    int unsorted = replay( NULL );
+
+    //Group draws sharing state within each layer
+    if( sorted )
+    {
+        std::sort( mCommands.begin(), mCommands.end(), compareDrawCommands );
+    }
+    int changes = replay( renderer );
+
+    //Update statistics
+    mLastRemoved = unsorted - changes;
+    mTotalCommands += mCommands.size();
+    mTotalUnsorted += unsorted;
+    mTotalSorted += changes;
+    ++mFrames;
+
+    //Start the next frame empty
+    mCommands.clear();
+    mTextures.clear();
+}
+
+void LCommandBuffer::setBatching( bool batching ) {
+    mBatching = batching;
+}
+
+int LCommandBuffer::getLastRemoved() {
+    return mLastRemoved;
+}
+
+void LCommandBuffer::printStats() {
+    if( mFrames == 0 )
+    {
+        return;
+    }
+
+    printf( "Command buffer: %d frames, %.1f draws/frame, %.1f state changes/frame in submission order, %.1f sorted, %.1f removed/frame\n",
+            mFrames, (double)mTotalCommands / mFrames, (double)mTotalUnsorted / mFrames,
+            (double)mTotalSorted / mFrames, (double)( mTotalUnsorted - mTotalSorted ) / mFrames );
+    if( mUnbatchedCalls > 0 )
+    {
+        printf( "Primitives unbatched: %.1f draw calls/frame\n", (double)mUnbatchedCalls / mFrames );
+    }
+    if( mBatch.getPrimitiveCount() > 0 )
+    {
+        printf( "Primitive batch: %.1f primitives/frame in %.1f draw calls/frame\n",
+                (double)mBatch.getPrimitiveCount() / mFrames, (double)mBatch.getCallCount() / mFrames );
+    }
+}
+
 bool loadMedia();
 
 bool init();
 
+//Starts up SDL with a software renderer drawing into an offscreen target, no window needed
+bool initHeadless();
+
+//Frees media and shuts down SDL
+void close();
+
+//Records the scene into the command buffer
+void recordScene();
+
+//Clears the current render target and replays the recorded scene into it
+void renderScene();
+
+//Renders frames offscreen as fast as possible and reads each one back
+void runHeadless( int frames, LReadbackMode mode, bool printHashes );
+
+//Renders the scene with and without batching and sorting and compares the pixels read back
+bool verifySortedReplay();
+
+LFrameReadback::LFrameReadback() {
+    //Initialize
+    mCaptureSlot = 0;
+    mProcessSlot = 0;
+    mFreeSlots = NULL;
+    mFilledSlots = NULL;
+    mWorker = NULL;
+    mWidth = 0;
+    mHeight = 0;
+    mMode = READBACK_HASH;
+    mPrintHashes = false;
+    mCombinedHash = 14695981039346656037ULL;
+}
+
+LFrameReadback::~LFrameReadback() {
+    //Deallocate
+    stop();
+}
+
+bool LFrameReadback::start( int width, int height, LReadbackMode mode, bool printHashes ) {
+    mWidth = width;
+    mHeight = height;
+    mMode = mode;
+    mPrintHashes = printHashes;
+    for( int i = 0; i < READBACK_SLOTS; ++i )
+    {
+        mPixels[ i ].resize( width * height );
+    }
+
+    mFreeSlots = SDL_CreateSemaphore( READBACK_SLOTS );
+    mFilledSlots = SDL_CreateSemaphore( 0 );
+    if( mFreeSlots == NULL || mFilledSlots == NULL )
+    {
+        printf( "Unable to create readback semaphores! SDL Error: %s\n", SDL_GetError() );
+        return false;
+    }
+
+    mWorker = SDL_CreateThread( workerThread, "Readback", this );
+    if( mWorker == NULL )
+    {
+        printf( "Unable to create readback thread! SDL Error: %s\n", SDL_GetError() );
+        return false;
+    }
+
+    return true;
+}
+
+void LFrameReadback::capture( SDL_Renderer* renderer, int frame ) {
+    //Block only when the worker is a full ring behind
+    SDL_SemWait( mFreeSlots );
+
+    int slot = mCaptureSlot;
+    mCaptureSlot = ( mCaptureSlot + 1 ) % READBACK_SLOTS;
+    if( SDL_RenderReadPixels( renderer, NULL, SDL_PIXELFORMAT_ARGB8888, &mPixels[ slot ][ 0 ], mWidth * 4 ) != 0 )
+    {
+        printf( "Unable to read frame %d! SDL Error: %s\n", frame, SDL_GetError() );
+    }
+    mFrameNumbers[ slot ] = frame;
+
+    SDL_SemPost( mFilledSlots );
+}
+
+void LFrameReadback::stop() {
+    //Queue a stop marker behind the last frame
+    if( mWorker != NULL )
+    {
+        SDL_SemWait( mFreeSlots );
+        mFrameNumbers[ mCaptureSlot ] = -1;
+        SDL_SemPost( mFilledSlots );
+        SDL_WaitThread( mWorker, NULL );
+        mWorker = NULL;
+    }
+
+    if( mFreeSlots != NULL )
+    {
+        SDL_DestroySemaphore( mFreeSlots );
+        mFreeSlots = NULL;
+    }
+    if( mFilledSlots != NULL )
+    {
+        SDL_DestroySemaphore( mFilledSlots );
+        mFilledSlots = NULL;
+    }
+}
+
+Uint64 LFrameReadback::getCombinedHash() {
+    return mCombinedHash;
+}
+
+int LFrameReadback::workerThread( void* data ) {
+    LFrameReadback* readback = (LFrameReadback*)data;
+    while( true )
+    {
+        SDL_SemWait( readback->mFilledSlots );
+
+        int slot = readback->mProcessSlot;
+        if( readback->mFrameNumbers[ slot ] < 0 )
+        {
+            break;
+        }
+
+        readback->process( slot );
+        readback->mProcessSlot = ( slot + 1 ) % READBACK_SLOTS;
+        SDL_SemPost( readback->mFreeSlots );
+    }
+
+    return 0;
+}
+
+void LFrameReadback::process( int slot ) {
+    std::vector<Uint32>& pixels = mPixels[ slot ];
+    int frame = mFrameNumbers[ slot ];
+    char path[ 64 ];
+
+    switch( mMode )
+    {
+        case READBACK_RAW:
+        {
+            //Raw ARGB8888 rows with no header
+            snprintf( path, sizeof( path ), "frame%05d.raw", frame );
+            FILE* file = fopen( path, "wb" );
+            if( file == NULL || fwrite( &pixels[ 0 ], 4, pixels.size(), file ) != pixels.size() )
+            {
+                printf( "Unable to write %s!\n", path );
+            }
+            if( file != NULL )
+            {
+                fclose( file );
+            }
+            break;
+        }
+
+        case READBACK_PNG:
+        {
+            snprintf( path, sizeof( path ), "frame%05d.png", frame );
+            SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom( &pixels[ 0 ], mWidth, mHeight, 32, mWidth * 4, SDL_PIXELFORMAT_ARGB8888 );
+            if( surface == NULL || IMG_SavePNG( surface, path ) != 0 )
+            {
+                printf( "Unable to write %s! SDL_image Error: %s\n", path, IMG_GetError() );
+            }
+            SDL_FreeSurface( surface );
+            break;
+        }
+
+        default:
+        {
+            //FNV-1a over whole pixels, cheap enough to keep up with rendering
+            Uint64 hash = 14695981039346656037ULL;
+            for( size_t i = 0; i < pixels.size(); ++i )
+            {
+                hash = ( hash ^ pixels[ i ] ) * 1099511628211ULL;
+            }
+
+            mCombinedHash = ( mCombinedHash ^ hash ) * 1099511628211ULL;
+            if( mPrintHashes )
+            {
+                printf( "Frame %d hash %016llx\n", frame, (unsigned long long)hash );
+            }
+            break;
+        }
+    }
+}
+
 int main(int argc, char* args[]) {
+    //Check for overlay, verification, headless and readback options
+    bool verify = false;
+    int headlessFrames = 0;
+    LReadbackMode readbackMode = READBACK_HASH;
+    bool printHashes = false;
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( args[ i ], "--overlay" ) == 0 && i + 1 < argc )
+        {
+            gOverlayCount = atoi( args[ ++i ] );
+        }
+        else if( strcmp( args[ i ], "--verify-sort" ) == 0 )
+        {
+            verify = true;
+        }
+        else if( strcmp( args[ i ], "--no-batch" ) == 0 )
+        {
+            gCommands.setBatching( false );
+        }
+        else if( strcmp( args[ i ], "--headless" ) == 0 && i + 1 < argc )
+        {
+            headlessFrames = atoi( args[ ++i ] );
+        }
+        else if( strcmp( args[ i ], "--dump" ) == 0 && i + 1 < argc )
+        {
+            ++i;
+            readbackMode = strcmp( args[ i ], "png" ) == 0 ? READBACK_PNG : READBACK_RAW;
+        }
+        else if( strcmp( args[ i ], "--hash" ) == 0 )
+        {
+            printHashes = true;
+        }
+    }
+
+    //Render without a window
+    if( headlessFrames > 0 )
+    {
+        if( !initHeadless() )
+        {
+            printf( "Failed to initialize headless rendering!\n" );
+        }
+        else if( !loadMedia() )
+        {
+            printf( "Failed to load media!\n" );
+        }
+        else
+        {
+            runHeadless( headlessFrames, readbackMode, printHashes );
+        }
+
+        close();
+        return 0;
+    }
+
     // Start up SDL and create window
     if (!init()) {
         printf("Failed to initialize!\n");
@@ -24,6 +945,8 @@ int main(int argc, char* args[]) {
         // Load media
         if (!loadMedia()) {
             printf("Failed to load media!\n");
+        } else if (verify) {
+            verifySortedReplay();
         } else {
             // Main loop flag
             bool quit = false;
@@ -39,37 +962,185 @@ int main(int argc, char* args[]) {
                     }
                 }
 
-                //Clear screen
-                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
-                SDL_RenderClear( gRenderer );
+                //Record and replay the frame's draws
+                renderScene();
 
-                //Render red filled quad
-                SDL_Rect fillRect = { SCREEN_WIDTH / 4, SCREEN_HEIGHT / 4, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 };
-                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0x00, 0x00, 0xFF );
-                SDL_RenderFillRect( gRenderer, &fillRect );
+                //Update screen
+                SDL_RenderPresent( gRenderer );
+            }
 
-                //Render green outlined quad
-                SDL_Rect outlineRect = { SCREEN_WIDTH / 6, SCREEN_HEIGHT / 6, SCREEN_WIDTH * 2 / 3, SCREEN_HEIGHT * 2 / 3 };
-                SDL_SetRenderDrawColor( gRenderer, 0x00, 0xFF, 0x00, 0xFF );
-                SDL_RenderDrawRect( gRenderer, &outlineRect );
+            gCommands.printStats();
+        }
+    }
 
-                //Draw blue horizontal line
-                SDL_SetRenderDrawColor( gRenderer, 0x00, 0x00, 0xFF, 0xFF );
-                SDL_RenderDrawLine( gRenderer, 0, SCREEN_HEIGHT / 2, SCREEN_WIDTH, SCREEN_HEIGHT / 2 );
+    // Free resources and close SDL
+    close();
 
-                //Draw vertical line of yellow dots
-                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0x00, 0xFF );
-                for( int i = 0; i < SCREEN_HEIGHT; i += 4 ) {
-                    SDL_RenderDrawPoint( gRenderer, SCREEN_WIDTH / 2, i );
-                }
+    return 0;
+}
 
-                //Update screen
-                SDL_RenderPresent( gRenderer );
+void recordScene() {
+    //Render red filled quad
+    SDL_Rect fillRect = { SCREEN_WIDTH / 4, SCREEN_HEIGHT / 4, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 };
+    gCommands.setLayer( 0 );
+    gCommands.setColor( 0xFF, 0x00, 0x00 );
+    gCommands.fillRect( fillRect );
+
+    //Render green outlined quad
+    SDL_Rect outlineRect = { SCREEN_WIDTH / 6, SCREEN_HEIGHT / 6, SCREEN_WIDTH * 2 / 3, SCREEN_HEIGHT * 2 / 3 };
+    gCommands.setLayer( 1 );
+    gCommands.setColor( 0x00, 0xFF, 0x00 );
+    gCommands.drawRect( outlineRect );
+
+    //Draw blue horizontal line on its own layer, it crosses the outline and sorting by color would put it underneath
+    gCommands.setLayer( 2 );
+    gCommands.setColor( 0x00, 0x00, 0xFF );
+    gCommands.drawLine( 0, SCREEN_HEIGHT / 2, SCREEN_WIDTH, SCREEN_HEIGHT / 2 );
+
+    //Draw vertical line of yellow dots over the blue line
+    gCommands.setLayer( 3 );
+    gCommands.setColor( 0xFF, 0xFF, 0x00 );
+    for( int i = 0; i < SCREEN_HEIGHT; i += 4 ) {
+        gCommands.drawPoint( SCREEN_WIDTH / 2, i );
+    }
+
+    //Draw debug overlay with colors interleaved, the worst case for state changes
+    for( int i = 0; i < gOverlayCount; ++i ) {
+        if( i % OVERLAY_CELLS == 0 ) {
+            gCommands.setLayer( OVERLAY_LAYER + i / OVERLAY_CELLS );
+        }
+        int cell = (int)( ( (Uint64)i * OVERLAY_CELL_STRIDE ) % OVERLAY_CELLS );
+        int x = ( cell % OVERLAY_COLUMNS ) * OVERLAY_CELL_SIZE;
+        int y = ( cell / OVERLAY_COLUMNS ) * OVERLAY_CELL_SIZE;
+
+        const SDL_Color& c = OVERLAY_COLORS[ i % OVERLAY_COLOR_COUNT ];
+        gCommands.setColor( c.r, c.g, c.b, c.a );
+        switch( ( i / OVERLAY_COLOR_COUNT ) % 4 ) {
+            case 0: {
+                SDL_Rect r = { x, y, 6, 6 };
+                gCommands.fillRect( r );
+                break;
+            }
+
+            case 1: {
+                SDL_Rect r = { x, y, 8, 8 };
+                gCommands.drawRect( r );
+                break;
             }
+
+            case 2:
+            gCommands.drawLine( x, y, x + 10, y + 5 );
+            break;
+
+            default:
+            gCommands.drawPoint( x, y );
+            break;
         }
     }
+}
 
-    return 0;
+void renderScene() {
+    //Clear screen
+    SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+    SDL_RenderClear( gRenderer );
+
+    //Record and replay the frame's draws
+    recordScene();
+    gCommands.flush( gRenderer );
+}
+
+void runHeadless( int frames, LReadbackMode mode, bool printHashes ) {
+    LFrameReadback readback;
+    if( !readback.start( SCREEN_WIDTH, SCREEN_HEIGHT, mode, printHashes ) )
+    {
+        return;
+    }
+
+    //Render and read back while the worker handles earlier frames
+    SDL_SetRenderTarget( gRenderer, gOffscreen );
+    Uint64 start = SDL_GetPerformanceCounter();
+    for( int frame = 0; frame < frames; ++frame )
+    {
+        renderScene();
+        readback.capture( gRenderer, frame );
+    }
+    readback.stop();
+    double ms = ( SDL_GetPerformanceCounter() - start ) * 1000.0 / SDL_GetPerformanceFrequency();
+    SDL_SetRenderTarget( gRenderer, NULL );
+
+    printf( "Headless: %d frames in %.1f ms (%.1f FPS)\n", frames, ms, frames * 1000.0 / ms );
+    if( mode == READBACK_HASH )
+    {
+        printf( "Combined frame hash %016llx\n", (unsigned long long)readback.getCombinedHash() );
+    }
+    gCommands.printStats();
+}
+
+bool verifySortedReplay() {
+    //Render into a texture so both replays can be read back
+    SDL_Texture* target = SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, SCREEN_WIDTH, SCREEN_HEIGHT );
+    if( target == NULL )
+    {
+        printf( "Unable to create verification target! SDL Error: %s\n", SDL_GetError() );
+        return false;
+    }
+
+    //One call per primitive in submission order, then batched, then batched and sorted
+    const char* passNames[] = { "unbatched", "batched", "sorted" };
+    std::vector<Uint32> pixels[ 3 ];
+    bool success = true;
+    SDL_SetRenderTarget( gRenderer, target );
+    for( int pass = 0; pass < 3 && success; ++pass )
+    {
+        SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+        SDL_RenderClear( gRenderer );
+        recordScene();
+        gCommands.setBatching( pass > 0 );
+        gCommands.flush( gRenderer, pass == 2 );
+
+        pixels[ pass ].resize( SCREEN_WIDTH * SCREEN_HEIGHT );
+        if( SDL_RenderReadPixels( gRenderer, NULL, SDL_PIXELFORMAT_ARGB8888, &pixels[ pass ][ 0 ], SCREEN_WIDTH * 4 ) != 0 )
+        {
+            printf( "Unable to read back pixels! SDL Error: %s\n", SDL_GetError() );
+            success = false;
+        }
+    }
+    SDL_SetRenderTarget( gRenderer, NULL );
+    SDL_DestroyTexture( target );
+    gCommands.setBatching( true );
+
+    //Batching has to match the per primitive calls, sorting has to match the batched submission order
+    for( int pass = 1; pass < 3 && success; ++pass )
+    {
+        //Find the first differing pixel
+        int differing = 0;
+        int first = -1;
+        for( int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; ++i )
+        {
+            if( pixels[ pass - 1 ][ i ] != pixels[ pass ][ i ] )
+            {
+                if( first < 0 )
+                {
+                    first = i;
+                }
+                ++differing;
+            }
+        }
+
+        if( differing == 0 )
+        {
+            printf( "%s replay matches %s with %d overlay primitives\n", passNames[ pass ], passNames[ pass - 1 ], gOverlayCount );
+        }
+        else
+        {
+            printf( "%s replay differs from %s in %d pixels, first at %d,%d: %08x %s, %08x %s\n", passNames[ pass ],
+                    passNames[ pass - 1 ], differing, first % SCREEN_WIDTH, first / SCREEN_WIDTH,
+                    pixels[ pass - 1 ][ first ], passNames[ pass - 1 ], pixels[ pass ][ first ], passNames[ pass ] );
+            success = false;
+        }
+    }
+
+    return success;
 }
 
 bool loadMedia() {
@@ -121,3 +1192,83 @@ bool init() {
 
     return success;
 }
+
+void close() {
+    //Free offscreen target
+    if( gOffscreen != NULL )
+    {
+        SDL_DestroyTexture( gOffscreen );
+        gOffscreen = NULL;
+    }
+
+    //Destroy window
+    if( gRenderer != NULL )
+    {
+        SDL_DestroyRenderer( gRenderer );
+        gRenderer = NULL;
+    }
+    if( gWindow != NULL )
+    {
+        SDL_DestroyWindow( gWindow );
+        gWindow = NULL;
+    }
+
+    //Free surface the headless renderer drew into
+    SDL_FreeSurface( gFrameSurface );
+    gFrameSurface = NULL;
+
+    //Quit SDL subsystems
+    IMG_Quit();
+    SDL_Quit();
+}
+
+bool initHeadless() {
+    //Initialization flag
+    bool success = true;
+
+    //No video subsystem needed, the software renderer draws into memory
+    if( SDL_Init( 0 ) < 0 )
+    {
+        printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+        success = false;
+    }
+    else
+    {
+        //Surface backing the software renderer
+        gFrameSurface = SDL_CreateRGBSurfaceWithFormat( 0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888 );
+        if( gFrameSurface == NULL )
+        {
+            printf( "Frame surface could not be created! SDL Error: %s\n", SDL_GetError() );
+            success = false;
+        }
+        else
+        {
+            gRenderer = SDL_CreateSoftwareRenderer( gFrameSurface );
+            if( gRenderer == NULL )
+            {
+                printf( "Software renderer could not be created! SDL Error: %s\n", SDL_GetError() );
+                success = false;
+            }
+            else
+            {
+                //Target the frames are rendered into and read back from
+                gOffscreen = SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, SCREEN_WIDTH, SCREEN_HEIGHT );
+                if( gOffscreen == NULL )
+                {
+                    printf( "Offscreen target could not be created! SDL Error: %s\n", SDL_GetError() );
+                    success = false;
+                }
+
+                //Initialize PNG loading
+                int imgFlags = IMG_INIT_PNG;
+                if( !( IMG_Init( imgFlags ) & imgFlags ) )
+                {
+                    printf( "SDL_image could not initialize! SDL_image Error: %s\n", IMG_GetError() );
+                    success = false;
+                }
+            }
+        }
+    }
+
+    return success;
+}
@@ -1,25 +1,604 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <string>
+#include <vector>
+#include <algorithm>
+
+//A texture copy placed in world coordinates
+struct LSceneCommand
+{
+    //Texture and optional source clip
+    SDL_Texture* texture;
+    bool clipped;
+    SDL_Rect clip;
+
+    //Destination in world coordinates
+    SDL_Rect world;
+};
+
+//What part of the world a viewport shows
+struct LCamera
+{
+    //World position shown at the viewport's top left corner
+    float x;
+    float y;
+
+    //Screen pixels per world unit
+    float zoom;
+};
+
+//Screen area with its own camera
+struct LViewport
+{
+    SDL_Rect screen;
+    LCamera camera;
+};
+
+//Scene commands recorded once per frame and replayed into any number of viewports
+class LSceneList
+{
+    public:
+        //Initializes variables
+        LSceneList();
+
+        //Removes all commands
+        void clear();
+
+        //Records a texture copy at a world rect
+        void add( SDL_Texture* texture, SDL_Rect* clip, const SDL_Rect& world );
+
+        //Draws the commands visible through a viewport
+        void render( const LViewport& viewport );
+
+        //Prints culling statistics
+        void printStats();
+
+    private:
+        //Rebuilds the cell index after commands changed
+        void buildIndex();
+
+        //Recorded commands in draw order
+        std::vector<LSceneCommand> mCommands;
+
+        //Command indices bucketed by world cell, rebuilt lazily after recording
+        std::vector< std::vector<int> > mCells;
+        int mCellColumns;
+        int mCellRows;
+        bool mIndexDirty;
+
+        //Scratch list of visible commands
+        std::vector<int> mVisible;
+
+        //Statistics
+        Uint64 mReplays;
+        Uint64 mRecorded;
+        Uint64 mDrawn;
+};
+
+//What the readback worker does with each frame
+enum LReadbackMode
+{
+    READBACK_HASH,
+    READBACK_RAW,
+    READBACK_PNG
+};
+
+//Reads rendered frames back into memory and hashes or dumps them on a worker thread
+class LFrameReadback
+{
+    public:
+        //Initializes variables
+        LFrameReadback();
+
+        //Deallocates memory
+        ~LFrameReadback();
+
+        //Allocates frame slots and starts the worker
+        bool start( int width, int height, LReadbackMode mode, bool printHashes );
+
+        //Copies the current render target into a free slot and queues it for the worker
+        void capture( SDL_Renderer* renderer, int frame );
+
+        //Waits for queued frames to finish and stops the worker
+        void stop();
+
+        //Gets a hash over every frame's hash in order
+        Uint64 getCombinedHash();
+
+    private:
+        //Hashes or dumps queued frames until stopped
+        static int workerThread( void* data );
+
+        //Handles one read back frame
+        void process( int slot );
+
+        //Frame slots shared between the renderer and the worker
+        std::vector<Uint32> mPixels[ 3 ];
+        int mFrameNumbers[ 3 ];
+
+        //Slot the renderer fills next and slot the worker handles next
+        int mCaptureSlot;
+        int mProcessSlot;
+
+        //Counts of empty and filled slots
+        SDL_sem* mFreeSlots;
+        SDL_sem* mFilledSlots;
+
+        SDL_Thread* mWorker;
+
+        //Frame dimensions and handling
+        int mWidth;
+        int mHeight;
+        LReadbackMode mMode;
+        bool mPrintHashes;
+
+        Uint64 mCombinedHash;
+};
 
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
+//World made of a grid of preview tiles
+const int WORLD_TILE_WIDTH = 160;
+const int WORLD_TILE_HEIGHT = 120;
+const int WORLD_COLUMNS = 16;
+const int WORLD_ROWS = 16;
+const int WORLD_WIDTH = WORLD_TILE_WIDTH * WORLD_COLUMNS;
+const int WORLD_HEIGHT = WORLD_TILE_HEIGHT * WORLD_ROWS;
+
+//World units covered by each culling cell
+const int SCENE_CELL_SIZE = 256;
+
+//Most viewports the split screen can have
+const int MAX_VIEWPORTS = 16;
+
+//Camera pan speed in world units per second
+const float CAMERA_PAN_SPEED = 60.f;
+
+//Frames in flight between the renderer and the readback worker
+const int READBACK_SLOTS = 3;
+
+//Time each headless frame advances the cameras, fixed so frame hashes repeat between runs
+const float HEADLESS_FRAME_SECONDS = 1.f / 60.f;
+
 // The window we'll be rendering to
 SDL_Window* gWindow = NULL;
 
 // The window renderer
 SDL_Renderer* gRenderer = NULL;
 
+//Texture drawn into every viewport
+SDL_Texture* gTexture = NULL;
+
+//Scene shared by all viewports
+LSceneList gScene;
+
+//Split screen views
+LViewport gViewports[ MAX_VIEWPORTS ];
+int gViewportCount = 3;
+
+//Offscreen target and the surface backing the software renderer in headless mode
+SDL_Texture* gOffscreen = NULL;
+SDL_Surface* gFrameSurface = NULL;
+
 bool loadMedia();
 
+void close();
+
+//Lays out the split screen and gives each view a starting camera
+void setupViewports();
+
 // Loads individual image
 SDL_Texture* loadTexture(std::string path);
 
 bool init();
 
+//Starts up SDL with a software renderer drawing into an offscreen target, no window needed
+bool initHeadless();
+
+//Pans the cameras and draws every viewport to the current render target
+void renderScene( float elapsed );
+
+//Renders frames offscreen as fast as possible and reads each one back
+void runHeadless( int frames, LReadbackMode mode, bool printHashes );
+
+LSceneList::LSceneList() {
+    //Initialize
+    mCellColumns = ( WORLD_WIDTH + SCENE_CELL_SIZE - 1 ) / SCENE_CELL_SIZE;
+    mCellRows = ( WORLD_HEIGHT + SCENE_CELL_SIZE - 1 ) / SCENE_CELL_SIZE;
+    mCells.resize( mCellColumns * mCellRows );
+    mIndexDirty = false;
+    mReplays = 0;
+    mRecorded = 0;
+    mDrawn = 0;
+}
+
+void LSceneList::clear() {
+    mCommands.clear();
+    mIndexDirty = true;
+}
+
+void LSceneList::add( SDL_Texture* texture, SDL_Rect* clip, const SDL_Rect& world ) {
+    LSceneCommand command;
+    command.texture = texture;
+    command.clipped = clip != NULL;
+    if( clip != NULL )
+    {
+        command.clip = *clip;
+    }
+    command.world = world;
+    mCommands.push_back( command );
+    mIndexDirty = true;
+}
+
+//Clamps a world coordinate to a cell index
+int getSceneCell( int coordinate, int cellCount )
+{
+    int cell = coordinate / SCENE_CELL_SIZE;
+    if( coordinate < 0 )
+    {
+        cell = 0;
+    }
+    return cell < cellCount ? cell : cellCount - 1;
+}
+
+void LSceneList::buildIndex() {
+    for( size_t i = 0; i < mCells.size(); ++i )
+    {
+        mCells[ i ].clear();
+    }
+
+    //Put each command in every cell its world rect touches, anything off the world lands in the edge cells
+    for( size_t i = 0; i < mCommands.size(); ++i )
+    {
+        const SDL_Rect& r = mCommands[ i ].world;
+        int x1 = getSceneCell( r.x, mCellColumns );
+        int y1 = getSceneCell( r.y, mCellRows );
+        int x2 = getSceneCell( r.x + r.w - 1, mCellColumns );
+        int y2 = getSceneCell( r.y + r.h - 1, mCellRows );
+        for( int y = y1; y <= y2; ++y )
+        {
+            for( int x = x1; x <= x2; ++x )
+            {
+                mCells[ y * mCellColumns + x ].push_back( i );
+            }
+        }
+    }
+
+    mIndexDirty = false;
+}
+
+void LSceneList::render( const LViewport& viewport ) {
+    if( mIndexDirty )
+    {
+        buildIndex();
+    }
+
+    //World area visible through the viewport
+    const LCamera& camera = viewport.camera;
+    SDL_Rect view;
+    view.x = (int)floorf( camera.x );
+    view.y = (int)floorf( camera.y );
+    view.w = (int)ceilf( viewport.screen.w / camera.zoom ) + 1;
+    view.h = (int)ceilf( viewport.screen.h / camera.zoom ) + 1;
+
+    //Gather candidates from the cells under the view, then restore draw order
+    mVisible.clear();
+    int x1 = getSceneCell( view.x, mCellColumns );
+    int y1 = getSceneCell( view.y, mCellRows );
+    int x2 = getSceneCell( view.x + view.w - 1, mCellColumns );
+    int y2 = getSceneCell( view.y + view.h - 1, mCellRows );
+    for( int y = y1; y <= y2; ++y )
+    {
+        for( int x = x1; x <= x2; ++x )
+        {
+            const std::vector<int>& cell = mCells[ y * mCellColumns + x ];
+            mVisible.insert( mVisible.end(), cell.begin(), cell.end() );
+        }
+    }
+    std::sort( mVisible.begin(), mVisible.end() );
+    mVisible.erase( std::unique( mVisible.begin(), mVisible.end() ), mVisible.end() );
+
+    SDL_RenderSetViewport( gRenderer, &viewport.screen );
+    for( size_t i = 0; i < mVisible.size(); ++i )
+    {
+        const LSceneCommand& command = mCommands[ mVisible[ i ] ];
+
+        //Cells are coarse, so drop candidates that still miss the view
+        if( !SDL_HasIntersection( &command.world, &view ) )
+        {
+            continue;
+        }
+
+        //Transform from world to viewport coordinates, rounding edges so neighbors stay seamless
+        SDL_Rect dest;
+        dest.x = (int)floorf( ( command.world.x - camera.x ) * camera.zoom + 0.5f );
+        dest.y = (int)floorf( ( command.world.y - camera.y ) * camera.zoom + 0.5f );
+        dest.w = (int)floorf( ( command.world.x + command.world.w - camera.x ) * camera.zoom + 0.5f ) - dest.x;
+        dest.h = (int)floorf( ( command.world.y + command.world.h - camera.y ) * camera.zoom + 0.5f ) - dest.y;
+
+        SDL_RenderCopy( gRenderer, command.texture, command.clipped ? &command.clip : NULL, &dest );
+        ++mDrawn;
+    }
+
+    ++mReplays;
+    mRecorded += mCommands.size();
+}
+
+void LSceneList::printStats() {
+    if( mReplays == 0 )
+    {
+        return;
+    }
+
+    printf( "Scene: %d viewports, %.1f commands recorded, %.1f drawn and %.1f culled per viewport\n",
+            gViewportCount, (double)mRecorded / mReplays, (double)mDrawn / mReplays,
+            (double)( mRecorded - mDrawn ) / mReplays );
+}
+
+void setupViewports() {
+    if( gViewportCount == 3 )
+    {
+        //Top left, top right and bottom halves
+        SDL_Rect layout[ 3 ] = {
+            { 0, 0, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 },
+            { SCREEN_WIDTH / 2, 0, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 },
+            { 0, SCREEN_HEIGHT / 2, SCREEN_WIDTH, SCREEN_HEIGHT / 2 }
+        };
+        for( int i = 0; i < 3; ++i )
+        {
+            gViewports[ i ].screen = layout[ i ];
+        }
+    }
+    else
+    {
+        //Grid as close to square as the count allows
+        int columns = (int)ceil( sqrt( (double)gViewportCount ) );
+        int rows = ( gViewportCount + columns - 1 ) / columns;
+        for( int i = 0; i < gViewportCount; ++i )
+        {
+            int column = i % columns;
+            int row = i / columns;
+            SDL_Rect& screen = gViewports[ i ].screen;
+            screen.x = column * SCREEN_WIDTH / columns;
+            screen.y = row * SCREEN_HEIGHT / rows;
+            screen.w = ( column + 1 ) * SCREEN_WIDTH / columns - screen.x;
+            screen.h = ( row + 1 ) * SCREEN_HEIGHT / rows - screen.y;
+        }
+    }
+
+    //Spread cameras over the world, alternating zoom
+    for( int i = 0; i < gViewportCount; ++i )
+    {
+        LCamera& camera = gViewports[ i ].camera;
+        camera.x = (float)( ( i * 3 * WORLD_TILE_WIDTH ) % WORLD_WIDTH );
+        camera.y = (float)( ( i * 2 * WORLD_TILE_HEIGHT ) % WORLD_HEIGHT );
+        camera.zoom = i % 2 == 0 ? 1.f : 1.5f;
+    }
+}
+
+LFrameReadback::LFrameReadback() {
+    //Initialize
+    mCaptureSlot = 0;
+    mProcessSlot = 0;
+    mFreeSlots = NULL;
+    mFilledSlots = NULL;
+    mWorker = NULL;
+    mWidth = 0;
+    mHeight = 0;
+    mMode = READBACK_HASH;
+    mPrintHashes = false;
+    mCombinedHash = 14695981039346656037ULL;
+}
+
+LFrameReadback::~LFrameReadback() {
+    //Deallocate
+    stop();
+}
+
+bool LFrameReadback::start( int width, int height, LReadbackMode mode, bool printHashes ) {
+    mWidth = width;
+    mHeight = height;
+    mMode = mode;
+    mPrintHashes = printHashes;
+    for( int i = 0; i < READBACK_SLOTS; ++i )
+    {
+        mPixels[ i ].resize( width * height );
+    }
+
+    mFreeSlots = SDL_CreateSemaphore( READBACK_SLOTS );
+    mFilledSlots = SDL_CreateSemaphore( 0 );
+    if( mFreeSlots == NULL || mFilledSlots == NULL )
+    {
+        printf( "Unable to create readback semaphores! SDL Error: %s\n", SDL_GetError() );
+        return false;
+    }
+
+    mWorker = SDL_CreateThread( workerThread, "Readback", this );
+    if( mWorker == NULL )
+    {
+        printf( "Unable to create readback thread! SDL Error: %s\n", SDL_GetError() );
+        return false;
+    }
+
+    return true;
+}
+
+void LFrameReadback::capture( SDL_Renderer* renderer, int frame ) {
+    //Block only when the worker is a full ring behind
+    SDL_SemWait( mFreeSlots );
+
+    int slot = mCaptureSlot;
+    mCaptureSlot = ( mCaptureSlot + 1 ) % READBACK_SLOTS;
+    if( SDL_RenderReadPixels( renderer, NULL, SDL_PIXELFORMAT_ARGB8888, &mPixels[ slot ][ 0 ], mWidth * 4 ) != 0 )
+    {
+        printf( "Unable to read frame %d! SDL Error: %s\n", frame, SDL_GetError() );
+    }
+    mFrameNumbers[ slot ] = frame;
+
+    SDL_SemPost( mFilledSlots );
+}
+
+void LFrameReadback::stop() {
+    //Queue a stop marker behind the last frame
+    if( mWorker != NULL )
+    {
+        SDL_SemWait( mFreeSlots );
+        mFrameNumbers[ mCaptureSlot ] = -1;
+        SDL_SemPost( mFilledSlots );
+        SDL_WaitThread( mWorker, NULL );
+        mWorker = NULL;
+    }
+
+    if( mFreeSlots != NULL )
+    {
+        SDL_DestroySemaphore( mFreeSlots );
+        mFreeSlots = NULL;
+    }
+    if( mFilledSlots != NULL )
+    {
+        SDL_DestroySemaphore( mFilledSlots );
+        mFilledSlots = NULL;
+    }
+}
+
+Uint64 LFrameReadback::getCombinedHash() {
+    return mCombinedHash;
+}
+
+int LFrameReadback::workerThread( void* data ) {
+    LFrameReadback* readback = (LFrameReadback*)data;
+    while( true )
+    {
+        SDL_SemWait( readback->mFilledSlots );
+
+        int slot = readback->mProcessSlot;
+        if( readback->mFrameNumbers[ slot ] < 0 )
+        {
+            break;
+        }
+
+        readback->process( slot );
+        readback->mProcessSlot = ( slot + 1 ) % READBACK_SLOTS;
+        SDL_SemPost( readback->mFreeSlots );
+    }
+
+    return 0;
+}
+
+void LFrameReadback::process( int slot ) {
+    std::vector<Uint32>& pixels = mPixels[ slot ];
+    int frame = mFrameNumbers[ slot ];
+    char path[ 64 ];
+
+    switch( mMode )
+    {
+        case READBACK_RAW:
+        {
+            //Raw ARGB8888 rows with no header
+            snprintf( path, sizeof( path ), "frame%05d.raw", frame );
+            FILE* file = fopen( path, "wb" );
+            if( file == NULL || fwrite( &pixels[ 0 ], 4, pixels.size(), file ) != pixels.size() )
+            {
+                printf( "Unable to write %s!\n", path );
+            }
+            if( file != NULL )
+            {
+                fclose( file );
+            }
+            break;
+        }
+
+        case READBACK_PNG:
+        {
+            snprintf( path, sizeof( path ), "frame%05d.png", frame );
+            SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom( &pixels[ 0 ], mWidth, mHeight, 32, mWidth * 4, SDL_PIXELFORMAT_ARGB8888 );
+            if( surface == NULL || IMG_SavePNG( surface, path ) != 0 )
+            {
+                printf( "Unable to write %s! SDL_image Error: %s\n", path, IMG_GetError() );
+            }
+            SDL_FreeSurface( surface );
+            break;
+        }
+
+        default:
+        {
+            //FNV-1a over whole pixels, cheap enough to keep up with rendering
+            Uint64 hash = 14695981039346656037ULL;
+            for( size_t i = 0; i < pixels.size(); ++i )
+            {
+                hash = ( hash ^ pixels[ i ] ) * 1099511628211ULL;
+            }
+
+            mCombinedHash = ( mCombinedHash ^ hash ) * 1099511628211ULL;
+            if( mPrintHashes )
+            {
+                printf( "Frame %d hash %016llx\n", frame, (unsigned long long)hash );
+            }
+            break;
+        }
+    }
+}
+
 int main(int argc, char* args[]) {
+    //Check for viewport count, headless and readback options
+    int headlessFrames = 0;
+    LReadbackMode readbackMode = READBACK_HASH;
+    bool printHashes = false;
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( args[ i ], "--views" ) == 0 && i + 1 < argc )
+        {
+            gViewportCount = atoi( args[ ++i ] );
+            if( gViewportCount < 1 )
+            {
+                gViewportCount = 1;
+            }
+            else if( gViewportCount > MAX_VIEWPORTS )
+            {
+                gViewportCount = MAX_VIEWPORTS;
+            }
+        }
+        else if( strcmp( args[ i ], "--headless" ) == 0 && i + 1 < argc )
+        {
+            headlessFrames = atoi( args[ ++i ] );
+        }
+        else if( strcmp( args[ i ], "--dump" ) == 0 && i + 1 < argc )
+        {
+            ++i;
+            readbackMode = strcmp( args[ i ], "png" ) == 0 ? READBACK_PNG : READBACK_RAW;
+        }
+        else if( strcmp( args[ i ], "--hash" ) == 0 )
+        {
+            printHashes = true;
+        }
+    }
+    setupViewports();
+
+    //Render without a window
+    if( headlessFrames > 0 )
+    {
+        if( !initHeadless() )
+        {
+            printf( "Failed to initialize headless rendering!\n" );
+        }
+        else if( !loadMedia() )
+        {
+            printf( "Failed to load media!\n" );
+        }
+        else
+        {
+            runHeadless( headlessFrames, readbackMode, printHashes );
+        }
+
+        close();
+        return 0;
+    }
+
     // Start up SDL and create window
     if (!init()) {
         printf("Failed to initialize!\n");
@@ -34,6 +613,9 @@ int main(int argc, char* args[]) {
             // Event handler
             SDL_Event e;
 
+            //Time of last camera update
+            Uint32 lastTime = SDL_GetTicks();
+
             while (!quit) {
                 while (SDL_PollEvent( &e ) != 0) {
                     //User requests quit
@@ -42,53 +624,84 @@ int main(int argc, char* args[]) {
                     }
                 }
 
-                SDL_Texture* gTexture = loadTexture("preview.png");
+                //Advance by the real time since the last frame
+                Uint32 currentTime = SDL_GetTicks();
+                renderScene( ( currentTime - lastTime ) / 1000.f );
+                lastTime = currentTime;
+
+                //Update screen
+                SDL_RenderPresent( gRenderer );
+            }
+
+            gScene.printStats();
+        }
+    }
 
-                //Clear screen
-                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
-                SDL_RenderClear( gRenderer );
+    //Free resources and close SDL
+    close();
 
-                //Top left corner viewport
-                SDL_Rect topLeftViewport;
-                topLeftViewport.x = 0;
-                topLeftViewport.y = 0;
-                topLeftViewport.w = SCREEN_WIDTH / 2;
-                topLeftViewport.h = SCREEN_HEIGHT / 2;
-                SDL_RenderSetViewport( gRenderer, &topLeftViewport );
+    return 0;
+}
 
-                //Render texture to screen
-                SDL_RenderCopy( gRenderer, gTexture, NULL, NULL );
+void renderScene( float elapsed )
+{
+    //Pan each camera across the world, wrapping at the edge
+    for( int i = 0; i < gViewportCount; ++i ) {
+        LCamera& camera = gViewports[ i ].camera;
+        camera.x += CAMERA_PAN_SPEED * elapsed;
+        if( camera.x > WORLD_WIDTH - gViewports[ i ].screen.w / camera.zoom ) {
+            camera.x = 0.f;
+        }
+    }
 
-                //Top right viewport
-                SDL_Rect topRightViewport;
-                topRightViewport.x = SCREEN_WIDTH / 2;
-                topRightViewport.y = 0;
-                topRightViewport.w = SCREEN_WIDTH / 2;
-                topRightViewport.h = SCREEN_HEIGHT / 2;
-                SDL_RenderSetViewport( gRenderer, &topRightViewport );
+    //Record the scene once for every viewport
+    gScene.clear();
+    for( int y = 0; y < WORLD_ROWS; ++y ) {
+        for( int x = 0; x < WORLD_COLUMNS; ++x ) {
+            SDL_Rect tile = { x * WORLD_TILE_WIDTH, y * WORLD_TILE_HEIGHT, WORLD_TILE_WIDTH, WORLD_TILE_HEIGHT };
+            gScene.add( gTexture, NULL, tile );
+        }
+    }
 
-                //Render texture to screen
-                SDL_RenderCopy( gRenderer, gTexture, NULL, NULL );
+    //Clear screen
+    SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+    SDL_RenderClear( gRenderer );
 
-                //Bottom viewport
-                SDL_Rect bottomViewport;
-                bottomViewport.x = 0;
-                bottomViewport.y = SCREEN_HEIGHT / 2;
-                bottomViewport.w = SCREEN_WIDTH;
-                bottomViewport.h = SCREEN_HEIGHT / 2;
-                SDL_RenderSetViewport( gRenderer, &bottomViewport );
+    //Replay into each viewport
+    for( int i = 0; i < gViewportCount; ++i ) {
+        gScene.render( gViewports[ i ] );
+    }
 
-                //Render texture to screen
-                SDL_RenderCopy( gRenderer, gTexture, NULL, NULL );
+    //Restore the full screen viewport
+    SDL_RenderSetViewport( gRenderer, NULL );
+}
 
+void runHeadless( int frames, LReadbackMode mode, bool printHashes )
+{
+    LFrameReadback readback;
+    if( !readback.start( SCREEN_WIDTH, SCREEN_HEIGHT, mode, printHashes ) )
+    {
+        return;
+    }
 
-                //Update screen
-                SDL_RenderPresent( gRenderer );
-            }
-        }
+    //Render and read back while the worker handles earlier frames
+    SDL_SetRenderTarget( gRenderer, gOffscreen );
+    Uint64 start = SDL_GetPerformanceCounter();
+    for( int frame = 0; frame < frames; ++frame )
+    {
+        renderScene( HEADLESS_FRAME_SECONDS );
+        readback.capture( gRenderer, frame );
     }
+    readback.stop();
+    double ms = ( SDL_GetPerformanceCounter() - start ) * 1000.0 / SDL_GetPerformanceFrequency();
+    SDL_SetRenderTarget( gRenderer, NULL );
 
-    return 0;
+    printf( "Headless: %d frames in %.1f ms (%.1f FPS)\n", frames, ms, frames * 1000.0 / ms );
+    if( mode == READBACK_HASH )
+    {
+        printf( "Combined frame hash %016llx\n", (unsigned long long)readback.getCombinedHash() );
+    }
+    gScene.printStats();
 }
 
 SDL_Texture* loadTexture(std::string path)
@@ -118,10 +731,51 @@ bool loadMedia() {
     //Loading success flag
     bool success = true;
 
-    //Nothing to load
+    //Load the texture once rather than every frame
+    gTexture = loadTexture( "preview.png" );
+    if( gTexture == NULL )
+    {
+        printf( "Failed to load texture image!\n" );
+        success = false;
+    }
+
     return success;
 }
 
+void close()
+{
+    //Free loaded image
+    SDL_DestroyTexture( gTexture );
+    gTexture = NULL;
+
+    //Free offscreen target
+    if( gOffscreen != NULL )
+    {
+        SDL_DestroyTexture( gOffscreen );
+        gOffscreen = NULL;
+    }
+
+    //Destroy window
+    if( gRenderer != NULL )
+    {
+        SDL_DestroyRenderer( gRenderer );
+        gRenderer = NULL;
+    }
+    if( gWindow != NULL )
+    {
+        SDL_DestroyWindow( gWindow );
+        gWindow = NULL;
+    }
+
+    //Free surface the headless renderer drew into
+    SDL_FreeSurface( gFrameSurface );
+    gFrameSurface = NULL;
+
+    //Quit SDL subsystems
+    IMG_Quit();
+    SDL_Quit();
+}
+
 bool init() {
     // Initialization flag
     bool success = true;
@@ -163,3 +817,54 @@ bool init() {
 
     return success;
 }
+
+bool initHeadless() {
+    //Initialization flag
+    bool success = true;
+
+    //No video subsystem needed, the software renderer draws into memory
+    if( SDL_Init( 0 ) < 0 )
+    {
+        printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+        success = false;
+    }
+    else
+    {
+        //Surface backing the software renderer
+        gFrameSurface = SDL_CreateRGBSurfaceWithFormat( 0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888 );
+        if( gFrameSurface == NULL )
+        {
+            printf( "Frame surface could not be created! SDL Error: %s\n", SDL_GetError() );
+            success = false;
+        }
+        else
+        {
+            gRenderer = SDL_CreateSoftwareRenderer( gFrameSurface );
+            if( gRenderer == NULL )
+            {
+                printf( "Software renderer could not be created! SDL Error: %s\n", SDL_GetError() );
+                success = false;
+            }
+            else
+            {
+                //Target the frames are rendered into and read back from
+                gOffscreen = SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, SCREEN_WIDTH, SCREEN_HEIGHT );
+                if( gOffscreen == NULL )
+                {
+                    printf( "Offscreen target could not be created! SDL Error: %s\n", SDL_GetError() );
+                    success = false;
+                }
+
+                //Initialize PNG loading
+                int imgFlags = IMG_INIT_PNG;
+                if( !( IMG_Init( imgFlags ) & imgFlags ) )
+                {
+                    printf( "SDL_image could not initialize! SDL_image Error: %s\n", IMG_GetError() );
+                    success = false;
+                }
+            }
+        }
+    }
+
+    return success;
+}
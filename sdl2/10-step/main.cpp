@@ -1,7 +1,10 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <string>
+#include <vector>
 
 class LTexture
 {
@@ -34,9 +37,153 @@ class LTexture
         int mHeight;
 };
 
+//Static texture placed inside a layer
+struct LLayerMember
+{
+    //Texture drawn by this member
+    LTexture* texture;
+
+    //Position inside the layer
+    int x;
+    int y;
+
+    //Whether the member is composited
+    bool visible;
+};
+
+//Group of static textures composited once into a cached render target
+class LLayer
+{
+    public:
+        //Initializes variables
+        LLayer();
+
+        //Deallocates memory
+        ~LLayer();
+
+        //Creates the cache target with the given dimensions, or draws members directly if not cached
+        bool create( int width, int height, bool cached = true );
+
+        //Deallocates the cache target and forgets all members
+        void free();
+
+        //Adds a static member at given point and returns its index
+        int addMember( LTexture* texture, int x, int y );
+
+        //Moves a member, invalidating the cache
+        void setMemberPosition( int index, int x, int y );
+
+        //Shows or hides a member, invalidating the cache
+        void setMemberVisible( int index, bool visible );
+
+        //Marks the area a member covers as changed so that part of the cache is recomposited
+        void invalidate( int index );
+
+        //Marks the whole cache as lost (e.g. after a render target reset)
+        void invalidateAll();
+
+        //Renders the cached layer at given point, recompositing it first if needed
+        void render( int x, int y );
+
+        //Prints invalidation and cache statistics
+        void printStats();
+
+    private:
+        //Adds an area to the part of the cache that must be recomposited
+        void invalidateRect( const SDL_Rect& area );
+
+        //Redraws the members overlapping the dirty area into the cache target
+        void composite();
+
+        //The cached render target
+        SDL_Texture* mTarget;
+
+        //Layer dimensions
+        int mWidth;
+        int mHeight;
+
+        //Static content of the layer
+        std::vector<LLayerMember> mMembers;
+
+        //Whether the cache must be recomposited before the next render, and the area to redraw
+        bool mDirty;
+        SDL_Rect mDirtyRect;
+
+        //Statistics
+        Uint32 mFrames;
+        Uint32 mRebuilds;
+        Uint32 mInvalidations;
+        Uint32 mMemberCopiesSaved;
+        Uint64 mRebuildTicks;
+        Uint64 mRebuildPixels;
+};
+
+//What the readback worker does with each frame
+enum LReadbackMode
+{
+    READBACK_HASH,
+    READBACK_RAW,
+    READBACK_PNG
+};
+
+//Reads rendered frames back into memory and hashes or dumps them on a worker thread
+class LFrameReadback
+{
+    public:
+        //Initializes variables
+        LFrameReadback();
+
+        //Deallocates memory
+        ~LFrameReadback();
+
+        //Allocates frame slots and starts the worker
+        bool start( int width, int height, LReadbackMode mode, bool printHashes );
+
+        //Copies the current render target into a free slot and queues it for the worker
+        void capture( SDL_Renderer* renderer, int frame );
+
+        //Waits for queued frames to finish and stops the worker
+        void stop();
+
+        //Gets a hash over every frame's hash in order
+        Uint64 getCombinedHash();
+
+    private:
+        //Hashes or dumps queued frames until stopped
+        static int workerThread( void* data );
+
+        //Handles one read back frame
+        void process( int slot );
+
+        //Frame slots shared between the renderer and the worker
+        std::vector<Uint32> mPixels[ 3 ];
+        int mFrameNumbers[ 3 ];
+
+        //Slot the renderer fills next and slot the worker handles next
+        int mCaptureSlot;
+        int mProcessSlot;
+
+        //Counts of empty and filled slots
+        SDL_sem* mFreeSlots;
+        SDL_sem* mFilledSlots;
+
+        SDL_Thread* mWorker;
+
+        //Frame dimensions and handling
+        int mWidth;
+        int mHeight;
+        LReadbackMode mMode;
+        bool mPrintHashes;
+
+        Uint64 mCombinedHash;
+};
+
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
+//Frames in flight between the renderer and the readback worker
+const int READBACK_SLOTS = 3;
+
 //The window we'll be rendering to
 SDL_Window* gWindow = NULL;
 
@@ -47,6 +194,16 @@ SDL_Renderer* gRenderer = NULL;
 LTexture gFooTexture;
 LTexture gBackgroundTexture;
 
+//Static scene layer
+LLayer gBackgroundLayer;
+
+//Whether the static layer is cached in a render target
+bool gLayerCache = true;
+
+//Offscreen target and the surface backing the software renderer in headless mode
+SDL_Texture* gOffscreen = NULL;
+SDL_Surface* gFrameSurface = NULL;
+
 bool LTexture::loadFromFile( std::string path ) {
     //Get rid of preexisting texture
     free();
@@ -123,11 +280,465 @@ LTexture::~LTexture() {
     free();
 }
 
+LLayer::LLayer() {
+    //Initialize
+    mTarget = NULL;
+    mWidth = 0;
+    mHeight = 0;
+    mDirty = true;
+    mDirtyRect.x = 0;
+    mDirtyRect.y = 0;
+    mDirtyRect.w = 0;
+    mDirtyRect.h = 0;
+
+    mFrames = 0;
+    mRebuilds = 0;
+    mInvalidations = 0;
+    mMemberCopiesSaved = 0;
+    mRebuildTicks = 0;
+    mRebuildPixels = 0;
+}
+
+LLayer::~LLayer() {
+    //Deallocate
+    free();
+}
+
+bool LLayer::create( int width, int height, bool cached ) {
+    //Get rid of preexisting target
+    free();
+
+    mWidth = width;
+    mHeight = height;
+    SDL_Rect area = { 0, 0, width, height };
+    invalidateRect( area );
+
+    //Uncached layers draw their members every frame
+    if( !cached )
+    {
+        return true;
+    }
+
+    //Without render targets the layer falls back to drawing its members directly
+    if( !SDL_RenderTargetSupported( gRenderer ) )
+    {
+        printf( "Warning: Render targets not supported, layer will not be cached!\n" );
+        return true;
+    }
+
+    //Create the cache target
+    mTarget = SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height );
+    if( mTarget == NULL )
+    {
+        printf( "Unable to create layer target! SDL Error: %s\n", SDL_GetError() );
+    }
+    else
+    {
+        //Members blended into a transparent target come out premultiplied, so the cache is drawn with a premultiplied over
+        SDL_BlendMode premultiplied = SDL_ComposeCustomBlendMode( SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+                                                                  SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD );
+        if( SDL_SetTextureBlendMode( mTarget, premultiplied ) != 0 )
+        {
+            //Plain blending would apply member alpha twice, drawing the members directly is the only exact fallback
+            printf( "Warning: Premultiplied blending not supported, layer will not be cached!\n" );
+            SDL_DestroyTexture( mTarget );
+            mTarget = NULL;
+            return true;
+        }
+    }
+
+    return mTarget != NULL;
+}
+
+void LLayer::free() {
+    //Free target if it exists
+    if( mTarget != NULL )
+    {
+        SDL_DestroyTexture( mTarget );
+        mTarget = NULL;
+    }
+
+    mMembers.clear();
+    mWidth = 0;
+    mHeight = 0;
+
+    //Nothing left to composite
+    mDirty = false;
+}
+
+int LLayer::addMember( LTexture* texture, int x, int y ) {
+    LLayerMember member = { texture, x, y, true };
+    mMembers.push_back( member );
+
+    //A new member changes the composited content under it
+    SDL_Rect area = { x, y, texture->getWidth(), texture->getHeight() };
+    invalidateRect( area );
+
+    return (int)mMembers.size() - 1;
+}
+
+void LLayer::setMemberPosition( int index, int x, int y ) {
+    LLayerMember& member = mMembers[ index ];
+    if( member.x != x || member.y != y )
+    {
+        //Both the uncovered and the newly covered area change
+        SDL_Rect oldArea = { member.x, member.y, member.texture->getWidth(), member.texture->getHeight() };
+        invalidateRect( oldArea );
+        member.x = x;
+        member.y = y;
+        invalidate( index );
+    }
+}
+
+void LLayer::setMemberVisible( int index, bool visible ) {
+    if( mMembers[ index ].visible != visible )
+    {
+        mMembers[ index ].visible = visible;
+        invalidate( index );
+    }
+}
+
+void LLayer::invalidate( int index ) {
+    const LLayerMember& member = mMembers[ index ];
+    SDL_Rect area = { member.x, member.y, member.texture->getWidth(), member.texture->getHeight() };
+    invalidateRect( area );
+    ++mInvalidations;
+}
+
+void LLayer::invalidateAll() {
+    SDL_Rect area = { 0, 0, mWidth, mHeight };
+    invalidateRect( area );
+    ++mInvalidations;
+}
+
+void LLayer::invalidateRect( const SDL_Rect& area ) {
+    //Grow the dirty area to cover the new one
+    if( mDirty )
+    {
+        SDL_UnionRect( &mDirtyRect, &area, &mDirtyRect );
+    }
+    else
+    {
+        mDirtyRect = area;
+    }
+    mDirty = true;
+}
+
+void LLayer::composite() {
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    //Draw members into the cache instead of the current target
+    SDL_Texture* previousTarget = SDL_GetRenderTarget( gRenderer );
+    SDL_SetRenderTarget( gRenderer, mTarget );
+
+    //Only the dirty part of the layer is redrawn
+    SDL_Rect layerArea = { 0, 0, mWidth, mHeight };
+    SDL_Rect area;
+    if( SDL_IntersectRect( &mDirtyRect, &layerArea, &area ) )
+    {
+        //Make the dirty area fully transparent, clears ignore the clip rect so fill it without blending
+        SDL_RenderSetClipRect( gRenderer, &area );
+        SDL_SetRenderDrawBlendMode( gRenderer, SDL_BLENDMODE_NONE );
+        SDL_SetRenderDrawColor( gRenderer, 0x00, 0x00, 0x00, 0x00 );
+        SDL_RenderFillRect( gRenderer, &area );
+
+        //Redraw the members under it, the clip rect keeps the rest of the cache intact
+        for( size_t i = 0; i < mMembers.size(); ++i )
+        {
+            SDL_Rect memberArea = { mMembers[ i ].x, mMembers[ i ].y, mMembers[ i ].texture->getWidth(), mMembers[ i ].texture->getHeight() };
+            if( mMembers[ i ].visible && SDL_HasIntersection( &memberArea, &area ) )
+            {
+                mMembers[ i ].texture->render( mMembers[ i ].x, mMembers[ i ].y );
+            }
+        }
+
+        SDL_RenderSetClipRect( gRenderer, NULL );
+        mRebuildPixels += (Uint64)area.w * area.h;
+    }
+
+    //Restore the window or offscreen target
+    SDL_SetRenderTarget( gRenderer, previousTarget );
+
+    mDirty = false;
+    ++mRebuilds;
+    mRebuildTicks += SDL_GetPerformanceCounter() - start;
+}
+
+void LLayer::render( int x, int y ) {
+    ++mFrames;
+
+    //No cache available, draw the members every frame
+    if( mTarget == NULL )
+    {
+        for( size_t i = 0; i < mMembers.size(); ++i )
+        {
+            if( mMembers[ i ].visible )
+            {
+                mMembers[ i ].texture->render( x + mMembers[ i ].x, y + mMembers[ i ].y );
+            }
+        }
+        return;
+    }
+
+    //Recomposite only when a member changed
+    if( mDirty )
+    {
+        composite();
+    }
+    else
+    {
+        for( size_t i = 0; i < mMembers.size(); ++i )
+        {
+            if( mMembers[ i ].visible )
+            {
+                ++mMemberCopiesSaved;
+            }
+        }
+    }
+
+    //One copy of the whole layer
+    SDL_Rect renderQuad = { x, y, mWidth, mHeight };
+    SDL_RenderCopy( gRenderer, mTarget, NULL, &renderQuad );
+}
+
+void LLayer::printStats() {
+    //Hit rates mean nothing without a cache
+    if( mTarget == NULL )
+    {
+        printf( "Layer: %u frames drawn uncached\n", mFrames );
+        return;
+    }
+
+    double rebuildMs = mRebuilds > 0 ? mRebuildTicks * 1000.0 / SDL_GetPerformanceFrequency() / mRebuilds : 0.0;
+    double hitRate = mFrames > 0 ? 100.0 * ( mFrames - mRebuilds ) / mFrames : 0.0;
+    double rebuildArea = mRebuilds > 0 && mWidth > 0 && mHeight > 0 ? 100.0 * mRebuildPixels / mRebuilds / ( (double)mWidth * mHeight ) : 0.0;
+
+    printf( "Layer: %u frames, %u invalidations, %u rebuilds (%.3f ms, %.1f%% of the layer avg), %.1f%% cache hits, %u member copies saved\n",
+            mFrames, mInvalidations, mRebuilds, rebuildMs, rebuildArea, hitRate, mMemberCopiesSaved );
+}
+
+LFrameReadback::LFrameReadback() {
+    //Initialize
+    mCaptureSlot = 0;
+    mProcessSlot = 0;
+    mFreeSlots = NULL;
+    mFilledSlots = NULL;
+    mWorker = NULL;
+    mWidth = 0;
+    mHeight = 0;
+    mMode = READBACK_HASH;
+    mPrintHashes = false;
+    mCombinedHash = 14695981039346656037ULL;
+}
+
+LFrameReadback::~LFrameReadback() {
+    //Deallocate
+    stop();
+}
+
+bool LFrameReadback::start( int width, int height, LReadbackMode mode, bool printHashes ) {
+    mWidth = width;
+    mHeight = height;
+    mMode = mode;
+    mPrintHashes = printHashes;
+    for( int i = 0; i < READBACK_SLOTS; ++i )
+    {
+        mPixels[ i ].resize( width * height );
+    }
+
+    mFreeSlots = SDL_CreateSemaphore( READBACK_SLOTS );
+    mFilledSlots = SDL_CreateSemaphore( 0 );
+    if( mFreeSlots == NULL || mFilledSlots == NULL )
+    {
+        printf( "Unable to create readback semaphores! SDL Error: %s\n", SDL_GetError() );
+        return false;
+    }
+
+    mWorker = SDL_CreateThread( workerThread, "Readback", this );
+    if( mWorker == NULL )
+    {
+        printf( "Unable to create readback thread! SDL Error: %s\n", SDL_GetError() );
+        return false;
+    }
+
+    return true;
+}
+
+void LFrameReadback::capture( SDL_Renderer* renderer, int frame ) {
+    //Block only when the worker is a full ring behind
+    SDL_SemWait( mFreeSlots );
+
+    int slot = mCaptureSlot;
+    mCaptureSlot = ( mCaptureSlot + 1 ) % READBACK_SLOTS;
+    if( SDL_RenderReadPixels( renderer, NULL, SDL_PIXELFORMAT_ARGB8888, &mPixels[ slot ][ 0 ], mWidth * 4 ) != 0 )
+    {
+        printf( "Unable to read frame %d! SDL Error: %s\n", frame, SDL_GetError() );
+    }
+    mFrameNumbers[ slot ] = frame;
+
+    SDL_SemPost( mFilledSlots );
+}
+
+void LFrameReadback::stop() {
+    //Queue a stop marker behind the last frame
+    if( mWorker != NULL )
+    {
+        SDL_SemWait( mFreeSlots );
+        mFrameNumbers[ mCaptureSlot ] = -1;
+        SDL_SemPost( mFilledSlots );
+        SDL_WaitThread( mWorker, NULL );
+        mWorker = NULL;
+    }
+
+    if( mFreeSlots != NULL )
+    {
+        SDL_DestroySemaphore( mFreeSlots );
+        mFreeSlots = NULL;
+    }
+    if( mFilledSlots != NULL )
+    {
+        SDL_DestroySemaphore( mFilledSlots );
+        mFilledSlots = NULL;
+    }
+}
+
+Uint64 LFrameReadback::getCombinedHash() {
+    return mCombinedHash;
+}
+
+int LFrameReadback::workerThread( void* data ) {
+    LFrameReadback* readback = (LFrameReadback*)data;
+    while( true )
+    {
+        SDL_SemWait( readback->mFilledSlots );
+
+        int slot = readback->mProcessSlot;
+        if( readback->mFrameNumbers[ slot ] < 0 )
+        {
+            break;
+        }
+
+        readback->process( slot );
+        readback->mProcessSlot = ( slot + 1 ) % READBACK_SLOTS;
+        SDL_SemPost( readback->mFreeSlots );
+    }
+
+    return 0;
+}
+
+void LFrameReadback::process( int slot ) {
+    std::vector<Uint32>& pixels = mPixels[ slot ];
+    int frame = mFrameNumbers[ slot ];
+    char path[ 64 ];
+
+    switch( mMode )
+    {
+        case READBACK_RAW:
+        {
+            //Raw ARGB8888 rows with no header
+            snprintf( path, sizeof( path ), "frame%05d.raw", frame );
+            FILE* file = fopen( path, "wb" );
+            if( file == NULL || fwrite( &pixels[ 0 ], 4, pixels.size(), file ) != pixels.size() )
+            {
+                printf( "Unable to write %s!\n", path );
+            }
+            if( file != NULL )
+            {
+                fclose( file );
+            }
+            break;
+        }
+
+        case READBACK_PNG:
+        {
+            snprintf( path, sizeof( path ), "frame%05d.png", frame );
+            SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom( &pixels[ 0 ], mWidth, mHeight, 32, mWidth * 4, SDL_PIXELFORMAT_ARGB8888 );
+            if( surface == NULL || IMG_SavePNG( surface, path ) != 0 )
+            {
+                printf( "Unable to write %s! SDL_image Error: %s\n", path, IMG_GetError() );
+            }
+            SDL_FreeSurface( surface );
+            break;
+        }
+
+        default:
+        {
+            //FNV-1a over whole pixels, cheap enough to keep up with rendering
+            Uint64 hash = 14695981039346656037ULL;
+            for( size_t i = 0; i < pixels.size(); ++i )
+            {
+                hash = ( hash ^ pixels[ i ] ) * 1099511628211ULL;
+            }
+
+            mCombinedHash = ( mCombinedHash ^ hash ) * 1099511628211ULL;
+            if( mPrintHashes )
+            {
+                printf( "Frame %d hash %016llx\n", frame, (unsigned long long)hash );
+            }
+            break;
+        }
+    }
+}
+
 bool loadMedia();
 void close();
 bool init();
 
+//Starts up SDL with a software renderer drawing into an offscreen target, no window needed
+bool initHeadless();
+
+//Draws the frame to the current render target
+void renderScene();
+
+//Renders frames offscreen as fast as possible and reads each one back
+void runHeadless( int frames, LReadbackMode mode, bool printHashes );
+
 int main(int argc, char* args[]) {
+    //Check for headless and readback options
+    int headlessFrames = 0;
+    LReadbackMode readbackMode = READBACK_HASH;
+    bool printHashes = false;
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( args[ i ], "--headless" ) == 0 && i + 1 < argc )
+        {
+            headlessFrames = atoi( args[ ++i ] );
+        }
+        else if( strcmp( args[ i ], "--dump" ) == 0 && i + 1 < argc )
+        {
+            ++i;
+            readbackMode = strcmp( args[ i ], "png" ) == 0 ? READBACK_PNG : READBACK_RAW;
+        }
+        else if( strcmp( args[ i ], "--hash" ) == 0 )
+        {
+            printHashes = true;
+        }
+        else if( strcmp( args[ i ], "--no-layer-cache" ) == 0 )
+        {
+            gLayerCache = false;
+        }
+    }
+
+    //Render without a window
+    if( headlessFrames > 0 )
+    {
+        if( !initHeadless() )
+        {
+            printf( "Failed to initialize headless rendering!\n" );
+        }
+        else if( !loadMedia() )
+        {
+            printf( "Failed to load media!\n" );
+        }
+        else
+        {
+            runHeadless( headlessFrames, readbackMode, printHashes );
+        }
+
+        close();
+        return 0;
+    }
+
     // Start up SDL and create window
     if (!init()) {
         printf("Failed to initialize!\n");
@@ -147,29 +758,71 @@ int main(int argc, char* args[]) {
                     //User requests quit
                     if( e.type == SDL_QUIT ) {
                         quit = true;
-                        close();
+                    }
+                    //Target contents are lost when the renderer resets
+                    else if( e.type == SDL_RENDER_TARGETS_RESET || e.type == SDL_RENDER_DEVICE_RESET ) {
+                        gBackgroundLayer.invalidateAll();
                     }
                 }
 
-                //Clear screen
-                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
-                SDL_RenderClear( gRenderer );
-
-                //Render background texture to screen
-                gBackgroundTexture.render( 0, 0 );
-
-                //Render Foo' to the screen
-                gFooTexture.render( 240, 190 );
+                renderScene();
 
                 //Update screen
                 SDL_RenderPresent( gRenderer );
             }
+
+            //Report how often the static layer was recomposited
+            gBackgroundLayer.printStats();
         }
     }
 
+    //Free resources and close SDL
+    close();
+
     return 0;
 }
 
+void renderScene()
+{
+    //Clear screen
+    SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+    SDL_RenderClear( gRenderer );
+
+    //Render cached static layer to screen
+    gBackgroundLayer.render( 0, 0 );
+
+    //Render Foo' to the screen
+    gFooTexture.render( 240, 190 );
+}
+
+void runHeadless( int frames, LReadbackMode mode, bool printHashes )
+{
+    LFrameReadback readback;
+    if( !readback.start( SCREEN_WIDTH, SCREEN_HEIGHT, mode, printHashes ) )
+    {
+        return;
+    }
+
+    //Render and read back while the worker handles earlier frames
+    SDL_SetRenderTarget( gRenderer, gOffscreen );
+    Uint64 start = SDL_GetPerformanceCounter();
+    for( int frame = 0; frame < frames; ++frame )
+    {
+        renderScene();
+        readback.capture( gRenderer, frame );
+    }
+    readback.stop();
+    double ms = ( SDL_GetPerformanceCounter() - start ) * 1000.0 / SDL_GetPerformanceFrequency();
+    SDL_SetRenderTarget( gRenderer, NULL );
+
+    printf( "Headless: %d frames in %.1f ms (%.1f FPS)\n", frames, ms, frames * 1000.0 / ms );
+    if( mode == READBACK_HASH )
+    {
+        printf( "Combined frame hash %016llx\n", (unsigned long long)readback.getCombinedHash() );
+    }
+    gBackgroundLayer.printStats();
+}
+
 bool loadMedia()
 {
     //Loading success flag
@@ -188,6 +841,16 @@ bool loadMedia()
         printf( "Failed to load background texture image!\n" );
         success = false;
     }
+    //Composite static content into the background layer
+    else if( !gBackgroundLayer.create( SCREEN_WIDTH, SCREEN_HEIGHT, gLayerCache ) )
+    {
+        printf( "Failed to create background layer!\n" );
+        success = false;
+    }
+    else
+    {
+        gBackgroundLayer.addMember( &gBackgroundTexture, 0, 0 );
+    }
 
     return success;
 }
@@ -195,14 +858,32 @@ bool loadMedia()
 void close()
 {
     //Free loaded images
+    gBackgroundLayer.free();
     gFooTexture.free();
     gBackgroundTexture.free();
 
+    //Free offscreen target
+    if( gOffscreen != NULL )
+    {
+        SDL_DestroyTexture( gOffscreen );
+        gOffscreen = NULL;
+    }
+
     //Destroy window
-    SDL_DestroyRenderer( gRenderer );
-    SDL_DestroyWindow( gWindow );
-    gWindow = NULL;
-    gRenderer = NULL;
+    if( gRenderer != NULL )
+    {
+        SDL_DestroyRenderer( gRenderer );
+        gRenderer = NULL;
+    }
+    if( gWindow != NULL )
+    {
+        SDL_DestroyWindow( gWindow );
+        gWindow = NULL;
+    }
+
+    //Free surface the headless renderer drew into
+    SDL_FreeSurface( gFrameSurface );
+    gFrameSurface = NULL;
 
     //Quit SDL subsystems
     IMG_Quit();
@@ -230,8 +911,8 @@ bool init() {
             printf("Window could not be created! SDL Error: %s\n", SDL_GetError());
             success = false;
         } else {
-            // Create renderer for window
-            gRenderer = SDL_CreateRenderer(gWindow, -1, SDL_RENDERER_ACCELERATED);
+            // Create renderer for window with render target support for layer caching
+            gRenderer = SDL_CreateRenderer(gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE);
             if (gRenderer == NULL) {
                 printf("Renderer could not be created! SDL Error: %s\n", SDL_GetError());
                 success = false;
@@ -251,3 +932,54 @@ bool init() {
 
     return success;
 }
+
+bool initHeadless() {
+    //Initialization flag
+    bool success = true;
+
+    //No video subsystem needed, the software renderer draws into memory
+    if( SDL_Init( 0 ) < 0 )
+    {
+        printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+        success = false;
+    }
+    else
+    {
+        //Surface backing the software renderer
+        gFrameSurface = SDL_CreateRGBSurfaceWithFormat( 0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888 );
+        if( gFrameSurface == NULL )
+        {
+            printf( "Frame surface could not be created! SDL Error: %s\n", SDL_GetError() );
+            success = false;
+        }
+        else
+        {
+            gRenderer = SDL_CreateSoftwareRenderer( gFrameSurface );
+            if( gRenderer == NULL )
+            {
+                printf( "Software renderer could not be created! SDL Error: %s\n", SDL_GetError() );
+                success = false;
+            }
+            else
+            {
+                //Target the frames are rendered into and read back from
+                gOffscreen = SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, SCREEN_WIDTH, SCREEN_HEIGHT );
+                if( gOffscreen == NULL )
+                {
+                    printf( "Offscreen target could not be created! SDL Error: %s\n", SDL_GetError() );
+                    success = false;
+                }
+
+                //Initialize PNG loading
+                int imgFlags = IMG_INIT_PNG;
+                if( !( IMG_Init( imgFlags ) & imgFlags ) )
+                {
+                    printf( "SDL_image could not initialize! SDL_image Error: %s\n", IMG_GetError() );
+                    success = false;
+                }
+            }
+        }
+    }
+
+    return success;
+}
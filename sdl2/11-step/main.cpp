@@ -1,7 +1,12 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <stdio.h>
+#include <string.h>
 #include <string>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 class LTexture
 {
@@ -12,8 +17,8 @@ class LTexture
         //Deallocates memory
         ~LTexture();
 
-        //Loads image at specified path
-        bool loadFromFile( std::string path );
+        //Loads image at specified path, optionally building a mip chain for downscaled rendering
+        bool loadFromFile( std::string path, bool generateMips = false );
 
         //Deallocates texture
         void free();
@@ -21,14 +26,36 @@ class LTexture
         //Renders texture at given point
         void render( int x, int y, SDL_Rect* clip = NULL );
 
+        //Renders texture scaled into given rect from the nearest mip level
+        void renderScaled( int x, int y, int width, int height, SDL_Rect* clip = NULL );
+
+        //Enables or disables mip level selection
+        void setMipsEnabled( bool enabled );
+
         //Gets image dimensions
         int getWidth();
         int getHeight();
 
+        //Gets the number of mip levels below the full size image
+        int getMipCount();
+
+        //Gets the texture memory used by the full size image and by the mip chain
+        size_t getBaseBytes();
+        size_t getMipBytes();
+
     private:
+        //Picks the smallest level that still covers the destination size
+        int selectMipLevel( SDL_Rect* clip, int width, int height );
+
         //The actual hardware texture
         SDL_Texture* mTexture;
 
+        //Downscaled copies, level n is 1 / 2^(n+1) of the full size
+        std::vector<SDL_Texture*> mMips;
+
+        //Whether renderScaled may use the mip chain
+        bool mMipsEnabled;
+
         //Image dimensions
         int mWidth;
         int mHeight;
@@ -47,7 +74,109 @@ SDL_Renderer* gRenderer = NULL;
 SDL_Rect gSpriteClips[ 4 ];
 LTexture gSpriteSheetTexture;
 
-bool LTexture::loadFromFile( std::string path ) {
+//Maximum number of downscaled levels generated per texture
+const int MAX_MIP_LEVELS = 8;
+
+//Scales the color of an RGBA32 surface by its alpha, so keyed out texels stop contributing their color
+void premultiplyAlpha( SDL_Surface* surface )
+{
+    for( int y = 0; y < surface->h; ++y )
+    {
+        Uint8* row = (Uint8*)surface->pixels + y * surface->pitch;
+        for( int x = 0; x < surface->w; ++x )
+        {
+            Uint8* pixel = row + x * 4;
+            for( int c = 0; c < 3; ++c )
+            {
+                pixel[ c ] = (Uint8)( ( pixel[ c ] * pixel[ 3 ] + 127 ) / 255 );
+            }
+        }
+    }
+}
+
+//Copies a premultiplied RGBA32 surface into another with straight alpha, the form the blend mode expects
+void unpremultiplyAlpha( SDL_Surface* source, SDL_Surface* destination )
+{
+    for( int y = 0; y < source->h; ++y )
+    {
+        const Uint8* in = (const Uint8*)source->pixels + y * source->pitch;
+        Uint8* out = (Uint8*)destination->pixels + y * destination->pitch;
+        for( int x = 0; x < source->w; ++x )
+        {
+            int alpha = in[ x * 4 + 3 ];
+            for( int c = 0; c < 3; ++c )
+            {
+                out[ x * 4 + c ] = alpha == 0 ? 0 : (Uint8)SDL_min( ( in[ x * 4 + c ] * 255 + alpha / 2 ) / alpha, 255 );
+            }
+            out[ x * 4 + 3 ] = (Uint8)alpha;
+        }
+    }
+}
+
+//Halves an RGBA32 surface into another with a 2x2 box filter
+void boxDownsample( SDL_Surface* source, SDL_Surface* destination )
+{
+    const int dstW = destination->w;
+    const int dstH = destination->h;
+
+    for( int y = 0; y < dstH; ++y )
+    {
+        //Odd sized sources reuse their last row/column
+        int sy0 = 2 * y;
+        int sy1 = SDL_min( sy0 + 1, source->h - 1 );
+
+        const Uint8* rowA = (const Uint8*)source->pixels + sy0 * source->pitch;
+        const Uint8* rowB = (const Uint8*)source->pixels + sy1 * source->pitch;
+        Uint8* out = (Uint8*)destination->pixels + y * destination->pitch;
+
+        int x = 0;
+
+#ifdef __SSE2__
+        //Four output pixels from eight source pixels on each row per iteration
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i round = _mm_set1_epi16( 2 );
+        for( ; x + 4 <= dstW && 2 * x + 8 <= source->w; x += 4 )
+        {
+            __m128i a0 = _mm_loadu_si128( (const __m128i*)( rowA + x * 8 ) );
+            __m128i a1 = _mm_loadu_si128( (const __m128i*)( rowA + x * 8 + 16 ) );
+            __m128i b0 = _mm_loadu_si128( (const __m128i*)( rowB + x * 8 ) );
+            __m128i b1 = _mm_loadu_si128( (const __m128i*)( rowB + x * 8 + 16 ) );
+
+            //Vertical sums, two source pixels per register
+            __m128i v0 = _mm_add_epi16( _mm_unpacklo_epi8( a0, zero ), _mm_unpacklo_epi8( b0, zero ) );
+            __m128i v1 = _mm_add_epi16( _mm_unpackhi_epi8( a0, zero ), _mm_unpackhi_epi8( b0, zero ) );
+            __m128i v2 = _mm_add_epi16( _mm_unpacklo_epi8( a1, zero ), _mm_unpacklo_epi8( b1, zero ) );
+            __m128i v3 = _mm_add_epi16( _mm_unpackhi_epi8( a1, zero ), _mm_unpackhi_epi8( b1, zero ) );
+
+            //Horizontal sums of neighbouring pixels
+            __m128i h0 = _mm_add_epi16( v0, _mm_srli_si128( v0, 8 ) );
+            __m128i h1 = _mm_add_epi16( v1, _mm_srli_si128( v1, 8 ) );
+            __m128i h2 = _mm_add_epi16( v2, _mm_srli_si128( v2, 8 ) );
+            __m128i h3 = _mm_add_epi16( v3, _mm_srli_si128( v3, 8 ) );
+
+            //Rounded average of the four samples
+            __m128i lo = _mm_srli_epi16( _mm_add_epi16( _mm_unpacklo_epi64( h0, h1 ), round ), 2 );
+            __m128i hi = _mm_srli_epi16( _mm_add_epi16( _mm_unpacklo_epi64( h2, h3 ), round ), 2 );
+
+            _mm_storeu_si128( (__m128i*)( out + x * 4 ), _mm_packus_epi16( lo, hi ) );
+        }
+#endif
+
+        //Remaining pixels
+        for( ; x < dstW; ++x )
+        {
+            int sx0 = 2 * x;
+            int sx1 = SDL_min( sx0 + 1, source->w - 1 );
+            for( int c = 0; c < 4; ++c )
+            {
+                int sum = rowA[ sx0 * 4 + c ] + rowA[ sx1 * 4 + c ] + rowB[ sx0 * 4 + c ] + rowB[ sx1 * 4 + c ];
+                out[ x * 4 + c ] = (Uint8)( ( sum + 2 ) >> 2 );
+            }
+        }
+    }
+}
+
+bool LTexture::loadFromFile( std::string path, bool generateMips ) {
     //Get rid of preexisting texture
     free();
     //The final texture
@@ -77,6 +206,56 @@ bool LTexture::loadFromFile( std::string path ) {
             mHeight = loadedSurface->h;
         }
 
+        //Build downscaled levels from the color keyed pixels
+        if( newTexture != NULL && generateMips )
+        {
+            //Averaging happens on premultiplied pixels so the transparent key color doesn't bleed into sprite edges
+            SDL_Surface* level = SDL_ConvertSurfaceFormat( loadedSurface, SDL_PIXELFORMAT_RGBA32, 0 );
+            if( level == NULL )
+            {
+                printf( "Unable to convert %s for mip generation! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+            }
+            else
+            {
+                premultiplyAlpha( level );
+            }
+
+            while( level != NULL && ( level->w > 1 || level->h > 1 ) && (int)mMips.size() < MAX_MIP_LEVELS )
+            {
+                SDL_Surface* next = SDL_CreateRGBSurfaceWithFormat( 0, SDL_max( level->w / 2, 1 ), SDL_max( level->h / 2, 1 ), 32, SDL_PIXELFORMAT_RGBA32 );
+                SDL_Surface* straight = SDL_CreateRGBSurfaceWithFormat( 0, SDL_max( level->w / 2, 1 ), SDL_max( level->h / 2, 1 ), 32, SDL_PIXELFORMAT_RGBA32 );
+                if( next == NULL || straight == NULL )
+                {
+                    printf( "Unable to create mip level for %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+                    SDL_FreeSurface( next );
+                    SDL_FreeSurface( straight );
+                    break;
+                }
+                boxDownsample( level, next );
+
+                //The chain stays premultiplied for the next level, the texture gets straight alpha for normal blending
+                unpremultiplyAlpha( next, straight );
+                SDL_Texture* mip = SDL_CreateTextureFromSurface( gRenderer, straight );
+                SDL_FreeSurface( straight );
+                if( mip == NULL )
+                {
+                    printf( "Unable to create mip texture for %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+                    SDL_FreeSurface( next );
+                    break;
+                }
+                mMips.push_back( mip );
+
+                SDL_FreeSurface( level );
+                level = next;
+            }
+            SDL_FreeSurface( level );
+
+            //Report what the chain costs
+            size_t baseBytes = getBaseBytes();
+            printf( "%s: %d mip levels, %u bytes base + %u bytes chain (+%.1f%%)\n", path.c_str(), getMipCount(),
+                    (unsigned)baseBytes, (unsigned)getMipBytes(), baseBytes > 0 ? 100.0 * getMipBytes() / baseBytes : 0.0 );
+        }
+
         //Get rid of old loaded surface
         SDL_FreeSurface( loadedSurface );
     }
@@ -95,6 +274,13 @@ void LTexture::free() {
         mWidth = 0;
         mHeight = 0;
     }
+
+    //Free mip levels
+    for( size_t i = 0; i < mMips.size(); ++i )
+    {
+        SDL_DestroyTexture( mMips[ i ] );
+    }
+    mMips.clear();
 }
 
 void LTexture::render( int x, int y, SDL_Rect* clip ) {
@@ -112,6 +298,85 @@ void LTexture::render( int x, int y, SDL_Rect* clip ) {
     SDL_RenderCopy( gRenderer, mTexture, clip, &renderQuad );
 }
 
+int LTexture::selectMipLevel( SDL_Rect* clip, int width, int height ) {
+    if( !mMipsEnabled || width <= 0 || height <= 0 )
+    {
+        return 0;
+    }
+
+    int level = 0;
+    while( level < (int)mMips.size() )
+    {
+        int next = level + 1;
+        int scale = 1 << next;
+        if( clip != NULL )
+        {
+            //Clips must land on whole texels of the smaller level
+            if( clip->x % scale != 0 || clip->y % scale != 0 || clip->w % scale != 0 || clip->h % scale != 0 )
+            {
+                break;
+            }
+            if( ( clip->w >> next ) < width || ( clip->h >> next ) < height )
+            {
+                break;
+            }
+        }
+        else if( SDL_max( mWidth >> next, 1 ) < width || SDL_max( mHeight >> next, 1 ) < height )
+        {
+            break;
+        }
+        level = next;
+    }
+
+    return level;
+}
+
+void LTexture::renderScaled( int x, int y, int width, int height, SDL_Rect* clip ) {
+    //Set rendering space
+    SDL_Rect renderQuad = { x, y, width, height };
+
+    int level = selectMipLevel( clip, width, height );
+    if( level == 0 )
+    {
+        SDL_RenderCopy( gRenderer, mTexture, clip, &renderQuad );
+        return;
+    }
+
+    //Map the clip into the selected level
+    if( clip != NULL )
+    {
+        SDL_Rect levelClip = { clip->x >> level, clip->y >> level, clip->w >> level, clip->h >> level };
+        SDL_RenderCopy( gRenderer, mMips[ level - 1 ], &levelClip, &renderQuad );
+    }
+    else
+    {
+        SDL_RenderCopy( gRenderer, mMips[ level - 1 ], NULL, &renderQuad );
+    }
+}
+
+void LTexture::setMipsEnabled( bool enabled ) {
+    mMipsEnabled = enabled;
+}
+
+int LTexture::getMipCount() {
+    return (int)mMips.size();
+}
+
+size_t LTexture::getBaseBytes() {
+    return mTexture != NULL ? (size_t)mWidth * mHeight * 4 : 0;
+}
+
+size_t LTexture::getMipBytes() {
+    size_t bytes = 0;
+    for( size_t i = 0; i < mMips.size(); ++i )
+    {
+        int w, h;
+        SDL_QueryTexture( mMips[ i ], NULL, NULL, &w, &h );
+        bytes += (size_t)w * h * 4;
+    }
+    return bytes;
+}
+
 int LTexture::getWidth() {
     return mWidth;
 }
@@ -125,6 +390,7 @@ LTexture::LTexture() {
     mTexture = NULL;
     mWidth = 0;
     mHeight = 0;
+    mMipsEnabled = true;
 }
 
 LTexture::~LTexture() {
@@ -136,7 +402,20 @@ bool loadMedia();
 void close();
 bool init();
 
+//Times downscaled sheet rendering with and without the mip chain
+void runMipBenchmark();
+
 int main(int argc, char* args[]) {
+    //Check for benchmark mode
+    bool benchmark = false;
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( args[ i ], "--mip-bench" ) == 0 )
+        {
+            benchmark = true;
+        }
+    }
+
     // Start up SDL and create window
     if (!init()) {
         printf("Failed to initialize!\n");
@@ -144,6 +423,9 @@ int main(int argc, char* args[]) {
         // Load media
         if (!loadMedia()) {
             printf("Failed to load media!\n");
+        } else if (benchmark) {
+            runMipBenchmark();
+            close();
         } else {
             // Main loop flag
             bool quit = false;
@@ -185,13 +467,62 @@ int main(int argc, char* args[]) {
     return 0;
 }
 
+void runMipBenchmark()
+{
+    //Thumbnail size the sheet clips are shrunk to
+    const int THUMB_SIZE = 24;
+    const int BENCH_FRAMES = 300;
+
+    double frameMs[ 2 ];
+    for( int pass = 0; pass < 2; ++pass )
+    {
+        gSpriteSheetTexture.setMipsEnabled( pass == 1 );
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        for( int frame = 0; frame < BENCH_FRAMES; ++frame )
+        {
+            SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+            SDL_RenderClear( gRenderer );
+
+            //Fill the screen with shrunken clips
+            int i = 0;
+            for( int y = 0; y + THUMB_SIZE <= SCREEN_HEIGHT; y += THUMB_SIZE )
+            {
+                for( int x = 0; x + THUMB_SIZE <= SCREEN_WIDTH; x += THUMB_SIZE )
+                {
+                    gSpriteSheetTexture.renderScaled( x, y, THUMB_SIZE, THUMB_SIZE, &gSpriteClips[ i++ % 4 ] );
+                }
+            }
+
+            //Whole sheet shrunk as well
+            gSpriteSheetTexture.renderScaled( 0, 0, THUMB_SIZE * 2, THUMB_SIZE * 2 );
+
+            //Read back a pixel so queued draws are included in the timing
+            Uint32 pixel;
+            SDL_Rect probe = { 0, 0, 1, 1 };
+            SDL_RenderReadPixels( gRenderer, &probe, SDL_PIXELFORMAT_RGBA8888, &pixel, 4 );
+
+            SDL_RenderPresent( gRenderer );
+        }
+        frameMs[ pass ] = ( SDL_GetPerformanceCounter() - start ) * 1000.0 / SDL_GetPerformanceFrequency() / BENCH_FRAMES;
+    }
+
+    gSpriteSheetTexture.setMipsEnabled( true );
+
+    size_t baseBytes = gSpriteSheetTexture.getBaseBytes();
+    printf( "Mip chain memory: %u bytes over %u base (+%.1f%%)\n", (unsigned)gSpriteSheetTexture.getMipBytes(), (unsigned)baseBytes,
+            baseBytes > 0 ? 100.0 * gSpriteSheetTexture.getMipBytes() / baseBytes : 0.0 );
+    printf( "Full size sampling: %.3f ms/frame, mip sampling: %.3f ms/frame, speedup %.2fx\n",
+            frameMs[ 0 ], frameMs[ 1 ], frameMs[ 1 ] > 0.0 ? frameMs[ 0 ] / frameMs[ 1 ] : 0.0 );
+}
+
 bool loadMedia()
 {
     //Loading success flag
     bool success = true;
 
     //Load sprite sheet texture
-    if( !gSpriteSheetTexture.loadFromFile( "sprites.png" ) )
+    if( !gSpriteSheetTexture.loadFromFile( "sprites.png", true ) )
     {
         printf( "Failed to load sprite sheet texture!\n" );
         success = false;
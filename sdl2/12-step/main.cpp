@@ -1,7 +1,93 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <string>
+#include <vector>
+#include <algorithm>
+
+//One recorded texture copy and the renderer state it needs
+struct LDrawCommand
+{
+    //Packed layer, blend mode, texture and color that commands are ordered by
+    Uint64 key;
+
+    //Submission order, keeps commands with equal keys in the order they were recorded
+    Uint32 sequence;
+
+    //Color and alpha modulation
+    SDL_Color color;
+    SDL_BlendMode blendMode;
+
+    //Texture to copy
+    SDL_Texture* texture;
+
+    //Destination rect and optional source clip
+    SDL_Rect rect;
+    bool clipped;
+    SDL_Rect clip;
+
+    //Rotation in degrees around the center
+    double angle;
+};
+
+//Records texture copies with a sort key and replays them ordered to minimize texture state changes
+class LCommandBuffer
+{
+    public:
+        //Initializes variables
+        LCommandBuffer();
+
+        //Sets the layer following copies go to, layers are always drawn in increasing order
+        void setLayer( int layer );
+
+        //Sets color and alpha modulation for following copies
+        void setColor( Uint8 r, Uint8 g, Uint8 b, Uint8 a = 0xFF );
+
+        //Sets blend mode for following copies
+        void setBlendMode( SDL_BlendMode blendMode );
+
+        //Records a texture copy
+        void copy( SDL_Texture* texture, SDL_Rect* clip, const SDL_Rect& dest, double angle = 0.0 );
+
+        //Sorts recorded copies within each layer unless told not to and replays them, then empties the buffer
+        void flush( SDL_Renderer* renderer, bool sorted = true );
+
+        //Gets state changes saved by sorting during the last flush
+        int getLastRemoved();
+
+        //Prints state change statistics
+        void printStats();
+
+    private:
+        //Packs layer, blend mode, texture and color into a command's sort key
+        Uint64 makeKey( const LDrawCommand& command );
+
+        //Counts state changes replaying commands in order, issuing them if a renderer is given
+        int replay( SDL_Renderer* renderer );
+
+        //Gets a small id for a texture, stable for the current frame
+        Uint32 getTextureId( SDL_Texture* texture );
+
+        //Recorded copies
+        std::vector<LDrawCommand> mCommands;
+
+        //Textures seen this frame, id is index plus one
+        std::vector<SDL_Texture*> mTextures;
+
+        //Current recording state
+        int mLayer;
+        SDL_Color mColor;
+        SDL_BlendMode mBlendMode;
+
+        //Statistics
+        int mFrames;
+        int mLastRemoved;
+        Uint64 mTotalCommands;
+        Uint64 mTotalUnsorted;
+        Uint64 mTotalSorted;
+};
 
 class LTexture
 {
@@ -21,8 +107,14 @@ class LTexture
         //Set color modulation
         void setColor( Uint8 red, Uint8 green, Uint8 blue );
 
+        //Set alpha modulation
+        void setAlpha( Uint8 alpha );
+
         //Renders texture at given point
-        void render( int x, int y, SDL_Rect* clip = NULL );
+        void render( int x, int y, SDL_Rect* clip = NULL, double angle = 0.0, SDL_Point* center = NULL, SDL_RendererFlip flip = SDL_FLIP_NONE );
+
+        //Records a copy at given point into a command buffer, modulated with the buffer's current color
+        void record( LCommandBuffer& commands, int x, int y, SDL_Rect* clip = NULL, double angle = 0.0 );
 
         //Gets image dimensions
         int getWidth();
@@ -37,6 +129,81 @@ class LTexture
         int mHeight;
 };
 
+//Most sprites a scene snapshot can hold
+const int MAX_SCENE_SPRITES = 64;
+
+//Everything the render thread needs to draw one sprite
+struct SpriteState
+{
+    //Texture to draw
+    LTexture* texture;
+
+    //Command buffer layer, sprites sharing one must not overlap
+    int layer;
+
+    //Position and optional source clip
+    int x;
+    int y;
+    bool clipped;
+    SDL_Rect clip;
+
+    //Rotation in degrees around the center
+    double angle;
+
+    //Color and alpha modulation
+    Uint8 r;
+    Uint8 g;
+    Uint8 b;
+    Uint8 a;
+};
+
+//Immutable scene published by the update thread
+struct SceneSnapshot
+{
+    //Update that produced this snapshot
+    Uint32 sequence;
+
+    //Sprites in draw order
+    int spriteCount;
+    SpriteState sprites[ MAX_SCENE_SPRITES ];
+};
+
+//Lock-free triple buffer passing scene snapshots from the update thread to the render thread
+class LSnapshotBuffer
+{
+    public:
+        //Initializes variables
+        LSnapshotBuffer();
+
+        //Gets the slot the update thread fills next
+        SceneSnapshot* beginWrite();
+
+        //Publishes the filled slot as the latest snapshot
+        void publish();
+
+        //Gets the latest published snapshot, unchanged until the next acquire
+        const SceneSnapshot* acquire();
+
+        //Gets how many snapshots were replaced before the render thread saw them
+        int getDroppedCount();
+
+    private:
+        //Three slots: one being written, one being drawn, one latest published
+        SceneSnapshot mSlots[ 3 ];
+
+        //Slot owned by the update thread
+        int mWriteIndex;
+
+        //Slot owned by the render thread
+        int mReadIndex;
+
+        //Latest published slot, flagged while the render thread hasn't taken it
+        SDL_atomic_t mShared;
+
+        //Snapshots overwritten unseen
+        SDL_atomic_t mDropped;
+};
+
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
@@ -49,6 +216,45 @@ SDL_Renderer* gRenderer = NULL;
 //Scene sprites
 LTexture gModulatedTexture;
 
+//Flag marking the published slot as not yet taken by the render thread
+const int SNAPSHOT_FRESH = 4;
+
+//Simulation updates per second on the update thread
+const int UPDATE_RATE = 120;
+
+//Milliseconds between thread timing reports
+const Uint32 THREAD_REPORT_MS = 5000;
+
+//Snapshots handed from the update thread to the render thread
+LSnapshotBuffer gSnapshots;
+
+//Highest layer a command can be recorded on
+const int MAX_DRAW_LAYER = 255;
+
+//Whether the render thread records sprites into a command buffer instead of drawing them directly
+bool gUseCommandBuffer = false;
+LCommandBuffer gCommands;
+
+//Tinted tiles drawn over the modulated sprite, laid out on a grid of TILE_COLUMNS by TILE_COLUMNS
+int gTintedTiles = 0;
+const int TILE_COLUMNS = 8;
+
+//Tints neighbouring tiles cycle through
+const int TILE_TINT_COUNT = 4;
+const SDL_Color TILE_TINTS[ TILE_TINT_COUNT ] =
+{
+    { 0xFF, 0x80, 0x80, 0xC0 },
+    { 0x80, 0xFF, 0x80, 0xC0 },
+    { 0x80, 0x80, 0xFF, 0xC0 },
+    { 0xFF, 0xFF, 0x80, 0xC0 }
+};
+
+//Set by the update thread when the user asks to quit
+SDL_atomic_t gQuit;
+
+//Average update cost in microseconds, written by the update thread for reports
+SDL_atomic_t gUpdateMicroseconds;
+
 void LTexture::setColor( Uint8 red, Uint8 green, Uint8 blue )
 {
     //Modulate texture
@@ -105,7 +311,7 @@ void LTexture::free() {
     }
 }
 
-void LTexture::render( int x, int y, SDL_Rect* clip ) {
+void LTexture::render( int x, int y, SDL_Rect* clip, double angle, SDL_Point* center, SDL_RendererFlip flip ) {
     //Set rendering space and render to screen
     SDL_Rect renderQuad = { x, y, mWidth, mHeight };
 
@@ -117,7 +323,25 @@ void LTexture::render( int x, int y, SDL_Rect* clip ) {
     }
 
     //Render to screen
-    SDL_RenderCopy( gRenderer, mTexture, clip, &renderQuad );
+    SDL_RenderCopyEx( gRenderer, mTexture, clip, &renderQuad, angle, center, flip );
+}
+
+void LTexture::record( LCommandBuffer& commands, int x, int y, SDL_Rect* clip, double angle ) {
+    //Same quad render() draws
+    SDL_Rect renderQuad = { x, y, mWidth, mHeight };
+    if( clip != NULL )
+    {
+        renderQuad.w = clip->w;
+        renderQuad.h = clip->h;
+    }
+
+    commands.copy( mTexture, clip, renderQuad, angle );
+}
+
+void LTexture::setAlpha( Uint8 alpha )
+{
+    //Modulate texture alpha
+    SDL_SetTextureAlphaMod( mTexture, alpha );
 }
 
 int LTexture::getWidth() {
@@ -140,11 +364,417 @@ LTexture::~LTexture() {
     free();
 }
 
+LSnapshotBuffer::LSnapshotBuffer() {
+    //Initialize
+    SDL_memset( mSlots, 0, sizeof( mSlots ) );
+    mWriteIndex = 0;
+    SDL_AtomicSet( &mShared, 1 );
+    mReadIndex = 2;
+    SDL_AtomicSet( &mDropped, 0 );
+}
+
+SceneSnapshot* LSnapshotBuffer::beginWrite() {
+    return &mSlots[ mWriteIndex ];
+}
+
+void LSnapshotBuffer::publish() {
+    //Make the slot contents visible before the index
+    SDL_MemoryBarrierRelease();
+
+    //Swap the filled slot with the shared one and keep writing into the old shared slot
+    int previous = SDL_AtomicSet( &mShared, mWriteIndex | SNAPSHOT_FRESH );
+    mWriteIndex = previous & ~SNAPSHOT_FRESH;
+    if( previous & SNAPSHOT_FRESH )
+    {
+        SDL_AtomicAdd( &mDropped, 1 );
+    }
+}
+
+const SceneSnapshot* LSnapshotBuffer::acquire() {
+    //Take the shared slot only when something newer was published
+    if( SDL_AtomicGet( &mShared ) & SNAPSHOT_FRESH )
+    {
+        int previous = SDL_AtomicSet( &mShared, mReadIndex );
+        mReadIndex = previous & ~SNAPSHOT_FRESH;
+        SDL_MemoryBarrierAcquire();
+    }
+
+    return &mSlots[ mReadIndex ];
+}
+
+int LSnapshotBuffer::getDroppedCount() {
+    return SDL_AtomicGet( &mDropped );
+}
+
+LCommandBuffer::LCommandBuffer() {
+    //Initialize
+    mLayer = 0;
+    mColor.r = 0xFF;
+    mColor.g = 0xFF;
+    mColor.b = 0xFF;
+    mColor.a = 0xFF;
+    mBlendMode = SDL_BLENDMODE_BLEND;
+
+    mFrames = 0;
+    mLastRemoved = 0;
+    mTotalCommands = 0;
+    mTotalUnsorted = 0;
+    mTotalSorted = 0;
+}
+
+void LCommandBuffer::setLayer( int layer ) {
+    //Clamp to the bits the sort key has for layers
+    mLayer = layer < 0 ? 0 : ( layer > MAX_DRAW_LAYER ? MAX_DRAW_LAYER : layer );
+}
+
+void LCommandBuffer::setColor( Uint8 r, Uint8 g, Uint8 b, Uint8 a ) {
+    mColor.r = r;
+    mColor.g = g;
+    mColor.b = b;
+    mColor.a = a;
+}
+
+void LCommandBuffer::setBlendMode( SDL_BlendMode blendMode ) {
+    mBlendMode = blendMode;
+}
+
+Uint32 LCommandBuffer::getTextureId( SDL_Texture* texture ) {
+    if( texture == NULL )
+    {
+        return 0;
+    }
+
+    //Few textures per frame, so a linear search is enough
+    for( size_t i = 0; i < mTextures.size(); ++i )
+    {
+        if( mTextures[ i ] == texture )
+        {
+            return i + 1;
+        }
+    }
+
+    mTextures.push_back( texture );
+    return mTextures.size();
+}
+
+//Orders by sort key, then by submission order
+bool compareDrawCommands( const LDrawCommand& a, const LDrawCommand& b )
+{
+    if( a.key != b.key )
+    {
+        return a.key < b.key;
+    }
+    return a.sequence < b.sequence;
+}
+
+//Maps blend modes onto the four bits the sort key has for them
+Uint64 getBlendKey( SDL_BlendMode blendMode )
+{
+    switch( blendMode )
+    {
+        case SDL_BLENDMODE_NONE: return 0;
+        case SDL_BLENDMODE_BLEND: return 1;
+        case SDL_BLENDMODE_ADD: return 2;
+        case SDL_BLENDMODE_MOD: return 3;
+        default: return 15;
+    }
+}
+
+Uint64 LCommandBuffer::makeKey( const LDrawCommand& command ) {
+    const SDL_Color& c = command.color;
+    return ( (Uint64)mLayer << 56 )
+         | ( getBlendKey( command.blendMode ) << 52 )
+         | ( (Uint64)( getTextureId( command.texture ) & 0xFFFFF ) << 32 )
+         | ( (Uint64)c.r << 24 ) | ( (Uint64)c.g << 16 ) | ( (Uint64)c.b << 8 ) | c.a;
+}
+
+void LCommandBuffer::copy( SDL_Texture* texture, SDL_Rect* clip, const SDL_Rect& dest, double angle ) {
+    LDrawCommand command;
+    memset( &command, 0, sizeof( command ) );
+    command.color = mColor;
+    command.blendMode = mBlendMode;
+    command.texture = texture;
+    command.rect = dest;
+    if( clip != NULL )
+    {
+        command.clipped = true;
+        command.clip = *clip;
+    }
+    command.angle = angle;
+    command.sequence = mCommands.size();
+    command.key = makeKey( command );
+    mCommands.push_back( command );
+}
+
+int LCommandBuffer::replay( SDL_Renderer* renderer ) {
+    int changes = 0;
+
+    //Modulation is reapplied whenever the bound texture changes
+    SDL_Texture* texture = NULL;
+    SDL_Color color = { 0, 0, 0, 0 };
+    SDL_BlendMode blendMode = SDL_BLENDMODE_NONE;
+
+    for( size_t i = 0; i < mCommands.size(); ++i )
+    {
+        const LDrawCommand& command = mCommands[ i ];
+        const SDL_Color& c = command.color;
+
+        bool rebound = command.texture != texture;
+        if( rebound )
+        {
+            texture = command.texture;
+            ++changes;
+        }
+        if( rebound || memcmp( &c, &color, sizeof( c ) ) != 0 )
+        {
+            color = c;
+            ++changes;
+            if( renderer != NULL )
+            {
+                SDL_SetTextureColorMod( texture, c.r, c.g, c.b );
+                SDL_SetTextureAlphaMod( texture, c.a );
+            }
+        }
+        if( rebound || command.blendMode != blendMode )
+        {
+            blendMode = command.blendMode;
+            ++changes;
+            if( renderer != NULL )
+            {
+                SDL_SetTextureBlendMode( texture, blendMode );
+            }
+        }
+        if( renderer != NULL )
+        {
+            SDL_RenderCopyEx( renderer, texture, command.clipped ? &command.clip : NULL, &command.rect, command.angle, NULL, SDL_FLIP_NONE );
+        }
+    }
+
+    return changes;
+}
+
+void LCommandBuffer::flush( SDL_Renderer* renderer, bool sorted ) {
+    //State changes the copies would cost in submission order
+    int unsorted = replay( NULL );
+
+    //Group copies sharing state within each layer
+    if( sorted )
+    {
+        std::sort( mCommands.begin(), mCommands.end(), compareDrawCommands );
+    }
+    int changes = replay( renderer );
+
+    //Update statistics
+    mLastRemoved = unsorted - changes;
+    mTotalCommands += mCommands.size();
+    mTotalUnsorted += unsorted;
+    mTotalSorted += changes;
+    ++mFrames;
+
+    //Start the next frame empty
+    mCommands.clear();
+    mTextures.clear();
+}
+
+int LCommandBuffer::getLastRemoved() {
+    return mLastRemoved;
+}
+
+void LCommandBuffer::printStats() {
+    if( mFrames == 0 )
+    {
+        return;
+    }
+
+    printf( "Command buffer: %d frames, %.1f copies/frame, %.1f state changes/frame in submission order, %.1f sorted, %.1f removed/frame\n",
+            mFrames, (double)mTotalCommands / mFrames, (double)mTotalUnsorted / mFrames,
+            (double)mTotalSorted / mFrames, (double)( mTotalUnsorted - mTotalSorted ) / mFrames );
+}
+
+//Handles input and simulation, publishing a snapshot per update
+int updateThread( void* data )
+{
+    //Event handler
+    SDL_Event e;
+
+    //Modulation components
+    Uint8 r = 255;
+    Uint8 g = 255;
+    Uint8 b = 255;
+
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 interval = frequency / UPDATE_RATE;
+    Uint64 nextUpdate = SDL_GetPerformanceCounter();
+    Uint64 busyTicks = 0;
+    Uint32 updates = 0;
+    Uint32 sequence = 0;
+
+    while( !SDL_AtomicGet( &gQuit ) )
+    {
+        Uint64 start = SDL_GetPerformanceCounter();
+
+        //Take input pumped by the render thread
+        while( SDL_PeepEvents( &e, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT ) > 0 )
+        {
+            //User requests quit
+            if( e.type == SDL_QUIT )
+            {
+                SDL_AtomicSet( &gQuit, 1 );
+            }
+            //On keypress change rgb values
+            else if( e.type == SDL_KEYDOWN )
+            {
+                switch( e.key.keysym.sym )
+                {
+                    //Increase red
+                    case SDLK_q:
+                    r += 32;
+                    break;
+
+                    //Increase green
+                    case SDLK_w:
+                    g += 32;
+                    break;
+
+                    //Increase blue
+                    case SDLK_e:
+                    b += 32;
+                    break;
+
+                    //Decrease red
+                    case SDLK_a:
+                    r -= 32;
+                    break;
+
+                    //Decrease green
+                    case SDLK_s:
+                    g -= 32;
+                    break;
+
+                    //Decrease blue
+                    case SDLK_d:
+                    b -= 32;
+                    break;
+                }
+            }
+        }
+
+        //Fill the next snapshot
+        SceneSnapshot* scene = gSnapshots.beginWrite();
+        scene->sequence = ++sequence;
+        scene->spriteCount = 1;
+
+        SpriteState& sprite = scene->sprites[ 0 ];
+        sprite.texture = &gModulatedTexture;
+        sprite.layer = 0;
+        sprite.x = 0;
+        sprite.y = 0;
+        sprite.clipped = false;
+        sprite.angle = 0.0;
+        sprite.r = r;
+        sprite.g = g;
+        sprite.b = b;
+        sprite.a = 255;
+
+        //Tinted tiles over it, none overlapping so their order within the layer doesn't matter
+        int tileWidth = gModulatedTexture.getWidth() / TILE_COLUMNS;
+        int tileHeight = gModulatedTexture.getHeight() / TILE_COLUMNS;
+        for( int i = 0; i < gTintedTiles; ++i )
+        {
+            SpriteState& tile = scene->sprites[ scene->spriteCount++ ];
+            const SDL_Color& tint = TILE_TINTS[ ( i + i / TILE_COLUMNS ) % TILE_TINT_COUNT ];
+            tile.texture = &gModulatedTexture;
+            tile.layer = 1;
+            tile.clip.x = ( i % TILE_COLUMNS ) * tileWidth;
+            tile.clip.y = ( i / TILE_COLUMNS ) * tileHeight;
+            tile.clip.w = tileWidth;
+            tile.clip.h = tileHeight;
+            tile.x = tile.clip.x;
+            tile.y = tile.clip.y;
+            tile.clipped = true;
+            tile.angle = 0.0;
+            tile.r = tint.r;
+            tile.g = tint.g;
+            tile.b = tint.b;
+            tile.a = tint.a;
+        }
+
+        gSnapshots.publish();
+
+        //Track update cost for reports
+        busyTicks += SDL_GetPerformanceCounter() - start;
+        if( ++updates == UPDATE_RATE )
+        {
+            SDL_AtomicSet( &gUpdateMicroseconds, (int)( busyTicks * 1000000 / frequency / updates ) );
+            busyTicks = 0;
+            updates = 0;
+        }
+
+        //Sleep until the next update is due
+        nextUpdate += interval;
+        Uint64 now = SDL_GetPerformanceCounter();
+        if( now < nextUpdate )
+        {
+            SDL_Delay( (Uint32)( ( nextUpdate - now ) * 1000 / frequency ) );
+        }
+        else
+        {
+            nextUpdate = now;
+        }
+    }
+
+    return 0;
+}
+
+//Draws a scene snapshot with the render thread's renderer
+void renderSnapshot( const SceneSnapshot* scene )
+{
+    //Record with each sprite's modulation and let the buffer order the copies
+    if( gUseCommandBuffer )
+    {
+        for( int i = 0; i < scene->spriteCount; ++i )
+        {
+            const SpriteState& sprite = scene->sprites[ i ];
+            SDL_Rect clip = sprite.clip;
+
+            gCommands.setLayer( sprite.layer );
+            gCommands.setColor( sprite.r, sprite.g, sprite.b, sprite.a );
+            sprite.texture->record( gCommands, sprite.x, sprite.y, sprite.clipped ? &clip : NULL, sprite.angle );
+        }
+        gCommands.flush( gRenderer );
+        return;
+    }
+
+    for( int i = 0; i < scene->spriteCount; ++i )
+    {
+        const SpriteState& sprite = scene->sprites[ i ];
+        SDL_Rect clip = sprite.clip;
+
+        //Modulate and render texture
+        sprite.texture->setColor( sprite.r, sprite.g, sprite.b );
+        sprite.texture->setAlpha( sprite.a );
+        sprite.texture->render( sprite.x, sprite.y, sprite.clipped ? &clip : NULL, sprite.angle );
+    }
+}
+
 bool loadMedia();
 void close();
 bool init();
 
 int main(int argc, char* args[]) {
+    //Check for command buffer and tile options
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( args[ i ], "--command-buffer" ) == 0 )
+        {
+            gUseCommandBuffer = true;
+        }
+        else if( strcmp( args[ i ], "--tiles" ) == 0 && i + 1 < argc )
+        {
+            gTintedTiles = SDL_max( 0, SDL_min( atoi( args[ ++i ] ), MAX_SCENE_SPRITES - 1 ) );
+        }
+    }
+
     // Start up SDL and create window
     if (!init()) {
         printf("Failed to initialize!\n");
@@ -153,75 +783,64 @@ int main(int argc, char* args[]) {
         if (!loadMedia()) {
             printf("Failed to load media!\n");
         } else {
-            // Main loop flag
-            bool quit = false;
-
-            // Event handler
-            SDL_Event e;
-
-            //Modulation components
-            Uint8 r = 255;
-            Uint8 g = 255;
-            Uint8 b = 255;
-
-            while (!quit) {
-                while (SDL_PollEvent( &e ) != 0) {
-                    //User requests quit
-                    if( e.type == SDL_QUIT ) {
-                        quit = true;
-                        close();
-                    }//On keypress change rgb values
-                    else if( e.type == SDL_KEYDOWN )
-                    {
-                        switch( e.key.keysym.sym )
-                        {
-                            //Increase red
-                            case SDLK_q:
-                            r += 32;
-                            break;
-
-                            //Increase green
-                            case SDLK_w:
-                            g += 32;
-                            break;
-
-                            //Increase blue
-                            case SDLK_e:
-                            b += 32;
-                            break;
-
-                            //Decrease red
-                            case SDLK_a:
-                            r -= 32;
-                            break;
-
-                            //Decrease green
-                            case SDLK_s:
-                            g -= 32;
-                            break;
-
-                            //Decrease blue
-                            case SDLK_d:
-                            b -= 32;
-                            break;
-                        }
-                    }
-                }
+            //Run input and simulation beside the render loop
+            SDL_AtomicSet( &gQuit, 0 );
+            SDL_Thread* updater = SDL_CreateThread( updateThread, "Update", NULL );
+            if( updater == NULL )
+            {
+                printf( "Unable to create update thread! SDL Error: %s\n", SDL_GetError() );
+                SDL_AtomicSet( &gQuit, 1 );
+            }
+
+            Uint64 frequency = SDL_GetPerformanceFrequency();
+            Uint64 reportStart = SDL_GetPerformanceCounter();
+            Uint32 nextReport = SDL_GetTicks() + THREAD_REPORT_MS;
+            Uint32 frames = 0;
+
+            //This thread owns the window and renderer, so it keeps the event queue pumped
+            while( !SDL_AtomicGet( &gQuit ) ) {
+                SDL_PumpEvents();
+
+                //Draw whatever the update thread published last
+                const SceneSnapshot* scene = gSnapshots.acquire();
 
                 //Clear screen
                 SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
                 SDL_RenderClear( gRenderer );
 
-                //Modulate and render texture
-                gModulatedTexture.setColor( r, g, b );
-                gModulatedTexture.render( 0, 0 );
+                renderSnapshot( scene );
 
                 //Update screen
                 SDL_RenderPresent( gRenderer );
+
+                //Report frame and update times periodically
+                ++frames;
+                if( SDL_GetTicks() >= nextReport )
+                {
+                    Uint64 now = SDL_GetPerformanceCounter();
+                    printf( "Render %.3f ms/frame, update %.3f ms/tick, %d snapshots dropped\n",
+                            ( now - reportStart ) * 1000.0 / frequency / frames,
+                            SDL_AtomicGet( &gUpdateMicroseconds ) / 1000.0, gSnapshots.getDroppedCount() );
+                    if( gUseCommandBuffer )
+                    {
+                        printf( "Command buffer removed %d state changes last frame\n", gCommands.getLastRemoved() );
+                    }
+                    reportStart = now;
+                    frames = 0;
+                    nextReport += THREAD_REPORT_MS;
+                }
             }
+
+            SDL_WaitThread( updater, NULL );
+
+            //Report how many texture state changes sorting saved
+            gCommands.printStats();
         }
     }
 
+    //Free resources and close SDL
+    close();
+
     return 0;
 }
 
@@ -1,7 +1,10 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <string>
+#include <vector>
 
 class LTexture
 {
@@ -15,6 +18,9 @@ class LTexture
         //Loads image at specified path
         bool loadFromFile( std::string path );
 
+        //Creates a blended texture from ARGB8888 pixels
+        bool loadFromPixels( SDL_Surface* pixels );
+
         //Deallocates texture
         void free();
 
@@ -30,6 +36,15 @@ class LTexture
         //Renders texture at given point
         void render( int x, int y, SDL_Rect* clip = NULL );
 
+        //Renders texture stretched over the given rect
+        void renderScaled( SDL_Rect* dst, SDL_Rect* clip = NULL );
+
+        //Creates a texture for another renderer from the pixels kept for the tile renderer
+        bool createTexture( SDL_Renderer* renderer );
+
+        //Destroys only the texture, keeping the pixels
+        void freeTexture();
+
         //Gets image dimensions
         int getWidth();
         int getHeight();
@@ -38,11 +53,152 @@ class LTexture
         //The actual hardware texture
         SDL_Texture* mTexture;
 
+        //Pixels used by the tile renderer instead of a hardware texture
+        SDL_Surface* mSurface;
+
+        //Modulation and blending state, replayed by the tile renderer
+        Uint8 mRed;
+        Uint8 mGreen;
+        Uint8 mBlue;
+        Uint8 mAlpha;
+        SDL_BlendMode mBlendMode;
+
         //Image dimensions
         int mWidth;
         int mHeight;
 };
 
+//Draw calls recorded by the tile renderer
+enum LRenderCommandType
+{
+    RENDER_COMMAND_CLEAR,
+    RENDER_COMMAND_FILL_RECT,
+    RENDER_COMMAND_DRAW_RECT,
+    RENDER_COMMAND_LINE,
+    RENDER_COMMAND_POINT,
+    RENDER_COMMAND_COPY
+};
+
+//A recorded draw call
+struct LRenderCommand
+{
+    LRenderCommandType type;
+
+    //Destination rect, or line end points as x/y and w/h
+    SDL_Rect dst;
+
+    //Source rect and 16.16 sampling steps for copies
+    SDL_Rect src;
+    Sint64 stepX;
+    Sint64 stepY;
+
+    //Source pixels for copies
+    SDL_Surface* texture;
+
+    //Draw color, or color and alpha modulation for copies
+    Uint8 r;
+    Uint8 g;
+    Uint8 b;
+    Uint8 a;
+    SDL_BlendMode blendMode;
+
+    //Copy blended by texel alpha alone, which SDL hands to its per pixel alpha blitter
+    bool pixelAlpha;
+
+    //Screen area touched, used for binning
+    SDL_Rect bounds;
+};
+
+//Software renderer that bins a recorded frame into screen tiles and rasterizes them in parallel
+class LTileRenderer
+{
+    public:
+        //Initializes variables
+        LTileRenderer();
+
+        //Stops workers and deallocates memory
+        ~LTileRenderer();
+
+        //Attaches to the window surface and starts threadCount - 1 workers
+        bool init( SDL_Window* window, int threadCount );
+
+        //Stops workers and releases the frame buffer
+        void free();
+
+        //Sets color and blending used by primitives
+        void setDrawColor( Uint8 r, Uint8 g, Uint8 b, Uint8 a );
+        void setDrawBlendMode( SDL_BlendMode blending );
+
+        //Records draw calls for the current frame
+        void clear();
+        void fillRect( const SDL_Rect* rect );
+        void drawRect( const SDL_Rect* rect );
+        void drawLine( int x1, int y1, int x2, int y2 );
+        void drawPoint( int x, int y );
+        void copy( SDL_Surface* texture, const SDL_Rect* clip, const SDL_Rect* dst, Uint8 r, Uint8 g, Uint8 b, Uint8 alpha, SDL_BlendMode blending );
+
+        //Rasterizes the recorded frame into the frame buffer
+        void flush();
+
+        //Rasterizes the recorded frame and shows it in the window
+        void present();
+
+        //Gets the surface tiles are rasterized into
+        SDL_Surface* getFrameBuffer();
+
+        //Gets the number of rasterizing threads including the caller
+        int getThreadCount();
+
+    private:
+        //Worker thread entry point
+        static int workerThread( void* data );
+
+        //Pulls tiles until none are left
+        void rasterizeTiles();
+
+        //Replays the commands binned to one tile, clipped to it
+        void rasterizeTile( int tile );
+
+        //Records primitives with the current draw state
+        void recordRect( LRenderCommandType type, const SDL_Rect* rect );
+        void recordLine( LRenderCommandType type, int x1, int y1, int x2, int y2 );
+
+        //Adds a command to the frame and to every tile it touches
+        void record( LRenderCommand& command );
+
+        //Window shown on present
+        SDL_Window* mWindow;
+
+        //Frame buffer, the window surface when its format allows it
+        SDL_Surface* mFrameBuffer;
+        bool mOwnsFrameBuffer;
+
+        //Tile grid
+        int mTilesX;
+        int mTilesY;
+
+        //Recorded frame and per tile command indices
+        std::vector<LRenderCommand> mCommands;
+        std::vector< std::vector<int> > mBins;
+
+        //Worker threads and frame hand-off
+        std::vector<SDL_Thread*> mThreads;
+        SDL_sem* mStartSemaphore;
+        SDL_sem* mDoneSemaphore;
+        SDL_atomic_t mNextTile;
+        bool mQuit;
+
+        //Primitive draw state
+        Uint8 mDrawR;
+        Uint8 mDrawG;
+        Uint8 mDrawB;
+        Uint8 mDrawA;
+        SDL_BlendMode mDrawBlendMode;
+
+        //Whether SDL's per pixel alpha blits run its MMX blitter
+        bool mBlitMMX;
+};
+
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
@@ -52,14 +208,34 @@ SDL_Window* gWindow = NULL;
 //The window renderer
 SDL_Renderer* gRenderer = NULL;
 
+//Tile size in pixels for the tile renderer
+const int RENDER_TILE_SIZE = 64;
+
+//Threads used by the tile renderer, 0 keeps the SDL renderer
+int gTileThreads = 0;
+
+//The tile renderer when it replaces gRenderer
+LTileRenderer gTileBackend;
+LTileRenderer* gTileRenderer = NULL;
+
 //Scene sprites
 LTexture gModulatedTexture;
 LTexture gBackgroundTexture;
 
+//Sprite with every alpha level for the bench scene, the images are opaque
+LTexture gAlphaSprite;
+
 void LTexture::setColor( Uint8 red, Uint8 green, Uint8 blue )
 {
+    mRed = red;
+    mGreen = green;
+    mBlue = blue;
+
     //Modulate texture
-    SDL_SetTextureColorMod( mTexture, red, green, blue );
+    if( mTexture != NULL )
+    {
+        SDL_SetTextureColorMod( mTexture, red, green, blue );
+    }
 }
 
 bool LTexture::loadFromFile( std::string path ) {
@@ -77,6 +253,42 @@ bool LTexture::loadFromFile( std::string path ) {
     }
     else
     {
+        //Keep pixels in memory for the tile renderer
+        if( gTileRenderer != NULL )
+        {
+            mSurface = SDL_ConvertSurfaceFormat( loadedSurface, SDL_PIXELFORMAT_ARGB8888, 0 );
+            if( mSurface == NULL )
+            {
+                printf( "Unable to convert %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+            }
+            else
+            {
+                //Color key image by clearing alpha of cyan pixels
+                for( int y = 0; y < mSurface->h; ++y )
+                {
+                    Uint32* row = (Uint32*)( (Uint8*)mSurface->pixels + y * mSurface->pitch );
+                    for( int x = 0; x < mSurface->w; ++x )
+                    {
+                        if( ( row[ x ] & 0x00FFFFFF ) == 0x0000FFFF )
+                        {
+                            row[ x ] = 0x0000FFFF;
+                        }
+                    }
+                }
+
+                //Color keyed textures blend by default
+                mBlendMode = SDL_BLENDMODE_BLEND;
+
+                //Get image dimensions
+                mWidth = mSurface->w;
+                mHeight = mSurface->h;
+            }
+
+            //Get rid of old loaded surface
+            SDL_FreeSurface( loadedSurface );
+            return mSurface != NULL;
+        }
+
         //Color key image
         SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 0, 0xFF, 0xFF ) );
         //Create texture from surface pixels
@@ -101,6 +313,38 @@ bool LTexture::loadFromFile( std::string path ) {
     return mTexture != NULL;
 }
 
+bool LTexture::loadFromPixels( SDL_Surface* pixels ) {
+    //Get rid of preexisting texture
+    free();
+
+    //Keep pixels in memory for the tile renderer
+    if( gTileRenderer != NULL )
+    {
+        mSurface = SDL_ConvertSurfaceFormat( pixels, SDL_PIXELFORMAT_ARGB8888, 0 );
+        if( mSurface == NULL )
+        {
+            printf( "Unable to copy pixels! SDL Error: %s\n", SDL_GetError() );
+            return false;
+        }
+    }
+    else
+    {
+        mTexture = SDL_CreateTextureFromSurface( gRenderer, pixels );
+        if( mTexture == NULL )
+        {
+            printf( "Unable to create texture from pixels! SDL Error: %s\n", SDL_GetError() );
+            return false;
+        }
+    }
+
+    //Get image dimensions
+    mWidth = pixels->w;
+    mHeight = pixels->h;
+
+    setBlendMode( SDL_BLENDMODE_BLEND );
+    return true;
+}
+
 void LTexture::free() {
     //Free texture if it exists
     if( mTexture != NULL )
@@ -110,6 +354,15 @@ void LTexture::free() {
         mWidth = 0;
         mHeight = 0;
     }
+
+    //Free pixels if they exist
+    if( mSurface != NULL )
+    {
+        SDL_FreeSurface( mSurface );
+        mSurface = NULL;
+        mWidth = 0;
+        mHeight = 0;
+    }
 }
 
 void LTexture::render( int x, int y, SDL_Rect* clip ) {
@@ -123,10 +376,60 @@ void LTexture::render( int x, int y, SDL_Rect* clip ) {
         renderQuad.h = clip->h;
     }
 
+    //Record into the tile renderer
+    if( gTileRenderer != NULL )
+    {
+        gTileRenderer->copy( mSurface, clip, &renderQuad, mRed, mGreen, mBlue, mAlpha, mBlendMode );
+        return;
+    }
+
     //Render to screen
     SDL_RenderCopy( gRenderer, mTexture, clip, &renderQuad );
 }
 
+void LTexture::renderScaled( SDL_Rect* dst, SDL_Rect* clip ) {
+    //Record into the tile renderer
+    if( gTileRenderer != NULL )
+    {
+        gTileRenderer->copy( mSurface, clip, dst, mRed, mGreen, mBlue, mAlpha, mBlendMode );
+        return;
+    }
+
+    //Render to screen
+    SDL_RenderCopy( gRenderer, mTexture, clip, dst );
+}
+
+bool LTexture::createTexture( SDL_Renderer* renderer ) {
+    freeTexture();
+    if( mSurface == NULL )
+    {
+        return false;
+    }
+
+    //Same pixels and state the tile renderer uses
+    mTexture = SDL_CreateTextureFromSurface( renderer, mSurface );
+    if( mTexture == NULL )
+    {
+        printf( "Unable to create texture from pixels! SDL Error: %s\n", SDL_GetError() );
+        return false;
+    }
+    SDL_SetTextureColorMod( mTexture, mRed, mGreen, mBlue );
+    SDL_SetTextureAlphaMod( mTexture, mAlpha );
+    SDL_SetTextureBlendMode( mTexture, mBlendMode );
+
+    //The tile renderer samples the nearest texel
+    SDL_SetTextureScaleMode( mTexture, SDL_ScaleModeNearest );
+    return true;
+}
+
+void LTexture::freeTexture() {
+    if( mTexture != NULL )
+    {
+        SDL_DestroyTexture( mTexture );
+        mTexture = NULL;
+    }
+}
+
 int LTexture::getWidth() {
     return mWidth;
 }
@@ -137,19 +440,35 @@ int LTexture::getHeight() {
 
 void LTexture::setBlendMode( SDL_BlendMode blending )
 {
+    mBlendMode = blending;
+
     //Set blending function
-    SDL_SetTextureBlendMode( mTexture, blending );
+    if( mTexture != NULL )
+    {
+        SDL_SetTextureBlendMode( mTexture, blending );
+    }
 }
 
 void LTexture::setAlpha( Uint8 alpha )
 {
+    mAlpha = alpha;
+
     //Modulate texture alpha
-    SDL_SetTextureAlphaMod( mTexture, alpha );
+    if( mTexture != NULL )
+    {
+        SDL_SetTextureAlphaMod( mTexture, alpha );
+    }
 }
 
 LTexture::LTexture() {
     //Initialize
     mTexture = NULL;
+    mSurface = NULL;
+    mRed = 255;
+    mGreen = 255;
+    mBlue = 255;
+    mAlpha = 255;
+    mBlendMode = SDL_BLENDMODE_NONE;
     mWidth = 0;
     mHeight = 0;
 }
@@ -159,11 +478,704 @@ LTexture::~LTexture() {
     free();
 }
 
+//Multiplies two 0-255 values as fractions of 255, truncated like SDL's software renderer
+static inline Uint32 mul255( Uint32 a, Uint32 b )
+{
+    return a * b / 255;
+}
+
+//Blends a modulated source color into an ARGB8888 destination pixel, left opaque
+static inline Uint32 blendPixel( Uint32 dst, Uint32 r, Uint32 g, Uint32 b, Uint32 a, SDL_BlendMode blending )
+{
+    Uint32 dr = ( dst >> 16 ) & 0xFF;
+    Uint32 dg = ( dst >> 8 ) & 0xFF;
+    Uint32 db = dst & 0xFF;
+
+    switch( blending )
+    {
+        case SDL_BLENDMODE_BLEND:
+        dr = SDL_min( mul255( r, a ) + mul255( dr, 255 - a ), 255u );
+        dg = SDL_min( mul255( g, a ) + mul255( dg, 255 - a ), 255u );
+        db = SDL_min( mul255( b, a ) + mul255( db, 255 - a ), 255u );
+        break;
+
+        case SDL_BLENDMODE_ADD:
+        dr = SDL_min( dr + mul255( r, a ), 255u );
+        dg = SDL_min( dg + mul255( g, a ), 255u );
+        db = SDL_min( db + mul255( b, a ), 255u );
+        break;
+
+        case SDL_BLENDMODE_MOD:
+        dr = mul255( r, dr );
+        dg = mul255( g, dg );
+        db = mul255( b, db );
+        break;
+
+        default:
+        dr = r;
+        dg = g;
+        db = b;
+        break;
+    }
+
+    return 0xFF000000 | ( dr << 16 ) | ( dg << 8 ) | db;
+}
+
+//Blends a partly transparent texel like SDL's per pixel alpha blitters, which shift by 8 instead of dividing by 255
+static inline Uint32 blendPixelAlpha( Uint32 dst, Uint32 texel, bool mmx )
+{
+    Uint32 alpha = texel >> 24;
+    if( alpha == 255 )
+    {
+        return 0xFF000000 | texel;
+    }
+
+    //The MMX blitter scales source and destination separately
+    if( mmx )
+    {
+        Uint32 result = 0xFF000000;
+        for( int shift = 0; shift < 24; shift += 8 )
+        {
+            Uint32 s = ( texel >> shift ) & 0xFF;
+            Uint32 d = ( dst >> shift ) & 0xFF;
+            result |= ( ( s * alpha >> 8 ) + ( d * ( 255 - alpha ) >> 8 ) ) << shift;
+        }
+        return result;
+    }
+
+    //The C blitter moves the destination toward the source, red and blue packed into one multiply
+    Uint32 s1 = texel & 0xFF00FF;
+    Uint32 d1 = dst & 0xFF00FF;
+    d1 = ( d1 + ( ( s1 - d1 ) * alpha >> 8 ) ) & 0xFF00FF;
+    Uint32 s2 = texel & 0xFF00;
+    Uint32 d2 = dst & 0xFF00;
+    d2 = ( d2 + ( ( s2 - d2 ) * alpha >> 8 ) ) & 0xFF00;
+    return 0xFF000000 | d1 | d2;
+}
+
+LTileRenderer::LTileRenderer() {
+    //Initialize
+    mWindow = NULL;
+    mFrameBuffer = NULL;
+    mOwnsFrameBuffer = false;
+    mTilesX = 0;
+    mTilesY = 0;
+    mStartSemaphore = NULL;
+    mDoneSemaphore = NULL;
+    SDL_AtomicSet( &mNextTile, 0 );
+    mQuit = false;
+
+    mDrawR = 0xFF;
+    mDrawG = 0xFF;
+    mDrawB = 0xFF;
+    mDrawA = 0xFF;
+    mDrawBlendMode = SDL_BLENDMODE_NONE;
+    mBlitMMX = false;
+}
+
+LTileRenderer::~LTileRenderer() {
+    //Deallocate
+    free();
+}
+
+bool LTileRenderer::init( SDL_Window* window, int threadCount ) {
+    //Get rid of preexisting state
+    free();
+
+    mWindow = window;
+    SDL_Surface* windowSurface = SDL_GetWindowSurface( window );
+    if( windowSurface == NULL )
+    {
+        printf( "Unable to get window surface! SDL Error: %s\n", SDL_GetError() );
+        return false;
+    }
+
+    //Rasterize straight into the window when it stores pixels as xRGB
+    if( windowSurface->format->format == SDL_PIXELFORMAT_ARGB8888 || windowSurface->format->format == SDL_PIXELFORMAT_RGB888 )
+    {
+        mFrameBuffer = windowSurface;
+        mOwnsFrameBuffer = false;
+    }
+    else
+    {
+        mFrameBuffer = SDL_CreateRGBSurfaceWithFormat( 0, windowSurface->w, windowSurface->h, 32, SDL_PIXELFORMAT_ARGB8888 );
+        if( mFrameBuffer == NULL )
+        {
+            printf( "Unable to create frame buffer! SDL Error: %s\n", SDL_GetError() );
+            return false;
+        }
+        SDL_SetSurfaceBlendMode( mFrameBuffer, SDL_BLENDMODE_NONE );
+        mOwnsFrameBuffer = true;
+    }
+
+    //SDL picks its MMX per pixel alpha blitter when built for and running on a CPU with MMX
+#ifdef __MMX__
+    mBlitMMX = SDL_HasMMX() == SDL_TRUE;
+#else
+    mBlitMMX = false;
+#endif
+
+    //Build the tile grid
+    mTilesX = ( mFrameBuffer->w + RENDER_TILE_SIZE - 1 ) / RENDER_TILE_SIZE;
+    mTilesY = ( mFrameBuffer->h + RENDER_TILE_SIZE - 1 ) / RENDER_TILE_SIZE;
+    mBins.resize( mTilesX * mTilesY );
+
+    //Start workers, the presenting thread rasterizes as well
+    mQuit = false;
+    mStartSemaphore = SDL_CreateSemaphore( 0 );
+    mDoneSemaphore = SDL_CreateSemaphore( 0 );
+    for( int i = 1; i < threadCount; ++i )
+    {
+        SDL_Thread* thread = SDL_CreateThread( workerThread, "TileWorker", this );
+        if( thread == NULL )
+        {
+            printf( "Unable to create tile worker! SDL Error: %s\n", SDL_GetError() );
+            break;
+        }
+        mThreads.push_back( thread );
+    }
+
+    return true;
+}
+
+void LTileRenderer::free() {
+    //Stop workers
+    if( !mThreads.empty() )
+    {
+        mQuit = true;
+        for( size_t i = 0; i < mThreads.size(); ++i )
+        {
+            SDL_SemPost( mStartSemaphore );
+        }
+        for( size_t i = 0; i < mThreads.size(); ++i )
+        {
+            SDL_WaitThread( mThreads[ i ], NULL );
+        }
+        mThreads.clear();
+    }
+
+    if( mStartSemaphore != NULL )
+    {
+        SDL_DestroySemaphore( mStartSemaphore );
+        SDL_DestroySemaphore( mDoneSemaphore );
+        mStartSemaphore = NULL;
+        mDoneSemaphore = NULL;
+    }
+
+    //Free frame buffer if we created it
+    if( mOwnsFrameBuffer )
+    {
+        SDL_FreeSurface( mFrameBuffer );
+    }
+    mFrameBuffer = NULL;
+    mOwnsFrameBuffer = false;
+    mWindow = NULL;
+
+    mCommands.clear();
+    mBins.clear();
+    mTilesX = 0;
+    mTilesY = 0;
+}
+
+void LTileRenderer::setDrawColor( Uint8 r, Uint8 g, Uint8 b, Uint8 a ) {
+    mDrawR = r;
+    mDrawG = g;
+    mDrawB = b;
+    mDrawA = a;
+}
+
+void LTileRenderer::setDrawBlendMode( SDL_BlendMode blending ) {
+    mDrawBlendMode = blending;
+}
+
+void LTileRenderer::clear() {
+    LRenderCommand command;
+    memset( &command, 0, sizeof( command ) );
+    command.type = RENDER_COMMAND_CLEAR;
+    command.r = mDrawR;
+    command.g = mDrawG;
+    command.b = mDrawB;
+    command.a = mDrawA;
+    command.blendMode = SDL_BLENDMODE_NONE;
+    command.bounds.w = mFrameBuffer->w;
+    command.bounds.h = mFrameBuffer->h;
+    record( command );
+}
+
+void LTileRenderer::fillRect( const SDL_Rect* rect ) {
+    recordRect( RENDER_COMMAND_FILL_RECT, rect );
+}
+
+void LTileRenderer::drawRect( const SDL_Rect* rect ) {
+    recordRect( RENDER_COMMAND_DRAW_RECT, rect );
+}
+
+void LTileRenderer::recordRect( LRenderCommandType type, const SDL_Rect* rect ) {
+    LRenderCommand command;
+    memset( &command, 0, sizeof( command ) );
+    command.type = type;
+    if( rect != NULL )
+    {
+        command.dst = *rect;
+    }
+    else
+    {
+        command.dst.w = mFrameBuffer->w;
+        command.dst.h = mFrameBuffer->h;
+    }
+    command.r = mDrawR;
+    command.g = mDrawG;
+    command.b = mDrawB;
+    command.a = mDrawA;
+    command.blendMode = mDrawBlendMode;
+    command.bounds = command.dst;
+    record( command );
+}
+
+void LTileRenderer::drawLine( int x1, int y1, int x2, int y2 ) {
+    recordLine( RENDER_COMMAND_LINE, x1, y1, x2, y2 );
+}
+
+void LTileRenderer::drawPoint( int x, int y ) {
+    recordLine( RENDER_COMMAND_POINT, x, y, x, y );
+}
+
+void LTileRenderer::recordLine( LRenderCommandType type, int x1, int y1, int x2, int y2 ) {
+    LRenderCommand command;
+    memset( &command, 0, sizeof( command ) );
+    command.type = type;
+    command.dst.x = x1;
+    command.dst.y = y1;
+    command.dst.w = x2;
+    command.dst.h = y2;
+    command.r = mDrawR;
+    command.g = mDrawG;
+    command.b = mDrawB;
+    command.a = mDrawA;
+    command.blendMode = mDrawBlendMode;
+    command.bounds.x = SDL_min( x1, x2 );
+    command.bounds.y = SDL_min( y1, y2 );
+    command.bounds.w = abs( x2 - x1 ) + 1;
+    command.bounds.h = abs( y2 - y1 ) + 1;
+    record( command );
+}
+
+void LTileRenderer::copy( SDL_Surface* texture, const SDL_Rect* clip, const SDL_Rect* dst, Uint8 r, Uint8 g, Uint8 b, Uint8 alpha, SDL_BlendMode blending ) {
+    LRenderCommand command;
+    memset( &command, 0, sizeof( command ) );
+    command.type = RENDER_COMMAND_COPY;
+    command.texture = texture;
+    if( clip != NULL )
+    {
+        command.src = *clip;
+    }
+    else
+    {
+        command.src.w = texture->w;
+        command.src.h = texture->h;
+    }
+    if( dst != NULL )
+    {
+        command.dst = *dst;
+    }
+    else
+    {
+        command.dst.w = mFrameBuffer->w;
+        command.dst.h = mFrameBuffer->h;
+    }
+    if( command.dst.w <= 0 || command.dst.h <= 0 )
+    {
+        return;
+    }
+
+    //Nearest sampling steps from the whole destination, so tiles sample identically
+    command.stepX = ( (Sint64)command.src.w << 16 ) / command.dst.w;
+    command.stepY = ( (Sint64)command.src.h << 16 ) / command.dst.h;
+
+    command.r = r;
+    command.g = g;
+    command.b = b;
+    command.a = alpha;
+    command.blendMode = blending;
+
+    //SDL blends unmodulated copies by texel alpha with its per pixel alpha blitter. Scaled copies inside the frame
+    //are stretched in place by its generic blitter instead, ones leaving the frame are stretched first and blitted
+    bool scaled = command.src.w != command.dst.w || command.src.h != command.dst.h;
+    bool inside = command.dst.x >= 0 && command.dst.y >= 0 &&
+                  command.dst.x + command.dst.w <= mFrameBuffer->w && command.dst.y + command.dst.h <= mFrameBuffer->h;
+    command.pixelAlpha = blending == SDL_BLENDMODE_BLEND && r == 255 && g == 255 && b == 255 && alpha == 255 && !( scaled && inside );
+
+    command.bounds = command.dst;
+    record( command );
+}
+
+void LTileRenderer::record( LRenderCommand& command ) {
+    //Clip bounds to the frame
+    SDL_Rect frame = { 0, 0, mFrameBuffer->w, mFrameBuffer->h };
+    SDL_Rect bounds;
+    if( !SDL_IntersectRect( &command.bounds, &frame, &bounds ) )
+    {
+        return;
+    }
+    command.bounds = bounds;
+
+    int index = (int)mCommands.size();
+    mCommands.push_back( command );
+
+    //Bin into every touched tile, keeping submission order
+    int firstX = bounds.x / RENDER_TILE_SIZE;
+    int lastX = ( bounds.x + bounds.w - 1 ) / RENDER_TILE_SIZE;
+    int firstY = bounds.y / RENDER_TILE_SIZE;
+    int lastY = ( bounds.y + bounds.h - 1 ) / RENDER_TILE_SIZE;
+    for( int ty = firstY; ty <= lastY; ++ty )
+    {
+        for( int tx = firstX; tx <= lastX; ++tx )
+        {
+            mBins[ ty * mTilesX + tx ].push_back( index );
+        }
+    }
+}
+
+int LTileRenderer::workerThread( void* data ) {
+    LTileRenderer* renderer = (LTileRenderer*)data;
+    while( true )
+    {
+        //Wait for a frame to rasterize
+        SDL_SemWait( renderer->mStartSemaphore );
+        if( renderer->mQuit )
+        {
+            break;
+        }
+
+        renderer->rasterizeTiles();
+        SDL_SemPost( renderer->mDoneSemaphore );
+    }
+
+    return 0;
+}
+
+void LTileRenderer::rasterizeTiles() {
+    int tileCount = mTilesX * mTilesY;
+    int tile;
+    while( ( tile = SDL_AtomicAdd( &mNextTile, 1 ) ) < tileCount )
+    {
+        rasterizeTile( tile );
+    }
+}
+
+void LTileRenderer::rasterizeTile( int tile ) {
+    std::vector<int>& bin = mBins[ tile ];
+
+    SDL_Rect tileRect;
+    tileRect.x = ( tile % mTilesX ) * RENDER_TILE_SIZE;
+    tileRect.y = ( tile / mTilesX ) * RENDER_TILE_SIZE;
+    tileRect.w = SDL_min( RENDER_TILE_SIZE, mFrameBuffer->w - tileRect.x );
+    tileRect.h = SDL_min( RENDER_TILE_SIZE, mFrameBuffer->h - tileRect.y );
+
+    Uint8* pixels = (Uint8*)mFrameBuffer->pixels;
+    int pitch = mFrameBuffer->pitch;
+
+    for( size_t i = 0; i < bin.size(); ++i )
+    {
+        const LRenderCommand& command = mCommands[ bin[ i ] ];
+        SDL_Rect area;
+        if( !SDL_IntersectRect( &command.bounds, &tileRect, &area ) )
+        {
+            continue;
+        }
+
+        switch( command.type )
+        {
+            case RENDER_COMMAND_CLEAR:
+            case RENDER_COMMAND_FILL_RECT:
+            {
+                for( int y = area.y; y < area.y + area.h; ++y )
+                {
+                    Uint32* row = (Uint32*)( pixels + y * pitch );
+                    for( int x = area.x; x < area.x + area.w; ++x )
+                    {
+                        row[ x ] = blendPixel( row[ x ], command.r, command.g, command.b, command.a, command.blendMode );
+                    }
+                }
+                break;
+            }
+
+            case RENDER_COMMAND_DRAW_RECT:
+            {
+                //Top and bottom edges span the full width, sides skip the corners
+                int left = command.dst.x;
+                int top = command.dst.y;
+                int right = command.dst.x + command.dst.w - 1;
+                int bottom = command.dst.y + command.dst.h - 1;
+                for( int y = area.y; y < area.y + area.h; ++y )
+                {
+                    Uint32* row = (Uint32*)( pixels + y * pitch );
+                    for( int x = area.x; x < area.x + area.w; ++x )
+                    {
+                        if( y == top || y == bottom || x == left || x == right )
+                        {
+                            row[ x ] = blendPixel( row[ x ], command.r, command.g, command.b, command.a, command.blendMode );
+                        }
+                    }
+                }
+                break;
+            }
+
+            case RENDER_COMMAND_LINE:
+            case RENDER_COMMAND_POINT:
+            {
+                //Walk the whole line so every tile sees the same pixels
+                int x = command.dst.x;
+                int y = command.dst.y;
+                int dx = abs( command.dst.w - x );
+                int dy = -abs( command.dst.h - y );
+                int sx = x < command.dst.w ? 1 : -1;
+                int sy = y < command.dst.h ? 1 : -1;
+                int error = dx + dy;
+                while( true )
+                {
+                    if( x >= area.x && x < area.x + area.w && y >= area.y && y < area.y + area.h )
+                    {
+                        Uint32* pixel = (Uint32*)( pixels + y * pitch ) + x;
+                        *pixel = blendPixel( *pixel, command.r, command.g, command.b, command.a, command.blendMode );
+                    }
+                    if( x == command.dst.w && y == command.dst.h )
+                    {
+                        break;
+                    }
+                    int error2 = 2 * error;
+                    if( error2 >= dy )
+                    {
+                        error += dy;
+                        x += sx;
+                    }
+                    if( error2 <= dx )
+                    {
+                        error += dx;
+                        y += sy;
+                    }
+                }
+                break;
+            }
+
+            case RENDER_COMMAND_COPY:
+            {
+                SDL_Surface* texture = command.texture;
+                bool modulated = command.r != 255 || command.g != 255 || command.b != 255;
+                for( int y = area.y; y < area.y + area.h; ++y )
+                {
+                    int srcY = command.src.y + (int)( ( ( y - command.dst.y ) * command.stepY + ( command.stepY >> 1 ) ) >> 16 );
+                    if( srcY < 0 || srcY >= texture->h )
+                    {
+                        continue;
+                    }
+                    const Uint32* srcRow = (const Uint32*)( (const Uint8*)texture->pixels + srcY * texture->pitch );
+                    Uint32* row = (Uint32*)( pixels + y * pitch );
+                    for( int x = area.x; x < area.x + area.w; ++x )
+                    {
+                        int srcX = command.src.x + (int)( ( ( x - command.dst.x ) * command.stepX + ( command.stepX >> 1 ) ) >> 16 );
+                        if( srcX < 0 || srcX >= texture->w )
+                        {
+                            continue;
+                        }
+
+                        Uint32 texel = srcRow[ srcX ];
+                        Uint32 a = mul255( texel >> 24, command.a );
+                        if( a == 0 && command.blendMode != SDL_BLENDMODE_NONE && command.blendMode != SDL_BLENDMODE_MOD )
+                        {
+                            continue;
+                        }
+                        if( command.pixelAlpha )
+                        {
+                            row[ x ] = blendPixelAlpha( row[ x ], texel, mBlitMMX );
+                            continue;
+                        }
+
+                        Uint32 r = ( texel >> 16 ) & 0xFF;
+                        Uint32 g = ( texel >> 8 ) & 0xFF;
+                        Uint32 b = texel & 0xFF;
+                        if( modulated )
+                        {
+                            r = mul255( r, command.r );
+                            g = mul255( g, command.g );
+                            b = mul255( b, command.b );
+                        }
+                        row[ x ] = blendPixel( row[ x ], r, g, b, a, command.blendMode );
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    //Ready for the next frame
+    bin.clear();
+}
+
+void LTileRenderer::flush() {
+    //Hand tiles out to workers and rasterize alongside them
+    SDL_AtomicSet( &mNextTile, 0 );
+    for( size_t i = 0; i < mThreads.size(); ++i )
+    {
+        SDL_SemPost( mStartSemaphore );
+    }
+
+    rasterizeTiles();
+
+    for( size_t i = 0; i < mThreads.size(); ++i )
+    {
+        SDL_SemWait( mDoneSemaphore );
+    }
+
+    mCommands.clear();
+}
+
+void LTileRenderer::present() {
+    flush();
+
+    //Show the frame
+    if( mOwnsFrameBuffer )
+    {
+        SDL_BlitSurface( mFrameBuffer, NULL, SDL_GetWindowSurface( mWindow ), NULL );
+    }
+    SDL_UpdateWindowSurface( mWindow );
+}
+
+SDL_Surface* LTileRenderer::getFrameBuffer() {
+    return mFrameBuffer;
+}
+
+int LTileRenderer::getThreadCount() {
+    return (int)mThreads.size() + 1;
+}
+
+void renderSetDrawColor( Uint8 r, Uint8 g, Uint8 b, Uint8 a )
+{
+    if( gTileRenderer != NULL )
+    {
+        gTileRenderer->setDrawColor( r, g, b, a );
+    }
+    else
+    {
+        SDL_SetRenderDrawColor( gRenderer, r, g, b, a );
+    }
+}
+
+void renderSetDrawBlendMode( SDL_BlendMode blending )
+{
+    if( gTileRenderer != NULL )
+    {
+        gTileRenderer->setDrawBlendMode( blending );
+    }
+    else
+    {
+        SDL_SetRenderDrawBlendMode( gRenderer, blending );
+    }
+}
+
+void renderClear()
+{
+    if( gTileRenderer != NULL )
+    {
+        gTileRenderer->clear();
+    }
+    else
+    {
+        SDL_RenderClear( gRenderer );
+    }
+}
+
+void renderFillRect( const SDL_Rect* rect )
+{
+    if( gTileRenderer != NULL )
+    {
+        gTileRenderer->fillRect( rect );
+    }
+    else
+    {
+        SDL_RenderFillRect( gRenderer, rect );
+    }
+}
+
+void renderDrawRect( const SDL_Rect* rect )
+{
+    if( gTileRenderer != NULL )
+    {
+        gTileRenderer->drawRect( rect );
+    }
+    else
+    {
+        SDL_RenderDrawRect( gRenderer, rect );
+    }
+}
+
+void renderDrawLine( int x1, int y1, int x2, int y2 )
+{
+    if( gTileRenderer != NULL )
+    {
+        gTileRenderer->drawLine( x1, y1, x2, y2 );
+    }
+    else
+    {
+        SDL_RenderDrawLine( gRenderer, x1, y1, x2, y2 );
+    }
+}
+
+void renderDrawPoint( int x, int y )
+{
+    if( gTileRenderer != NULL )
+    {
+        gTileRenderer->drawPoint( x, y );
+    }
+    else
+    {
+        SDL_RenderDrawPoint( gRenderer, x, y );
+    }
+}
+
+void renderPresent()
+{
+    if( gTileRenderer != NULL )
+    {
+        gTileRenderer->present();
+    }
+    else
+    {
+        SDL_RenderPresent( gRenderer );
+    }
+}
+
 bool loadMedia();
 void close();
 bool init();
 
+//Times the tile renderer at increasing thread counts and checks the output matches one thread
+void runTileBenchmark();
+
+//Renders a bench frame with SDL's software renderer and compares it with the tile renderer's frame buffer
+bool compareWithSoftwareRenderer( int frame );
+
 int main(int argc, char* args[]) {
+    //Check for tile renderer options
+    bool benchmark = false;
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( args[ i ], "--tile-renderer" ) == 0 )
+        {
+            //Thread count defaults to one per core
+            gTileThreads = SDL_GetCPUCount();
+            if( i + 1 < argc && atoi( args[ i + 1 ] ) > 0 )
+            {
+                gTileThreads = atoi( args[ ++i ] );
+            }
+        }
+        else if( strcmp( args[ i ], "--tile-bench" ) == 0 )
+        {
+            benchmark = true;
+            gTileThreads = SDL_GetCPUCount();
+        }
+    }
+
     // Start up SDL and create window
     if (!init()) {
         printf("Failed to initialize!\n");
@@ -171,6 +1183,8 @@ int main(int argc, char* args[]) {
         // Load media
         if (!loadMedia()) {
             printf("Failed to load media!\n");
+        } else if (benchmark) {
+            runTileBenchmark();
         } else {
             // Main loop flag
             bool quit = false;
@@ -186,7 +1200,6 @@ int main(int argc, char* args[]) {
                     //User requests quit
                     if( e.type == SDL_QUIT ) {
                         quit = true;
-                        close();
                     } //Handle key presses
                     else if( e.type == SDL_KEYDOWN )
                     {
@@ -222,8 +1235,8 @@ int main(int argc, char* args[]) {
                 }
 
                 //Clear screen
-                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
-                SDL_RenderClear( gRenderer );
+                renderSetDrawColor( 0xFF, 0xFF, 0xFF, 0xFF );
+                renderClear();
 
                 //Render background
                 gBackgroundTexture.render( 0, 0 );
@@ -233,14 +1246,257 @@ int main(int argc, char* args[]) {
                 gModulatedTexture.render( 0, 0 );
 
                 //Update screen
-                SDL_RenderPresent( gRenderer );
+                renderPresent();
             }
         }
     }
 
+    //Free resources and close SDL
+    close();
+
     return 0;
 }
 
+//Draws the scene plus a blended primitive overlay through the active backend
+void renderBenchScene( int frame )
+{
+    renderSetDrawColor( 0xFF, 0xFF, 0xFF, 0xFF );
+    renderClear();
+
+    gBackgroundTexture.render( 0, 0 );
+    gModulatedTexture.setAlpha( (Uint8)( frame * 8 ) );
+    gModulatedTexture.render( 0, 0 );
+
+    //Shrunk copy of an opaque image
+    int shift = frame % 32;
+    SDL_Rect thumbnail = { 460, 20 + shift, 160, 120 };
+    gBackgroundTexture.renderScaled( &thumbnail );
+
+    //Partly transparent copies, unscaled and scaled, modulated and not, some leaving the frame
+    SDL_Rect spriteClip = { 8, 4, 40, 20 };
+    gAlphaSprite.render( 100 + shift, 80 );
+    gAlphaSprite.render( -20, 200 + shift );
+    gAlphaSprite.render( SCREEN_WIDTH - 24, 40 + shift, &spriteClip );
+    SDL_Rect enlarged = { 300 - shift, 120, 150, 70 };
+    gAlphaSprite.renderScaled( &enlarged );
+    SDL_Rect shrunk = { 40, 380 + shift, 37, 19 };
+    gAlphaSprite.renderScaled( &shrunk );
+    SDL_Rect leaving = { SCREEN_WIDTH - 90 + shift, SCREEN_HEIGHT - 50, 170, 90 };
+    gAlphaSprite.renderScaled( &leaving );
+
+    gAlphaSprite.setAlpha( 0xA0 );
+    gAlphaSprite.render( 180, 300 - shift );
+    SDL_Rect faded = { 420, 360, 96, 48 };
+    gAlphaSprite.renderScaled( &faded );
+
+    gAlphaSprite.setColor( 0xFF, 0x80, 0x40 );
+    gAlphaSprite.render( 520, 10 + shift );
+    SDL_Rect tinted = { -30, -10, 110, 60 };
+    gAlphaSprite.renderScaled( &tinted, &spriteClip );
+    gAlphaSprite.setColor( 0xFF, 0xFF, 0xFF );
+    gAlphaSprite.setAlpha( 0xFF );
+
+    renderSetDrawBlendMode( SDL_BLENDMODE_BLEND );
+    for( int i = 0; i < 64; ++i )
+    {
+        int x = ( i * 37 + frame * 3 ) % SCREEN_WIDTH;
+        int y = ( i * 53 + frame * 2 ) % SCREEN_HEIGHT;
+
+        SDL_Rect fillRect = { x - 40, y - 30, 80, 60 };
+        renderSetDrawColor( (Uint8)( i * 4 ), 0x80, (Uint8)( 255 - i * 4 ), 0x60 );
+        renderFillRect( &fillRect );
+
+        renderSetDrawColor( 0x00, 0x00, 0x00, 0xC0 );
+        renderDrawRect( &fillRect );
+        renderDrawLine( x, y, SCREEN_WIDTH - 1 - x, SCREEN_HEIGHT - 1 - y );
+    }
+    for( int i = 0; i < SCREEN_HEIGHT; i += 4 )
+    {
+        renderDrawPoint( SCREEN_WIDTH / 2, i );
+    }
+    renderSetDrawBlendMode( SDL_BLENDMODE_NONE );
+}
+
+void runTileBenchmark()
+{
+    const int BENCH_FRAMES = 120;
+
+    //Sprite cycling through every alpha level
+    SDL_Surface* spritePixels = SDL_CreateRGBSurfaceWithFormat( 0, 64, 32, 32, SDL_PIXELFORMAT_ARGB8888 );
+    if( spritePixels == NULL )
+    {
+        printf( "Unable to create sprite pixels! SDL Error: %s\n", SDL_GetError() );
+        return;
+    }
+    for( int y = 0; y < spritePixels->h; ++y )
+    {
+        Uint32* row = (Uint32*)( (Uint8*)spritePixels->pixels + y * spritePixels->pitch );
+        for( int x = 0; x < spritePixels->w; ++x )
+        {
+            Uint32 alpha = ( x * 4 + y ) & 0xFF;
+            row[ x ] = ( alpha << 24 ) | ( ( x * 4 ) << 16 ) | ( ( y * 8 ) << 8 ) | ( 255 - x * 4 );
+        }
+    }
+    bool loaded = gAlphaSprite.loadFromPixels( spritePixels );
+    SDL_FreeSurface( spritePixels );
+    if( !loaded )
+    {
+        return;
+    }
+
+    //Output of the single threaded run
+    std::vector<Uint8> reference;
+    double singleMs = 0.0;
+
+    int maxThreads = SDL_GetCPUCount();
+    for( int threads = 1; ; threads = SDL_min( threads * 2, maxThreads ) )
+    {
+        if( !gTileBackend.init( gWindow, threads ) )
+        {
+            break;
+        }
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        for( int frame = 0; frame < BENCH_FRAMES; ++frame )
+        {
+            renderBenchScene( frame );
+            gTileBackend.flush();
+        }
+        double frameMs = ( SDL_GetPerformanceCounter() - start ) * 1000.0 / SDL_GetPerformanceFrequency() / BENCH_FRAMES;
+
+        //Compare the last frame row by row, the pitch may include padding
+        SDL_Surface* frameBuffer = gTileBackend.getFrameBuffer();
+        size_t rowBytes = frameBuffer->w * 4;
+        bool match = true;
+        if( threads == 1 )
+        {
+            singleMs = frameMs;
+            reference.resize( rowBytes * frameBuffer->h );
+        }
+        for( int y = 0; y < frameBuffer->h; ++y )
+        {
+            Uint8* row = (Uint8*)frameBuffer->pixels + y * frameBuffer->pitch;
+            if( threads == 1 )
+            {
+                memcpy( &reference[ y * rowBytes ], row, rowBytes );
+            }
+            else if( memcmp( &reference[ y * rowBytes ], row, rowBytes ) != 0 )
+            {
+                match = false;
+            }
+        }
+
+        printf( "%2d threads: %.3f ms/frame, %.2fx, output %s\n", gTileBackend.getThreadCount(), frameMs,
+                frameMs > 0.0 ? singleMs / frameMs : 0.0, match ? "matches" : "DIFFERS" );
+
+        gTileBackend.present();
+        if( threads == maxThreads )
+        {
+            break;
+        }
+    }
+
+    //The frame buffer still holds the last frame
+    compareWithSoftwareRenderer( BENCH_FRAMES - 1 );
+
+    gAlphaSprite.free();
+}
+
+bool compareWithSoftwareRenderer( int frame )
+{
+    //Render into a surface shaped like the frame buffer
+    SDL_Surface* frameBuffer = gTileBackend.getFrameBuffer();
+    if( frameBuffer == NULL )
+    {
+        return false;
+    }
+    SDL_Surface* reference = SDL_CreateRGBSurfaceWithFormat( 0, frameBuffer->w, frameBuffer->h, 32, SDL_PIXELFORMAT_ARGB8888 );
+    if( reference == NULL )
+    {
+        printf( "Unable to create reference surface! SDL Error: %s\n", SDL_GetError() );
+        return false;
+    }
+    SDL_Renderer* software = SDL_CreateSoftwareRenderer( reference );
+    if( software == NULL )
+    {
+        printf( "Unable to create software renderer! SDL Error: %s\n", SDL_GetError() );
+        SDL_FreeSurface( reference );
+        return false;
+    }
+
+    //Draw the same scene through the SDL renderer path. Blending truncates like SDL's generic blitter, copies by
+    //texel alpha alone take its per pixel alpha blitter's rounding, scaled copies sample from the half step and lines
+    //step like SDL's Bresenham, so the frames should match
+    LTileRenderer* tileRenderer = gTileRenderer;
+    gTileRenderer = NULL;
+    gRenderer = software;
+    bool success = gBackgroundTexture.createTexture( software ) && gModulatedTexture.createTexture( software ) &&
+                   gAlphaSprite.createTexture( software );
+    if( success )
+    {
+        renderBenchScene( frame );
+        SDL_RenderPresent( software );
+    }
+    gBackgroundTexture.freeTexture();
+    gModulatedTexture.freeTexture();
+    gAlphaSprite.freeTexture();
+    SDL_DestroyRenderer( software );
+    gRenderer = NULL;
+    gTileRenderer = tileRenderer;
+
+    //SDL's blitters leave uneven alpha the window ignores, so only color compares
+    if( success )
+    {
+        size_t rowBytes = frameBuffer->w * 4;
+        int differing = 0;
+        int worst = 0;
+        int firstX = -1;
+        int firstY = -1;
+        for( int y = 0; y < frameBuffer->h; ++y )
+        {
+            const Uint32* row = (const Uint32*)( (const Uint8*)frameBuffer->pixels + y * frameBuffer->pitch );
+            const Uint32* referenceRow = (const Uint32*)( (const Uint8*)reference->pixels + y * reference->pitch );
+            if( memcmp( row, referenceRow, rowBytes ) == 0 )
+            {
+                continue;
+            }
+
+            for( int x = 0; x < frameBuffer->w; ++x )
+            {
+                if( ( ( row[ x ] ^ referenceRow[ x ] ) & 0x00FFFFFF ) == 0 )
+                {
+                    continue;
+                }
+                if( firstX < 0 )
+                {
+                    firstX = x;
+                    firstY = y;
+                }
+                ++differing;
+                for( int shift = 0; shift < 24; shift += 8 )
+                {
+                    int difference = abs( (int)( ( row[ x ] >> shift ) & 0xFF ) - (int)( ( referenceRow[ x ] >> shift ) & 0xFF ) );
+                    worst = SDL_max( worst, difference );
+                }
+            }
+        }
+
+        if( differing == 0 )
+        {
+            printf( "Software renderer reference: output matches\n" );
+        }
+        else
+        {
+            printf( "Software renderer reference: output DIFFERS in %d pixels, up to %d per channel, first at %d,%d\n",
+                    differing, worst, firstX, firstY );
+            success = false;
+        }
+    }
+
+    SDL_FreeSurface( reference );
+    return success;
+}
+
 bool loadMedia()
 {
     //Loading success flag
@@ -272,6 +1528,11 @@ void close()
 {
     //Free loaded images
     gModulatedTexture.free();
+    gBackgroundTexture.free();
+
+    //Stop tile workers
+    gTileBackend.free();
+    gTileRenderer = NULL;
 
     //Destroy window
     SDL_DestroyRenderer( gRenderer );
@@ -304,6 +1565,21 @@ bool init() {
         if (gWindow == NULL) {
             printf("Window could not be created! SDL Error: %s\n", SDL_GetError());
             success = false;
+        } else if (gTileThreads > 0) {
+            // Rasterize into the window surface instead of creating a renderer
+            if (!gTileBackend.init(gWindow, gTileThreads)) {
+                success = false;
+            } else {
+                gTileRenderer = &gTileBackend;
+                printf("Tile renderer with %d threads\n", gTileBackend.getThreadCount());
+
+                // Initialize PNG loading
+                int imgFlags = IMG_INIT_PNG;
+                if (!(IMG_Init(imgFlags) & imgFlags)) {
+                    printf("SDL_image could not initialize! SDL_image Error: %s\n", IMG_GetError());
+                    success = false;
+                }
+            }
         } else {
             // Create renderer for window
             gRenderer = SDL_CreateRenderer(gWindow, -1, SDL_RENDERER_ACCELERATED);
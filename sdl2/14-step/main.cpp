@@ -1,7 +1,13 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
 #include <string>
+#include <vector>
+#include <algorithm>
 
 class LTexture
 {
@@ -43,6 +49,173 @@ class LTexture
         int mHeight;
 };
 
+//Runs simulation updates at a fixed rate independent of the render rate
+class LFixedStep
+{
+    public:
+        //Initializes the clock for the given update rate
+        LFixedStep( int updatesPerSecond );
+
+        //Starts counting real time from now
+        void start();
+
+        //Accumulates real time since the last call and returns the number of updates due
+        int advance();
+
+        //Gets how far real time is between the last update and the next, from 0 to 1
+        double getAlpha();
+
+    private:
+        //Updates per second
+        Uint64 mRate;
+
+        //Performance counter ticks per second
+        Uint64 mFrequency;
+
+        //Counter value at the last advance
+        Uint64 mLastCounter;
+
+        //Unsimulated time in counter ticks times the update rate, so no rounding is lost
+        Uint64 mAccumulator;
+};
+
+//Spatial hash of fixed size cells; entities register by their top left corner
+class LSpatialGrid
+{
+    public:
+        //Initializes variables
+        LSpatialGrid();
+
+        //Forgets every entity
+        void clear();
+
+        //Registers a new entity, ids must be added in order starting at zero
+        void add( int id, float x, float y );
+
+        //Updates an entity's position, touching the buckets only when it changes cell
+        void move( int id, float x, float y );
+
+        //Gets ids of entities whose top left corner lies in the cells overlapping a rect, in increasing order
+        void query( const SDL_Rect& rect, std::vector<int>& ids );
+
+        //Gets how many cells the last query visited
+        int getLastCellCount();
+
+    private:
+        //Gets the bucket a cell hashes to, hashed unsigned so negative cells and overflow stay defined
+        Uint32 getBucket( int cellX, int cellY );
+
+        //Gets the cell a coordinate lies in
+        int getCell( float coordinate );
+
+        //Entity ids per bucket
+        std::vector< std::vector<int> > mBuckets;
+
+        //Per entity cell, bucket and slot in the bucket
+        std::vector<int> mCellX;
+        std::vector<int> mCellY;
+        std::vector<Uint32> mBucketOf;
+        std::vector<int> mSlotOf;
+
+        //Per entity stamp so cells colliding in one bucket aren't reported twice
+        std::vector<Uint32> mQueryStamp;
+        Uint32 mStamp;
+
+        int mLastCellCount;
+};
+
+//Animated walkers stored as parallel arrays so updates stream through contiguous memory
+class LWalkerStore
+{
+    public:
+        //Removes all walkers
+        void clear();
+
+        //Adds a walker and returns its index
+        int add( float x, float y, float velocityX, float velocityY, int frame );
+
+        //Gets number of walkers
+        int getCount();
+
+        //Advances every walker by one simulation step
+        void update();
+
+        //Gets a walker's position interpolated between the last two updates
+        void getPosition( int index, double alpha, float& x, float& y );
+
+        //Renders the walkers overlapping a world rect, shown at the current viewport's top left
+        void render( double alpha, const SDL_Rect& view );
+
+        //Gets how many walkers the last render drew
+        int getDrawnCount();
+
+    private:
+        //Positions after the last two updates
+        std::vector<float> mX;
+        std::vector<float> mY;
+        std::vector<float> mPreviousX;
+        std::vector<float> mPreviousY;
+
+        //Pixels moved per update
+        std::vector<float> mVelocityX;
+        std::vector<float> mVelocityY;
+
+        //Animation counter, four updates per sprite clip
+        std::vector<int> mFrame;
+
+        //Sprite clip drawn for the current frame
+        std::vector<int> mClip;
+
+        //Spatial index of current positions
+        LSpatialGrid mGrid;
+
+        //Walkers found by the last render query
+        std::vector<int> mVisible;
+        int mDrawnCount;
+};
+
+//Paces the main loop to a target rate without vsync by sleeping, then spinning to the deadline
+class LFrameLimiter
+{
+    public:
+        //Initializes variables
+        LFrameLimiter();
+
+        //Sets the target rate, 0 disables limiting
+        void setTargetRate( int framesPerSecond );
+
+        //Starts the frame clock and statistics from now
+        void start();
+
+        //Waits until the current frame's deadline has passed
+        void waitForNextFrame();
+
+        //Prints achieved rate, jitter and CPU use since the last report
+        void printStats();
+
+    private:
+        //Performance counter ticks per second
+        Uint64 mFrequency;
+
+        //Ticks per frame at the target rate, 0 when disabled
+        Uint64 mFrameTicks;
+
+        //Counter value the current frame should end at
+        Uint64 mDeadline;
+
+        //Time left to spin after sleeping, grows to the worst oversleep seen
+        Uint64 mSpinTicks;
+
+        //Statistics since the last report
+        Uint64 mReportStart;
+        Uint64 mLastFrame;
+        clock_t mCpuStart;
+        int mFrames;
+        double mPeriodSum;
+        double mPeriodSquareSum;
+        double mMaxError;
+};
+
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
@@ -57,6 +230,44 @@ const int WALKING_ANIMATION_FRAMES = 4;
 SDL_Rect gSpriteClips[ WALKING_ANIMATION_FRAMES ];
 LTexture gSpriteSheetTexture;
 
+//Simulation updates per second, the animation advances one clip every four updates
+const int SIMULATION_RATE = 60;
+
+//Most updates run per rendered frame before unsimulated time is dropped
+const int MAX_UPDATES_PER_FRAME = 5;
+
+//Walker speed in pixels per update
+const int WALK_SPEED = 2;
+
+//Fastest any walker moves per update, bounds how far interpolation can lag the grid
+const int MAX_WALK_SPEED = 3;
+
+//World units per spatial grid cell and number of hash buckets, a power of two
+const int GRID_CELL_SIZE = 256;
+const int GRID_BUCKETS = 4096;
+
+//Updates spent on each walker count in stress mode
+const int STRESS_STEP_UPDATES = SIMULATION_RATE * 2;
+
+//Walkers in the first stress step, doubled every step
+const int STRESS_START_COUNT = 1000;
+
+//Whether presentation waits for vsync
+bool gVsync = true;
+
+//Frame rate the limiter holds when vsync is unavailable
+int gTargetFps = 60;
+
+//Milliseconds between limiter reports
+const Uint32 LIMITER_REPORT_MS = 5000;
+
+//All walkers in the scene
+LWalkerStore gWalkers;
+
+//World the walkers wrap around, the screen unless scaled up
+int gWorldWidth = SCREEN_WIDTH;
+int gWorldHeight = SCREEN_HEIGHT;
+
 void LTexture::setColor( Uint8 red, Uint8 green, Uint8 blue )
 {
     //Modulate texture
@@ -160,11 +371,435 @@ LTexture::~LTexture() {
     free();
 }
 
+LFixedStep::LFixedStep( int updatesPerSecond ) {
+    //Initialize
+    mRate = updatesPerSecond;
+    mFrequency = SDL_GetPerformanceFrequency();
+    mLastCounter = 0;
+    mAccumulator = 0;
+}
+
+void LFixedStep::start() {
+    mLastCounter = SDL_GetPerformanceCounter();
+    mAccumulator = 0;
+}
+
+int LFixedStep::advance() {
+    //Add elapsed real time
+    Uint64 now = SDL_GetPerformanceCounter();
+    mAccumulator += ( now - mLastCounter ) * mRate;
+    mLastCounter = now;
+
+    //Each update consumes one second worth of scaled ticks
+    Uint64 updates = mAccumulator / mFrequency;
+    mAccumulator %= mFrequency;
+
+    //Drop time we can't catch up on instead of falling further behind
+    if( updates > (Uint64)MAX_UPDATES_PER_FRAME )
+    {
+        updates = MAX_UPDATES_PER_FRAME;
+    }
+
+    return (int)updates;
+}
+
+double LFixedStep::getAlpha() {
+    return (double)mAccumulator / mFrequency;
+}
+
+LSpatialGrid::LSpatialGrid() {
+    //Initialize
+    mBuckets.resize( GRID_BUCKETS );
+    mStamp = 0;
+    mLastCellCount = 0;
+}
+
+void LSpatialGrid::clear() {
+    for( size_t i = 0; i < mBuckets.size(); ++i )
+    {
+        mBuckets[ i ].clear();
+    }
+    mCellX.clear();
+    mCellY.clear();
+    mBucketOf.clear();
+    mSlotOf.clear();
+    mQueryStamp.clear();
+}
+
+Uint32 LSpatialGrid::getBucket( int cellX, int cellY ) {
+    return ( ( (Uint32)cellX * 73856093u ) ^ ( (Uint32)cellY * 19349663u ) ) & ( GRID_BUCKETS - 1 );
+}
+
+int LSpatialGrid::getCell( float coordinate ) {
+    return (int)floorf( coordinate / GRID_CELL_SIZE );
+}
+
+void LSpatialGrid::add( int id, float x, float y ) {
+    int cellX = getCell( x );
+    int cellY = getCell( y );
+    Uint32 bucket = getBucket( cellX, cellY );
+
+    mCellX.push_back( cellX );
+    mCellY.push_back( cellY );
+    mBucketOf.push_back( bucket );
+    mSlotOf.push_back( mBuckets[ bucket ].size() );
+    mQueryStamp.push_back( 0 );
+    mBuckets[ bucket ].push_back( id );
+}
+
+void LSpatialGrid::move( int id, float x, float y ) {
+    int cellX = getCell( x );
+    int cellY = getCell( y );
+    if( cellX == mCellX[ id ] && cellY == mCellY[ id ] )
+    {
+        return;
+    }
+
+    //Remove from the old bucket by moving its last entry into the hole
+    std::vector<int>& oldBucket = mBuckets[ mBucketOf[ id ] ];
+    int last = oldBucket.back();
+    oldBucket[ mSlotOf[ id ] ] = last;
+    mSlotOf[ last ] = mSlotOf[ id ];
+    oldBucket.pop_back();
+
+    //Append to the new one
+    Uint32 bucket = getBucket( cellX, cellY );
+    mCellX[ id ] = cellX;
+    mCellY[ id ] = cellY;
+    mBucketOf[ id ] = bucket;
+    mSlotOf[ id ] = mBuckets[ bucket ].size();
+    mBuckets[ bucket ].push_back( id );
+}
+
+void LSpatialGrid::query( const SDL_Rect& rect, std::vector<int>& ids ) {
+    ids.clear();
+
+    //New stamp per query, resetting stamps when it wraps
+    if( ++mStamp == 0 )
+    {
+        std::fill( mQueryStamp.begin(), mQueryStamp.end(), 0 );
+        mStamp = 1;
+    }
+
+    int x1 = getCell( (float)rect.x );
+    int y1 = getCell( (float)rect.y );
+    int x2 = getCell( (float)( rect.x + rect.w - 1 ) );
+    int y2 = getCell( (float)( rect.y + rect.h - 1 ) );
+    mLastCellCount = ( x2 - x1 + 1 ) * ( y2 - y1 + 1 );
+    for( int cellY = y1; cellY <= y2; ++cellY )
+    {
+        for( int cellX = x1; cellX <= x2; ++cellX )
+        {
+            //Buckets are shared by colliding cells, so check each entry's real cell
+            const std::vector<int>& bucket = mBuckets[ getBucket( cellX, cellY ) ];
+            for( size_t i = 0; i < bucket.size(); ++i )
+            {
+                int id = bucket[ i ];
+                if( mCellX[ id ] == cellX && mCellY[ id ] == cellY && mQueryStamp[ id ] != mStamp )
+                {
+                    mQueryStamp[ id ] = mStamp;
+                    ids.push_back( id );
+                }
+            }
+        }
+    }
+
+    //Keep draw order stable as entities change cells
+    std::sort( ids.begin(), ids.end() );
+}
+
+int LSpatialGrid::getLastCellCount() {
+    return mLastCellCount;
+}
+
+void LWalkerStore::clear() {
+    mX.clear();
+    mY.clear();
+    mPreviousX.clear();
+    mPreviousY.clear();
+    mVelocityX.clear();
+    mVelocityY.clear();
+    mFrame.clear();
+    mClip.clear();
+    mGrid.clear();
+    mDrawnCount = 0;
+}
+
+int LWalkerStore::add( float x, float y, float velocityX, float velocityY, int frame ) {
+    mX.push_back( x );
+    mY.push_back( y );
+    mPreviousX.push_back( x );
+    mPreviousY.push_back( y );
+    mVelocityX.push_back( velocityX );
+    mVelocityY.push_back( velocityY );
+    mFrame.push_back( frame );
+    mClip.push_back( frame / 4 );
+    mGrid.add( (int)mX.size() - 1, x, y );
+    return (int)mX.size() - 1;
+}
+
+int LWalkerStore::getCount() {
+    return (int)mX.size();
+}
+
+void LWalkerStore::update() {
+    int count = getCount();
+    if( count == 0 )
+    {
+        return;
+    }
+
+    //Remember where walkers were for interpolation
+    memcpy( &mPreviousX[ 0 ], &mX[ 0 ], count * sizeof( float ) );
+    memcpy( &mPreviousY[ 0 ], &mY[ 0 ], count * sizeof( float ) );
+
+    //Move, wrapping around the world; branch free so the compiler can vectorize it
+    float* __restrict x = &mX[ 0 ];
+    float* __restrict y = &mY[ 0 ];
+    const float* __restrict velocityX = &mVelocityX[ 0 ];
+    const float* __restrict velocityY = &mVelocityY[ 0 ];
+    const float minX = (float)-gSpriteClips[ 0 ].w;
+    const float minY = (float)-gSpriteClips[ 0 ].h;
+    const float maxX = (float)gWorldWidth;
+    const float maxY = (float)gWorldHeight;
+    const float spanX = maxX - minX;
+    const float spanY = maxY - minY;
+    for( int i = 0; i < count; ++i )
+    {
+        float nextX = x[ i ] + velocityX[ i ];
+        float nextY = y[ i ] + velocityY[ i ];
+        nextX += ( nextX >= maxX ? -spanX : 0.f ) + ( nextX < minX ? spanX : 0.f );
+        nextY += ( nextY >= maxY ? -spanY : 0.f ) + ( nextY < minY ? spanY : 0.f );
+        x[ i ] = nextX;
+        y[ i ] = nextY;
+    }
+
+    //Cycle animation
+    int* __restrict frame = &mFrame[ 0 ];
+    int* __restrict clip = &mClip[ 0 ];
+    for( int i = 0; i < count; ++i )
+    {
+        int next = frame[ i ] + 1;
+        next = next >= WALKING_ANIMATION_FRAMES * 4 ? 0 : next;
+        frame[ i ] = next;
+        clip[ i ] = next >> 2;
+    }
+
+    //Move walkers that changed cell
+    for( int i = 0; i < count; ++i )
+    {
+        mGrid.move( i, x[ i ], y[ i ] );
+    }
+}
+
+void LWalkerStore::getPosition( int index, double alpha, float& x, float& y ) {
+    //Interpolate position between the last two updates, snapping when it wrapped
+    const float spanX = (float)( gWorldWidth + gSpriteClips[ 0 ].w );
+    const float spanY = (float)( gWorldHeight + gSpriteClips[ 0 ].h );
+    float dx = mX[ index ] - mPreviousX[ index ];
+    float dy = mY[ index ] - mPreviousY[ index ];
+    x = fabsf( dx ) * 2.f < spanX ? mPreviousX[ index ] + dx * (float)alpha : mX[ index ];
+    y = fabsf( dy ) * 2.f < spanY ? mPreviousY[ index ] + dy * (float)alpha : mY[ index ];
+}
+
+void LWalkerStore::render( double alpha, const SDL_Rect& view ) {
+    //Walkers register by top left corner and are drawn up to one update behind it
+    SDL_Rect area = { view.x - gSpriteClips[ 0 ].w - MAX_WALK_SPEED, view.y - gSpriteClips[ 0 ].h - MAX_WALK_SPEED,
+                      view.w + gSpriteClips[ 0 ].w + MAX_WALK_SPEED * 2, view.h + gSpriteClips[ 0 ].h + MAX_WALK_SPEED * 2 };
+    mGrid.query( area, mVisible );
+
+    mDrawnCount = 0;
+    for( size_t i = 0; i < mVisible.size(); ++i )
+    {
+        int index = mVisible[ i ];
+        float x, y;
+        getPosition( index, alpha, x, y );
+
+        //Skip walkers in visited cells that still miss the view
+        SDL_Rect* clip = &gSpriteClips[ mClip[ index ] ];
+        SDL_Rect quad = { (int)floorf( x + 0.5f ), (int)floorf( y + 0.5f ), clip->w, clip->h };
+        if( quad.x >= view.x + view.w || quad.y >= view.y + view.h || quad.x + quad.w <= view.x || quad.y + quad.h <= view.y )
+        {
+            continue;
+        }
+
+        gSpriteSheetTexture.render( quad.x - view.x, quad.y - view.y, clip );
+        ++mDrawnCount;
+    }
+}
+
+int LWalkerStore::getDrawnCount() {
+    return mDrawnCount;
+}
+
+//Fills the store with walkers at random positions, speeds and animation frames
+void spawnWalkers( int count )
+{
+    gWalkers.clear();
+    for( int i = 0; i < count; ++i )
+    {
+        float x = (float)( rand() % gWorldWidth );
+        float y = (float)( rand() % gWorldHeight ) - gSpriteClips[ 0 ].h / 2;
+        float velocityX = 1.f + ( rand() % ( ( MAX_WALK_SPEED - 1 ) * 100 ) ) / 100.f;
+        float velocityY = ( rand() % 100 - 50 ) / 100.f;
+        gWalkers.add( x, y, velocityX, velocityY, rand() % ( WALKING_ANIMATION_FRAMES * 4 ) );
+    }
+}
+
+LFrameLimiter::LFrameLimiter() {
+    //Initialize
+    mFrequency = SDL_GetPerformanceFrequency();
+    mFrameTicks = 0;
+    mDeadline = 0;
+    mSpinTicks = mFrequency / 1000;
+    mReportStart = 0;
+    mLastFrame = 0;
+    mCpuStart = 0;
+    mFrames = 0;
+    mPeriodSum = 0.0;
+    mPeriodSquareSum = 0.0;
+    mMaxError = 0.0;
+}
+
+void LFrameLimiter::setTargetRate( int framesPerSecond ) {
+    mFrameTicks = framesPerSecond > 0 ? mFrequency / framesPerSecond : 0;
+}
+
+void LFrameLimiter::start() {
+    mLastFrame = SDL_GetPerformanceCounter();
+    mDeadline = mLastFrame + mFrameTicks;
+    mReportStart = mLastFrame;
+    mCpuStart = clock();
+    mFrames = 0;
+    mPeriodSum = 0.0;
+    mPeriodSquareSum = 0.0;
+    mMaxError = 0.0;
+}
+
+void LFrameLimiter::waitForNextFrame() {
+    if( mFrameTicks > 0 )
+    {
+        //Sleep through most of the remaining budget
+        Uint64 now = SDL_GetPerformanceCounter();
+        if( now + mSpinTicks < mDeadline )
+        {
+            Uint64 sleepTicks = mDeadline - now - mSpinTicks;
+            Uint32 sleepMs = (Uint32)( sleepTicks * 1000 / mFrequency );
+            if( sleepMs > 0 )
+            {
+                SDL_Delay( sleepMs );
+
+                //Learn how late the scheduler wakes us, shrinking slowly when it improves
+                Uint64 woke = SDL_GetPerformanceCounter();
+                Uint64 requested = (Uint64)sleepMs * mFrequency / 1000;
+                Uint64 oversleep = woke - now > requested ? woke - now - requested : 0;
+                if( oversleep > mSpinTicks )
+                {
+                    mSpinTicks = oversleep;
+                }
+                else
+                {
+                    mSpinTicks -= ( mSpinTicks - oversleep ) / 64;
+                }
+                mSpinTicks = SDL_max( mSpinTicks, mFrequency / 2000 );
+            }
+        }
+
+        //Spin the last stretch on the performance counter
+        while( SDL_GetPerformanceCounter() < mDeadline )
+        {
+        }
+
+        //Schedule from the deadline so errors don't accumulate, resyncing after a long stall
+        now = SDL_GetPerformanceCounter();
+        mDeadline += mFrameTicks;
+        if( now > mDeadline )
+        {
+            mDeadline = now + mFrameTicks;
+        }
+    }
+
+    //Record the achieved frame period
+    Uint64 frameEnd = SDL_GetPerformanceCounter();
+    double period = (double)( frameEnd - mLastFrame ) / mFrequency;
+    mLastFrame = frameEnd;
+    ++mFrames;
+    mPeriodSum += period;
+    mPeriodSquareSum += period * period;
+    if( mFrameTicks > 0 )
+    {
+        double error = fabs( period - (double)mFrameTicks / mFrequency );
+        mMaxError = SDL_max( mMaxError, error );
+    }
+}
+
+void LFrameLimiter::printStats() {
+    Uint64 now = SDL_GetPerformanceCounter();
+    double wall = (double)( now - mReportStart ) / mFrequency;
+    double cpu = (double)( clock() - mCpuStart ) / CLOCKS_PER_SEC;
+
+    if( mFrames > 0 && wall > 0.0 )
+    {
+        double mean = mPeriodSum / mFrames;
+        double variance = SDL_max( mPeriodSquareSum / mFrames - mean * mean, 0.0 );
+        printf( "%.2f FPS, jitter %.3f ms (max %.3f ms), CPU %.1f%%, spin %.3f ms\n", mFrames / wall, sqrt( variance ) * 1000.0,
+                mMaxError * 1000.0, 100.0 * cpu / wall, (double)mSpinTicks * 1000.0 / mFrequency );
+    }
+
+    //Start a new report window
+    mReportStart = now;
+    mCpuStart = clock();
+    mFrames = 0;
+    mPeriodSum = 0.0;
+    mPeriodSquareSum = 0.0;
+    mMaxError = 0.0;
+}
+
 bool loadMedia();
 void close();
 bool init();
 
 int main(int argc, char* args[]) {
+    //Check for vsync, frame rate, walker count and stress options
+    int walkerCount = 1;
+    bool stress = false;
+    double stressThresholdMs = 1000.0 / SIMULATION_RATE;
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( args[ i ], "--no-vsync" ) == 0 )
+        {
+            gVsync = false;
+        }
+        else if( strcmp( args[ i ], "--fps" ) == 0 && i + 1 < argc )
+        {
+            gTargetFps = atoi( args[ ++i ] );
+        }
+        else if( strcmp( args[ i ], "--world" ) == 0 && i + 1 < argc )
+        {
+            //World several screens wide and tall
+            int scale = atoi( args[ ++i ] );
+            if( scale > 1 )
+            {
+                gWorldWidth = SCREEN_WIDTH * scale;
+                gWorldHeight = SCREEN_HEIGHT * scale;
+            }
+        }
+        else if( strcmp( args[ i ], "--walkers" ) == 0 && i + 1 < argc )
+        {
+            walkerCount = atoi( args[ ++i ] );
+        }
+        else if( strcmp( args[ i ], "--stress" ) == 0 )
+        {
+            //Vsync would hide frame time under the refresh interval
+            stress = true;
+            gVsync = false;
+            if( i + 1 < argc && atof( args[ i + 1 ] ) > 0.0 )
+            {
+                stressThresholdMs = atof( args[ ++i ] );
+            }
+        }
+    }
+
     // Start up SDL and create window
     if (!init()) {
         printf("Failed to initialize!\n");
@@ -179,42 +814,130 @@ int main(int argc, char* args[]) {
             // Event handler
             SDL_Event e;
 
-            //Current animation frame
-            int frame = 0;
+            //A single walker starts in the middle like before, more are scattered
+            if( walkerCount <= 1 && !stress )
+            {
+                gWalkers.add( ( SCREEN_WIDTH - gSpriteClips[ 0 ].w ) / 2, ( SCREEN_HEIGHT - gSpriteClips[ 0 ].h ) / 2, WALK_SPEED, 0.f, 0 );
+            }
+            else
+            {
+                spawnWalkers( stress ? STRESS_START_COUNT : walkerCount );
+            }
+
+            //Stress mode timing for the current walker count
+            Uint64 frequency = SDL_GetPerformanceFrequency();
+            Uint64 stressUpdateTicks = 0;
+            Uint64 stressRenderTicks = 0;
+            Uint64 stressFrameTicks = 0;
+            int stressFrames = 0;
+            int stressUpdates = 0;
+            int lastPassingCount = 0;
+
+            //Simulation clock
+            LFixedStep simulation( SIMULATION_RATE );
+            simulation.start();
+
+            //Pace the loop ourselves when the renderer doesn't wait for vsync, stress mode runs flat out
+            SDL_RendererInfo info;
+            SDL_GetRendererInfo( gRenderer, &info );
+            bool vsynced = ( info.flags & SDL_RENDERER_PRESENTVSYNC ) != 0;
+
+            LFrameLimiter limiter;
+            limiter.setTargetRate( vsynced || stress ? 0 : gTargetFps );
+            limiter.start();
+            Uint32 nextReport = SDL_GetTicks() + LIMITER_REPORT_MS;
 
             while (!quit) {
                 while (SDL_PollEvent( &e ) != 0) {
                     //User requests quit
                     if( e.type == SDL_QUIT ) {
                         quit = true;
-                        close();
                     }
                 }
 
+                Uint64 frameStart = SDL_GetPerformanceCounter();
+
+                //Run the updates real time has accumulated, however long the last frame took
+                int updates = simulation.advance();
+                for( int i = 0; i < updates; ++i )
+                {
+                    gWalkers.update();
+                }
+                Uint64 updateEnd = SDL_GetPerformanceCounter();
+
                 //Clear screen
                 SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
                 SDL_RenderClear( gRenderer );
 
-                //Render current frame
-                SDL_Rect* currentClip = &gSpriteClips[ frame / 4 ];
-                gSpriteSheetTexture.render( ( SCREEN_WIDTH - currentClip->w ) / 2, ( SCREEN_HEIGHT - currentClip->h ) / 2, currentClip );
+                //Camera follows the first walker, kept inside the world
+                double alpha = simulation.getAlpha();
+                float cameraX, cameraY;
+                gWalkers.getPosition( 0, alpha, cameraX, cameraY );
+                SDL_Rect viewport;
+                SDL_RenderGetViewport( gRenderer, &viewport );
+                SDL_Rect view = { (int)cameraX + gSpriteClips[ 0 ].w / 2 - viewport.w / 2, (int)cameraY + gSpriteClips[ 0 ].h / 2 - viewport.h / 2, viewport.w, viewport.h };
+                view.x = std::max( 0, std::min( view.x, gWorldWidth - view.w ) );
+                view.y = std::max( 0, std::min( view.y, gWorldHeight - view.h ) );
+
+                //Render the current frame of every walker in view
+                gWalkers.render( alpha, view );
 
                 //Update screen
                 SDL_RenderPresent( gRenderer );
 
-                //Go to next frame
-                ++frame;
+                //Hold the target rate
+                limiter.waitForNextFrame();
 
-                //Cycle animation
-                if( frame / 4 >= WALKING_ANIMATION_FRAMES )
+                //Report pacing periodically
+                if( SDL_GetTicks() >= nextReport )
                 {
-                    frame = 0;
+                    limiter.printStats();
+                    nextReport += LIMITER_REPORT_MS;
                 }
 
+                if( stress )
+                {
+                    Uint64 frameEnd = SDL_GetPerformanceCounter();
+                    stressUpdateTicks += updateEnd - frameStart;
+                    stressRenderTicks += frameEnd - updateEnd;
+                    stressFrameTicks += frameEnd - frameStart;
+                    stressUpdates += updates;
+                    ++stressFrames;
+
+                    //Judge each walker count over a fixed stretch of simulated time
+                    if( stressUpdates >= STRESS_STEP_UPDATES )
+                    {
+                        double frameMs = stressFrameTicks * 1000.0 / frequency / stressFrames;
+                        printf( "%d walkers: %.3f ms/frame (update %.3f ms, render %.3f ms), %d drawn\n", gWalkers.getCount(), frameMs,
+                                stressUpdateTicks * 1000.0 / frequency / stressFrames, stressRenderTicks * 1000.0 / frequency / stressFrames,
+                                gWalkers.getDrawnCount() );
+
+                        if( frameMs > stressThresholdMs )
+                        {
+                            printf( "Frame time passed %.2f ms, last passing count %d walkers\n", stressThresholdMs, lastPassingCount );
+                            quit = true;
+                        }
+                        else
+                        {
+                            lastPassingCount = gWalkers.getCount();
+                            spawnWalkers( gWalkers.getCount() * 2 );
+                            simulation.start();
+                        }
+
+                        stressUpdateTicks = 0;
+                        stressRenderTicks = 0;
+                        stressFrameTicks = 0;
+                        stressFrames = 0;
+                        stressUpdates = 0;
+                    }
+                }
             }
         }
     }
 
+    //Free resources and close SDL
+    close();
+
     return 0;
 }
 
@@ -293,8 +1016,13 @@ bool init() {
             printf("Window could not be created! SDL Error: %s\n", SDL_GetError());
             success = false;
         } else {
-            //Create vsynced renderer for window
-            gRenderer = SDL_CreateRenderer( gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC );
+            //Create renderer for window, vsynced unless disabled
+            Uint32 rendererFlags = SDL_RENDERER_ACCELERATED;
+            if( gVsync )
+            {
+                rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+            }
+            gRenderer = SDL_CreateRenderer( gWindow, -1, rendererFlags );
             if( gRenderer == NULL )
             {
                 printf( "Renderer could not be created! SDL Error: %s\n", SDL_GetError() );
@@ -3,6 +3,9 @@
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <string>
 #include <cmath>
 
@@ -46,6 +49,48 @@ class LTexture
         int mHeight;
 };
 
+//Paces the main loop to a target rate without vsync by sleeping, then spinning to the deadline
+class LFrameLimiter
+{
+    public:
+        //Initializes variables
+        LFrameLimiter();
+
+        //Sets the target rate, 0 disables limiting
+        void setTargetRate( int framesPerSecond );
+
+        //Starts the frame clock and statistics from now
+        void start();
+
+        //Waits until the current frame's deadline has passed
+        void waitForNextFrame();
+
+        //Prints achieved rate, jitter and CPU use since the last report
+        void printStats();
+
+    private:
+        //Performance counter ticks per second
+        Uint64 mFrequency;
+
+        //Ticks per frame at the target rate, 0 when disabled
+        Uint64 mFrameTicks;
+
+        //Counter value the current frame should end at
+        Uint64 mDeadline;
+
+        //Time left to spin after sleeping, grows to the worst oversleep seen
+        Uint64 mSpinTicks;
+
+        //Statistics since the last report
+        Uint64 mReportStart;
+        Uint64 mLastFrame;
+        clock_t mCpuStart;
+        int mFrames;
+        double mPeriodSum;
+        double mPeriodSquareSum;
+        double mMaxError;
+};
+
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
@@ -61,6 +106,21 @@ TTF_Font *gFont = NULL;
 //Rendered texture
 LTexture gTextTexture;
 
+//Whether the main loop sleeps until an event marks the window dirty
+bool gIdleMode = false;
+
+//Longest idle sleep, redrawing afterwards in case the window system lost our pixels
+const int IDLE_REFRESH_MS = 1000;
+
+//Whether to ask the renderer for vsync
+bool gVsync = true;
+
+//Frame rate the limiter holds when vsync is unavailable
+int gTargetFps = 60;
+
+//Milliseconds between limiter reports
+const Uint32 LIMITER_REPORT_MS = 5000;
+
 void LTexture::setColor( Uint8 red, Uint8 green, Uint8 blue )
 {
     //Modulate texture
@@ -158,11 +218,137 @@ LTexture::~LTexture() {
     free();
 }
 
+LFrameLimiter::LFrameLimiter() {
+    //Initialize
+    mFrequency = SDL_GetPerformanceFrequency();
+    mFrameTicks = 0;
+    mDeadline = 0;
+    mSpinTicks = mFrequency / 1000;
+    mReportStart = 0;
+    mLastFrame = 0;
+    mCpuStart = 0;
+    mFrames = 0;
+    mPeriodSum = 0.0;
+    mPeriodSquareSum = 0.0;
+    mMaxError = 0.0;
+}
+
+void LFrameLimiter::setTargetRate( int framesPerSecond ) {
+    mFrameTicks = framesPerSecond > 0 ? mFrequency / framesPerSecond : 0;
+}
+
+void LFrameLimiter::start() {
+    mLastFrame = SDL_GetPerformanceCounter();
+    mDeadline = mLastFrame + mFrameTicks;
+    mReportStart = mLastFrame;
+    mCpuStart = clock();
+    mFrames = 0;
+    mPeriodSum = 0.0;
+    mPeriodSquareSum = 0.0;
+    mMaxError = 0.0;
+}
+
+void LFrameLimiter::waitForNextFrame() {
+    if( mFrameTicks > 0 )
+    {
+        //Sleep through most of the remaining budget
+        Uint64 now = SDL_GetPerformanceCounter();
+        if( now + mSpinTicks < mDeadline )
+        {
+            Uint64 sleepTicks = mDeadline - now - mSpinTicks;
+            Uint32 sleepMs = (Uint32)( sleepTicks * 1000 / mFrequency );
+            if( sleepMs > 0 )
+            {
+                SDL_Delay( sleepMs );
+
+                //Learn how late the scheduler wakes us, shrinking slowly when it improves
+                Uint64 woke = SDL_GetPerformanceCounter();
+                Uint64 requested = (Uint64)sleepMs * mFrequency / 1000;
+                Uint64 oversleep = woke - now > requested ? woke - now - requested : 0;
+                if( oversleep > mSpinTicks )
+                {
+                    mSpinTicks = oversleep;
+                }
+                else
+                {
+                    mSpinTicks -= ( mSpinTicks - oversleep ) / 64;
+                }
+                mSpinTicks = SDL_max( mSpinTicks, mFrequency / 2000 );
+            }
+        }
+
+        //Spin the last stretch on the performance counter
+        while( SDL_GetPerformanceCounter() < mDeadline )
+        {
+        }
+
+        //Schedule from the deadline so errors don't accumulate, resyncing after a long stall
+        now = SDL_GetPerformanceCounter();
+        mDeadline += mFrameTicks;
+        if( now > mDeadline )
+        {
+            mDeadline = now + mFrameTicks;
+        }
+    }
+
+    //Record the achieved frame period
+    Uint64 frameEnd = SDL_GetPerformanceCounter();
+    double period = (double)( frameEnd - mLastFrame ) / mFrequency;
+    mLastFrame = frameEnd;
+    ++mFrames;
+    mPeriodSum += period;
+    mPeriodSquareSum += period * period;
+    if( mFrameTicks > 0 )
+    {
+        double error = fabs( period - (double)mFrameTicks / mFrequency );
+        mMaxError = SDL_max( mMaxError, error );
+    }
+}
+
+void LFrameLimiter::printStats() {
+    Uint64 now = SDL_GetPerformanceCounter();
+    double wall = (double)( now - mReportStart ) / mFrequency;
+    double cpu = (double)( clock() - mCpuStart ) / CLOCKS_PER_SEC;
+
+    if( mFrames > 0 && wall > 0.0 )
+    {
+        double mean = mPeriodSum / mFrames;
+        double variance = SDL_max( mPeriodSquareSum / mFrames - mean * mean, 0.0 );
+        printf( "%.2f FPS, jitter %.3f ms (max %.3f ms), CPU %.1f%%, spin %.3f ms\n", mFrames / wall, sqrt( variance ) * 1000.0,
+                mMaxError * 1000.0, 100.0 * cpu / wall, (double)mSpinTicks * 1000.0 / mFrequency );
+    }
+
+    //Start a new report window
+    mReportStart = now;
+    mCpuStart = clock();
+    mFrames = 0;
+    mPeriodSum = 0.0;
+    mPeriodSquareSum = 0.0;
+    mMaxError = 0.0;
+}
+
 bool loadMedia();
 void close();
 bool init();
 
 int main(int argc, char* args[]) {
+    //Check for idle and pacing options
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( args[ i ], "--idle" ) == 0 )
+        {
+            gIdleMode = true;
+        }
+        else if( strcmp( args[ i ], "--no-vsync" ) == 0 )
+        {
+            gVsync = false;
+        }
+        else if( strcmp( args[ i ], "--fps" ) == 0 && i + 1 < argc )
+        {
+            gTargetFps = atoi( args[ ++i ] );
+        }
+    }
+
     // Start up SDL and create window
     if (!init()) {
         printf("Failed to initialize!\n");
@@ -180,15 +366,55 @@ int main(int argc, char* args[]) {
             //Flip type
             SDL_RendererFlip flipType = SDL_FLIP_NONE;
 
+            //Whether the window needs to be redrawn
+            bool dirty = true;
+
+            //Pace the loop ourselves when the renderer doesn't wait for vsync, idle mode blocks on events instead
+            SDL_RendererInfo info;
+            SDL_GetRendererInfo( gRenderer, &info );
+            bool vsynced = ( info.flags & SDL_RENDERER_PRESENTVSYNC ) != 0;
+
+            LFrameLimiter limiter;
+            limiter.setTargetRate( vsynced || gIdleMode ? 0 : gTargetFps );
+            limiter.start();
+            Uint32 nextReport = SDL_GetTicks() + LIMITER_REPORT_MS;
+
             while (!quit) {
-                while (SDL_PollEvent( &e ) != 0) {
+                //In idle mode block until an event arrives or the refresh timeout passes
+                bool hasEvent;
+                if( gIdleMode )
+                {
+                    hasEvent = SDL_WaitEventTimeout( &e, IDLE_REFRESH_MS ) != 0;
+                    if( !hasEvent )
+                    {
+                        dirty = true;
+                    }
+                }
+                else
+                {
+                    hasEvent = SDL_PollEvent( &e ) != 0;
+                }
+
+                while (hasEvent) {
                     //User requests quit
                     if( e.type == SDL_QUIT ) {
                         quit = true;
-                        close();
                     }
+                    //Window contents may need repainting
+                    else if( e.type == SDL_WINDOWEVENT || e.type == SDL_RENDER_TARGETS_RESET ) {
+                        dirty = true;
+                    }
+
+                    hasEvent = SDL_PollEvent( &e ) != 0;
                 }
 
+                //Present nothing when the frame is unchanged
+                if( gIdleMode && !dirty )
+                {
+                    continue;
+                }
+                dirty = false;
+
                 //Clear screen
                 SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
                 SDL_RenderClear( gRenderer );
@@ -198,10 +424,23 @@ int main(int argc, char* args[]) {
 
                 //Update screen
                 SDL_RenderPresent( gRenderer );
+
+                //Hold the target rate
+                limiter.waitForNextFrame();
+
+                //Report pacing periodically
+                if( SDL_GetTicks() >= nextReport )
+                {
+                    limiter.printStats();
+                    nextReport += LIMITER_REPORT_MS;
+                }
             }
         }
     }
 
+    //Free resources and close SDL
+    close();
+
     return 0;
 }
 
@@ -273,8 +512,13 @@ bool init() {
             printf("Window could not be created! SDL Error: %s\n", SDL_GetError());
             success = false;
         } else {
-            //Create vsynced renderer for window
-            gRenderer = SDL_CreateRenderer( gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC );
+            //Create renderer for window, vsynced unless disabled
+            Uint32 rendererFlags = SDL_RENDERER_ACCELERATED;
+            if( gVsync )
+            {
+                rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+            }
+            gRenderer = SDL_CreateRenderer( gWindow, -1, rendererFlags );
             if( gRenderer == NULL )
             {
                 printf( "Renderer could not be created! SDL Error: %s\n", SDL_GetError() );
@@ -1,7 +1,1025 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
 
-int main(int argc, char* args[]) {
-    puts("Not done yet.");
+//Texture wrapper class
+class LTexture
+{
+    public:
+        //Initializes variables
+        LTexture();
+
+        //Deallocates memory
+        ~LTexture();
+
+        //Loads image at specified path
+        bool loadFromFile( std::string path );
+
+        //Deallocates texture
+        void free();
+
+        //Set color modulation
+        void setColor( Uint8 red, Uint8 green, Uint8 blue );
+
+        //Renders texture at given point
+        void render( int x, int y, SDL_Rect* clip = NULL );
+
+        //Gets image dimensions
+        int getWidth();
+        int getHeight();
+
+    private:
+        //The actual hardware texture
+        SDL_Texture* mTexture;
+
+        //Image dimensions
+        int mWidth;
+        int mHeight;
+};
+
+//Walls that never move, stored as one array per edge
+struct LStaticSet
+{
+    //Adds a wall
+    void add( int x, int y, int w, int h );
+
+    //Checks whether a mover at the given point overlaps any wall
+    bool overlaps( float x, float y ) const;
+
+    //Wall edges, right and bottom one past the wall like SDL_Rect
+    std::vector<float> mLeft;
+    std::vector<float> mTop;
+    std::vector<float> mRight;
+    std::vector<float> mBottom;
+};
+
+//A mover's place in the broadphase order
+struct LSweepEntry
+{
+    //Left edge of everything the mover covers this tick
+    float left;
+    int id;
+};
+
+//Dot sized boxes moved together each tick with swept collision
+class LMoverSet
+{
+    public:
+        //Places movers with random velocities where they do not overlap a wall
+        void create( int count, const LStaticSet& statics );
+
+        //Advances every mover by one tick, continuously or with the plain move and check
+        void tick( float dt, const LStaticSet& statics, bool continuous );
+
+        //Sets a mover's velocity in pixels per second
+        void setVelocity( int index, float velX, float velY );
+
+        //Gets the number of movers
+        int getCount();
+
+        //Gets a mover's top left corner
+        float getX( int index );
+        float getY( int index );
+
+        //Gets and resets statistics since the last call
+        int takeTunnelCount();
+        int takeContactCount();
+
+    private:
+        //Positions and velocities
+        std::vector<float> mX;
+        std::vector<float> mY;
+        std::vector<float> mVelX;
+        std::vector<float> mVelY;
+
+        //Movement this tick and the movers sorted by where it starts, for the mover broadphase
+        std::vector<float> mDX;
+        std::vector<float> mDY;
+        std::vector<LSweepEntry> mOrder;
+
+        //Earliest contact with another mover this tick, who it is with and the velocity after it
+        std::vector<float> mPairTime;
+        std::vector<int> mPairPartner;
+        std::vector<float> mPairVelX;
+        std::vector<float> mPairVelY;
+
+        //Statistics
+        int mTunnels;
+        int mContacts;
+};
+
+//The player's input, steering the first mover
+class Dot
+{
+    public:
+        //The dimensions of the dot
+        static const int DOT_WIDTH = 20;
+        static const int DOT_HEIGHT = 20;
+
+        //Maximum axis velocity of the dot in pixels per second
+        static const int DOT_VEL = 600;
+
+        //Initializes the variables
+        Dot();
+
+        //Takes key presses and adjusts the dot's velocity
+        void handleEvent( SDL_Event& e );
+
+        //Gets the velocity
+        int getVelX();
+        int getVelY();
+
+    private:
+        //The velocity of the dot
+        int mVelX, mVelY;
+};
+
+//Screen dimension constants
+const int SCREEN_WIDTH = 640;
+const int SCREEN_HEIGHT = 480;
+
+//Movers are dot sized
+const float MOVER_SIZE = 20.f;
+
+//Default mover count and the speed range in pixels per second
+const int DEFAULT_MOVERS = 200;
+const float MIN_MOVER_SPEED = 200.f;
+const float MAX_MOVER_SPEED = 1200.f;
+
+//Default simulation rate, and the most ticks run to catch up in one frame
+const int DEFAULT_TICK_RATE = 60;
+const int MAX_TICKS_PER_FRAME = 8;
+
+//Wall hits one mover resolves in a tick before it stops for the rest of the tick
+const int MAX_SWEEP_STEPS = 4;
+
+//Time of impact meaning nothing was hit
+const float NO_IMPACT = 2.f;
+
+//Overlap tolerated before a sweep counts the boxes as already inside each other
+const float SWEEP_EPSILON = 1e-4f;
+
+//Milliseconds between performance reports
+const Uint32 MOTION_REPORT_MS = 5000;
+
+//Seed for mover placement, so benchmark runs start from the same scene
+const Uint32 MOVER_SEED = 2463534242u;
+
+//Ticks simulated per tunneling benchmark run
+const int BENCHMARK_TICKS = 2000;
+
+//Starts up SDL and creates window
+bool init();
+
+//Loads media
+bool loadMedia();
+
+//Frees media and shuts down SDL
+void close();
+
+//Orders movers by the left edge of their sweep
+bool compareSweepEntries( const LSweepEntry& a, const LSweepEntry& b );
+
+//Finds when a mover sweeping by dx, dy first touches a box, as a fraction of the move
+float sweepBox( float x, float y, float dx, float dy, float left, float top, float right, float bottom, int& axis );
+
+//Adds the screen border and the thin walls inside it
+void buildLevel( LStaticSet& statics );
+
+//Runs both collision modes without a window at several tick rates and counts the movers that got through walls
+void runTunnelBenchmark();
+
+//The window we'll be rendering to
+SDL_Window* gWindow = NULL;
+
+//The window renderer
+SDL_Renderer* gRenderer = NULL;
+
+//Scene textures
+LTexture gDotTexture;
+
+//Random state shared by mover placement
+Uint32 gRandomState = MOVER_SEED;
+
+//Xorshift random numbers
+inline Uint32 nextRandom()
+{
+    gRandomState ^= gRandomState << 13;
+    gRandomState ^= gRandomState >> 17;
+    gRandomState ^= gRandomState << 5;
+    return gRandomState;
+}
+
+//Random float in [0, 1)
+inline float randomUnit()
+{
+    return ( nextRandom() >> 8 ) / 16777216.f;
+}
+
+LTexture::LTexture()
+{
+    //Initialize
+    mTexture = NULL;
+    mWidth = 0;
+    mHeight = 0;
+}
+
+LTexture::~LTexture()
+{
+    //Deallocate
+    free();
+}
+
+bool LTexture::loadFromFile( std::string path )
+{
+    //Get rid of preexisting texture
+    free();
+
+    //The final texture
+    SDL_Texture* newTexture = NULL;
+
+    //Load image at specified path
+    SDL_Surface* loadedSurface = IMG_Load( path.c_str() );
+    if( loadedSurface == NULL )
+    {
+        printf( "Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError() );
+    }
+    else
+    {
+        //Color key image
+        SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 0, 0xFF, 0xFF ) );
+
+        //Create texture from surface pixels
+        newTexture = SDL_CreateTextureFromSurface( gRenderer, loadedSurface );
+        if( newTexture == NULL )
+        {
+            printf( "Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+        }
+        else
+        {
+            //Get image dimensions
+            mWidth = loadedSurface->w;
+            mHeight = loadedSurface->h;
+        }
+
+        //Get rid of old loaded surface
+        SDL_FreeSurface( loadedSurface );
+    }
+
+    //Return success
+    mTexture = newTexture;
+    return mTexture != NULL;
+}
+
+void LTexture::free()
+{
+    //Free texture if it exists
+    if( mTexture != NULL )
+    {
+        SDL_DestroyTexture( mTexture );
+        mTexture = NULL;
+        mWidth = 0;
+        mHeight = 0;
+    }
+}
+
+void LTexture::setColor( Uint8 red, Uint8 green, Uint8 blue )
+{
+    //Modulate texture rgb
+    SDL_SetTextureColorMod( mTexture, red, green, blue );
+}
+
+void LTexture::render( int x, int y, SDL_Rect* clip )
+{
+    //Set rendering space and render to screen
+    SDL_Rect renderQuad = { x, y, mWidth, mHeight };
+
+    //Set clip rendering dimensions
+    if( clip != NULL )
+    {
+        renderQuad.w = clip->w;
+        renderQuad.h = clip->h;
+    }
+
+    //Render to screen
+    SDL_RenderCopy( gRenderer, mTexture, clip, &renderQuad );
+}
+
+int LTexture::getWidth()
+{
+    return mWidth;
+}
+
+int LTexture::getHeight()
+{
+    return mHeight;
+}
+
+void LStaticSet::add( int x, int y, int w, int h )
+{
+    mLeft.push_back( (float)x );
+    mTop.push_back( (float)y );
+    mRight.push_back( (float)( x + w ) );
+    mBottom.push_back( (float)( y + h ) );
+}
+
+bool LStaticSet::overlaps( float x, float y ) const
+{
+    for( size_t i = 0; i < mLeft.size(); ++i )
+    {
+        if( x < mRight[ i ] && x + MOVER_SIZE > mLeft[ i ] && y < mBottom[ i ] && y + MOVER_SIZE > mTop[ i ] )
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void LMoverSet::create( int count, const LStaticSet& statics )
+{
+    mX.resize( count );
+    mY.resize( count );
+    mVelX.resize( count );
+    mVelY.resize( count );
+    mDX.resize( count );
+    mDY.resize( count );
+    mOrder.resize( count );
+    mPairTime.resize( count );
+    mPairPartner.resize( count );
+    mPairVelX.resize( count );
+    mPairVelY.resize( count );
+    mTunnels = 0;
+    mContacts = 0;
+
+    for( int i = 0; i < count; ++i )
+    {
+        //Keep trying until the spot is clear of walls
+        do
+        {
+            mX[ i ] = randomUnit() * ( SCREEN_WIDTH - MOVER_SIZE );
+            mY[ i ] = randomUnit() * ( SCREEN_HEIGHT - MOVER_SIZE );
+        } while( statics.overlaps( mX[ i ], mY[ i ] ) );
+
+        float speed = MIN_MOVER_SPEED + ( MAX_MOVER_SPEED - MIN_MOVER_SPEED ) * randomUnit();
+        mVelX[ i ] = speed * ( randomUnit() * 2.f - 1.f );
+        mVelY[ i ] = speed * ( randomUnit() * 2.f - 1.f );
+    }
+}
+
+bool compareSweepEntries( const LSweepEntry& a, const LSweepEntry& b )
+{
+    return a.left < b.left;
+}
+
+float sweepBox( float x, float y, float dx, float dy, float left, float top, float right, float bottom, int& axis )
+{
+    //Times the mover's edges reach and leave the box on each axis
+    float entryX, exitX, entryY, exitY;
+    if( dx > 0.f )
+    {
+        entryX = ( left - ( x + MOVER_SIZE ) ) / dx;
+        exitX = ( right - x ) / dx;
+    }
+    else if( dx < 0.f )
+    {
+        entryX = ( right - x ) / dx;
+        exitX = ( left - ( x + MOVER_SIZE ) ) / dx;
+    }
+    else if( x + MOVER_SIZE <= left || x >= right )
+    {
+        return NO_IMPACT;
+    }
+    else
+    {
+        entryX = -1e30f;
+        exitX = 1e30f;
+    }
+
+    if( dy > 0.f )
+    {
+        entryY = ( top - ( y + MOVER_SIZE ) ) / dy;
+        exitY = ( bottom - y ) / dy;
+    }
+    else if( dy < 0.f )
+    {
+        entryY = ( bottom - y ) / dy;
+        exitY = ( top - ( y + MOVER_SIZE ) ) / dy;
+    }
+    else if( y + MOVER_SIZE <= top || y >= bottom )
+    {
+        return NO_IMPACT;
+    }
+    else
+    {
+        entryY = -1e30f;
+        exitY = 1e30f;
+    }
+
+    //The boxes touch once both axes overlap, and stop once either separates
+    float entry = entryX > entryY ? entryX : entryY;
+    float exit = exitX < exitY ? exitX : exitY;
+    if( entry > exit || entry >= 1.f || exit <= 0.f || entry < -SWEEP_EPSILON )
+    {
+        return NO_IMPACT;
+    }
+
+    axis = entryX > entryY ? 0 : 1;
+    return entry < 0.f ? 0.f : entry;
+}
+
+void LMoverSet::tick( float dt, const LStaticSet& statics, bool continuous )
+{
+    int count = getCount();
+    int staticCount = (int)statics.mLeft.size();
+
+    //The move every mover wants this tick
+    for( int i = 0; i < count; ++i )
+    {
+        mDX[ i ] = mVelX[ i ] * dt;
+        mDY[ i ] = mVelY[ i ] * dt;
+    }
+
+    if( !continuous )
+    {
+        //Move and move back on overlap, counting the movers that skipped over a wall
+        for( int i = 0; i < count; ++i )
+        {
+            int axis;
+            bool sweptHit = false;
+            for( int s = 0; s < staticCount && !sweptHit; ++s )
+            {
+                sweptHit = sweepBox( mX[ i ], mY[ i ], mDX[ i ], mDY[ i ], statics.mLeft[ s ], statics.mTop[ s ], statics.mRight[ s ], statics.mBottom[ s ], axis ) < 1.f;
+            }
+
+            bool steppedHit = false;
+            mX[ i ] += mDX[ i ];
+            if( statics.overlaps( mX[ i ], mY[ i ] ) )
+            {
+                mX[ i ] -= mDX[ i ];
+                mVelX[ i ] = -mVelX[ i ];
+                steppedHit = true;
+            }
+            mY[ i ] += mDY[ i ];
+            if( statics.overlaps( mX[ i ], mY[ i ] ) )
+            {
+                mY[ i ] -= mDY[ i ];
+                mVelY[ i ] = -mVelY[ i ];
+                steppedHit = true;
+            }
+
+            if( sweptHit && !steppedHit )
+            {
+                ++mTunnels;
+            }
+        }
+        return;
+    }
+
+    //Broadphase over the swept bounds of every mover, sorted on the left edge
+    for( int i = 0; i < count; ++i )
+    {
+        mOrder[ i ].left = mDX[ i ] < 0.f ? mX[ i ] + mDX[ i ] : mX[ i ];
+        mOrder[ i ].id = i;
+        mPairTime[ i ] = NO_IMPACT;
+        mPairPartner[ i ] = -1;
+    }
+    std::sort( mOrder.begin(), mOrder.end(), compareSweepEntries );
+
+    //Earliest contact for each mover, using the other mover's motion as the frame of reference
+    for( int k = 0; k < count; ++k )
+    {
+        int a = mOrder[ k ].id;
+        float sweptRightA = ( mDX[ a ] > 0.f ? mX[ a ] + mDX[ a ] : mX[ a ] ) + MOVER_SIZE;
+        for( int m = k + 1; m < count && mOrder[ m ].left < sweptRightA; ++m )
+        {
+            int b = mOrder[ m ].id;
+            int axis;
+            float time = sweepBox( mX[ a ], mY[ a ], mDX[ a ] - mDX[ b ], mDY[ a ] - mDY[ b ], mX[ b ], mY[ b ], mX[ b ] + MOVER_SIZE, mY[ b ] + MOVER_SIZE, axis );
+            if( time >= 1.f )
+            {
+                continue;
+            }
+
+            //Equal masses trade their velocity along the axis they meet on
+            if( time < mPairTime[ a ] )
+            {
+                mPairTime[ a ] = time;
+                mPairPartner[ a ] = b;
+                mPairVelX[ a ] = axis == 0 ? mVelX[ b ] : mVelX[ a ];
+                mPairVelY[ a ] = axis == 1 ? mVelY[ b ] : mVelY[ a ];
+            }
+            if( time < mPairTime[ b ] )
+            {
+                mPairTime[ b ] = time;
+                mPairPartner[ b ] = a;
+                mPairVelX[ b ] = axis == 0 ? mVelX[ a ] : mVelX[ b ];
+                mPairVelY[ b ] = axis == 1 ? mVelY[ a ] : mVelY[ b ];
+            }
+        }
+    }
+
+    //A contact was worked out for both movers' straight paths, so it only holds if it is the first for both
+    //and neither reaches a wall before it. Drop the partner of any mover that fails either test
+    for( int i = 0; i < count; ++i )
+    {
+        int partner = mPairPartner[ i ];
+        if( partner < 0 )
+        {
+            continue;
+        }
+
+        bool clear = mPairPartner[ partner ] == i;
+        float dx = mDX[ i ] * mPairTime[ i ];
+        float dy = mDY[ i ] * mPairTime[ i ];
+        for( int s = 0; s < staticCount && clear; ++s )
+        {
+            int axis;
+            clear = sweepBox( mX[ i ], mY[ i ], dx, dy, statics.mLeft[ s ], statics.mTop[ s ], statics.mRight[ s ], statics.mBottom[ s ], axis ) >= 1.f;
+        }
+        if( !clear )
+        {
+            mPairPartner[ i ] = -1;
+        }
+    }
+
+    //Then both movers of a pair take the exchange or neither does
+    for( int i = 0; i < count; ++i )
+    {
+        int partner = mPairPartner[ i ];
+        if( partner < 0 || mPairPartner[ partner ] != i )
+        {
+            mPairTime[ i ] = NO_IMPACT;
+        }
+        else if( i < partner )
+        {
+            ++mContacts;
+        }
+    }
+
+    //Move every mover through its tick, stopping at each wall hit and at its mover contact
+    for( int i = 0; i < count; ++i )
+    {
+        float time = 0.f;
+        bool pairPending = mPairTime[ i ] < 1.f;
+        for( int step = 0; step < MAX_SWEEP_STEPS && time < 1.f; ++step )
+        {
+            float end = pairPending ? mPairTime[ i ] : 1.f;
+            float dx = mVelX[ i ] * dt * ( end - time );
+            float dy = mVelY[ i ] * dt * ( end - time );
+
+            //Earliest wall along this stretch
+            float hit = NO_IMPACT;
+            int hitAxis = 0;
+            int hitWall = 0;
+            for( int s = 0; s < staticCount; ++s )
+            {
+                int axis;
+                float t = sweepBox( mX[ i ], mY[ i ], dx, dy, statics.mLeft[ s ], statics.mTop[ s ], statics.mRight[ s ], statics.mBottom[ s ], axis );
+                if( t < hit )
+                {
+                    hit = t;
+                    hitAxis = axis;
+                    hitWall = s;
+                }
+            }
+
+            if( hit < 1.f )
+            {
+                //Stop at the wall and bounce, pending contacts were checked clear of walls so this comes after them
+                //Snap onto the wall's face so rounding never leaves the mover a hair inside it
+                mX[ i ] += dx * hit;
+                mY[ i ] += dy * hit;
+                time += ( end - time ) * hit;
+                if( hitAxis == 0 )
+                {
+                    mX[ i ] = dx > 0.f ? statics.mLeft[ hitWall ] - MOVER_SIZE : statics.mRight[ hitWall ];
+                    mVelX[ i ] = -mVelX[ i ];
+                }
+                else
+                {
+                    mY[ i ] = dy > 0.f ? statics.mTop[ hitWall ] - MOVER_SIZE : statics.mBottom[ hitWall ];
+                    mVelY[ i ] = -mVelY[ i ];
+                }
+                continue;
+            }
+
+            mX[ i ] += dx;
+            mY[ i ] += dy;
+            time = end;
+
+            //Reached the other mover, take the velocity from the exchange
+            if( pairPending )
+            {
+                mVelX[ i ] = mPairVelX[ i ];
+                mVelY[ i ] = mPairVelY[ i ];
+                pairPending = false;
+            }
+        }
+
+        //Anything still inside a wall got through the sweep
+        if( statics.overlaps( mX[ i ], mY[ i ] ) )
+        {
+            ++mTunnels;
+        }
+    }
+}
+
+void LMoverSet::setVelocity( int index, float velX, float velY )
+{
+    mVelX[ index ] = velX;
+    mVelY[ index ] = velY;
+}
+
+int LMoverSet::getCount()
+{
+    return (int)mX.size();
+}
+
+float LMoverSet::getX( int index )
+{
+    return mX[ index ];
+}
+
+float LMoverSet::getY( int index )
+{
+    return mY[ index ];
+}
+
+int LMoverSet::takeTunnelCount()
+{
+    int tunnels = mTunnels;
+    mTunnels = 0;
+    return tunnels;
+}
+
+int LMoverSet::takeContactCount()
+{
+    int contacts = mContacts;
+    mContacts = 0;
+    return contacts;
+}
+
+Dot::Dot()
+{
+    //Initialize the velocity
+    mVelX = 0;
+    mVelY = 0;
+}
+
+void Dot::handleEvent( SDL_Event& e )
+{
+    //If a key was pressed
+    if( e.type == SDL_KEYDOWN && e.key.repeat == 0 )
+    {
+        //Adjust the velocity
+        switch( e.key.keysym.sym )
+        {
+            case SDLK_UP: mVelY -= DOT_VEL; break;
+            case SDLK_DOWN: mVelY += DOT_VEL; break;
+            case SDLK_LEFT: mVelX -= DOT_VEL; break;
+            case SDLK_RIGHT: mVelX += DOT_VEL; break;
+        }
+    }
+    //If a key was released
+    else if( e.type == SDL_KEYUP && e.key.repeat == 0 )
+    {
+        //Adjust the velocity
+        switch( e.key.keysym.sym )
+        {
+            case SDLK_UP: mVelY += DOT_VEL; break;
+            case SDLK_DOWN: mVelY -= DOT_VEL; break;
+            case SDLK_LEFT: mVelX += DOT_VEL; break;
+            case SDLK_RIGHT: mVelX -= DOT_VEL; break;
+        }
+    }
+}
+
+int Dot::getVelX()
+{
+    return mVelX;
+}
+
+int Dot::getVelY()
+{
+    return mVelY;
+}
+
+bool init()
+{
+    //Initialization flag
+    bool success = true;
+
+    //Initialize SDL
+    if( SDL_Init( SDL_INIT_VIDEO ) < 0 )
+    {
+        printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+        success = false;
+    }
+    else
+    {
+        //Set texture filtering to linear
+        if( !SDL_SetHint( SDL_HINT_RENDER_SCALE_QUALITY, "1" ) )
+        {
+            printf( "Warning: Linear texture filtering not enabled!" );
+        }
+
+        //Create window
+        gWindow = SDL_CreateWindow( "SDL Tutorial", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN );
+        if( gWindow == NULL )
+        {
+            printf( "Window could not be created! SDL Error: %s\n", SDL_GetError() );
+            success = false;
+        }
+        else
+        {
+            //Create vsynced renderer for window
+            gRenderer = SDL_CreateRenderer( gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC );
+            if( gRenderer == NULL )
+            {
+                printf( "Renderer could not be created! SDL Error: %s\n", SDL_GetError() );
+                success = false;
+            }
+            else
+            {
+                //Initialize renderer color
+                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+
+                //Initialize PNG loading
+                int imgFlags = IMG_INIT_PNG;
+                if( !( IMG_Init( imgFlags ) & imgFlags ) )
+                {
+                    printf( "SDL_image could not initialize! SDL_image Error: %s\n", IMG_GetError() );
+                    success = false;
+                }
+            }
+        }
+    }
+
+    return success;
+}
+
+bool loadMedia()
+{
+    //Loading success flag
+    bool success = true;
+
+    //Load dot texture
+    if( !gDotTexture.loadFromFile( "dot.bmp" ) )
+    {
+        printf( "Failed to load dot texture!\n" );
+        success = false;
+    }
+
+    return success;
+}
+
+void close()
+{
+    //Free loaded images
+    gDotTexture.free();
+
+    //Destroy window
+    SDL_DestroyRenderer( gRenderer );
+    SDL_DestroyWindow( gWindow );
+    gWindow = NULL;
+    gRenderer = NULL;
+
+    //Quit SDL subsystems
+    IMG_Quit();
+    SDL_Quit();
+}
+
+void buildLevel( LStaticSet& statics )
+{
+    //Screen border and thin walls fast movers would skip over with a plain step
+    statics.add( -100, -100, SCREEN_WIDTH + 200, 100 );
+    statics.add( -100, SCREEN_HEIGHT, SCREEN_WIDTH + 200, 100 );
+    statics.add( -100, 0, 100, SCREEN_HEIGHT );
+    statics.add( SCREEN_WIDTH, 0, 100, SCREEN_HEIGHT );
+    statics.add( 160, 60, 4, 160 );
+    statics.add( 480, 260, 4, 160 );
+    statics.add( 240, 120, 160, 4 );
+    statics.add( 240, 360, 160, 4 );
+    statics.add( 320, 180, 4, 120 );
+}
+
+void runTunnelBenchmark()
+{
+    const int TICK_RATES[] = { 60, 20, 6 };
+    const int MOVER_COUNTS[] = { 200, 1000 };
+
+    LStaticSet statics;
+    buildLevel( statics );
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+
+    printf( "%d ticks per run from the same scene\n", BENCHMARK_TICKS );
+    printf( "  movers     Hz      mode   ms/tick  contacts/tick  tunneled  escaped\n" );
+    for( int c = 0; c < 2; ++c )
+    {
+        for( int r = 0; r < 3; ++r )
+        {
+            for( int mode = 0; mode < 2; ++mode )
+            {
+                bool continuous = mode == 0;
+
+                //Every run starts from the same placement
+                gRandomState = MOVER_SEED;
+                LMoverSet movers;
+                movers.create( MOVER_COUNTS[ c ], statics );
+
+                int tunnels = 0;
+                int contacts = 0;
+                Uint64 start = SDL_GetPerformanceCounter();
+                for( int t = 0; t < BENCHMARK_TICKS; ++t )
+                {
+                    movers.tick( 1.f / TICK_RATES[ r ], statics, continuous );
+                    tunnels += movers.takeTunnelCount();
+                    contacts += movers.takeContactCount();
+                }
+                double tickMs = ( SDL_GetPerformanceCounter() - start ) * 1000.0 / frequency / BENCHMARK_TICKS;
+
+                //Movers that left the level through its border
+                int escaped = 0;
+                for( int i = 0; i < movers.getCount(); ++i )
+                {
+                    if( movers.getX( i ) < 0.f || movers.getX( i ) > SCREEN_WIDTH - MOVER_SIZE || movers.getY( i ) < 0.f || movers.getY( i ) > SCREEN_HEIGHT - MOVER_SIZE )
+                    {
+                        ++escaped;
+                    }
+                }
+
+                printf( "%8d %6d %9s %9.4f %14.2f %9d %8d\n", MOVER_COUNTS[ c ], TICK_RATES[ r ], continuous ? "swept" : "discrete",
+                        tickMs, (double)contacts / BENCHMARK_TICKS, tunnels, escaped );
+            }
+        }
+    }
+}
+
+int main( int argc, char* args[] )
+{
+    //Check for mover count, tick rate, collision mode and benchmark options
+    int moverCount = DEFAULT_MOVERS;
+    int tickRate = DEFAULT_TICK_RATE;
+    bool continuous = true;
+    bool benchmark = false;
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( args[ i ], "--movers" ) == 0 && i + 1 < argc )
+        {
+            moverCount = atoi( args[ ++i ] );
+        }
+        else if( strcmp( args[ i ], "--tick-rate" ) == 0 && i + 1 < argc )
+        {
+            tickRate = atoi( args[ ++i ] );
+        }
+        else if( strcmp( args[ i ], "--discrete" ) == 0 )
+        {
+            continuous = false;
+        }
+        else if( strcmp( args[ i ], "--tunnel-bench" ) == 0 )
+        {
+            benchmark = true;
+        }
+    }
+
+    //The benchmark needs no window
+    if( benchmark )
+    {
+        runTunnelBenchmark();
+        return 0;
+    }
+
+    //The first mover is the player's dot
+    if( moverCount < 1 )
+    {
+        moverCount = 1;
+    }
+    if( tickRate < 1 )
+    {
+        tickRate = 1;
+    }
+
+    //Start up SDL and create window
+    if( !init() )
+    {
+        printf( "Failed to initialize!\n" );
+    }
+    else
+    {
+        //Load media
+        if( !loadMedia() )
+        {
+            printf( "Failed to load media!\n" );
+        }
+        else
+        {
+            //Main loop flag
+            bool quit = false;
+
+            //Event handler
+            SDL_Event e;
+
+            //The dot that will be moving around on the screen
+            Dot dot;
+
+            //Walls the movers bounce off
+            LStaticSet statics;
+            buildLevel( statics );
+
+            //Everything that moves, simulated at a fixed rate
+            LMoverSet movers;
+            movers.create( moverCount, statics );
+            const float tickSeconds = 1.f / tickRate;
+            Uint64 frequency = SDL_GetPerformanceFrequency();
+            Uint64 tickLength = frequency / tickRate;
+            Uint64 lastCounter = SDL_GetPerformanceCounter();
+            Uint64 accumulated = 0;
+
+            //Performance reporting
+            Uint64 tickTicks = 0;
+            Uint32 ticks = 0;
+            Uint32 reportStart = SDL_GetTicks();
+
+            //While application is running
+            while( !quit )
+            {
+                //Handle events on queue
+                while( SDL_PollEvent( &e ) != 0 )
+                {
+                    //User requests quit
+                    if( e.type == SDL_QUIT )
+                    {
+                        quit = true;
+                    }
+
+                    //Handle input for the dot
+                    dot.handleEvent( e );
+                }
+
+                //Run the ticks that are due, dropping time if the simulation falls too far behind
+                Uint64 counter = SDL_GetPerformanceCounter();
+                accumulated += counter - lastCounter;
+                lastCounter = counter;
+                if( accumulated > tickLength * MAX_TICKS_PER_FRAME )
+                {
+                    accumulated = tickLength * MAX_TICKS_PER_FRAME;
+                }
+                while( accumulated >= tickLength )
+                {
+                    Uint64 start = SDL_GetPerformanceCounter();
+                    movers.setVelocity( 0, (float)dot.getVelX(), (float)dot.getVelY() );
+                    movers.tick( tickSeconds, statics, continuous );
+                    tickTicks += SDL_GetPerformanceCounter() - start;
+                    accumulated -= tickLength;
+                    ++ticks;
+                }
+
+                //Clear screen
+                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+                SDL_RenderClear( gRenderer );
+
+                //Render walls
+                SDL_SetRenderDrawColor( gRenderer, 0x00, 0x00, 0x00, 0xFF );
+                for( size_t i = 0; i < statics.mLeft.size(); ++i )
+                {
+                    SDL_Rect wall = { (int)statics.mLeft[ i ], (int)statics.mTop[ i ], (int)( statics.mRight[ i ] - statics.mLeft[ i ] ), (int)( statics.mBottom[ i ] - statics.mTop[ i ] ) };
+                    SDL_RenderFillRect( gRenderer, &wall );
+                }
+
+                //Render the other movers greyed out and the dot on top
+                gDotTexture.setColor( 0x80, 0x80, 0x80 );
+                for( int i = 1; i < moverCount; ++i )
+                {
+                    gDotTexture.render( (int)movers.getX( i ), (int)movers.getY( i ) );
+                }
+                gDotTexture.setColor( 0xFF, 0xFF, 0xFF );
+                gDotTexture.render( (int)movers.getX( 0 ), (int)movers.getY( 0 ) );
+
+                //Update screen
+                SDL_RenderPresent( gRenderer );
+
+                //Report tick cost and tunneling periodically
+                if( SDL_GetTicks() - reportStart >= MOTION_REPORT_MS && ticks > 0 )
+                {
+                    printf( "%d movers at %d Hz (%s): %.3f ms per tick, %.1f mover contacts per tick, %d tunneled\n", moverCount, tickRate,
+                        continuous ? "swept" : "discrete", tickTicks * 1000.0 / frequency / ticks,
+                        (double)movers.takeContactCount() / ticks, movers.takeTunnelCount() );
+                    tickTicks = 0;
+                    ticks = 0;
+                    reportStart = SDL_GetTicks();
+                }
+            }
+        }
+    }
+
+    //Free resources and close SDL
+    close();
 
     return 0;
 }
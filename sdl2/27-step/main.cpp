@@ -1,7 +1,959 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
 
-int main(int argc, char* args[]) {
-    puts("Not done yet.");
+//Texture wrapper class
+class LTexture
+{
+    public:
+        //Initializes variables
+        LTexture();
+
+        //Deallocates memory
+        ~LTexture();
+
+        //Loads image at specified path
+        bool loadFromFile( std::string path );
+
+        //Deallocates texture
+        void free();
+
+        //Renders texture at given point
+        void render( int x, int y, SDL_Rect* clip = NULL );
+
+        //Gets image dimensions
+        int getWidth();
+        int getHeight();
+
+    private:
+        //The actual hardware texture
+        SDL_Texture* mTexture;
+
+        //Image dimensions
+        int mWidth;
+        int mHeight;
+};
+
+//Moving boxes stored as one array per field
+class LBoxField
+{
+    public:
+        //Scatters boxes with random sizes and velocities over an arena
+        void create( int count, int arenaWidth, int arenaHeight );
+
+        //Moves every box, bouncing off the arena edges
+        void move();
+
+        //Gets the number of boxes
+        int getCount();
+
+        //Gets a box as a rect
+        SDL_Rect getBox( int index );
+
+        //Box edges, right and bottom are one past the box like SDL_Rect
+        std::vector<int> mLeft;
+        std::vector<int> mRight;
+        std::vector<int> mTop;
+        std::vector<int> mBottom;
+
+    private:
+        //Velocities in pixels per frame
+        std::vector<int> mVelX;
+        std::vector<int> mVelY;
+
+        //Arena dimensions
+        int mArenaWidth;
+        int mArenaHeight;
+};
+
+//Pair of boxes, lower id first
+struct LBoxPair
+{
+    int a;
+    int b;
+};
+
+//Broadphase that keeps box endpoints sorted along X between frames
+class LSweepAndPrune
+{
+    public:
+        //Initializes variables
+        LSweepAndPrune();
+
+        //Rebuilds the endpoint list for a new set of boxes
+        void reset( LBoxField& boxes );
+
+        //Re-sorts the endpoints, sweeps for X overlaps and tests those pairs on Y
+        void update( LBoxField& boxes );
+
+        //Gets the boxes that touched this update
+        const std::vector<LBoxPair>& getContacts();
+
+        //Gets how many endpoint swaps and X overlaps the last update had
+        int getSwapCount();
+        int getCandidateCount();
+
+    private:
+        //Box edge on the sweep axis, the tag is the box id shifted left with the low bit set for a left edge
+        struct LEndpoint
+        {
+            int value;
+            Uint32 tag;
+        };
+
+        //Orders endpoints by value, right edges before left edges at the same value so touching boxes are not overlapping
+        static bool endpointBefore( const LEndpoint& a, const LEndpoint& b );
+
+        //Endpoints in sweep order, nearly sorted already after a frame of movement
+        std::vector<LEndpoint> mEndpoints;
+
+        //Boxes whose left edge was passed but not their right
+        std::vector<int> mActive;
+        std::vector<int> mActiveSlot;
+
+        //X overlaps found by the sweep and the ones that overlap on Y too
+        std::vector<LBoxPair> mCandidates;
+        std::vector<LBoxPair> mContacts;
+
+        //Statistics
+        int mSwaps;
+};
+
+//The dot that will move around on the screen
+class Dot
+{
+    public:
+        //The dimensions of the dot
+        static const int DOT_WIDTH = 20;
+        static const int DOT_HEIGHT = 20;
+
+        //Maximum axis velocity of the dot
+        static const int DOT_VEL = 10;
+
+        //Initializes the variables
+        Dot();
+
+        //Takes key presses and adjusts the dot's velocity
+        void handleEvent( SDL_Event& e );
+
+        //Moves the dot and checks collision
+        void move( SDL_Rect& wall );
+
+        //Shows the dot on the screen
+        void render();
+
+    private:
+        //The X and Y offsets of the dot
+        int mPosX, mPosY;
+
+        //The velocity of the dot
+        int mVelX, mVelY;
+
+        //Dot's collision box
+        SDL_Rect mCollider;
+};
+
+//Screen dimension constants
+const int SCREEN_WIDTH = 640;
+const int SCREEN_HEIGHT = 480;
+
+//Moving boxes in the interactive scene
+const int DEFAULT_BOXES = 200;
+
+//Box size range and fastest box speed in pixels per frame
+const int MIN_BOX_SIZE = 4;
+const int MAX_BOX_SIZE = 12;
+const int MAX_BOX_SPEED = 3;
+
+//Benchmark arenas grow with the box count so density stays the same
+const int BENCHMARK_AREA_PER_BOX = 400;
+
+//Frames simulated per benchmark size
+const int BENCHMARK_FRAMES = 100;
+
+//Largest box count the quadratic test is timed against
+const int MAX_BRUTE_FORCE_BOXES = 8000;
+
+//Candidate pairs the narrowphase tests at a time
+const int NARROWPHASE_BATCH = 256;
+
+//Milliseconds between performance reports
+const Uint32 COLLISION_REPORT_MS = 5000;
+
+//Starts up SDL and creates window
+bool init();
+
+//Loads media
+bool loadMedia();
+
+//Frees media and shuts down SDL
+void close();
+
+//Box collision detector
+bool checkCollision( SDL_Rect a, SDL_Rect b );
+
+//Tests every pair of boxes, the reference the broadphase has to match
+void bruteForceContacts( LBoxField& boxes, std::vector<LBoxPair>& contacts );
+
+//Times the broadphase against the pairwise test over growing box counts
+void runCollisionBenchmark();
+
+//The window we'll be rendering to
+SDL_Window* gWindow = NULL;
+
+//The window renderer
+SDL_Renderer* gRenderer = NULL;
+
+//Scene textures
+LTexture gDotTexture;
+
+//Random state shared by box placement
+Uint32 gRandomState = 2463534242u;
+
+//Xorshift random numbers, cheap enough to seed thousands of boxes
+inline Uint32 nextRandom()
+{
+    gRandomState ^= gRandomState << 13;
+    gRandomState ^= gRandomState >> 17;
+    gRandomState ^= gRandomState << 5;
+    return gRandomState;
+}
+
+LTexture::LTexture()
+{
+    //Initialize
+    mTexture = NULL;
+    mWidth = 0;
+    mHeight = 0;
+}
+
+LTexture::~LTexture()
+{
+    //Deallocate
+    free();
+}
+
+bool LTexture::loadFromFile( std::string path )
+{
+    //Get rid of preexisting texture
+    free();
+
+    //The final texture
+    SDL_Texture* newTexture = NULL;
+
+    //Load image at specified path
+    SDL_Surface* loadedSurface = IMG_Load( path.c_str() );
+    if( loadedSurface == NULL )
+    {
+        printf( "Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError() );
+    }
+    else
+    {
+        //Color key image
+        SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 0, 0xFF, 0xFF ) );
+
+        //Create texture from surface pixels
+        newTexture = SDL_CreateTextureFromSurface( gRenderer, loadedSurface );
+        if( newTexture == NULL )
+        {
+            printf( "Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+        }
+        else
+        {
+            //Get image dimensions
+            mWidth = loadedSurface->w;
+            mHeight = loadedSurface->h;
+        }
+
+        //Get rid of old loaded surface
+        SDL_FreeSurface( loadedSurface );
+    }
+
+    //Return success
+    mTexture = newTexture;
+    return mTexture != NULL;
+}
+
+void LTexture::free()
+{
+    //Free texture if it exists
+    if( mTexture != NULL )
+    {
+        SDL_DestroyTexture( mTexture );
+        mTexture = NULL;
+        mWidth = 0;
+        mHeight = 0;
+    }
+}
+
+void LTexture::render( int x, int y, SDL_Rect* clip )
+{
+    //Set rendering space and render to screen
+    SDL_Rect renderQuad = { x, y, mWidth, mHeight };
+
+    //Set clip rendering dimensions
+    if( clip != NULL )
+    {
+        renderQuad.w = clip->w;
+        renderQuad.h = clip->h;
+    }
+
+    //Render to screen
+    SDL_RenderCopy( gRenderer, mTexture, clip, &renderQuad );
+}
+
+int LTexture::getWidth()
+{
+    return mWidth;
+}
+
+int LTexture::getHeight()
+{
+    return mHeight;
+}
+
+void LBoxField::create( int count, int arenaWidth, int arenaHeight )
+{
+    mArenaWidth = arenaWidth;
+    mArenaHeight = arenaHeight;
+
+    mLeft.resize( count );
+    mRight.resize( count );
+    mTop.resize( count );
+    mBottom.resize( count );
+    mVelX.resize( count );
+    mVelY.resize( count );
+
+    for( int i = 0; i < count; ++i )
+    {
+        int w = MIN_BOX_SIZE + nextRandom() % ( MAX_BOX_SIZE - MIN_BOX_SIZE + 1 );
+        int h = MIN_BOX_SIZE + nextRandom() % ( MAX_BOX_SIZE - MIN_BOX_SIZE + 1 );
+        mLeft[ i ] = nextRandom() % ( arenaWidth - w );
+        mTop[ i ] = nextRandom() % ( arenaHeight - h );
+        mRight[ i ] = mLeft[ i ] + w;
+        mBottom[ i ] = mTop[ i ] + h;
+
+        //Never stand still so the endpoint order keeps changing
+        mVelX[ i ] = (int)( nextRandom() % ( 2 * MAX_BOX_SPEED + 1 ) ) - MAX_BOX_SPEED;
+        mVelY[ i ] = (int)( nextRandom() % ( 2 * MAX_BOX_SPEED + 1 ) ) - MAX_BOX_SPEED;
+        if( mVelX[ i ] == 0 )
+        {
+            mVelX[ i ] = 1;
+        }
+    }
+}
+
+void LBoxField::move()
+{
+    int count = getCount();
+    for( int i = 0; i < count; ++i )
+    {
+        //Move and turn around at the arena edges
+        mLeft[ i ] += mVelX[ i ];
+        mRight[ i ] += mVelX[ i ];
+        if( mLeft[ i ] < 0 || mRight[ i ] > mArenaWidth )
+        {
+            mVelX[ i ] = -mVelX[ i ];
+            mLeft[ i ] += mVelX[ i ];
+            mRight[ i ] += mVelX[ i ];
+        }
+
+        mTop[ i ] += mVelY[ i ];
+        mBottom[ i ] += mVelY[ i ];
+        if( mTop[ i ] < 0 || mBottom[ i ] > mArenaHeight )
+        {
+            mVelY[ i ] = -mVelY[ i ];
+            mTop[ i ] += mVelY[ i ];
+            mBottom[ i ] += mVelY[ i ];
+        }
+    }
+}
+
+int LBoxField::getCount()
+{
+    return (int)mLeft.size();
+}
+
+SDL_Rect LBoxField::getBox( int index )
+{
+    SDL_Rect box = { mLeft[ index ], mTop[ index ], mRight[ index ] - mLeft[ index ], mBottom[ index ] - mTop[ index ] };
+    return box;
+}
+
+LSweepAndPrune::LSweepAndPrune()
+{
+    //Initialize
+    mSwaps = 0;
+}
+
+bool LSweepAndPrune::endpointBefore( const LEndpoint& a, const LEndpoint& b )
+{
+    return a.value < b.value || ( a.value == b.value && ( a.tag & 1 ) < ( b.tag & 1 ) );
+}
+
+void LSweepAndPrune::reset( LBoxField& boxes )
+{
+    int count = boxes.getCount();
+
+    //Two endpoints per box
+    mEndpoints.resize( count * 2 );
+    for( int i = 0; i < count; ++i )
+    {
+        mEndpoints[ i * 2 ].tag = ( (Uint32)i << 1 ) | 1;
+        mEndpoints[ i * 2 ].value = boxes.mLeft[ i ];
+        mEndpoints[ i * 2 + 1 ].tag = (Uint32)i << 1;
+        mEndpoints[ i * 2 + 1 ].value = boxes.mRight[ i ];
+    }
+
+    //Sort once up front, insertion sort would be quadratic on an unordered list
+    std::sort( mEndpoints.begin(), mEndpoints.end(), endpointBefore );
+
+    mActive.clear();
+    mActiveSlot.assign( count, -1 );
+}
+
+void LSweepAndPrune::update( LBoxField& boxes )
+{
+    //Nothing to sort or test without boxes
+    mSwaps = 0;
+    mCandidates.clear();
+    mContacts.clear();
+    if( boxes.getCount() == 0 )
+    {
+        return;
+    }
+
+    //Pick up the boxes' new edges where their endpoints already sit
+    int endpointCount = (int)mEndpoints.size();
+    for( int i = 0; i < endpointCount; ++i )
+    {
+        Uint32 tag = mEndpoints[ i ].tag;
+        int id = tag >> 1;
+        mEndpoints[ i ].value = ( tag & 1 ) ? boxes.mLeft[ id ] : boxes.mRight[ id ];
+    }
+
+    //Insertion sort, linear when boxes only moved a little since last frame
+    for( int i = 1; i < endpointCount; ++i )
+    {
+        LEndpoint endpoint = mEndpoints[ i ];
+        int j = i - 1;
+        while( j >= 0 && endpointBefore( endpoint, mEndpoints[ j ] ) )
+        {
+            mEndpoints[ j + 1 ] = mEndpoints[ j ];
+            --j;
+            ++mSwaps;
+        }
+        mEndpoints[ j + 1 ] = endpoint;
+    }
+
+    //Sweep, every box opening while another is open overlaps it on X
+    for( int i = 0; i < endpointCount; ++i )
+    {
+        Uint32 tag = mEndpoints[ i ].tag;
+        int id = tag >> 1;
+        if( tag & 1 )
+        {
+            for( size_t k = 0; k < mActive.size(); ++k )
+            {
+                LBoxPair pair = { mActive[ k ] < id ? mActive[ k ] : id, mActive[ k ] < id ? id : mActive[ k ] };
+                mCandidates.push_back( pair );
+            }
+            mActiveSlot[ id ] = (int)mActive.size();
+            mActive.push_back( id );
+        }
+        else
+        {
+            //Swap the closing box out of the active list
+            int slot = mActiveSlot[ id ];
+            int last = mActive.back();
+            mActive[ slot ] = last;
+            mActiveSlot[ last ] = slot;
+            mActive.pop_back();
+            mActiveSlot[ id ] = -1;
+        }
+    }
+
+    //Narrowphase in batches, test a block of pairs into a mask and then keep the hits
+    const int* top = &boxes.mTop[ 0 ];
+    const int* bottom = &boxes.mBottom[ 0 ];
+    int candidateCount = (int)mCandidates.size();
+    Uint8 hit[ NARROWPHASE_BATCH ];
+    for( int start = 0; start < candidateCount; start += NARROWPHASE_BATCH )
+    {
+        int end = start + NARROWPHASE_BATCH < candidateCount ? start + NARROWPHASE_BATCH : candidateCount;
+        for( int i = start; i < end; ++i )
+        {
+            const LBoxPair& pair = mCandidates[ i ];
+            hit[ i - start ] = ( top[ pair.a ] < bottom[ pair.b ] ) & ( top[ pair.b ] < bottom[ pair.a ] );
+        }
+        for( int i = start; i < end; ++i )
+        {
+            if( hit[ i - start ] )
+            {
+                mContacts.push_back( mCandidates[ i ] );
+            }
+        }
+    }
+}
+
+const std::vector<LBoxPair>& LSweepAndPrune::getContacts()
+{
+    return mContacts;
+}
+
+int LSweepAndPrune::getSwapCount()
+{
+    return mSwaps;
+}
+
+int LSweepAndPrune::getCandidateCount()
+{
+    return (int)mCandidates.size();
+}
+
+Dot::Dot()
+{
+    //Initialize the offsets
+    mPosX = 0;
+    mPosY = 0;
+
+    //Set collision box dimension
+    mCollider.w = DOT_WIDTH;
+    mCollider.h = DOT_HEIGHT;
+
+    //Initialize the velocity
+    mVelX = 0;
+    mVelY = 0;
+}
+
+void Dot::handleEvent( SDL_Event& e )
+{
+    //If a key was pressed
+    if( e.type == SDL_KEYDOWN && e.key.repeat == 0 )
+    {
+        //Adjust the velocity
+        switch( e.key.keysym.sym )
+        {
+            case SDLK_UP: mVelY -= DOT_VEL; break;
+            case SDLK_DOWN: mVelY += DOT_VEL; break;
+            case SDLK_LEFT: mVelX -= DOT_VEL; break;
+            case SDLK_RIGHT: mVelX += DOT_VEL; break;
+        }
+    }
+    //If a key was released
+    else if( e.type == SDL_KEYUP && e.key.repeat == 0 )
+    {
+        //Adjust the velocity
+        switch( e.key.keysym.sym )
+        {
+            case SDLK_UP: mVelY += DOT_VEL; break;
+            case SDLK_DOWN: mVelY -= DOT_VEL; break;
+            case SDLK_LEFT: mVelX += DOT_VEL; break;
+            case SDLK_RIGHT: mVelX -= DOT_VEL; break;
+        }
+    }
+}
+
+void Dot::move( SDL_Rect& wall )
+{
+    //Move the dot left or right
+    mPosX += mVelX;
+    mCollider.x = mPosX;
+
+    //If the dot collided or went too far to the left or right
+    if( ( mPosX < 0 ) || ( mPosX + DOT_WIDTH > SCREEN_WIDTH ) || checkCollision( mCollider, wall ) )
+    {
+        //Move back
+        mPosX -= mVelX;
+        mCollider.x = mPosX;
+    }
+
+    //Move the dot up or down
+    mPosY += mVelY;
+    mCollider.y = mPosY;
+
+    //If the dot collided or went too far up or down
+    if( ( mPosY < 0 ) || ( mPosY + DOT_HEIGHT > SCREEN_HEIGHT ) || checkCollision( mCollider, wall ) )
+    {
+        //Move back
+        mPosY -= mVelY;
+        mCollider.y = mPosY;
+    }
+}
+
+void Dot::render()
+{
+    //Show the dot
+    gDotTexture.render( mPosX, mPosY );
+}
+
+bool checkCollision( SDL_Rect a, SDL_Rect b )
+{
+    //The sides of the rectangles
+    int leftA, leftB;
+    int rightA, rightB;
+    int topA, topB;
+    int bottomA, bottomB;
+
+    //Calculate the sides of rect A
+    leftA = a.x;
+    rightA = a.x + a.w;
+    topA = a.y;
+    bottomA = a.y + a.h;
+
+    //Calculate the sides of rect B
+    leftB = b.x;
+    rightB = b.x + b.w;
+    topB = b.y;
+    bottomB = b.y + b.h;
+
+    //If any of the sides from A are outside of B
+    if( bottomA <= topB )
+    {
+        return false;
+    }
+
+    if( topA >= bottomB )
+    {
+        return false;
+    }
+
+    if( rightA <= leftB )
+    {
+        return false;
+    }
+
+    if( leftA >= rightB )
+    {
+        return false;
+    }
+
+    //If none of the sides from A are outside B
+    return true;
+}
+
+void bruteForceContacts( LBoxField& boxes, std::vector<LBoxPair>& contacts )
+{
+    contacts.clear();
+    int count = boxes.getCount();
+    for( int a = 0; a < count; ++a )
+    {
+        for( int b = a + 1; b < count; ++b )
+        {
+            if( checkCollision( boxes.getBox( a ), boxes.getBox( b ) ) )
+            {
+                LBoxPair pair = { a, b };
+                contacts.push_back( pair );
+            }
+        }
+    }
+}
+
+bool comparePairs( const LBoxPair& a, const LBoxPair& b )
+{
+    return a.a != b.a ? a.a < b.a : a.b < b.b;
+}
+
+void runCollisionBenchmark()
+{
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+
+    printf( "%8s %12s %12s %10s %10s %10s %8s\n", "boxes", "sap ms", "brute ms", "swaps", "candidates", "contacts", "match" );
+    for( int count = 500; count <= 64000; count *= 2 )
+    {
+        //Same density at every size
+        int side = (int)sqrt( (double)count * BENCHMARK_AREA_PER_BOX );
+        gRandomState = 2463534242u;
+        LBoxField boxes;
+        boxes.create( count, side, side );
+
+        //The first update sorts from scratch, leave it out of the timing
+        LSweepAndPrune sweep;
+        sweep.reset( boxes );
+        sweep.update( boxes );
+
+        Uint64 ticks = 0;
+        double swaps = 0;
+        double candidates = 0;
+        for( int frame = 0; frame < BENCHMARK_FRAMES; ++frame )
+        {
+            boxes.move();
+            Uint64 start = SDL_GetPerformanceCounter();
+            sweep.update( boxes );
+            ticks += SDL_GetPerformanceCounter() - start;
+            swaps += sweep.getSwapCount();
+            candidates += sweep.getCandidateCount();
+        }
+
+        //Check the last frame against every pair, timed on the sizes it finishes in reasonable time
+        std::vector<LBoxPair> found( sweep.getContacts() );
+        std::vector<LBoxPair> expected;
+        char bruteText[ 16 ] = "-";
+        char matchText[ 8 ] = "-";
+        if( count <= MAX_BRUTE_FORCE_BOXES )
+        {
+            Uint64 start = SDL_GetPerformanceCounter();
+            bruteForceContacts( boxes, expected );
+            snprintf( bruteText, sizeof( bruteText ), "%.3f", ( SDL_GetPerformanceCounter() - start ) * 1000.0 / frequency );
+
+            std::sort( found.begin(), found.end(), comparePairs );
+            bool match = found.size() == expected.size();
+            for( size_t i = 0; match && i < found.size(); ++i )
+            {
+                match = found[ i ].a == expected[ i ].a && found[ i ].b == expected[ i ].b;
+            }
+            snprintf( matchText, sizeof( matchText ), "%s", match ? "yes" : "NO" );
+        }
+
+        printf( "%8d %12.3f %12s %10.0f %10.0f %10d %8s\n", count, ticks * 1000.0 / frequency / BENCHMARK_FRAMES, bruteText,
+            swaps / BENCHMARK_FRAMES, candidates / BENCHMARK_FRAMES, (int)found.size(), matchText );
+    }
+}
+
+bool init()
+{
+    //Initialization flag
+    bool success = true;
+
+    //Initialize SDL
+    if( SDL_Init( SDL_INIT_VIDEO ) < 0 )
+    {
+        printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+        success = false;
+    }
+    else
+    {
+        //Set texture filtering to linear
+        if( !SDL_SetHint( SDL_HINT_RENDER_SCALE_QUALITY, "1" ) )
+        {
+            printf( "Warning: Linear texture filtering not enabled!" );
+        }
+
+        //Create window
+        gWindow = SDL_CreateWindow( "SDL Tutorial", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN );
+        if( gWindow == NULL )
+        {
+            printf( "Window could not be created! SDL Error: %s\n", SDL_GetError() );
+            success = false;
+        }
+        else
+        {
+            //Create vsynced renderer for window
+            gRenderer = SDL_CreateRenderer( gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC );
+            if( gRenderer == NULL )
+            {
+                printf( "Renderer could not be created! SDL Error: %s\n", SDL_GetError() );
+                success = false;
+            }
+            else
+            {
+                //Initialize renderer color
+                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+
+                //Initialize PNG loading
+                int imgFlags = IMG_INIT_PNG;
+                if( !( IMG_Init( imgFlags ) & imgFlags ) )
+                {
+                    printf( "SDL_image could not initialize! SDL_image Error: %s\n", IMG_GetError() );
+                    success = false;
+                }
+            }
+        }
+    }
+
+    return success;
+}
+
+bool loadMedia()
+{
+    //Loading success flag
+    bool success = true;
+
+    //Load dot texture
+    if( !gDotTexture.loadFromFile( "dot.bmp" ) )
+    {
+        printf( "Failed to load dot texture!\n" );
+        success = false;
+    }
+
+    return success;
+}
+
+void close()
+{
+    //Free loaded images
+    gDotTexture.free();
+
+    //Destroy window
+    SDL_DestroyRenderer( gRenderer );
+    SDL_DestroyWindow( gWindow );
+    gWindow = NULL;
+    gRenderer = NULL;
+
+    //Quit SDL subsystems
+    IMG_Quit();
+    SDL_Quit();
+}
+
+int main( int argc, char* args[] )
+{
+    //Check for box count and benchmark options
+    int boxCount = DEFAULT_BOXES;
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( args[ i ], "--boxes" ) == 0 && i + 1 < argc )
+        {
+            boxCount = atoi( args[ ++i ] );
+        }
+        else if( strcmp( args[ i ], "--collision-bench" ) == 0 )
+        {
+            //Nothing to draw, the benchmark only needs the timer
+            runCollisionBenchmark();
+            return 0;
+        }
+    }
+    if( boxCount < 0 )
+    {
+        boxCount = 0;
+    }
+
+    //Start up SDL and create window
+    if( !init() )
+    {
+        printf( "Failed to initialize!\n" );
+    }
+    else
+    {
+        //Load media
+        if( !loadMedia() )
+        {
+            printf( "Failed to load media!\n" );
+        }
+        else
+        {
+            //Main loop flag
+            bool quit = false;
+
+            //Event handler
+            SDL_Event e;
+
+            //The dot that will be moving around on the screen
+            Dot dot;
+
+            //Set the wall
+            SDL_Rect wall;
+            wall.x = 300;
+            wall.y = 40;
+            wall.w = 40;
+            wall.h = 400;
+
+            //Boxes bouncing around the screen and their broadphase
+            LBoxField boxes;
+            boxes.create( boxCount, SCREEN_WIDTH, SCREEN_HEIGHT );
+            LSweepAndPrune sweep;
+            sweep.reset( boxes );
+
+            //Box outlines split by whether they touch anything
+            std::vector<Uint8> touching( boxCount );
+            std::vector<SDL_Rect> freeRects;
+            std::vector<SDL_Rect> touchingRects;
+
+            //Performance reporting
+            Uint64 frequency = SDL_GetPerformanceFrequency();
+            Uint64 collisionTicks = 0;
+            Uint32 frames = 0;
+            Uint32 contacts = 0;
+            Uint32 reportStart = SDL_GetTicks();
+
+            //While application is running
+            while( !quit )
+            {
+                //Handle events on queue
+                while( SDL_PollEvent( &e ) != 0 )
+                {
+                    //User requests quit
+                    if( e.type == SDL_QUIT )
+                    {
+                        quit = true;
+                    }
+
+                    //Handle input for the dot
+                    dot.handleEvent( e );
+                }
+
+                //Move the dot and check collision
+                dot.move( wall );
+
+                //Move the boxes and find the ones touching
+                boxes.move();
+                Uint64 start = SDL_GetPerformanceCounter();
+                sweep.update( boxes );
+                collisionTicks += SDL_GetPerformanceCounter() - start;
+
+                const std::vector<LBoxPair>& found = sweep.getContacts();
+                contacts += found.size();
+                std::fill( touching.begin(), touching.end(), 0 );
+                for( size_t i = 0; i < found.size(); ++i )
+                {
+                    touching[ found[ i ].a ] = 1;
+                    touching[ found[ i ].b ] = 1;
+                }
+
+                //Clear screen
+                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+                SDL_RenderClear( gRenderer );
+
+                //Render wall
+                SDL_SetRenderDrawColor( gRenderer, 0x00, 0x00, 0x00, 0xFF );
+                SDL_RenderDrawRect( gRenderer, &wall );
+
+                //Render boxes, one call per color
+                freeRects.clear();
+                touchingRects.clear();
+                for( int i = 0; i < boxCount; ++i )
+                {
+                    ( touching[ i ] ? touchingRects : freeRects ).push_back( boxes.getBox( i ) );
+                }
+                if( !freeRects.empty() )
+                {
+                    SDL_SetRenderDrawColor( gRenderer, 0x80, 0x80, 0x80, 0xFF );
+                    SDL_RenderDrawRects( gRenderer, &freeRects[ 0 ], (int)freeRects.size() );
+                }
+                if( !touchingRects.empty() )
+                {
+                    SDL_SetRenderDrawColor( gRenderer, 0xFF, 0x00, 0x00, 0xFF );
+                    SDL_RenderDrawRects( gRenderer, &touchingRects[ 0 ], (int)touchingRects.size() );
+                }
+
+                //Render dot
+                dot.render();
+
+                //Update screen
+                SDL_RenderPresent( gRenderer );
+
+                //Report collision cost periodically
+                ++frames;
+                if( SDL_GetTicks() - reportStart >= COLLISION_REPORT_MS )
+                {
+                    printf( "%d boxes: %.3f ms collision per frame, %.1f contacts\n", boxCount,
+                        collisionTicks * 1000.0 / frequency / frames, (double)contacts / frames );
+                    collisionTicks = 0;
+                    contacts = 0;
+                    frames = 0;
+                    reportStart = SDL_GetTicks();
+                }
+            }
+        }
+    }
+
+    //Free resources and close SDL
+    close();
 
     return 0;
 }
@@ -1,7 +1,843 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
 
-int main(int argc, char* args[]) {
-    puts("Not done yet.");
+//One bit per pixel of a sprite, set where the sprite is solid
+class LBitmask
+{
+    public:
+        //Initializes variables
+        LBitmask();
+
+        //Builds the mask from a clip of an RGBA8888 surface, transparent and color keyed pixels are empty
+        void create( SDL_Surface* surface, const SDL_Rect& clip );
+
+        //Checks a single pixel, the slow way used to verify the word test
+        bool getPixel( int x, int y ) const;
+
+        //Gets the smallest rect around the solid pixels, relative to the clip
+        const SDL_Rect& getBounds() const;
+
+        //Gets 64 pixels of a row starting at any pixel, pixels past the row are empty
+        Uint64 getBits( int row, int pixel ) const;
+
+    private:
+        //Rows of bits, the leftmost pixel of a word in its lowest bit
+        std::vector<Uint64> mWords;
+        int mWordsPerRow;
+
+        //Mask dimensions
+        int mWidth;
+        int mHeight;
+
+        //Solid pixel bounds
+        SDL_Rect mBounds;
+};
+
+//Texture wrapper class
+class LTexture
+{
+    public:
+        //Initializes variables
+        LTexture();
+
+        //Deallocates memory
+        ~LTexture();
+
+        //Loads image at specified path, building a mask for each clip when asked
+        bool loadFromFile( std::string path, LBitmask* masks = NULL, SDL_Rect* clips = NULL, int clipCount = 0 );
+
+        //Deallocates texture
+        void free();
+
+        //Set color modulation
+        void setColor( Uint8 red, Uint8 green, Uint8 blue );
+
+        //Renders texture at given point
+        void render( int x, int y, SDL_Rect* clip = NULL );
+
+        //Gets image dimensions
+        int getWidth();
+        int getHeight();
+
+    private:
+        //The actual hardware texture
+        SDL_Texture* mTexture;
+
+        //Image dimensions
+        int mWidth;
+        int mHeight;
+};
+
+//Animated figure walking back and forth across the screen
+class LWalker
+{
+    public:
+        //Initializes the variables
+        LWalker();
+
+        //Walks and advances the animation
+        void move();
+
+        //Shows the current frame on the screen
+        void render();
+
+        //Gets the position and the mask of the current frame
+        int getPosX();
+        int getPosY();
+        const LBitmask& getMask();
+
+    private:
+        //The X and Y offsets of the walker
+        int mPosX, mPosY;
+
+        //Walking direction and animation frame
+        int mVelX;
+        int mFrame;
+};
+
+//The dot that will move around on the screen
+class Dot
+{
+    public:
+        //The dimensions of the dot
+        static const int DOT_WIDTH = 20;
+        static const int DOT_HEIGHT = 20;
+
+        //Maximum axis velocity of the dot
+        static const int DOT_VEL = 1;
+
+        //Initializes the variables
+        Dot( int x, int y );
+
+        //Takes key presses and adjusts the dot's velocity
+        void handleEvent( SDL_Event& e );
+
+        //Moves the dot and checks collision against the other dot and the walker
+        void move( Dot& other, LWalker& walker );
+
+        //Shows the dot on the screen
+        void render();
+
+        //Checks whether the dot's pixels overlap a mask placed at the given point
+        bool touches( const LBitmask& mask, int x, int y );
+
+        //Position accessors
+        int getPosX();
+        int getPosY();
+
+    private:
+        //The X and Y offsets of the dot
+        int mPosX, mPosY;
+
+        //The velocity of the dot
+        int mVelX, mVelY;
+};
+
+//Screen dimension constants
+const int SCREEN_WIDTH = 640;
+const int SCREEN_HEIGHT = 480;
+
+//Walking animation
+const int WALKING_ANIMATION_FRAMES = 4;
+const int WALK_SPEED = 2;
+
+//Placements tested by the mask benchmark
+const int BENCHMARK_TESTS = 1000000;
+
+//Starts up SDL and creates window
+bool init();
+
+//Loads media
+bool loadMedia();
+
+//Frees media and shuts down SDL
+void close();
+
+//Pixel perfect collision between two masks placed on the screen
+bool checkCollision( const LBitmask& a, int ax, int ay, const LBitmask& b, int bx, int by );
+
+//Times mask tests against bounds only tests and checks them against a pixel by pixel test
+void runMaskBenchmark();
+
+//The window we'll be rendering to
+SDL_Window* gWindow = NULL;
+
+//The window renderer
+SDL_Renderer* gRenderer = NULL;
+
+//Scene textures and their masks
+LTexture gDotTexture;
+LBitmask gDotMask;
+LTexture gSpriteSheetTexture;
+SDL_Rect gSpriteClips[ WALKING_ANIMATION_FRAMES ];
+LBitmask gSpriteMasks[ WALKING_ANIMATION_FRAMES ];
+
+LBitmask::LBitmask()
+{
+    //Initialize
+    mWordsPerRow = 0;
+    mWidth = 0;
+    mHeight = 0;
+    mBounds.x = 0;
+    mBounds.y = 0;
+    mBounds.w = 0;
+    mBounds.h = 0;
+}
+
+void LBitmask::create( SDL_Surface* surface, const SDL_Rect& clip )
+{
+    mWidth = clip.w;
+    mHeight = clip.h;
+    mWordsPerRow = ( mWidth + 63 ) / 64;
+    mWords.assign( mWordsPerRow * mHeight, 0 );
+
+    //Clips may hang off the sheet, those pixels stay empty
+    int minX = mWidth, minY = mHeight, maxX = -1, maxY = -1;
+    SDL_LockSurface( surface );
+    for( int y = 0; y < mHeight; ++y )
+    {
+        int sheetY = clip.y + y;
+        if( sheetY < 0 || sheetY >= surface->h )
+        {
+            continue;
+        }
+
+        const Uint32* row = (const Uint32*)( (const Uint8*)surface->pixels + sheetY * surface->pitch );
+        for( int x = 0; x < mWidth; ++x )
+        {
+            int sheetX = clip.x + x;
+            if( sheetX < 0 || sheetX >= surface->w )
+            {
+                continue;
+            }
+
+            //Solid unless fully transparent or the cyan color key
+            Uint32 pixel = row[ sheetX ];
+            if( ( pixel & 0xFF ) == 0 || ( pixel >> 8 ) == 0x00FFFF )
+            {
+                continue;
+            }
+
+            mWords[ y * mWordsPerRow + x / 64 ] |= (Uint64)1 << ( x % 64 );
+            minX = x < minX ? x : minX;
+            minY = y < minY ? y : minY;
+            maxX = x > maxX ? x : maxX;
+            maxY = y > maxY ? y : maxY;
+        }
+    }
+    SDL_UnlockSurface( surface );
+
+    //An empty mask gets empty bounds so it never passes the rect test
+    mBounds.x = maxX < 0 ? 0 : minX;
+    mBounds.y = maxY < 0 ? 0 : minY;
+    mBounds.w = maxX < 0 ? 0 : maxX - minX + 1;
+    mBounds.h = maxY < 0 ? 0 : maxY - minY + 1;
+}
+
+bool LBitmask::getPixel( int x, int y ) const
+{
+    if( x < 0 || y < 0 || x >= mWidth || y >= mHeight )
+    {
+        return false;
+    }
+
+    return ( mWords[ y * mWordsPerRow + x / 64 ] >> ( x % 64 ) ) & 1;
+}
+
+const SDL_Rect& LBitmask::getBounds() const
+{
+    return mBounds;
+}
+
+Uint64 LBitmask::getBits( int row, int pixel ) const
+{
+    //Join the tail of one word with the head of the next
+    const Uint64* words = &mWords[ row * mWordsPerRow ];
+    int word = pixel / 64;
+    int shift = pixel % 64;
+    Uint64 bits = words[ word ] >> shift;
+    if( shift != 0 && word + 1 < mWordsPerRow )
+    {
+        bits |= words[ word + 1 ] << ( 64 - shift );
+    }
+
+    return bits;
+}
+
+LTexture::LTexture()
+{
+    //Initialize
+    mTexture = NULL;
+    mWidth = 0;
+    mHeight = 0;
+}
+
+LTexture::~LTexture()
+{
+    //Deallocate
+    free();
+}
+
+bool LTexture::loadFromFile( std::string path, LBitmask* masks, SDL_Rect* clips, int clipCount )
+{
+    //Get rid of preexisting texture
+    free();
+
+    //The final texture
+    SDL_Texture* newTexture = NULL;
+
+    //Load image at specified path
+    SDL_Surface* loadedSurface = IMG_Load( path.c_str() );
+    if( loadedSurface == NULL )
+    {
+        printf( "Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError() );
+    }
+    else
+    {
+        //Build the masks while the pixels are still around
+        if( masks != NULL )
+        {
+            SDL_Surface* maskSurface = SDL_ConvertSurfaceFormat( loadedSurface, SDL_PIXELFORMAT_RGBA8888, 0 );
+            if( maskSurface == NULL )
+            {
+                printf( "Unable to convert %s for masking! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+            }
+            else
+            {
+                //No clips means one mask for the whole image
+                SDL_Rect whole = { 0, 0, loadedSurface->w, loadedSurface->h };
+                for( int i = 0; i < ( clips != NULL ? clipCount : 1 ); ++i )
+                {
+                    masks[ i ].create( maskSurface, clips != NULL ? clips[ i ] : whole );
+                }
+                SDL_FreeSurface( maskSurface );
+            }
+        }
+
+        //Color key image
+        SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 0, 0xFF, 0xFF ) );
+
+        //Create texture from surface pixels
+        newTexture = SDL_CreateTextureFromSurface( gRenderer, loadedSurface );
+        if( newTexture == NULL )
+        {
+            printf( "Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+        }
+        else
+        {
+            //Get image dimensions
+            mWidth = loadedSurface->w;
+            mHeight = loadedSurface->h;
+        }
+
+        //Get rid of old loaded surface
+        SDL_FreeSurface( loadedSurface );
+    }
+
+    //Return success
+    mTexture = newTexture;
+    return mTexture != NULL;
+}
+
+void LTexture::free()
+{
+    //Free texture if it exists
+    if( mTexture != NULL )
+    {
+        SDL_DestroyTexture( mTexture );
+        mTexture = NULL;
+        mWidth = 0;
+        mHeight = 0;
+    }
+}
+
+void LTexture::setColor( Uint8 red, Uint8 green, Uint8 blue )
+{
+    //Modulate texture rgb
+    SDL_SetTextureColorMod( mTexture, red, green, blue );
+}
+
+void LTexture::render( int x, int y, SDL_Rect* clip )
+{
+    //Set rendering space and render to screen
+    SDL_Rect renderQuad = { x, y, mWidth, mHeight };
+
+    //Set clip rendering dimensions
+    if( clip != NULL )
+    {
+        renderQuad.w = clip->w;
+        renderQuad.h = clip->h;
+    }
+
+    //Render to screen
+    SDL_RenderCopy( gRenderer, mTexture, clip, &renderQuad );
+}
+
+int LTexture::getWidth()
+{
+    return mWidth;
+}
+
+int LTexture::getHeight()
+{
+    return mHeight;
+}
+
+LWalker::LWalker()
+{
+    //Start on the left, walking right through the middle of the screen
+    mPosX = 0;
+    mPosY = SCREEN_HEIGHT - 205 - 20;
+    mVelX = WALK_SPEED;
+    mFrame = 0;
+}
+
+void LWalker::move()
+{
+    //Turn around at the screen edges
+    mPosX += mVelX;
+    if( mPosX < 0 || mPosX + gSpriteClips[ 0 ].w > SCREEN_WIDTH )
+    {
+        mVelX = -mVelX;
+        mPosX += mVelX;
+    }
+
+    //Go to next frame
+    ++mFrame;
+
+    //Cycle animation
+    if( mFrame / 4 >= WALKING_ANIMATION_FRAMES )
+    {
+        mFrame = 0;
+    }
+}
+
+void LWalker::render()
+{
+    gSpriteSheetTexture.render( mPosX, mPosY, &gSpriteClips[ mFrame / 4 ] );
+}
+
+int LWalker::getPosX()
+{
+    return mPosX;
+}
+
+int LWalker::getPosY()
+{
+    return mPosY;
+}
+
+const LBitmask& LWalker::getMask()
+{
+    //The mask follows the animation frame
+    return gSpriteMasks[ mFrame / 4 ];
+}
+
+Dot::Dot( int x, int y )
+{
+    //Initialize the offsets
+    mPosX = x;
+    mPosY = y;
+
+    //Initialize the velocity
+    mVelX = 0;
+    mVelY = 0;
+}
+
+void Dot::handleEvent( SDL_Event& e )
+{
+    //If a key was pressed
+    if( e.type == SDL_KEYDOWN && e.key.repeat == 0 )
+    {
+        //Adjust the velocity
+        switch( e.key.keysym.sym )
+        {
+            case SDLK_UP: mVelY -= DOT_VEL; break;
+            case SDLK_DOWN: mVelY += DOT_VEL; break;
+            case SDLK_LEFT: mVelX -= DOT_VEL; break;
+            case SDLK_RIGHT: mVelX += DOT_VEL; break;
+        }
+    }
+    //If a key was released
+    else if( e.type == SDL_KEYUP && e.key.repeat == 0 )
+    {
+        //Adjust the velocity
+        switch( e.key.keysym.sym )
+        {
+            case SDLK_UP: mVelY += DOT_VEL; break;
+            case SDLK_DOWN: mVelY -= DOT_VEL; break;
+            case SDLK_LEFT: mVelX += DOT_VEL; break;
+            case SDLK_RIGHT: mVelX -= DOT_VEL; break;
+        }
+    }
+}
+
+void Dot::move( Dot& other, LWalker& walker )
+{
+    //Move the dot left or right
+    mPosX += mVelX;
+
+    //If the dot collided or went too far to the left or right
+    if( ( mPosX < 0 ) || ( mPosX + DOT_WIDTH > SCREEN_WIDTH ) || touches( gDotMask, other.getPosX(), other.getPosY() ) || touches( walker.getMask(), walker.getPosX(), walker.getPosY() ) )
+    {
+        //Move back
+        mPosX -= mVelX;
+    }
+
+    //Move the dot up or down
+    mPosY += mVelY;
+
+    //If the dot collided or went too far up or down
+    if( ( mPosY < 0 ) || ( mPosY + DOT_HEIGHT > SCREEN_HEIGHT ) || touches( gDotMask, other.getPosX(), other.getPosY() ) || touches( walker.getMask(), walker.getPosX(), walker.getPosY() ) )
+    {
+        //Move back
+        mPosY -= mVelY;
+    }
+}
+
+void Dot::render()
+{
+    //Show the dot
+    gDotTexture.render( mPosX, mPosY );
+}
+
+bool Dot::touches( const LBitmask& mask, int x, int y )
+{
+    return checkCollision( gDotMask, mPosX, mPosY, mask, x, y );
+}
+
+int Dot::getPosX()
+{
+    return mPosX;
+}
+
+int Dot::getPosY()
+{
+    return mPosY;
+}
+
+bool checkCollision( const LBitmask& a, int ax, int ay, const LBitmask& b, int bx, int by )
+{
+    //Reject on the solid bounds first, most pairs never get further
+    SDL_Rect boundsA = { ax + a.getBounds().x, ay + a.getBounds().y, a.getBounds().w, a.getBounds().h };
+    SDL_Rect boundsB = { bx + b.getBounds().x, by + b.getBounds().y, b.getBounds().w, b.getBounds().h };
+    SDL_Rect overlap;
+    if( !SDL_IntersectRect( &boundsA, &boundsB, &overlap ) )
+    {
+        return false;
+    }
+
+    //AND 64 pixels at a time across the overlap
+    for( int y = overlap.y; y < overlap.y + overlap.h; ++y )
+    {
+        for( int x = overlap.x; x < overlap.x + overlap.w; x += 64 )
+        {
+            Uint64 bits = a.getBits( y - ay, x - ax ) & b.getBits( y - by, x - bx );
+
+            //Drop pixels past the overlap on the last word of the row
+            int remaining = overlap.x + overlap.w - x;
+            if( remaining < 64 )
+            {
+                bits &= ( (Uint64)1 << remaining ) - 1;
+            }
+
+            if( bits != 0 )
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void runMaskBenchmark()
+{
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+
+    //Scatter the dot around the walker so most placements are near misses or hits
+    std::vector<int> positions( BENCHMARK_TESTS * 3 );
+    Uint32 state = 2463534242u;
+    for( int i = 0; i < BENCHMARK_TESTS; ++i )
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        positions[ i * 3 ] = (int)( state % ( gSpriteClips[ 0 ].w + Dot::DOT_WIDTH * 2 ) ) - Dot::DOT_WIDTH;
+        positions[ i * 3 + 1 ] = (int)( ( state >> 8 ) % ( gSpriteClips[ 0 ].h + Dot::DOT_HEIGHT * 2 ) ) - Dot::DOT_HEIGHT;
+        positions[ i * 3 + 2 ] = ( state >> 24 ) % WALKING_ANIMATION_FRAMES;
+    }
+
+    //Bounds only, the cheapest answer and the upper limit on hits
+    int boundsHits = 0;
+    Uint64 start = SDL_GetPerformanceCounter();
+    for( int i = 0; i < BENCHMARK_TESTS; ++i )
+    {
+        const LBitmask& sprite = gSpriteMasks[ positions[ i * 3 + 2 ] ];
+        SDL_Rect dot = { positions[ i * 3 ] + gDotMask.getBounds().x, positions[ i * 3 + 1 ] + gDotMask.getBounds().y, gDotMask.getBounds().w, gDotMask.getBounds().h };
+        boundsHits += SDL_HasIntersection( &dot, &sprite.getBounds() ) ? 1 : 0;
+    }
+    double boundsTime = ( SDL_GetPerformanceCounter() - start ) * 1.0e9 / frequency / BENCHMARK_TESTS;
+
+    //Word masks, answers kept for the comparison below
+    std::vector<Uint8> maskResults( BENCHMARK_TESTS );
+    int maskHits = 0;
+    start = SDL_GetPerformanceCounter();
+    for( int i = 0; i < BENCHMARK_TESTS; ++i )
+    {
+        maskResults[ i ] = checkCollision( gDotMask, positions[ i * 3 ], positions[ i * 3 + 1 ], gSpriteMasks[ positions[ i * 3 + 2 ] ], 0, 0 ) ? 1 : 0;
+        maskHits += maskResults[ i ];
+    }
+    double maskTime = ( SDL_GetPerformanceCounter() - start ) * 1.0e9 / frequency / BENCHMARK_TESTS;
+
+    //Pixel by pixel over the whole dot, the answer the masks have to give
+    std::vector<Uint8> pixelResults( BENCHMARK_TESTS );
+    int pixelHits = 0;
+    start = SDL_GetPerformanceCounter();
+    for( int i = 0; i < BENCHMARK_TESTS; ++i )
+    {
+        const LBitmask& sprite = gSpriteMasks[ positions[ i * 3 + 2 ] ];
+        bool hit = false;
+        const SDL_Rect& dotBounds = gDotMask.getBounds();
+        for( int y = dotBounds.y; y < dotBounds.y + dotBounds.h && !hit; ++y )
+        {
+            for( int x = dotBounds.x; x < dotBounds.x + dotBounds.w && !hit; ++x )
+            {
+                hit = gDotMask.getPixel( x, y ) && sprite.getPixel( positions[ i * 3 ] + x, positions[ i * 3 + 1 ] + y );
+            }
+        }
+        pixelResults[ i ] = hit ? 1 : 0;
+        pixelHits += pixelResults[ i ];
+    }
+    double pixelTime = ( SDL_GetPerformanceCounter() - start ) * 1.0e9 / frequency / BENCHMARK_TESTS;
+
+    //Compare outside the timed loops
+    int mismatches = 0;
+    for( int i = 0; i < BENCHMARK_TESTS; ++i )
+    {
+        if( maskResults[ i ] != pixelResults[ i ] )
+        {
+            ++mismatches;
+        }
+    }
+
+    printf( "%d placements of the dot around the walker\n", BENCHMARK_TESTS );
+    printf( "Bounds only: %.1f ns/test, %d hits\n", boundsTime, boundsHits );
+    printf( "Word masks:  %.1f ns/test, %d hits\n", maskTime, maskHits );
+    printf( "Per pixel:   %.1f ns/test, %d hits, %d placements differ from the masks\n", pixelTime, pixelHits, mismatches );
+}
+
+bool init()
+{
+    //Initialization flag
+    bool success = true;
+
+    //Initialize SDL
+    if( SDL_Init( SDL_INIT_VIDEO ) < 0 )
+    {
+        printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+        success = false;
+    }
+    else
+    {
+        //Set texture filtering to linear
+        if( !SDL_SetHint( SDL_HINT_RENDER_SCALE_QUALITY, "1" ) )
+        {
+            printf( "Warning: Linear texture filtering not enabled!" );
+        }
+
+        //Create window
+        gWindow = SDL_CreateWindow( "SDL Tutorial", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN );
+        if( gWindow == NULL )
+        {
+            printf( "Window could not be created! SDL Error: %s\n", SDL_GetError() );
+            success = false;
+        }
+        else
+        {
+            //Create vsynced renderer for window
+            gRenderer = SDL_CreateRenderer( gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC );
+            if( gRenderer == NULL )
+            {
+                printf( "Renderer could not be created! SDL Error: %s\n", SDL_GetError() );
+                success = false;
+            }
+            else
+            {
+                //Initialize renderer color
+                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+
+                //Initialize PNG loading
+                int imgFlags = IMG_INIT_PNG;
+                if( !( IMG_Init( imgFlags ) & imgFlags ) )
+                {
+                    printf( "SDL_image could not initialize! SDL_image Error: %s\n", IMG_GetError() );
+                    success = false;
+                }
+            }
+        }
+    }
+
+    return success;
+}
+
+bool loadMedia()
+{
+    //Loading success flag
+    bool success = true;
+
+    //Load dot texture and its mask
+    if( !gDotTexture.loadFromFile( "dot.bmp", &gDotMask ) )
+    {
+        printf( "Failed to load dot texture!\n" );
+        success = false;
+    }
+
+    //Set sprite clips, the masks are cut along them
+    gSpriteClips[ 0 ].x =   0;
+    gSpriteClips[ 0 ].y =   0;
+    gSpriteClips[ 0 ].w =  64;
+    gSpriteClips[ 0 ].h = 205;
+
+    gSpriteClips[ 1 ].x =  64;
+    gSpriteClips[ 1 ].y =   0;
+    gSpriteClips[ 1 ].w =  64;
+    gSpriteClips[ 1 ].h = 205;
+
+    gSpriteClips[ 2 ].x = 128;
+    gSpriteClips[ 2 ].y =   0;
+    gSpriteClips[ 2 ].w =  64;
+    gSpriteClips[ 2 ].h = 205;
+
+    gSpriteClips[ 3 ].x = 196;
+    gSpriteClips[ 3 ].y =   0;
+    gSpriteClips[ 3 ].w =  64;
+    gSpriteClips[ 3 ].h = 205;
+
+    //Load sprite sheet texture with a mask per frame
+    if( !gSpriteSheetTexture.loadFromFile( "foo.png", gSpriteMasks, gSpriteClips, WALKING_ANIMATION_FRAMES ) )
+    {
+        printf( "Failed to load walking animation texture!\n" );
+        success = false;
+    }
+
+    return success;
+}
+
+void close()
+{
+    //Free loaded images
+    gDotTexture.free();
+    gSpriteSheetTexture.free();
+
+    //Destroy window
+    SDL_DestroyRenderer( gRenderer );
+    SDL_DestroyWindow( gWindow );
+    gWindow = NULL;
+    gRenderer = NULL;
+
+    //Quit SDL subsystems
+    IMG_Quit();
+    SDL_Quit();
+}
+
+int main( int argc, char* args[] )
+{
+    //Check for benchmark option
+    bool benchmark = false;
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( args[ i ], "--mask-bench" ) == 0 )
+        {
+            benchmark = true;
+        }
+    }
+
+    //Start up SDL and create window
+    if( !init() )
+    {
+        printf( "Failed to initialize!\n" );
+    }
+    else
+    {
+        //Load media
+        if( !loadMedia() )
+        {
+            printf( "Failed to load media!\n" );
+        }
+        else if( benchmark )
+        {
+            runMaskBenchmark();
+        }
+        else
+        {
+            //Main loop flag
+            bool quit = false;
+
+            //Event handler
+            SDL_Event e;
+
+            //The dot that will be moving around on the screen
+            Dot dot( 0, 0 );
+
+            //The dot we will be colliding with
+            Dot otherDot( SCREEN_WIDTH / 4, SCREEN_HEIGHT / 4 );
+
+            //The figure walking past
+            LWalker walker;
+
+            //While application is running
+            while( !quit )
+            {
+                //Handle events on queue
+                while( SDL_PollEvent( &e ) != 0 )
+                {
+                    //User requests quit
+                    if( e.type == SDL_QUIT )
+                    {
+                        quit = true;
+                    }
+
+                    //Handle input for the dot
+                    dot.handleEvent( e );
+                }
+
+                //Move the walker and the dot and check collision
+                walker.move();
+                dot.move( otherDot, walker );
+
+                //Clear screen
+                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+                SDL_RenderClear( gRenderer );
+
+                //Tint the walker while it walks into the dot
+                if( dot.touches( walker.getMask(), walker.getPosX(), walker.getPosY() ) )
+                {
+                    gSpriteSheetTexture.setColor( 0xFF, 0x80, 0x80 );
+                }
+                else
+                {
+                    gSpriteSheetTexture.setColor( 0xFF, 0xFF, 0xFF );
+                }
+
+                //Render objects
+                walker.render();
+                otherDot.render();
+                dot.render();
+
+                //Update screen
+                SDL_RenderPresent( gRenderer );
+            }
+        }
+    }
+
+    //Free resources and close SDL
+    close();
 
     return 0;
 }
@@ -1,7 +1,1320 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
-int main(int argc, char* args[]) {
-    puts("Not done yet.");
+//AVX2 kernels are compiled for their own target and only called when the CPU has it
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define HAVE_AVX2_KERNELS
+#include <immintrin.h>
+#endif
+
+//A circle stucture
+struct Circle
+{
+    int x, y;
+    int r;
+};
+
+//Texture wrapper class
+class LTexture
+{
+    public:
+        //Initializes variables
+        LTexture();
+
+        //Deallocates memory
+        ~LTexture();
+
+        //Loads image at specified path
+        bool loadFromFile( std::string path );
+
+        //Deallocates texture
+        void free();
+
+        //Set color modulation
+        void setColor( Uint8 red, Uint8 green, Uint8 blue );
+
+        //Renders texture at given point
+        void render( int x, int y, SDL_Rect* clip = NULL );
+
+        //Renders the whole texture stretched over a rect
+        void renderStretched( const SDL_Rect& dest );
+
+        //Gets image dimensions
+        int getWidth();
+        int getHeight();
+
+    private:
+        //The actual hardware texture
+        SDL_Texture* mTexture;
+
+        //Image dimensions
+        int mWidth;
+        int mHeight;
+};
+
+//Tests a query circle against circles [begin, end), writing the indices it touches and returning their count
+typedef int (*CircleKernel)( float qx, float qy, float qr, const float* x, const float* y, const float* r, int begin, int end, int* hits );
+
+//Tests a query circle against boxes [begin, end) given by their edges
+typedef int (*BoxKernel)( float qx, float qy, float qr, const float* left, const float* top, const float* right, const float* bottom, int begin, int end, int* hits );
+
+//One implementation of the collision kernels
+struct LKernelSet
+{
+    //Name for reports and the command line
+    const char* name;
+
+    //Whether this CPU can run it, NULL when any CPU can
+    SDL_bool (*supported)( void );
+
+    CircleKernel circles;
+    BoxKernel boxes;
+};
+
+//Moving circles stored as one array per field
+class LCircleSet
+{
+    public:
+        //Scatters circles with random radii and velocities over an arena
+        void create( int count, float arenaWidth, float arenaHeight );
+
+        //Moves every circle, bouncing off the arena edges
+        void move();
+
+        //Undoes a circle's last move and turns it around
+        void bounce( int index );
+
+        //Gets the number of circles
+        int getCount();
+
+        //Centers and radii
+        std::vector<float> mX;
+        std::vector<float> mY;
+        std::vector<float> mRadius;
+
+    private:
+        //Velocities in pixels per frame
+        std::vector<float> mVelX;
+        std::vector<float> mVelY;
+
+        //Arena dimensions
+        float mArenaWidth;
+        float mArenaHeight;
+};
+
+//Static boxes stored as one array per edge
+struct LBoxSet
+{
+    //Adds a box
+    void add( const SDL_Rect& box );
+
+    //Box edges, right and bottom one past the box like SDL_Rect
+    std::vector<float> mLeft;
+    std::vector<float> mTop;
+    std::vector<float> mRight;
+    std::vector<float> mBottom;
+};
+
+//Uniform grid that copies circles into cell order so each row of cells is one contiguous run for the kernels
+class LCircleGrid
+{
+    public:
+        //Initializes variables
+        LCircleGrid();
+
+        //Buckets the circles by the cell their center is in
+        void build( LCircleSet& circles, float width, float height );
+
+        //Appends the ids of circles touching a query circle, returns the number of candidates tested
+        int query( float x, float y, float r, CircleKernel kernel, std::vector<int>& ids );
+
+        //Gets a circle in cell order, walking these keeps neighbouring queries close in memory
+        float getX( int slot );
+        float getY( int slot );
+        float getRadius( int slot );
+        int getId( int slot );
+
+    private:
+        //Cells across and down
+        int mCellsX;
+        int mCellsY;
+
+        //Where each cell starts in the sorted arrays, with one extra entry marking the end
+        std::vector<int> mCellStart;
+
+        //Circle data in cell order and the id each came from
+        std::vector<float> mX;
+        std::vector<float> mY;
+        std::vector<float> mRadius;
+        std::vector<int> mIds;
+
+        //Cell of each circle while building and kernel output while querying
+        std::vector<int> mCellOf;
+        std::vector<int> mHits;
+};
+
+//The dot that will move around on the screen
+class Dot
+{
+    public:
+        //The dimensions of the dot
+        static const int DOT_WIDTH = 20;
+        static const int DOT_HEIGHT = 20;
+
+        //Maximum axis velocity of the dot
+        static const int DOT_VEL = 1;
+
+        //Initializes the variables
+        Dot( int x, int y );
+
+        //Takes key presses and adjusts the dot's velocity
+        void handleEvent( SDL_Event& e );
+
+        //Moves the dot and checks collision
+        void move( SDL_Rect& square, Circle& circle );
+
+        //Shows the dot on the screen
+        void render();
+
+        //Gets collision circle
+        Circle& getCollider();
+
+    private:
+        //The X and Y offsets of the dot
+        int mPosX, mPosY;
+
+        //The velocity of the dot
+        int mVelX, mVelY;
+
+        //Dot's collision circle
+        Circle mCollider;
+
+        //Moves the collision circle relative to the dot's offset
+        void shiftColliders();
+};
+
+//Screen dimension constants
+const int SCREEN_WIDTH = 640;
+const int SCREEN_HEIGHT = 480;
+
+//Moving circles in the interactive scene
+const int DEFAULT_CIRCLES = 300;
+
+//Circle radius range and fastest circle speed in pixels per frame
+const float MIN_CIRCLE_RADIUS = 3.f;
+const float MAX_CIRCLE_RADIUS = 10.f;
+const float MAX_CIRCLE_SPEED = 2.f;
+
+//Grid cells hold a handful of circles, so a row of cells under a query fills a couple of SIMD batches
+const float GRID_CELL_SIZE = 64.f;
+
+//Benchmark arenas grow with the circle count so density stays the same
+const int BENCHMARK_AREA_PER_CIRCLE = 600;
+
+//Frames simulated per benchmark size
+const int BENCHMARK_FRAMES = 20;
+
+//Largest circle count the per pair check is timed against
+const int MAX_NAIVE_CIRCLES = 16000;
+
+//Milliseconds between performance reports
+const Uint32 COLLISION_REPORT_MS = 5000;
+
+//Starts up SDL and creates window
+bool init();
+
+//Loads media
+bool loadMedia();
+
+//Frees media and shuts down SDL
+void close();
+
+//Circle/Circle collision detector
+bool checkCollision( Circle& a, Circle& b );
+
+//Circle/Box collision detector
+bool checkCollision( Circle& a, SDL_Rect& b );
+
+//Calculates distance squared between two points
+double distanceSquared( int x1, int y1, int x2, int y2 );
+
+//Picks the fastest kernels this CPU runs, or the named ones
+const LKernelSet* chooseKernels( const char* name );
+
+//Finds every touching pair of circles through the grid, returns the pair count
+int findContacts( LCircleSet& circles, LCircleGrid& grid, CircleKernel kernel, float width, float height, Uint32& pairHash, int* candidates, std::vector<Uint8>* touching );
+
+//Times the grid with each kernel against the per pair check over growing circle counts
+void runCircleBenchmark();
+
+//The window we'll be rendering to
+SDL_Window* gWindow = NULL;
+
+//The window renderer
+SDL_Renderer* gRenderer = NULL;
+
+//Scene textures
+LTexture gDotTexture;
+
+//Random state shared by circle placement
+Uint32 gRandomState = 2463534242u;
+
+//Xorshift random numbers, cheap enough to seed thousands of circles
+inline Uint32 nextRandom()
+{
+    gRandomState ^= gRandomState << 13;
+    gRandomState ^= gRandomState >> 17;
+    gRandomState ^= gRandomState << 5;
+    return gRandomState;
+}
+
+//Random float in [0, 1)
+inline float randomUnit()
+{
+    return ( nextRandom() >> 8 ) / 16777216.f;
+}
+
+int testCirclesScalar( float qx, float qy, float qr, const float* x, const float* y, const float* r, int begin, int end, int* hits )
+{
+    int count = 0;
+    for( int i = begin; i < end; ++i )
+    {
+        float dx = x[ i ] - qx;
+        float dy = y[ i ] - qy;
+        float reach = r[ i ] + qr;
+        if( dx * dx + dy * dy < reach * reach )
+        {
+            hits[ count++ ] = i;
+        }
+    }
+
+    return count;
+}
+
+int testBoxesScalar( float qx, float qy, float qr, const float* left, const float* top, const float* right, const float* bottom, int begin, int end, int* hits )
+{
+    int count = 0;
+    for( int i = begin; i < end; ++i )
+    {
+        //Closest point on the box to the circle's center
+        float cx = qx < left[ i ] ? left[ i ] : ( qx > right[ i ] ? right[ i ] : qx );
+        float cy = qy < top[ i ] ? top[ i ] : ( qy > bottom[ i ] ? bottom[ i ] : qy );
+        float dx = cx - qx;
+        float dy = cy - qy;
+        if( dx * dx + dy * dy < qr * qr )
+        {
+            hits[ count++ ] = i;
+        }
+    }
+
+    return count;
+}
+
+#ifdef __SSE2__
+int testCirclesSSE2( float qx, float qy, float qr, const float* x, const float* y, const float* r, int begin, int end, int* hits )
+{
+    const __m128 centerX = _mm_set1_ps( qx );
+    const __m128 centerY = _mm_set1_ps( qy );
+    const __m128 radius = _mm_set1_ps( qr );
+
+    //Four candidates at a time, the compare mask says which ones hit
+    int count = 0;
+    int i = begin;
+    for( ; i + 4 <= end; i += 4 )
+    {
+        __m128 dx = _mm_sub_ps( _mm_loadu_ps( &x[ i ] ), centerX );
+        __m128 dy = _mm_sub_ps( _mm_loadu_ps( &y[ i ] ), centerY );
+        __m128 reach = _mm_add_ps( _mm_loadu_ps( &r[ i ] ), radius );
+        __m128 distance = _mm_add_ps( _mm_mul_ps( dx, dx ), _mm_mul_ps( dy, dy ) );
+        int mask = _mm_movemask_ps( _mm_cmplt_ps( distance, _mm_mul_ps( reach, reach ) ) );
+        for( int k = 0; mask != 0; ++k, mask >>= 1 )
+        {
+            if( mask & 1 )
+            {
+                hits[ count++ ] = i + k;
+            }
+        }
+    }
+
+    //Remaining candidates
+    return count + testCirclesScalar( qx, qy, qr, x, y, r, i, end, hits + count );
+}
+
+int testBoxesSSE2( float qx, float qy, float qr, const float* left, const float* top, const float* right, const float* bottom, int begin, int end, int* hits )
+{
+    const __m128 centerX = _mm_set1_ps( qx );
+    const __m128 centerY = _mm_set1_ps( qy );
+    const __m128 radiusSquared = _mm_set1_ps( qr * qr );
+
+    int count = 0;
+    int i = begin;
+    for( ; i + 4 <= end; i += 4 )
+    {
+        //Clamp the center into each box
+        __m128 cx = _mm_min_ps( _mm_max_ps( centerX, _mm_loadu_ps( &left[ i ] ) ), _mm_loadu_ps( &right[ i ] ) );
+        __m128 cy = _mm_min_ps( _mm_max_ps( centerY, _mm_loadu_ps( &top[ i ] ) ), _mm_loadu_ps( &bottom[ i ] ) );
+        __m128 dx = _mm_sub_ps( cx, centerX );
+        __m128 dy = _mm_sub_ps( cy, centerY );
+        __m128 distance = _mm_add_ps( _mm_mul_ps( dx, dx ), _mm_mul_ps( dy, dy ) );
+        int mask = _mm_movemask_ps( _mm_cmplt_ps( distance, radiusSquared ) );
+        for( int k = 0; mask != 0; ++k, mask >>= 1 )
+        {
+            if( mask & 1 )
+            {
+                hits[ count++ ] = i + k;
+            }
+        }
+    }
+
+    //Remaining boxes
+    return count + testBoxesScalar( qx, qy, qr, left, top, right, bottom, i, end, hits + count );
+}
+#endif
+
+#ifdef HAVE_AVX2_KERNELS
+__attribute__(( target( "avx2" ) ))
+int testCirclesAVX2( float qx, float qy, float qr, const float* x, const float* y, const float* r, int begin, int end, int* hits )
+{
+    const __m256 centerX = _mm256_set1_ps( qx );
+    const __m256 centerY = _mm256_set1_ps( qy );
+    const __m256 radius = _mm256_set1_ps( qr );
+
+    //Eight candidates at a time
+    int count = 0;
+    int i = begin;
+    for( ; i + 8 <= end; i += 8 )
+    {
+        __m256 dx = _mm256_sub_ps( _mm256_loadu_ps( &x[ i ] ), centerX );
+        __m256 dy = _mm256_sub_ps( _mm256_loadu_ps( &y[ i ] ), centerY );
+        __m256 reach = _mm256_add_ps( _mm256_loadu_ps( &r[ i ] ), radius );
+        __m256 distance = _mm256_add_ps( _mm256_mul_ps( dx, dx ), _mm256_mul_ps( dy, dy ) );
+        int mask = _mm256_movemask_ps( _mm256_cmp_ps( distance, _mm256_mul_ps( reach, reach ), _CMP_LT_OQ ) );
+        for( int k = 0; mask != 0; ++k, mask >>= 1 )
+        {
+            if( mask & 1 )
+            {
+                hits[ count++ ] = i + k;
+            }
+        }
+    }
+
+    //Remaining candidates
+    return count + testCirclesScalar( qx, qy, qr, x, y, r, i, end, hits + count );
+}
+
+__attribute__(( target( "avx2" ) ))
+int testBoxesAVX2( float qx, float qy, float qr, const float* left, const float* top, const float* right, const float* bottom, int begin, int end, int* hits )
+{
+    const __m256 centerX = _mm256_set1_ps( qx );
+    const __m256 centerY = _mm256_set1_ps( qy );
+    const __m256 radiusSquared = _mm256_set1_ps( qr * qr );
+
+    int count = 0;
+    int i = begin;
+    for( ; i + 8 <= end; i += 8 )
+    {
+        //Clamp the center into each box
+        __m256 cx = _mm256_min_ps( _mm256_max_ps( centerX, _mm256_loadu_ps( &left[ i ] ) ), _mm256_loadu_ps( &right[ i ] ) );
+        __m256 cy = _mm256_min_ps( _mm256_max_ps( centerY, _mm256_loadu_ps( &top[ i ] ) ), _mm256_loadu_ps( &bottom[ i ] ) );
+        __m256 dx = _mm256_sub_ps( cx, centerX );
+        __m256 dy = _mm256_sub_ps( cy, centerY );
+        __m256 distance = _mm256_add_ps( _mm256_mul_ps( dx, dx ), _mm256_mul_ps( dy, dy ) );
+        int mask = _mm256_movemask_ps( _mm256_cmp_ps( distance, radiusSquared, _CMP_LT_OQ ) );
+        for( int k = 0; mask != 0; ++k, mask >>= 1 )
+        {
+            if( mask & 1 )
+            {
+                hits[ count++ ] = i + k;
+            }
+        }
+    }
+
+    //Remaining boxes
+    return count + testBoxesScalar( qx, qy, qr, left, top, right, bottom, i, end, hits + count );
+}
+#endif
+
+//Kernel sets from fastest to slowest, the scalar one always works
+const LKernelSet gKernelSets[] = {
+#ifdef HAVE_AVX2_KERNELS
+    { "avx2", SDL_HasAVX2, testCirclesAVX2, testBoxesAVX2 },
+#endif
+#ifdef __SSE2__
+    { "sse2", SDL_HasSSE2, testCirclesSSE2, testBoxesSSE2 },
+#endif
+    { "scalar", NULL, testCirclesScalar, testBoxesScalar }
+};
+const int KERNEL_SET_TOTAL = sizeof( gKernelSets ) / sizeof( gKernelSets[ 0 ] );
+
+LTexture::LTexture()
+{
+    //Initialize
+    mTexture = NULL;
+    mWidth = 0;
+    mHeight = 0;
+}
+
+LTexture::~LTexture()
+{
+    //Deallocate
+    free();
+}
+
+bool LTexture::loadFromFile( std::string path )
+{
+    //Get rid of preexisting texture
+    free();
+
+    //The final texture
+    SDL_Texture* newTexture = NULL;
+
+    //Load image at specified path
+    SDL_Surface* loadedSurface = IMG_Load( path.c_str() );
+    if( loadedSurface == NULL )
+    {
+        printf( "Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError() );
+    }
+    else
+    {
+        //Color key image
+        SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 0, 0xFF, 0xFF ) );
+
+        //Create texture from surface pixels
+        newTexture = SDL_CreateTextureFromSurface( gRenderer, loadedSurface );
+        if( newTexture == NULL )
+        {
+            printf( "Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+        }
+        else
+        {
+            //Get image dimensions
+            mWidth = loadedSurface->w;
+            mHeight = loadedSurface->h;
+        }
+
+        //Get rid of old loaded surface
+        SDL_FreeSurface( loadedSurface );
+    }
+
+    //Return success
+    mTexture = newTexture;
+    return mTexture != NULL;
+}
+
+void LTexture::free()
+{
+    //Free texture if it exists
+    if( mTexture != NULL )
+    {
+        SDL_DestroyTexture( mTexture );
+        mTexture = NULL;
+        mWidth = 0;
+        mHeight = 0;
+    }
+}
+
+void LTexture::setColor( Uint8 red, Uint8 green, Uint8 blue )
+{
+    //Modulate texture rgb
+    SDL_SetTextureColorMod( mTexture, red, green, blue );
+}
+
+void LTexture::render( int x, int y, SDL_Rect* clip )
+{
+    //Set rendering space and render to screen
+    SDL_Rect renderQuad = { x, y, mWidth, mHeight };
+
+    //Set clip rendering dimensions
+    if( clip != NULL )
+    {
+        renderQuad.w = clip->w;
+        renderQuad.h = clip->h;
+    }
+
+    //Render to screen
+    SDL_RenderCopy( gRenderer, mTexture, clip, &renderQuad );
+}
+
+void LTexture::renderStretched( const SDL_Rect& dest )
+{
+    SDL_RenderCopy( gRenderer, mTexture, NULL, &dest );
+}
+
+int LTexture::getWidth()
+{
+    return mWidth;
+}
+
+int LTexture::getHeight()
+{
+    return mHeight;
+}
+
+void LCircleSet::create( int count, float arenaWidth, float arenaHeight )
+{
+    mArenaWidth = arenaWidth;
+    mArenaHeight = arenaHeight;
+
+    mX.resize( count );
+    mY.resize( count );
+    mRadius.resize( count );
+    mVelX.resize( count );
+    mVelY.resize( count );
+
+    for( int i = 0; i < count; ++i )
+    {
+        mRadius[ i ] = MIN_CIRCLE_RADIUS + ( MAX_CIRCLE_RADIUS - MIN_CIRCLE_RADIUS ) * randomUnit();
+        mX[ i ] = mRadius[ i ] + ( arenaWidth - mRadius[ i ] * 2 ) * randomUnit();
+        mY[ i ] = mRadius[ i ] + ( arenaHeight - mRadius[ i ] * 2 ) * randomUnit();
+        mVelX[ i ] = MAX_CIRCLE_SPEED * ( randomUnit() * 2.f - 1.f );
+        mVelY[ i ] = MAX_CIRCLE_SPEED * ( randomUnit() * 2.f - 1.f );
+    }
+}
+
+void LCircleSet::move()
+{
+    int count = getCount();
+    for( int i = 0; i < count; ++i )
+    {
+        //Move and turn around at the arena edges
+        mX[ i ] += mVelX[ i ];
+        if( mX[ i ] < mRadius[ i ] || mX[ i ] > mArenaWidth - mRadius[ i ] )
+        {
+            mVelX[ i ] = -mVelX[ i ];
+            mX[ i ] += mVelX[ i ];
+        }
+
+        mY[ i ] += mVelY[ i ];
+        if( mY[ i ] < mRadius[ i ] || mY[ i ] > mArenaHeight - mRadius[ i ] )
+        {
+            mVelY[ i ] = -mVelY[ i ];
+            mY[ i ] += mVelY[ i ];
+        }
+    }
+}
+
+void LCircleSet::bounce( int index )
+{
+    mX[ index ] -= mVelX[ index ];
+    mY[ index ] -= mVelY[ index ];
+    mVelX[ index ] = -mVelX[ index ];
+    mVelY[ index ] = -mVelY[ index ];
+}
+
+int LCircleSet::getCount()
+{
+    return (int)mX.size();
+}
+
+void LBoxSet::add( const SDL_Rect& box )
+{
+    mLeft.push_back( (float)box.x );
+    mTop.push_back( (float)box.y );
+    mRight.push_back( (float)( box.x + box.w ) );
+    mBottom.push_back( (float)( box.y + box.h ) );
+}
+
+LCircleGrid::LCircleGrid()
+{
+    //Initialize
+    mCellsX = 0;
+    mCellsY = 0;
+}
+
+void LCircleGrid::build( LCircleSet& circles, float width, float height )
+{
+    int count = circles.getCount();
+    mCellsX = (int)( width / GRID_CELL_SIZE ) + 1;
+    mCellsY = (int)( height / GRID_CELL_SIZE ) + 1;
+
+    //Count the circles in each cell
+    mCellStart.assign( mCellsX * mCellsY + 1, 0 );
+    mCellOf.resize( count );
+    for( int i = 0; i < count; ++i )
+    {
+        int cellX = (int)( circles.mX[ i ] / GRID_CELL_SIZE );
+        int cellY = (int)( circles.mY[ i ] / GRID_CELL_SIZE );
+        cellX = cellX < 0 ? 0 : ( cellX >= mCellsX ? mCellsX - 1 : cellX );
+        cellY = cellY < 0 ? 0 : ( cellY >= mCellsY ? mCellsY - 1 : cellY );
+        mCellOf[ i ] = cellY * mCellsX + cellX;
+        ++mCellStart[ mCellOf[ i ] + 1 ];
+    }
+
+    //Turn counts into start offsets
+    for( int cell = 0; cell < mCellsX * mCellsY; ++cell )
+    {
+        mCellStart[ cell + 1 ] += mCellStart[ cell ];
+    }
+
+    //Copy the circles into cell order
+    mX.resize( count );
+    mY.resize( count );
+    mRadius.resize( count );
+    mIds.resize( count );
+    mHits.resize( count );
+    std::vector<int> fill( mCellStart.begin(), mCellStart.end() - 1 );
+    for( int i = 0; i < count; ++i )
+    {
+        int slot = fill[ mCellOf[ i ] ]++;
+        mX[ slot ] = circles.mX[ i ];
+        mY[ slot ] = circles.mY[ i ];
+        mRadius[ slot ] = circles.mRadius[ i ];
+        mIds[ slot ] = i;
+    }
+}
+
+int LCircleGrid::query( float x, float y, float r, CircleKernel kernel, std::vector<int>& ids )
+{
+    //Any circle reaching the query has its center within this range
+    float reach = r + MAX_CIRCLE_RADIUS;
+    int x1 = (int)( ( x - reach ) / GRID_CELL_SIZE );
+    int y1 = (int)( ( y - reach ) / GRID_CELL_SIZE );
+    int x2 = (int)( ( x + reach ) / GRID_CELL_SIZE );
+    int y2 = (int)( ( y + reach ) / GRID_CELL_SIZE );
+    x1 = x1 < 0 ? 0 : x1;
+    y1 = y1 < 0 ? 0 : y1;
+    x2 = x2 >= mCellsX ? mCellsX - 1 : x2;
+    y2 = y2 >= mCellsY ? mCellsY - 1 : y2;
+
+    //Neighbouring cells in a row are next to each other in the arrays, so each row is one kernel call
+    int candidates = 0;
+    for( int cellY = y1; cellY <= y2; ++cellY )
+    {
+        int begin = mCellStart[ cellY * mCellsX + x1 ];
+        int end = mCellStart[ cellY * mCellsX + x2 + 1 ];
+        int found = kernel( x, y, r, &mX[ 0 ], &mY[ 0 ], &mRadius[ 0 ], begin, end, &mHits[ 0 ] );
+        for( int i = 0; i < found; ++i )
+        {
+            ids.push_back( mIds[ mHits[ i ] ] );
+        }
+        candidates += end - begin;
+    }
+
+    return candidates;
+}
+
+float LCircleGrid::getX( int slot )
+{
+    return mX[ slot ];
+}
+
+float LCircleGrid::getY( int slot )
+{
+    return mY[ slot ];
+}
+
+float LCircleGrid::getRadius( int slot )
+{
+    return mRadius[ slot ];
+}
+
+int LCircleGrid::getId( int slot )
+{
+    return mIds[ slot ];
+}
+
+Dot::Dot( int x, int y )
+{
+    //Initialize the offsets
+    mPosX = x;
+    mPosY = y;
+
+    //Set collision circle size
+    mCollider.r = DOT_WIDTH / 2;
+
+    //Initialize the velocity
+    mVelX = 0;
+    mVelY = 0;
+
+    //Move collider relative to the circle
+    shiftColliders();
+}
+
+void Dot::handleEvent( SDL_Event& e )
+{
+    //If a key was pressed
+    if( e.type == SDL_KEYDOWN && e.key.repeat == 0 )
+    {
+        //Adjust the velocity
+        switch( e.key.keysym.sym )
+        {
+            case SDLK_UP: mVelY -= DOT_VEL; break;
+            case SDLK_DOWN: mVelY += DOT_VEL; break;
+            case SDLK_LEFT: mVelX -= DOT_VEL; break;
+            case SDLK_RIGHT: mVelX += DOT_VEL; break;
+        }
+    }
+    //If a key was released
+    else if( e.type == SDL_KEYUP && e.key.repeat == 0 )
+    {
+        //Adjust the velocity
+        switch( e.key.keysym.sym )
+        {
+            case SDLK_UP: mVelY += DOT_VEL; break;
+            case SDLK_DOWN: mVelY -= DOT_VEL; break;
+            case SDLK_LEFT: mVelX += DOT_VEL; break;
+            case SDLK_RIGHT: mVelX -= DOT_VEL; break;
+        }
+    }
+}
+
+void Dot::move( SDL_Rect& square, Circle& circle )
+{
+    //Move the dot left or right
+    mPosX += mVelX;
+    shiftColliders();
+
+    //If the dot collided or went too far to the left or right
+    if( ( mPosX - mCollider.r < 0 ) || ( mPosX + mCollider.r > SCREEN_WIDTH ) || checkCollision( mCollider, square ) || checkCollision( mCollider, circle ) )
+    {
+        //Move back
+        mPosX -= mVelX;
+        shiftColliders();
+    }
+
+    //Move the dot up or down
+    mPosY += mVelY;
+    shiftColliders();
+
+    //If the dot collided or went too far up or down
+    if( ( mPosY - mCollider.r < 0 ) || ( mPosY + mCollider.r > SCREEN_HEIGHT ) || checkCollision( mCollider, square ) || checkCollision( mCollider, circle ) )
+    {
+        //Move back
+        mPosY -= mVelY;
+        shiftColliders();
+    }
+}
+
+void Dot::render()
+{
+    //Show the dot
+    gDotTexture.render( mPosX - mCollider.r, mPosY - mCollider.r );
+}
+
+Circle& Dot::getCollider()
+{
+    return mCollider;
+}
+
+void Dot::shiftColliders()
+{
+    //Align collider to center of dot
+    mCollider.x = mPosX;
+    mCollider.y = mPosY;
+}
+
+bool checkCollision( Circle& a, Circle& b )
+{
+    //Calculate total radius squared
+    int totalRadiusSquared = a.r + b.r;
+    totalRadiusSquared = totalRadiusSquared * totalRadiusSquared;
+
+    //If the distance between the centers of the circles is less than the sum of their radii
+    if( distanceSquared( a.x, a.y, b.x, b.y ) < ( totalRadiusSquared ) )
+    {
+        //The circles have collided
+        return true;
+    }
+
+    //If not
+    return false;
+}
+
+bool checkCollision( Circle& a, SDL_Rect& b )
+{
+    //Closest point on collision box
+    int cX, cY;
+
+    //Find closest x offset
+    if( a.x < b.x )
+    {
+        cX = b.x;
+    }
+    else if( a.x > b.x + b.w )
+    {
+        cX = b.x + b.w;
+    }
+    else
+    {
+        cX = a.x;
+    }
+
+    //Find closest y offset
+    if( a.y < b.y )
+    {
+        cY = b.y;
+    }
+    else if( a.y > b.y + b.h )
+    {
+        cY = b.y + b.h;
+    }
+    else
+    {
+        cY = a.y;
+    }
+
+    //If the closest point is inside the circle
+    if( distanceSquared( a.x, a.y, cX, cY ) < a.r * a.r )
+    {
+        //This box and the circle have collided
+        return true;
+    }
+
+    //If the shapes have not collided
+    return false;
+}
+
+double distanceSquared( int x1, int y1, int x2, int y2 )
+{
+    int deltaX = x2 - x1;
+    int deltaY = y2 - y1;
+    return deltaX * deltaX + deltaY * deltaY;
+}
+
+const LKernelSet* chooseKernels( const char* name )
+{
+    for( int i = 0; i < KERNEL_SET_TOTAL; ++i )
+    {
+        const LKernelSet& set = gKernelSets[ i ];
+        bool supported = set.supported == NULL || set.supported();
+        if( supported && ( name == NULL || strcmp( name, set.name ) == 0 ) )
+        {
+            return &set;
+        }
+    }
+
+    //Unknown or unsupported names fall back to the scalar kernels
+    if( name != NULL )
+    {
+        printf( "Warning: %s kernels not available, using scalar\n", name );
+    }
+    return &gKernelSets[ KERNEL_SET_TOTAL - 1 ];
+}
+
+int findContacts( LCircleSet& circles, LCircleGrid& grid, CircleKernel kernel, float width, float height, Uint32& pairHash, int* candidates, std::vector<Uint8>* touching )
+{
+    grid.build( circles, width, height );
+
+    //Each circle looks up its neighbours in cell order, pairs are counted from the lower id
+    std::vector<int> ids;
+    int pairs = 0;
+    int tested = 0;
+    int count = circles.getCount();
+    for( int slot = 0; slot < count; ++slot )
+    {
+        int i = grid.getId( slot );
+        ids.clear();
+        tested += grid.query( grid.getX( slot ), grid.getY( slot ), grid.getRadius( slot ), kernel, ids );
+        for( size_t k = 0; k < ids.size(); ++k )
+        {
+            if( ids[ k ] > i )
+            {
+                ++pairs;
+                pairHash += (Uint32)i * 2654435761u ^ (Uint32)ids[ k ] * 40503u;
+                if( touching != NULL )
+                {
+                    ( *touching )[ i ] = 1;
+                    ( *touching )[ ids[ k ] ] = 1;
+                }
+            }
+        }
+    }
+
+    if( candidates != NULL )
+    {
+        *candidates = tested;
+    }
+    return pairs;
+}
+
+void runCircleBenchmark()
+{
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+
+    //Raw kernel throughput, every circle of a large set against a few queries
+    {
+        gRandomState = 2463534242u;
+        LCircleSet circles;
+        circles.create( 64000, 6000.f, 6000.f );
+        std::vector<int> hits( circles.getCount() );
+        for( int k = 0; k < KERNEL_SET_TOTAL; ++k )
+        {
+            const LKernelSet& set = gKernelSets[ k ];
+            if( set.supported != NULL && !set.supported() )
+            {
+                continue;
+            }
+
+            int found = 0;
+            Uint64 start = SDL_GetPerformanceCounter();
+            for( int q = 0; q < 100; ++q )
+            {
+                found += set.circles( circles.mX[ q ], circles.mY[ q ], 200.f, &circles.mX[ 0 ], &circles.mY[ 0 ], &circles.mRadius[ 0 ], 0, circles.getCount(), &hits[ 0 ] );
+            }
+            printf( "%-6s kernel: %.3f ns per candidate, %d hits\n", set.name,
+                ( SDL_GetPerformanceCounter() - start ) * 1.0e9 / frequency / ( 100.0 * circles.getCount() ), found );
+        }
+    }
+
+    printf( "%8s %10s %10s", "circles", "naive ms", "contacts" );
+    for( int k = 0; k < KERNEL_SET_TOTAL; ++k )
+    {
+        printf( " %10s", gKernelSets[ k ].name );
+    }
+    printf( " %8s\n", "match" );
+
+    for( int count = 1000; count <= 64000; count *= 2 )
+    {
+        //Same density at every size
+        float side = (float)sqrt( (double)count * BENCHMARK_AREA_PER_CIRCLE );
+        gRandomState = 2463534242u;
+        LCircleSet circles;
+        circles.create( count, side, side );
+        for( int frame = 0; frame < 10; ++frame )
+        {
+            circles.move();
+        }
+
+        //Every pair, on the sizes that finish in reasonable time
+        char naiveText[ 16 ] = "-";
+        int naivePairs = -1;
+        Uint32 naiveHash = 0;
+        if( count <= MAX_NAIVE_CIRCLES )
+        {
+            naivePairs = 0;
+            Uint64 start = SDL_GetPerformanceCounter();
+            for( int i = 0; i < count; ++i )
+            {
+                for( int j = i + 1; j < count; ++j )
+                {
+                    float dx = circles.mX[ j ] - circles.mX[ i ];
+                    float dy = circles.mY[ j ] - circles.mY[ i ];
+                    float reach = circles.mRadius[ i ] + circles.mRadius[ j ];
+                    if( dx * dx + dy * dy < reach * reach )
+                    {
+                        ++naivePairs;
+                        naiveHash += (Uint32)i * 2654435761u ^ (Uint32)j * 40503u;
+                    }
+                }
+            }
+            snprintf( naiveText, sizeof( naiveText ), "%.3f", ( SDL_GetPerformanceCounter() - start ) * 1000.0 / frequency );
+        }
+
+        //The grid with each kernel set this CPU runs
+        char kernelText[ 8 ][ 16 ];
+        int pairs = -1;
+        Uint32 hash = 0;
+        bool match = true;
+        for( int k = 0; k < KERNEL_SET_TOTAL; ++k )
+        {
+            const LKernelSet& set = gKernelSets[ k ];
+            if( set.supported != NULL && !set.supported() )
+            {
+                snprintf( kernelText[ k ], sizeof( kernelText[ k ] ), "n/a" );
+                continue;
+            }
+
+            LCircleGrid grid;
+            Uint64 start = SDL_GetPerformanceCounter();
+            for( int frame = 0; frame < BENCHMARK_FRAMES; ++frame )
+            {
+                hash = 0;
+                pairs = findContacts( circles, grid, set.circles, side, side, hash, NULL, NULL );
+            }
+            snprintf( kernelText[ k ], sizeof( kernelText[ k ] ), "%.3f", ( SDL_GetPerformanceCounter() - start ) * 1000.0 / frequency / BENCHMARK_FRAMES );
+
+            if( naivePairs >= 0 && ( pairs != naivePairs || hash != naiveHash ) )
+            {
+                match = false;
+            }
+        }
+
+        printf( "%8d %10s %10d", count, naiveText, pairs );
+        for( int k = 0; k < KERNEL_SET_TOTAL; ++k )
+        {
+            printf( " %10s", kernelText[ k ] );
+        }
+        printf( " %8s\n", naivePairs < 0 ? "-" : ( match ? "yes" : "NO" ) );
+    }
+}
+
+bool init()
+{
+    //Initialization flag
+    bool success = true;
+
+    //Initialize SDL
+    if( SDL_Init( SDL_INIT_VIDEO ) < 0 )
+    {
+        printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+        success = false;
+    }
+    else
+    {
+        //Set texture filtering to linear
+        if( !SDL_SetHint( SDL_HINT_RENDER_SCALE_QUALITY, "1" ) )
+        {
+            printf( "Warning: Linear texture filtering not enabled!" );
+        }
+
+        //Create window
+        gWindow = SDL_CreateWindow( "SDL Tutorial", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN );
+        if( gWindow == NULL )
+        {
+            printf( "Window could not be created! SDL Error: %s\n", SDL_GetError() );
+            success = false;
+        }
+        else
+        {
+            //Create vsynced renderer for window
+            gRenderer = SDL_CreateRenderer( gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC );
+            if( gRenderer == NULL )
+            {
+                printf( "Renderer could not be created! SDL Error: %s\n", SDL_GetError() );
+                success = false;
+            }
+            else
+            {
+                //Initialize renderer color
+                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+
+                //Initialize PNG loading
+                int imgFlags = IMG_INIT_PNG;
+                if( !( IMG_Init( imgFlags ) & imgFlags ) )
+                {
+                    printf( "SDL_image could not initialize! SDL_image Error: %s\n", IMG_GetError() );
+                    success = false;
+                }
+            }
+        }
+    }
+
+    return success;
+}
+
+bool loadMedia()
+{
+    //Loading success flag
+    bool success = true;
+
+    //Load dot texture
+    if( !gDotTexture.loadFromFile( "dot.bmp" ) )
+    {
+        printf( "Failed to load dot texture!\n" );
+        success = false;
+    }
+
+    return success;
+}
+
+void close()
+{
+    //Free loaded images
+    gDotTexture.free();
+
+    //Destroy window
+    SDL_DestroyRenderer( gRenderer );
+    SDL_DestroyWindow( gWindow );
+    gWindow = NULL;
+    gRenderer = NULL;
+
+    //Quit SDL subsystems
+    IMG_Quit();
+    SDL_Quit();
+}
+
+int main( int argc, char* args[] )
+{
+    //Check for circle count, kernel and benchmark options
+    int circleCount = DEFAULT_CIRCLES;
+    const char* kernelName = NULL;
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( args[ i ], "--circles" ) == 0 && i + 1 < argc )
+        {
+            circleCount = atoi( args[ ++i ] );
+        }
+        else if( strcmp( args[ i ], "--kernel" ) == 0 && i + 1 < argc )
+        {
+            kernelName = args[ ++i ];
+        }
+        else if( strcmp( args[ i ], "--circle-bench" ) == 0 )
+        {
+            //Nothing to draw, the benchmark only needs the timer
+            runCircleBenchmark();
+            return 0;
+        }
+    }
+    if( circleCount < 0 )
+    {
+        circleCount = 0;
+    }
+    const LKernelSet* kernels = chooseKernels( kernelName );
+
+    //Start up SDL and create window
+    if( !init() )
+    {
+        printf( "Failed to initialize!\n" );
+    }
+    else
+    {
+        //Load media
+        if( !loadMedia() )
+        {
+            printf( "Failed to load media!\n" );
+        }
+        else
+        {
+            //Main loop flag
+            bool quit = false;
+
+            //Event handler
+            SDL_Event e;
+
+            //The dot that will be moving around on the screen
+            Dot dot( Dot::DOT_WIDTH / 2, Dot::DOT_HEIGHT / 2 );
+            Dot otherDot( SCREEN_WIDTH / 4, SCREEN_HEIGHT / 4 );
+
+            //Set the wall
+            SDL_Rect wall;
+            wall.x = 300;
+            wall.y = 40;
+            wall.w = 40;
+            wall.h = 400;
+
+            //Circles bounce off the wall and a few more boxes
+            LBoxSet boxes;
+            boxes.add( wall );
+            for( int i = 0; i < 7; ++i )
+            {
+                SDL_Rect box = { 40 + i * 80, i % 2 == 0 ? 20 : SCREEN_HEIGHT - 60, 30, 40 };
+                boxes.add( box );
+            }
+
+            //Circles and the grid that finds their neighbours
+            LCircleSet circles;
+            circles.create( circleCount, (float)SCREEN_WIDTH, (float)SCREEN_HEIGHT );
+            LCircleGrid grid;
+            std::vector<Uint8> touching( circleCount );
+            std::vector<int> boxHits( boxes.mLeft.size() );
+
+            //Circle outlines split by whether they touch anything
+            std::vector<SDL_Rect> freeRects;
+            std::vector<SDL_Rect> touchingRects;
+
+            //Performance reporting
+            printf( "Using %s collision kernels\n", kernels->name );
+            Uint64 frequency = SDL_GetPerformanceFrequency();
+            Uint64 collisionTicks = 0;
+            Uint32 frames = 0;
+            Uint32 contacts = 0;
+            Uint32 candidates = 0;
+            Uint32 reportStart = SDL_GetTicks();
+
+            //While application is running
+            while( !quit )
+            {
+                //Handle events on queue
+                while( SDL_PollEvent( &e ) != 0 )
+                {
+                    //User requests quit
+                    if( e.type == SDL_QUIT )
+                    {
+                        quit = true;
+                    }
+
+                    //Handle input for the dot
+                    dot.handleEvent( e );
+                }
+
+                //Move the dot and check collision
+                dot.move( wall, otherDot.getCollider() );
+
+                //Move the circles, bounce them off the boxes and find the ones touching each other
+                Uint64 start = SDL_GetPerformanceCounter();
+                circles.move();
+                for( int i = 0; i < circleCount; ++i )
+                {
+                    if( kernels->boxes( circles.mX[ i ], circles.mY[ i ], circles.mRadius[ i ], &boxes.mLeft[ 0 ], &boxes.mTop[ 0 ],
+                                        &boxes.mRight[ 0 ], &boxes.mBottom[ 0 ], 0, (int)boxes.mLeft.size(), &boxHits[ 0 ] ) > 0 )
+                    {
+                        circles.bounce( i );
+                    }
+                }
+                std::fill( touching.begin(), touching.end(), 0 );
+                Uint32 hash = 0;
+                int tested = 0;
+                contacts += findContacts( circles, grid, kernels->circles, (float)SCREEN_WIDTH, (float)SCREEN_HEIGHT, hash, &tested, &touching );
+                candidates += tested;
+                collisionTicks += SDL_GetPerformanceCounter() - start;
+
+                //Clear screen
+                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+                SDL_RenderClear( gRenderer );
+
+                //Render wall and boxes
+                SDL_SetRenderDrawColor( gRenderer, 0x00, 0x00, 0x00, 0xFF );
+                for( size_t i = 0; i < boxes.mLeft.size(); ++i )
+                {
+                    SDL_Rect box = { (int)boxes.mLeft[ i ], (int)boxes.mTop[ i ], (int)( boxes.mRight[ i ] - boxes.mLeft[ i ] ), (int)( boxes.mBottom[ i ] - boxes.mTop[ i ] ) };
+                    SDL_RenderDrawRect( gRenderer, &box );
+                }
+
+                //Render circles, grouped so the tint changes twice a frame
+                freeRects.clear();
+                touchingRects.clear();
+                for( int i = 0; i < circleCount; ++i )
+                {
+                    int r = (int)circles.mRadius[ i ];
+                    SDL_Rect dest = { (int)circles.mX[ i ] - r, (int)circles.mY[ i ] - r, r * 2, r * 2 };
+                    ( touching[ i ] ? touchingRects : freeRects ).push_back( dest );
+                }
+                gDotTexture.setColor( 0x80, 0x80, 0x80 );
+                for( size_t i = 0; i < freeRects.size(); ++i )
+                {
+                    gDotTexture.renderStretched( freeRects[ i ] );
+                }
+                gDotTexture.setColor( 0xFF, 0x00, 0x00 );
+                for( size_t i = 0; i < touchingRects.size(); ++i )
+                {
+                    gDotTexture.renderStretched( touchingRects[ i ] );
+                }
+                gDotTexture.setColor( 0xFF, 0xFF, 0xFF );
+
+                //Render dots
+                dot.render();
+                otherDot.render();
+
+                //Update screen
+                SDL_RenderPresent( gRenderer );
+
+                //Report collision cost periodically
+                ++frames;
+                if( SDL_GetTicks() - reportStart >= COLLISION_REPORT_MS )
+                {
+                    printf( "%d circles: %.3f ms collision per frame, %.1f candidates, %.1f contacts\n", circleCount,
+                        collisionTicks * 1000.0 / frequency / frames, (double)candidates / frames, (double)contacts / frames );
+                    collisionTicks = 0;
+                    candidates = 0;
+                    contacts = 0;
+                    frames = 0;
+                    reportStart = SDL_GetTicks();
+                }
+            }
+        }
+    }
+
+    //Free resources and close SDL
+    close();
 
     return 0;
 }
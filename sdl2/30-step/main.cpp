@@ -1,7 +1,773 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
 
-int main(int argc, char* args[]) {
-    puts("Not done yet.");
+//Texture wrapper class
+class LTexture
+{
+    public:
+        //Initializes variables
+        LTexture();
+
+        //Deallocates memory
+        ~LTexture();
+
+        //Loads image at specified path
+        bool loadFromFile( std::string path );
+
+        //Deallocates texture
+        void free();
+
+        //Renders texture at given point
+        void render( int x, int y, SDL_Rect* clip = NULL );
+
+        //Gets image dimensions
+        int getWidth();
+        int getHeight();
+
+    private:
+        //The actual hardware texture
+        SDL_Texture* mTexture;
+
+        //Image dimensions
+        int mWidth;
+        int mHeight;
+};
+
+//Camera that follows a target without leaving the level
+class LCamera
+{
+    public:
+        //Initializes the view to the screen size
+        LCamera();
+
+        //Centers the view over a point, clamped to the level bounds
+        void follow( int x, int y );
+
+        //Gets the view in level coordinates
+        const SDL_Rect& getView();
+
+    private:
+        //Visible part of the level
+        SDL_Rect mView;
+};
+
+//Static scenery placed in the level
+struct LProp
+{
+    //Top left corner in level coordinates
+    int x;
+    int y;
+
+    //Sprite in the prop sheet
+    int type;
+};
+
+//Uniform grid over the level that finds props by area instead of scanning them all
+class LPropIndex
+{
+    public:
+        //Initializes variables
+        LPropIndex();
+
+        //Buckets every prop by the cell its corner falls in
+        void build( const std::vector<LProp>& props, int levelWidth, int levelHeight );
+
+        //Appends the props whose cells overlap a rect, returns how many cells were visited
+        int query( const SDL_Rect& area, std::vector<int>& ids );
+
+    private:
+        //Cells across and down
+        int mCellsX;
+        int mCellsY;
+
+        //Where each cell's ids start in mIds, with one extra entry marking the end
+        std::vector<int> mCellStart;
+
+        //Prop ids ordered by cell
+        std::vector<int> mIds;
+};
+
+//The dot that will move around on the screen
+class Dot
+{
+    public:
+        //The dimensions of the dot
+        static const int DOT_WIDTH = 20;
+        static const int DOT_HEIGHT = 20;
+
+        //Maximum axis velocity of the dot
+        static const int DOT_VEL = 10;
+
+        //Initializes the variables
+        Dot();
+
+        //Takes key presses and adjusts the dot's velocity
+        void handleEvent( SDL_Event& e );
+
+        //Moves the dot
+        void move();
+
+        //Shows the dot on the screen relative to the camera
+        void render( int camX, int camY );
+
+        //Position accessors
+        int getPosX();
+        int getPosY();
+
+    private:
+        //The X and Y offsets of the dot
+        int mPosX, mPosY;
+
+        //The velocity of the dot
+        int mVelX, mVelY;
+};
+
+//Screen dimension constants
+const int SCREEN_WIDTH = 640;
+const int SCREEN_HEIGHT = 480;
+
+//Default level dimensions, the size of the background image
+const int DEFAULT_LEVEL_WIDTH = 1280;
+const int DEFAULT_LEVEL_HEIGHT = 960;
+
+//Prop sprite dimensions and sheet layout
+const int PROP_WIDTH = 32;
+const int PROP_HEIGHT = 32;
+const int TOTAL_PROP_SPRITES = 3;
+
+//Average distance between props when no count is given
+const int PROP_SPACING = 128;
+
+//Upper limit on props so huge levels still fit in memory
+const int MAX_PROPS = 4000000;
+
+//Grid cell size, a few props per cell at the default spacing
+const int INDEX_CELL_SIZE = 256;
+
+//Props are anchored at their corner, so the query reaches back this far to catch ones hanging into view
+const int CULL_MARGIN = PROP_WIDTH > PROP_HEIGHT ? PROP_WIDTH : PROP_HEIGHT;
+
+//Milliseconds between performance reports
+const Uint32 CULL_REPORT_MS = 5000;
+
+//Starts up SDL and creates window
+bool init();
+
+//Loads media
+bool loadMedia();
+
+//Scatters props over the level
+void placeProps( int count );
+
+//Frees media and shuts down SDL
+void close();
+
+//The window we'll be rendering to
+SDL_Window* gWindow = NULL;
+
+//The window renderer
+SDL_Renderer* gRenderer = NULL;
+
+//Scene textures
+LTexture gDotTexture;
+LTexture gBGTexture;
+LTexture gPropTexture;
+SDL_Rect gPropClips[ TOTAL_PROP_SPRITES ];
+
+//Level dimensions
+int gLevelWidth = DEFAULT_LEVEL_WIDTH;
+int gLevelHeight = DEFAULT_LEVEL_HEIGHT;
+
+//Level scenery and its spatial index
+std::vector<LProp> gProps;
+LPropIndex gPropIndex;
+
+LTexture::LTexture()
+{
+    //Initialize
+    mTexture = NULL;
+    mWidth = 0;
+    mHeight = 0;
+}
+
+LTexture::~LTexture()
+{
+    //Deallocate
+    free();
+}
+
+bool LTexture::loadFromFile( std::string path )
+{
+    //Get rid of preexisting texture
+    free();
+
+    //The final texture
+    SDL_Texture* newTexture = NULL;
+
+    //Load image at specified path
+    SDL_Surface* loadedSurface = IMG_Load( path.c_str() );
+    if( loadedSurface == NULL )
+    {
+        printf( "Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError() );
+    }
+    else
+    {
+        //Color key image
+        SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 0, 0xFF, 0xFF ) );
+
+        //Create texture from surface pixels
+        newTexture = SDL_CreateTextureFromSurface( gRenderer, loadedSurface );
+        if( newTexture == NULL )
+        {
+            printf( "Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+        }
+        else
+        {
+            //Get image dimensions
+            mWidth = loadedSurface->w;
+            mHeight = loadedSurface->h;
+        }
+
+        //Get rid of old loaded surface
+        SDL_FreeSurface( loadedSurface );
+    }
+
+    //Return success
+    mTexture = newTexture;
+    return mTexture != NULL;
+}
+
+void LTexture::free()
+{
+    //Free texture if it exists
+    if( mTexture != NULL )
+    {
+        SDL_DestroyTexture( mTexture );
+        mTexture = NULL;
+        mWidth = 0;
+        mHeight = 0;
+    }
+}
+
+void LTexture::render( int x, int y, SDL_Rect* clip )
+{
+    //Set rendering space and render to screen
+    SDL_Rect renderQuad = { x, y, mWidth, mHeight };
+
+    //Set clip rendering dimensions
+    if( clip != NULL )
+    {
+        renderQuad.w = clip->w;
+        renderQuad.h = clip->h;
+    }
+
+    //Render to screen
+    SDL_RenderCopy( gRenderer, mTexture, clip, &renderQuad );
+}
+
+int LTexture::getWidth()
+{
+    return mWidth;
+}
+
+int LTexture::getHeight()
+{
+    return mHeight;
+}
+
+LCamera::LCamera()
+{
+    mView.x = 0;
+    mView.y = 0;
+    mView.w = SCREEN_WIDTH;
+    mView.h = SCREEN_HEIGHT;
+}
+
+void LCamera::follow( int x, int y )
+{
+    //Center the camera over the target
+    mView.x = x - SCREEN_WIDTH / 2;
+    mView.y = y - SCREEN_HEIGHT / 2;
+
+    //Keep the camera in bounds
+    if( mView.x < 0 )
+    {
+        mView.x = 0;
+    }
+    if( mView.y < 0 )
+    {
+        mView.y = 0;
+    }
+    if( mView.x > gLevelWidth - mView.w )
+    {
+        mView.x = gLevelWidth - mView.w;
+    }
+    if( mView.y > gLevelHeight - mView.h )
+    {
+        mView.y = gLevelHeight - mView.h;
+    }
+}
+
+const SDL_Rect& LCamera::getView()
+{
+    return mView;
+}
+
+LPropIndex::LPropIndex()
+{
+    //Initialize
+    mCellsX = 0;
+    mCellsY = 0;
+}
+
+void LPropIndex::build( const std::vector<LProp>& props, int levelWidth, int levelHeight )
+{
+    mCellsX = ( levelWidth + INDEX_CELL_SIZE - 1 ) / INDEX_CELL_SIZE;
+    mCellsY = ( levelHeight + INDEX_CELL_SIZE - 1 ) / INDEX_CELL_SIZE;
+
+    //Count the props in each cell
+    mCellStart.assign( mCellsX * mCellsY + 1, 0 );
+    for( size_t i = 0; i < props.size(); ++i )
+    {
+        int cell = ( props[ i ].y / INDEX_CELL_SIZE ) * mCellsX + props[ i ].x / INDEX_CELL_SIZE;
+        ++mCellStart[ cell + 1 ];
+    }
+
+    //Turn counts into start offsets
+    for( int cell = 0; cell < mCellsX * mCellsY; ++cell )
+    {
+        mCellStart[ cell + 1 ] += mCellStart[ cell ];
+    }
+
+    //Place the ids, props stay in level order within a cell
+    std::vector<int> fill( mCellStart.begin(), mCellStart.end() - 1 );
+    mIds.resize( props.size() );
+    for( size_t i = 0; i < props.size(); ++i )
+    {
+        int cell = ( props[ i ].y / INDEX_CELL_SIZE ) * mCellsX + props[ i ].x / INDEX_CELL_SIZE;
+        mIds[ fill[ cell ]++ ] = (int)i;
+    }
+}
+
+int LPropIndex::query( const SDL_Rect& area, std::vector<int>& ids )
+{
+    //Cells covered by the area, clamped to the grid
+    int x1 = area.x / INDEX_CELL_SIZE;
+    int y1 = area.y / INDEX_CELL_SIZE;
+    int x2 = ( area.x + area.w - 1 ) / INDEX_CELL_SIZE;
+    int y2 = ( area.y + area.h - 1 ) / INDEX_CELL_SIZE;
+    if( area.x < 0 )
+    {
+        x1 = 0;
+    }
+    if( area.y < 0 )
+    {
+        y1 = 0;
+    }
+    if( x2 >= mCellsX )
+    {
+        x2 = mCellsX - 1;
+    }
+    if( y2 >= mCellsY )
+    {
+        y2 = mCellsY - 1;
+    }
+
+    int cells = 0;
+    for( int y = y1; y <= y2; ++y )
+    {
+        for( int x = x1; x <= x2; ++x )
+        {
+            int cell = y * mCellsX + x;
+            ids.insert( ids.end(), mIds.begin() + mCellStart[ cell ], mIds.begin() + mCellStart[ cell + 1 ] );
+            ++cells;
+        }
+    }
+
+    return cells;
+}
+
+Dot::Dot()
+{
+    //Initialize the offsets
+    mPosX = 0;
+    mPosY = 0;
+
+    //Initialize the velocity
+    mVelX = 0;
+    mVelY = 0;
+}
+
+void Dot::handleEvent( SDL_Event& e )
+{
+    //If a key was pressed
+    if( e.type == SDL_KEYDOWN && e.key.repeat == 0 )
+    {
+        //Adjust the velocity
+        switch( e.key.keysym.sym )
+        {
+            case SDLK_UP: mVelY -= DOT_VEL; break;
+            case SDLK_DOWN: mVelY += DOT_VEL; break;
+            case SDLK_LEFT: mVelX -= DOT_VEL; break;
+            case SDLK_RIGHT: mVelX += DOT_VEL; break;
+        }
+    }
+    //If a key was released
+    else if( e.type == SDL_KEYUP && e.key.repeat == 0 )
+    {
+        //Adjust the velocity
+        switch( e.key.keysym.sym )
+        {
+            case SDLK_UP: mVelY += DOT_VEL; break;
+            case SDLK_DOWN: mVelY -= DOT_VEL; break;
+            case SDLK_LEFT: mVelX += DOT_VEL; break;
+            case SDLK_RIGHT: mVelX -= DOT_VEL; break;
+        }
+    }
+}
+
+void Dot::move()
+{
+    //Move the dot left or right
+    mPosX += mVelX;
+
+    //If the dot went too far to the left or right
+    if( ( mPosX < 0 ) || ( mPosX + DOT_WIDTH > gLevelWidth ) )
+    {
+        //Move back
+        mPosX -= mVelX;
+    }
+
+    //Move the dot up or down
+    mPosY += mVelY;
+
+    //If the dot went too far up or down
+    if( ( mPosY < 0 ) || ( mPosY + DOT_HEIGHT > gLevelHeight ) )
+    {
+        //Move back
+        mPosY -= mVelY;
+    }
+}
+
+void Dot::render( int camX, int camY )
+{
+    //Show the dot relative to the camera
+    gDotTexture.render( mPosX - camX, mPosY - camY );
+}
+
+int Dot::getPosX()
+{
+    return mPosX;
+}
+
+int Dot::getPosY()
+{
+    return mPosY;
+}
+
+bool init()
+{
+    //Initialization flag
+    bool success = true;
+
+    //Initialize SDL
+    if( SDL_Init( SDL_INIT_VIDEO ) < 0 )
+    {
+        printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+        success = false;
+    }
+    else
+    {
+        //Set texture filtering to linear
+        if( !SDL_SetHint( SDL_HINT_RENDER_SCALE_QUALITY, "1" ) )
+        {
+            printf( "Warning: Linear texture filtering not enabled!" );
+        }
+
+        //Create window
+        gWindow = SDL_CreateWindow( "SDL Tutorial", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN );
+        if( gWindow == NULL )
+        {
+            printf( "Window could not be created! SDL Error: %s\n", SDL_GetError() );
+            success = false;
+        }
+        else
+        {
+            //Create vsynced renderer for window
+            gRenderer = SDL_CreateRenderer( gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC );
+            if( gRenderer == NULL )
+            {
+                printf( "Renderer could not be created! SDL Error: %s\n", SDL_GetError() );
+                success = false;
+            }
+            else
+            {
+                //Initialize renderer color
+                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+
+                //Initialize PNG loading
+                int imgFlags = IMG_INIT_PNG;
+                if( !( IMG_Init( imgFlags ) & imgFlags ) )
+                {
+                    printf( "SDL_image could not initialize! SDL_image Error: %s\n", IMG_GetError() );
+                    success = false;
+                }
+            }
+        }
+    }
+
+    return success;
+}
+
+bool loadMedia()
+{
+    //Loading success flag
+    bool success = true;
+
+    //Load dot texture
+    if( !gDotTexture.loadFromFile( "dot.bmp" ) )
+    {
+        printf( "Failed to load dot texture!\n" );
+        success = false;
+    }
+
+    //Load background texture
+    if( !gBGTexture.loadFromFile( "bg.png" ) )
+    {
+        printf( "Failed to load background texture!\n" );
+        success = false;
+    }
+
+    //Load prop sheet
+    if( !gPropTexture.loadFromFile( "props.png" ) )
+    {
+        printf( "Failed to load prop texture!\n" );
+        success = false;
+    }
+    else
+    {
+        //Props are laid out in a row
+        for( int i = 0; i < TOTAL_PROP_SPRITES; ++i )
+        {
+            gPropClips[ i ].x = i * PROP_WIDTH;
+            gPropClips[ i ].y = 0;
+            gPropClips[ i ].w = PROP_WIDTH;
+            gPropClips[ i ].h = PROP_HEIGHT;
+        }
+    }
+
+    return success;
+}
+
+void placeProps( int count )
+{
+    //Xorshift so placement is the same every run
+    Uint32 state = 2463534242u;
+
+    gProps.resize( count );
+    for( int i = 0; i < count; ++i )
+    {
+        LProp& prop = gProps[ i ];
+
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        prop.x = state % ( gLevelWidth - PROP_WIDTH );
+
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        prop.y = state % ( gLevelHeight - PROP_HEIGHT );
+
+        prop.type = i % TOTAL_PROP_SPRITES;
+    }
+
+    gPropIndex.build( gProps, gLevelWidth, gLevelHeight );
+}
+
+void close()
+{
+    //Free loaded images
+    gDotTexture.free();
+    gBGTexture.free();
+    gPropTexture.free();
+
+    //Destroy window
+    SDL_DestroyRenderer( gRenderer );
+    SDL_DestroyWindow( gWindow );
+    gWindow = NULL;
+    gRenderer = NULL;
+
+    //Quit SDL subsystems
+    IMG_Quit();
+    SDL_Quit();
+}
+
+int main( int argc, char* args[] )
+{
+    //Check for level size and prop count options
+    int propCount = -1;
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( args[ i ], "--level" ) == 0 && i + 2 < argc )
+        {
+            gLevelWidth = atoi( args[ ++i ] );
+            gLevelHeight = atoi( args[ ++i ] );
+        }
+        else if( strcmp( args[ i ], "--props" ) == 0 && i + 1 < argc )
+        {
+            propCount = atoi( args[ ++i ] );
+        }
+    }
+
+    //The level must at least fill the screen
+    if( gLevelWidth < SCREEN_WIDTH )
+    {
+        gLevelWidth = SCREEN_WIDTH;
+    }
+    if( gLevelHeight < SCREEN_HEIGHT )
+    {
+        gLevelHeight = SCREEN_HEIGHT;
+    }
+
+    //Default to one prop per spacing square, computed wide since huge levels overflow an int
+    if( propCount < 0 )
+    {
+        Uint64 area = (Uint64)gLevelWidth * gLevelHeight;
+        Uint64 spacing = (Uint64)PROP_SPACING * PROP_SPACING;
+        propCount = area / spacing > (Uint64)MAX_PROPS ? MAX_PROPS : (int)( area / spacing );
+    }
+    if( propCount > MAX_PROPS )
+    {
+        propCount = MAX_PROPS;
+    }
+
+    //Start up SDL and create window
+    if( !init() )
+    {
+        printf( "Failed to initialize!\n" );
+    }
+    else
+    {
+        //Load media
+        if( !loadMedia() )
+        {
+            printf( "Failed to load media!\n" );
+        }
+        else
+        {
+            //Build the level
+            placeProps( propCount );
+            printf( "Level %dx%d with %d props\n", gLevelWidth, gLevelHeight, propCount );
+
+            //Main loop flag
+            bool quit = false;
+
+            //Event handler
+            SDL_Event e;
+
+            //The dot that will be moving around on the screen
+            Dot dot;
+
+            //The camera area
+            LCamera camera;
+
+            //Props found near the camera this frame
+            std::vector<int> visible;
+
+            //Culling statistics
+            Uint32 frames = 0;
+            Uint32 candidates = 0;
+            Uint32 drawn = 0;
+            Uint32 cellsVisited = 0;
+            Uint32 reportStart = SDL_GetTicks();
+
+            //While application is running
+            while( !quit )
+            {
+                //Handle events on queue
+                while( SDL_PollEvent( &e ) != 0 )
+                {
+                    //User requests quit
+                    if( e.type == SDL_QUIT )
+                    {
+                        quit = true;
+                    }
+
+                    //Handle input for the dot
+                    dot.handleEvent( e );
+                }
+
+                //Move the dot
+                dot.move();
+
+                //Center the camera over the dot
+                camera.follow( dot.getPosX() + Dot::DOT_WIDTH / 2, dot.getPosY() + Dot::DOT_HEIGHT / 2 );
+                const SDL_Rect& view = camera.getView();
+
+                //Clear screen
+                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+                SDL_RenderClear( gRenderer );
+
+                //Render the background tiles under the camera, the image repeats over big levels
+                int bgWidth = gBGTexture.getWidth();
+                int bgHeight = gBGTexture.getHeight();
+                for( int y = view.y / bgHeight * bgHeight; y < view.y + view.h; y += bgHeight )
+                {
+                    for( int x = view.x / bgWidth * bgWidth; x < view.x + view.w; x += bgWidth )
+                    {
+                        gBGTexture.render( x - view.x, y - view.y );
+                    }
+                }
+
+                //Ask the index for props near the view instead of walking the whole level
+                SDL_Rect area = { view.x - CULL_MARGIN, view.y - CULL_MARGIN, view.w + CULL_MARGIN, view.h + CULL_MARGIN };
+                visible.clear();
+                cellsVisited += gPropIndex.query( area, visible );
+                candidates += visible.size();
+
+                //Render the props that actually overlap the view
+                for( size_t i = 0; i < visible.size(); ++i )
+                {
+                    const LProp& prop = gProps[ visible[ i ] ];
+                    SDL_Rect box = { prop.x, prop.y, PROP_WIDTH, PROP_HEIGHT };
+                    if( SDL_HasIntersection( &box, &view ) )
+                    {
+                        gPropTexture.render( prop.x - view.x, prop.y - view.y, &gPropClips[ prop.type ] );
+                        ++drawn;
+                    }
+                }
+
+                //Render objects
+                dot.render( view.x, view.y );
+
+                //Update screen
+                SDL_RenderPresent( gRenderer );
+
+                //Report frame rate and culling work periodically
+                ++frames;
+                if( SDL_GetTicks() - reportStart >= CULL_REPORT_MS )
+                {
+                    printf( "%.1f FPS, per frame: %.1f cells, %.1f candidates, %.1f props drawn of %d\n",
+                        frames * 1000.0 / ( SDL_GetTicks() - reportStart ), (double)cellsVisited / frames,
+                        (double)candidates / frames, (double)drawn / frames, (int)gProps.size() );
+                    frames = 0;
+                    candidates = 0;
+                    drawn = 0;
+                    cellsVisited = 0;
+                    reportStart = SDL_GetTicks();
+                }
+            }
+        }
+    }
+
+    //Free resources and close SDL
+    close();
 
     return 0;
 }
@@ -1,7 +1,781 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
 
-int main(int argc, char* args[]) {
-    puts("Not done yet.");
+//Texture wrapper class
+class LTexture
+{
+    public:
+        //Initializes variables
+        LTexture();
+
+        //Deallocates memory
+        ~LTexture();
+
+        //Loads image at specified path
+        bool loadFromFile( std::string path );
+
+        //Creates texture from a surface, which stays owned by the caller
+        bool loadFromSurface( SDL_Surface* surface );
+
+        //Deallocates texture
+        void free();
+
+        //Set blending
+        void setBlendMode( SDL_BlendMode blending );
+
+        //Renders texture at given point
+        void render( int x, int y, SDL_Rect* clip = NULL );
+
+        //Gets image dimensions
+        int getWidth();
+        int getHeight();
+
+    private:
+        //The actual hardware texture
+        SDL_Texture* mTexture;
+
+        //Image dimensions
+        int mWidth;
+        int mHeight;
+};
+
+//Background layers composed off the main thread and scrolled at different rates
+class LParallax
+{
+    public:
+        //Initializes variables
+        LParallax();
+
+        //Deallocates memory
+        ~LParallax();
+
+        //Starts composing the given number of layers, in the background unless told otherwise
+        bool start( int count, bool background );
+
+        //Turns layers the composer finished into textures
+        void upload();
+
+        //Advances every layer by its own rate
+        void scroll( float seconds );
+
+        //Draws the uploaded layers back to front, returns the number of copies
+        int render();
+
+        //Gets how many layers are ready to draw
+        int getUploadedCount();
+
+        //Stops the composer and frees the layers
+        void free();
+
+    private:
+        //Composer thread entry, data is the parallax
+        static int composeThread( void* data );
+
+        //Draws one layer into a new surface
+        SDL_Surface* composeLayer( int index );
+
+        //Layer textures and scroll positions
+        LTexture mTextures[ 16 ];
+        float mOffsets[ 16 ];
+        float mSpeeds[ 16 ];
+        int mCount;
+        int mUploaded;
+
+        //Surfaces handed from the composer, valid up to the composed count
+        SDL_Surface* mSurfaces[ 16 ];
+        SDL_atomic_t mComposed;
+        SDL_atomic_t mCancel;
+        SDL_Thread* mComposer;
+};
+
+//The dot that will move around on the screen
+class Dot
+{
+    public:
+        //The dimensions of the dot
+        static const int DOT_WIDTH = 20;
+        static const int DOT_HEIGHT = 20;
+
+        //Maximum axis velocity of the dot
+        static const int DOT_VEL = 10;
+
+        //Initializes the variables
+        Dot();
+
+        //Takes key presses and adjusts the dot's velocity
+        void handleEvent( SDL_Event& e );
+
+        //Moves the dot
+        void move();
+
+        //Shows the dot on the screen
+        void render();
+
+    private:
+        //The X and Y offsets of the dot
+        int mPosX, mPosY;
+
+        //The velocity of the dot
+        int mVelX, mVelY;
+};
+
+//Screen dimension constants
+const int SCREEN_WIDTH = 640;
+const int SCREEN_HEIGHT = 480;
+
+//Layer limits, every layer is one screen so two copies always cover the wrap
+const int MAX_LAYERS = 16;
+const int DEFAULT_LAYERS = 5;
+const int LAYER_WIDTH = SCREEN_WIDTH;
+const int LAYER_HEIGHT = SCREEN_HEIGHT;
+
+//Scroll rates of the farthest and nearest layers in pixels per second
+const float FAR_LAYER_SPEED = 8.f;
+const float NEAR_LAYER_SPEED = 240.f;
+
+//Milliseconds between performance reports
+const Uint32 PARALLAX_REPORT_MS = 5000;
+
+//Starts up SDL and creates window
+bool init();
+
+//Loads media
+bool loadMedia();
+
+//Frees media and shuts down SDL
+void close();
+
+//The window we'll be rendering to
+SDL_Window* gWindow = NULL;
+
+//The window renderer
+SDL_Renderer* gRenderer = NULL;
+
+//Scene textures
+LTexture gDotTexture;
+
+//Scrolling background
+LParallax gParallax;
+
+LTexture::LTexture()
+{
+    //Initialize
+    mTexture = NULL;
+    mWidth = 0;
+    mHeight = 0;
+}
+
+LTexture::~LTexture()
+{
+    //Deallocate
+    free();
+}
+
+bool LTexture::loadFromFile( std::string path )
+{
+    //Get rid of preexisting texture
+    free();
+
+    //Load image at specified path
+    SDL_Surface* loadedSurface = IMG_Load( path.c_str() );
+    if( loadedSurface == NULL )
+    {
+        printf( "Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError() );
+    }
+    else
+    {
+        //Color key image
+        SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 0, 0xFF, 0xFF ) );
+
+        //Create texture from surface pixels
+        if( !loadFromSurface( loadedSurface ) )
+        {
+            printf( "Unable to create texture from %s!\n", path.c_str() );
+        }
+
+        //Get rid of old loaded surface
+        SDL_FreeSurface( loadedSurface );
+    }
+
+    //Return success
+    return mTexture != NULL;
+}
+
+bool LTexture::loadFromSurface( SDL_Surface* surface )
+{
+    //Get rid of preexisting texture
+    free();
+
+    //Create texture from surface pixels
+    mTexture = SDL_CreateTextureFromSurface( gRenderer, surface );
+    if( mTexture == NULL )
+    {
+        printf( "Unable to create texture from surface! SDL Error: %s\n", SDL_GetError() );
+    }
+    else
+    {
+        //Get image dimensions
+        mWidth = surface->w;
+        mHeight = surface->h;
+    }
+
+    return mTexture != NULL;
+}
+
+void LTexture::free()
+{
+    //Free texture if it exists
+    if( mTexture != NULL )
+    {
+        SDL_DestroyTexture( mTexture );
+        mTexture = NULL;
+        mWidth = 0;
+        mHeight = 0;
+    }
+}
+
+void LTexture::setBlendMode( SDL_BlendMode blending )
+{
+    //Set blending function
+    SDL_SetTextureBlendMode( mTexture, blending );
+}
+
+void LTexture::render( int x, int y, SDL_Rect* clip )
+{
+    //Set rendering space and render to screen
+    SDL_Rect renderQuad = { x, y, mWidth, mHeight };
+
+    //Set clip rendering dimensions
+    if( clip != NULL )
+    {
+        renderQuad.w = clip->w;
+        renderQuad.h = clip->h;
+    }
+
+    //Render to screen
+    SDL_RenderCopy( gRenderer, mTexture, clip, &renderQuad );
+}
+
+int LTexture::getWidth()
+{
+    return mWidth;
+}
+
+int LTexture::getHeight()
+{
+    return mHeight;
+}
+
+LParallax::LParallax()
+{
+    //Initialize
+    mCount = 0;
+    mUploaded = 0;
+    mComposer = NULL;
+    SDL_AtomicSet( &mComposed, 0 );
+    SDL_AtomicSet( &mCancel, 0 );
+    for( int i = 0; i < MAX_LAYERS; ++i )
+    {
+        mSurfaces[ i ] = NULL;
+        mOffsets[ i ] = 0.f;
+        mSpeeds[ i ] = 0.f;
+    }
+}
+
+LParallax::~LParallax()
+{
+    //Deallocate
+    free();
+}
+
+bool LParallax::start( int count, bool background )
+{
+    //Get rid of preexisting layers
+    free();
+
+    mCount = count;
+    SDL_AtomicSet( &mComposed, 0 );
+    SDL_AtomicSet( &mCancel, 0 );
+
+    //Farther layers scroll slower, spaced evenly between the two rates
+    for( int i = 0; i < mCount; ++i )
+    {
+        float depth = mCount > 1 ? (float)i / ( mCount - 1 ) : 1.f;
+        mSpeeds[ i ] = FAR_LAYER_SPEED + ( NEAR_LAYER_SPEED - FAR_LAYER_SPEED ) * depth * depth;
+        mOffsets[ i ] = 0.f;
+    }
+
+    //Compose right away if asked, the layers are ready on the first frame
+    if( !background )
+    {
+        composeThread( this );
+        return true;
+    }
+
+    mComposer = SDL_CreateThread( composeThread, "Compose", this );
+    if( mComposer == NULL )
+    {
+        printf( "Unable to create composer thread! SDL Error: %s\n", SDL_GetError() );
+        return false;
+    }
+
+    return true;
+}
+
+int LParallax::composeThread( void* data )
+{
+    LParallax* parallax = (LParallax*)data;
+
+    //Back to front so the sky shows up first
+    for( int i = 0; i < parallax->mCount && !SDL_AtomicGet( &parallax->mCancel ); ++i )
+    {
+        parallax->mSurfaces[ i ] = parallax->composeLayer( i );
+
+        //Make the surface visible before the count
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet( &parallax->mComposed, i + 1 );
+    }
+
+    return 0;
+}
+
+SDL_Surface* LParallax::composeLayer( int index )
+{
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat( 0, LAYER_WIDTH, LAYER_HEIGHT, 32, SDL_PIXELFORMAT_RGBA8888 );
+    if( surface == NULL )
+    {
+        return NULL;
+    }
+
+    Uint32* pixels = (Uint32*)surface->pixels;
+    int pitch = surface->pitch / 4;
+
+    //Xorshift seeded per layer so every run looks the same
+    Uint32 state = 2463534242u + index * 747796405u;
+
+    if( index == 0 )
+    {
+        //Sky gradient from deep blue at the top to dusk at the horizon
+        for( int y = 0; y < LAYER_HEIGHT; ++y )
+        {
+            float t = (float)y / LAYER_HEIGHT;
+            Uint32 color = SDL_MapRGBA( surface->format, (Uint8)( 20 + 200 * t ), (Uint8)( 30 + 90 * t ), (Uint8)( 90 + 60 * t ), 0xFF );
+            for( int x = 0; x < LAYER_WIDTH; ++x )
+            {
+                pixels[ y * pitch + x ] = color;
+            }
+        }
+
+        //Stars in the upper half
+        Uint32 star = SDL_MapRGBA( surface->format, 0xFF, 0xFF, 0xE0, 0xFF );
+        for( int i = 0; i < 200; ++i )
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            pixels[ ( state / LAYER_WIDTH % ( LAYER_HEIGHT / 2 ) ) * pitch + state % LAYER_WIDTH ] = star;
+        }
+
+        return surface;
+    }
+
+    //Ridges get lower, darker and rougher towards the front
+    float depth = mCount > 1 ? (float)( index - 1 ) / ( mCount > 2 ? mCount - 2 : 1 ) : 1.f;
+    float baseline = LAYER_HEIGHT * ( 0.45f + 0.4f * depth );
+    float amplitude = 70.f - 30.f * depth;
+    Uint8 shade = (Uint8)( 150 - 120 * depth );
+
+    //Whole numbers of waves across the layer so its edges meet when wrapped
+    float phases[ 3 ];
+    for( int k = 0; k < 3; ++k )
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        phases[ k ] = ( state % 6283 ) / 1000.f;
+    }
+
+    //Transparent above the ridge, shaded towards the bottom below it
+    for( int x = 0; x < LAYER_WIDTH; ++x )
+    {
+        float angle = 2.f * (float)M_PI * x / LAYER_WIDTH;
+        float ridge = baseline - amplitude * ( 0.6f * sinf( angle * 2 + phases[ 0 ] ) + 0.3f * sinf( angle * 5 + phases[ 1 ] ) + 0.1f * sinf( angle * 13 + phases[ 2 ] ) );
+        for( int y = 0; y < LAYER_HEIGHT; ++y )
+        {
+            if( y < ridge )
+            {
+                pixels[ y * pitch + x ] = 0;
+            }
+            else
+            {
+                float fade = 1.f - 0.5f * ( y - ridge ) / ( LAYER_HEIGHT - ridge + 1.f );
+                pixels[ y * pitch + x ] = SDL_MapRGBA( surface->format, (Uint8)( shade * 0.6f * fade ), (Uint8)( shade * fade ), (Uint8)( shade * 0.8f * fade ), 0xFF );
+            }
+        }
+    }
+
+    return surface;
+}
+
+void LParallax::upload()
+{
+    //Nothing new unless the composer moved on
+    int composed = SDL_AtomicGet( &mComposed );
+    if( composed == mUploaded )
+    {
+        return;
+    }
+    SDL_MemoryBarrierAcquire();
+
+    for( int i = mUploaded; i < composed; ++i )
+    {
+        if( mSurfaces[ i ] != NULL )
+        {
+            mTextures[ i ].loadFromSurface( mSurfaces[ i ] );
+            SDL_FreeSurface( mSurfaces[ i ] );
+            mSurfaces[ i ] = NULL;
+
+            //The sky covers the screen, nothing under it needs blending
+            mTextures[ i ].setBlendMode( i == 0 ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND );
+        }
+    }
+    mUploaded = composed;
+}
+
+void LParallax::scroll( float seconds )
+{
+    for( int i = 0; i < mCount; ++i )
+    {
+        mOffsets[ i ] += mSpeeds[ i ] * seconds;
+        mOffsets[ i ] = fmodf( mOffsets[ i ], (float)LAYER_WIDTH );
+    }
+}
+
+int LParallax::render()
+{
+    int copies = 0;
+    for( int i = 0; i < mUploaded; ++i )
+    {
+        //The layer and the copy that wraps in behind it
+        int offset = (int)mOffsets[ i ];
+        mTextures[ i ].render( -offset, 0 );
+        ++copies;
+        if( offset > 0 )
+        {
+            mTextures[ i ].render( LAYER_WIDTH - offset, 0 );
+            ++copies;
+        }
+    }
+
+    return copies;
+}
+
+int LParallax::getUploadedCount()
+{
+    return mUploaded;
+}
+
+void LParallax::free()
+{
+    //Stop the composer before touching its surfaces
+    if( mComposer != NULL )
+    {
+        SDL_AtomicSet( &mCancel, 1 );
+        SDL_WaitThread( mComposer, NULL );
+        mComposer = NULL;
+    }
+
+    for( int i = 0; i < MAX_LAYERS; ++i )
+    {
+        if( mSurfaces[ i ] != NULL )
+        {
+            SDL_FreeSurface( mSurfaces[ i ] );
+            mSurfaces[ i ] = NULL;
+        }
+        mTextures[ i ].free();
+    }
+    mCount = 0;
+    mUploaded = 0;
+}
+
+Dot::Dot()
+{
+    //Initialize the offsets
+    mPosX = 0;
+    mPosY = 0;
+
+    //Initialize the velocity
+    mVelX = 0;
+    mVelY = 0;
+}
+
+void Dot::handleEvent( SDL_Event& e )
+{
+    //If a key was pressed
+    if( e.type == SDL_KEYDOWN && e.key.repeat == 0 )
+    {
+        //Adjust the velocity
+        switch( e.key.keysym.sym )
+        {
+            case SDLK_UP: mVelY -= DOT_VEL; break;
+            case SDLK_DOWN: mVelY += DOT_VEL; break;
+            case SDLK_LEFT: mVelX -= DOT_VEL; break;
+            case SDLK_RIGHT: mVelX += DOT_VEL; break;
+        }
+    }
+    //If a key was released
+    else if( e.type == SDL_KEYUP && e.key.repeat == 0 )
+    {
+        //Adjust the velocity
+        switch( e.key.keysym.sym )
+        {
+            case SDLK_UP: mVelY += DOT_VEL; break;
+            case SDLK_DOWN: mVelY -= DOT_VEL; break;
+            case SDLK_LEFT: mVelX += DOT_VEL; break;
+            case SDLK_RIGHT: mVelX -= DOT_VEL; break;
+        }
+    }
+}
+
+void Dot::move()
+{
+    //Move the dot left or right
+    mPosX += mVelX;
+
+    //If the dot went too far to the left or right
+    if( ( mPosX < 0 ) || ( mPosX + DOT_WIDTH > SCREEN_WIDTH ) )
+    {
+        //Move back
+        mPosX -= mVelX;
+    }
+
+    //Move the dot up or down
+    mPosY += mVelY;
+
+    //If the dot went too far up or down
+    if( ( mPosY < 0 ) || ( mPosY + DOT_HEIGHT > SCREEN_HEIGHT ) )
+    {
+        //Move back
+        mPosY -= mVelY;
+    }
+}
+
+void Dot::render()
+{
+    //Show the dot
+    gDotTexture.render( mPosX, mPosY );
+}
+
+bool init()
+{
+    //Initialization flag
+    bool success = true;
+
+    //Initialize SDL
+    if( SDL_Init( SDL_INIT_VIDEO ) < 0 )
+    {
+        printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+        success = false;
+    }
+    else
+    {
+        //Set texture filtering to linear
+        if( !SDL_SetHint( SDL_HINT_RENDER_SCALE_QUALITY, "1" ) )
+        {
+            printf( "Warning: Linear texture filtering not enabled!" );
+        }
+
+        //Create window
+        gWindow = SDL_CreateWindow( "SDL Tutorial", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN );
+        if( gWindow == NULL )
+        {
+            printf( "Window could not be created! SDL Error: %s\n", SDL_GetError() );
+            success = false;
+        }
+        else
+        {
+            //Create vsynced renderer for window
+            gRenderer = SDL_CreateRenderer( gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC );
+            if( gRenderer == NULL )
+            {
+                printf( "Renderer could not be created! SDL Error: %s\n", SDL_GetError() );
+                success = false;
+            }
+            else
+            {
+                //Initialize renderer color
+                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+
+                //Initialize PNG loading
+                int imgFlags = IMG_INIT_PNG;
+                if( !( IMG_Init( imgFlags ) & imgFlags ) )
+                {
+                    printf( "SDL_image could not initialize! SDL_image Error: %s\n", IMG_GetError() );
+                    success = false;
+                }
+            }
+        }
+    }
+
+    return success;
+}
+
+bool loadMedia()
+{
+    //Loading success flag
+    bool success = true;
+
+    //Load dot texture
+    if( !gDotTexture.loadFromFile( "dot.bmp" ) )
+    {
+        printf( "Failed to load dot texture!\n" );
+        success = false;
+    }
+
+    return success;
+}
+
+void close()
+{
+    //Stop composing and free the layers
+    gParallax.free();
+
+    //Free loaded images
+    gDotTexture.free();
+
+    //Destroy window
+    SDL_DestroyRenderer( gRenderer );
+    SDL_DestroyWindow( gWindow );
+    gWindow = NULL;
+    gRenderer = NULL;
+
+    //Quit SDL subsystems
+    IMG_Quit();
+    SDL_Quit();
+}
+
+int main( int argc, char* args[] )
+{
+    //Check for layer options
+    int layerCount = DEFAULT_LAYERS;
+    bool background = true;
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( args[ i ], "--layers" ) == 0 && i + 1 < argc )
+        {
+            layerCount = atoi( args[ ++i ] );
+        }
+        else if( strcmp( args[ i ], "--sync" ) == 0 )
+        {
+            background = false;
+        }
+    }
+    if( layerCount < 1 )
+    {
+        layerCount = 1;
+    }
+    if( layerCount > MAX_LAYERS )
+    {
+        layerCount = MAX_LAYERS;
+    }
+
+    //Start up SDL and create window
+    if( !init() )
+    {
+        printf( "Failed to initialize!\n" );
+    }
+    else
+    {
+        //Load media
+        if( !loadMedia() )
+        {
+            printf( "Failed to load media!\n" );
+        }
+        else if( !gParallax.start( layerCount, background ) )
+        {
+            printf( "Failed to start composing layers!\n" );
+        }
+        else
+        {
+            //Main loop flag
+            bool quit = false;
+
+            //Event handler
+            SDL_Event e;
+
+            //The dot that will be moving around on the screen
+            Dot dot;
+
+            //Frame timing
+            Uint32 lastTicks = SDL_GetTicks();
+
+            //Performance reporting
+            Uint32 frames = 0;
+            Uint32 copies = 0;
+            Uint32 reportStart = lastTicks;
+
+            //While application is running
+            while( !quit )
+            {
+                //Handle events on queue
+                while( SDL_PollEvent( &e ) != 0 )
+                {
+                    //User requests quit
+                    if( e.type == SDL_QUIT )
+                    {
+                        quit = true;
+                    }
+
+                    //Handle input for the dot
+                    dot.handleEvent( e );
+                }
+
+                //Move the dot
+                dot.move();
+
+                //Pick up layers composed since the last frame and scroll them all
+                Uint32 ticks = SDL_GetTicks();
+                gParallax.upload();
+                gParallax.scroll( ( ticks - lastTicks ) / 1000.f );
+                lastTicks = ticks;
+
+                //Clear screen until the opaque sky covers it
+                if( gParallax.getUploadedCount() == 0 )
+                {
+                    SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+                    SDL_RenderClear( gRenderer );
+                }
+
+                //Render background
+                copies += gParallax.render();
+
+                //Render objects
+                dot.render();
+
+                //Update screen
+                SDL_RenderPresent( gRenderer );
+
+                //Report frame rate and copies periodically
+                ++frames;
+                if( ticks - reportStart >= PARALLAX_REPORT_MS )
+                {
+                    printf( "%.1f FPS, %d/%d layers, %.1f copies per frame\n", frames * 1000.0 / ( ticks - reportStart ),
+                        gParallax.getUploadedCount(), layerCount, (double)copies / frames );
+                    frames = 0;
+                    copies = 0;
+                    reportStart = ticks;
+                }
+            }
+        }
+    }
+
+    //Free resources and close SDL
+    close();
 
     return 0;
 }
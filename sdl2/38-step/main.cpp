@@ -1,7 +1,970 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
-int main(int argc, char* args[]) {
-    puts("Not done yet.");
+//Particle textures, the shimmer is drawn over the colors every other frame
+enum ParticleTextures
+{
+    PARTICLE_TEXTURE_RED,
+    PARTICLE_TEXTURE_GREEN,
+    PARTICLE_TEXTURE_BLUE,
+    PARTICLE_TEXTURE_SHIMMER,
+    PARTICLE_TEXTURE_TOTAL
+};
+
+//Number of particle color textures picked from at random
+const int PARTICLE_COLOR_TOTAL = PARTICLE_TEXTURE_SHIMMER;
+
+class LTexture
+{
+    public:
+        //Initializes variables
+        LTexture();
+
+        //Deallocates memory
+        ~LTexture();
+
+        //Loads image at specified path
+        bool loadFromFile( std::string path );
+
+        //Deallocates texture
+        void free();
+
+        //Set blending
+        void setBlendMode( SDL_BlendMode blending );
+
+        //Set alpha modulation
+        void setAlpha( Uint8 alpha );
+
+        //Renders texture at given point
+        void render( int x, int y, SDL_Rect* clip = NULL );
+
+        //Gets the hardware texture for batched drawing
+        SDL_Texture* getTexture();
+
+        //Gets image dimensions
+        int getWidth();
+        int getHeight();
+
+    private:
+        //The actual hardware texture
+        SDL_Texture* mTexture;
+
+        //Image dimensions
+        int mWidth;
+        int mHeight;
+};
+
+//Fixed capacity pool of particles stored as parallel arrays
+class LParticlePool
+{
+    public:
+        //Initializes variables
+        LParticlePool();
+
+        //Allocates every array up front for the given capacity and particle lifetime in seconds
+        void create( int capacity, float lifetime );
+
+        //Kills every particle
+        void reset();
+
+        //Takes a slot from the free list, returns false when the pool is full
+        bool spawn( float x, float y, float velocityX, float velocityY, int texture );
+
+        //Moves particles, ages them and fades them out, returning dead slots to the free list
+        void integrate( float dt, bool simd = true );
+
+        //Draws live particles with their own textures, plus the shimmer over them if asked
+        void render( bool shimmer );
+
+        //Gets number of live particles
+        int getLiveCount();
+
+        //Gets the highest slot ever used, the range integrate walks
+        int getHighWater();
+
+        //Gets a particle's position for comparing integration paths
+        float getX( int index );
+        float getY( int index );
+
+    private:
+        //Returns a slot to the free list
+        void release( int index );
+
+        //Queues a particle quad into a texture's vertex batch
+        void addQuad( int texture, int index, Uint8 alpha );
+
+        //Particle state, one entry per slot
+        std::vector<float> mX;
+        std::vector<float> mY;
+        std::vector<float> mVelocityX;
+        std::vector<float> mVelocityY;
+        std::vector<float> mLife;
+        std::vector<float> mAlpha;
+        std::vector<Uint8> mTexture;
+
+        //Dead slots below the high water mark
+        std::vector<int> mFreeList;
+
+        //Slots in use so far and currently alive
+        int mHighWater;
+        int mLiveCount;
+
+        //Seconds a particle lives and alpha per second of life left
+        float mLifetime;
+        float mFadeScale;
+
+#if SDL_VERSION_ATLEAST( 2, 0, 18 )
+        //Vertex batch per texture, rebuilt every frame
+        std::vector<SDL_Vertex> mVertices[ PARTICLE_TEXTURE_TOTAL ];
+
+        //Quad indices shared by every batch
+        std::vector<int> mIndices;
+#endif
+};
+
+//The dot that will move around on the screen
+class Dot
+{
+    public:
+        //The dimensions of the dot
+        static const int DOT_WIDTH = 20;
+        static const int DOT_HEIGHT = 20;
+
+        //Maximum axis velocity of the dot
+        static const int DOT_VEL = 10;
+
+        //Initializes the variables and the particle pool
+        Dot( int particles );
+
+        //Takes key presses and adjusts the dot's velocity
+        void handleEvent( SDL_Event& e );
+
+        //Moves the dot
+        void move();
+
+        //Emits new particles and advances the live ones
+        void update( float dt );
+
+        //Shows the dot and its particles on the screen
+        void render();
+
+        //Gets the dot's particle pool
+        LParticlePool& getParticles();
+
+    private:
+        //The X and Y offsets of the dot
+        int mPosX, mPosY;
+
+        //The velocity of the dot
+        int mVelX, mVelY;
+
+        //Live particles kept around the dot
+        LParticlePool mParticles;
+        int mTargetParticles;
+
+        //Fractional particles owed from earlier frames
+        float mSpawnDebt;
+
+        //Shimmer flickers every other frame
+        int mFrame;
+};
+
+//Screen dimension constants
+const int SCREEN_WIDTH = 640;
+const int SCREEN_HEIGHT = 480;
+
+//Particles kept alive around the dot by default
+const int TOTAL_PARTICLES = 20;
+
+//Seconds a particle lives, about 10 frames at 60 FPS
+const float PARTICLE_LIFETIME = 0.16f;
+
+//Fastest a particle drifts in pixels per second
+const float PARTICLE_DRIFT = 40.f;
+
+//Longest step the simulation takes at once
+const float MAX_PARTICLE_STEP = 0.05f;
+
+//Frames simulated and rendered per benchmark pass
+const int BENCHMARK_FRAMES = 300;
+
+//Starts up SDL and creates window
+bool init();
+
+//Loads media
+bool loadMedia();
+
+//Frees media and shuts down SDL
+void close();
+
+//Times integration and rendering of a full pool
+void runParticleBenchmark( int particles );
+
+//The window we'll be rendering to
+SDL_Window* gWindow = NULL;
+
+//The window renderer
+SDL_Renderer* gRenderer = NULL;
+
+//Scene textures
+LTexture gDotTexture;
+LTexture gParticleTextures[ PARTICLE_TEXTURE_TOTAL ];
+
+//State of the particle random generator
+Uint32 gRandomState = 2463534242u;
+
+//Fast xorshift generator, rand() is too slow at hundreds of thousands of spawns per second
+inline Uint32 nextRandom()
+{
+    gRandomState ^= gRandomState << 13;
+    gRandomState ^= gRandomState >> 17;
+    gRandomState ^= gRandomState << 5;
+    return gRandomState;
+}
+
+//Random float from -1 to 1
+inline float randomSigned()
+{
+    return ( nextRandom() & 0xFFFF ) / 32767.5f - 1.f;
+}
+
+LTexture::LTexture()
+{
+    //Initialize
+    mTexture = NULL;
+    mWidth = 0;
+    mHeight = 0;
+}
+
+LTexture::~LTexture()
+{
+    //Deallocate
+    free();
+}
+
+bool LTexture::loadFromFile( std::string path )
+{
+    //Get rid of preexisting texture
+    free();
+
+    //The final texture
+    SDL_Texture* newTexture = NULL;
+
+    //Load image at specified path
+    SDL_Surface* loadedSurface = IMG_Load( path.c_str() );
+    if( loadedSurface == NULL )
+    {
+        printf( "Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError() );
+    }
+    else
+    {
+        //Color key image
+        SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 0, 0xFF, 0xFF ) );
+
+        //Create texture from surface pixels
+        newTexture = SDL_CreateTextureFromSurface( gRenderer, loadedSurface );
+        if( newTexture == NULL )
+        {
+            printf( "Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+        }
+        else
+        {
+            //Get image dimensions
+            mWidth = loadedSurface->w;
+            mHeight = loadedSurface->h;
+        }
+
+        //Get rid of old loaded surface
+        SDL_FreeSurface( loadedSurface );
+    }
+
+    //Return success
+    mTexture = newTexture;
+    return mTexture != NULL;
+}
+
+void LTexture::free()
+{
+    //Free texture if it exists
+    if( mTexture != NULL )
+    {
+        SDL_DestroyTexture( mTexture );
+        mTexture = NULL;
+        mWidth = 0;
+        mHeight = 0;
+    }
+}
+
+void LTexture::setBlendMode( SDL_BlendMode blending )
+{
+    //Set blending function
+    SDL_SetTextureBlendMode( mTexture, blending );
+}
+
+void LTexture::setAlpha( Uint8 alpha )
+{
+    //Modulate texture alpha
+    SDL_SetTextureAlphaMod( mTexture, alpha );
+}
+
+void LTexture::render( int x, int y, SDL_Rect* clip )
+{
+    //Set rendering space and render to screen
+    SDL_Rect renderQuad = { x, y, mWidth, mHeight };
+
+    //Set clip rendering dimensions
+    if( clip != NULL )
+    {
+        renderQuad.w = clip->w;
+        renderQuad.h = clip->h;
+    }
+
+    //Render to screen
+    SDL_RenderCopy( gRenderer, mTexture, clip, &renderQuad );
+}
+
+SDL_Texture* LTexture::getTexture()
+{
+    return mTexture;
+}
+
+int LTexture::getWidth()
+{
+    return mWidth;
+}
+
+int LTexture::getHeight()
+{
+    return mHeight;
+}
+
+LParticlePool::LParticlePool()
+{
+    //Initialize
+    mHighWater = 0;
+    mLiveCount = 0;
+    mLifetime = 1.f;
+    mFadeScale = 255.f;
+}
+
+void LParticlePool::create( int capacity, float lifetime )
+{
+    //Allocate everything now so spawning never touches the heap
+    mX.assign( capacity, 0.f );
+    mY.assign( capacity, 0.f );
+    mVelocityX.assign( capacity, 0.f );
+    mVelocityY.assign( capacity, 0.f );
+    mLife.assign( capacity, 0.f );
+    mAlpha.assign( capacity, 0.f );
+    mTexture.assign( capacity, 0 );
+    mFreeList.clear();
+    mFreeList.reserve( capacity );
+
+    mLifetime = lifetime;
+    mFadeScale = 255.f / lifetime;
+    mHighWater = 0;
+    mLiveCount = 0;
+
+#if SDL_VERSION_ATLEAST( 2, 0, 18 )
+    //Worst case every particle lands in one batch
+    for( int i = 0; i < PARTICLE_TEXTURE_TOTAL; ++i )
+    {
+        mVertices[ i ].clear();
+        mVertices[ i ].reserve( capacity * 4 );
+    }
+
+    //Two triangles per quad
+    mIndices.resize( capacity * 6 );
+    for( int i = 0; i < capacity; ++i )
+    {
+        int* quad = &mIndices[ i * 6 ];
+        quad[ 0 ] = i * 4;
+        quad[ 1 ] = i * 4 + 1;
+        quad[ 2 ] = i * 4 + 2;
+        quad[ 3 ] = i * 4 + 2;
+        quad[ 4 ] = i * 4 + 3;
+        quad[ 5 ] = i * 4;
+    }
+#endif
+}
+
+void LParticlePool::reset()
+{
+    std::fill( mLife.begin(), mLife.end(), 0.f );
+    std::fill( mAlpha.begin(), mAlpha.end(), 0.f );
+    mFreeList.clear();
+    mHighWater = 0;
+    mLiveCount = 0;
+}
+
+bool LParticlePool::spawn( float x, float y, float velocityX, float velocityY, int texture )
+{
+    //Reuse a dead slot before growing into untouched ones
+    int index;
+    if( !mFreeList.empty() )
+    {
+        index = mFreeList.back();
+        mFreeList.pop_back();
+    }
+    else if( mHighWater < (int)mX.size() )
+    {
+        index = mHighWater++;
+    }
+    else
+    {
+        return false;
+    }
+
+    mX[ index ] = x;
+    mY[ index ] = y;
+    mVelocityX[ index ] = velocityX;
+    mVelocityY[ index ] = velocityY;
+    mLife[ index ] = mLifetime;
+    mAlpha[ index ] = 255.f;
+    mTexture[ index ] = texture;
+    ++mLiveCount;
+
+    return true;
+}
+
+void LParticlePool::release( int index )
+{
+    mFreeList.push_back( index );
+    --mLiveCount;
+}
+
+void LParticlePool::integrate( float dt, bool simd )
+{
+    int count = mHighWater;
+    int i = 0;
+
+#ifdef __SSE2__
+    //Four particles at a time; dead slots are integrated too, which is cheaper than skipping them
+    if( simd )
+    {
+        const __m128 step = _mm_set1_ps( dt );
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 fade = _mm_set1_ps( mFadeScale );
+        for( ; i + 4 <= count; i += 4 )
+        {
+            __m128 x = _mm_add_ps( _mm_loadu_ps( &mX[ i ] ), _mm_mul_ps( _mm_loadu_ps( &mVelocityX[ i ] ), step ) );
+            __m128 y = _mm_add_ps( _mm_loadu_ps( &mY[ i ] ), _mm_mul_ps( _mm_loadu_ps( &mVelocityY[ i ] ), step ) );
+            __m128 life = _mm_loadu_ps( &mLife[ i ] );
+            __m128 nextLife = _mm_sub_ps( life, step );
+            __m128 alpha = _mm_mul_ps( _mm_max_ps( nextLife, zero ), fade );
+
+            _mm_storeu_ps( &mX[ i ], x );
+            _mm_storeu_ps( &mY[ i ], y );
+            _mm_storeu_ps( &mLife[ i ], nextLife );
+            _mm_storeu_ps( &mAlpha[ i ], alpha );
+
+            //Lanes that were alive and just ran out go back to the free list
+            int died = _mm_movemask_ps( _mm_and_ps( _mm_cmpgt_ps( life, zero ), _mm_cmple_ps( nextLife, zero ) ) );
+            while( died != 0 )
+            {
+                int lane = __builtin_ctz( died );
+                release( i + lane );
+                died &= died - 1;
+            }
+        }
+    }
+#endif
+
+    //Remaining particles, or all of them without SSE2
+    for( ; i < count; ++i )
+    {
+        mX[ i ] = mX[ i ] + mVelocityX[ i ] * dt;
+        mY[ i ] = mY[ i ] + mVelocityY[ i ] * dt;
+        float life = mLife[ i ];
+        float nextLife = life - dt;
+        mLife[ i ] = nextLife;
+        mAlpha[ i ] = ( nextLife > 0.f ? nextLife : 0.f ) * mFadeScale;
+        if( life > 0.f && nextLife <= 0.f )
+        {
+            release( i );
+        }
+    }
+}
+
+void LParticlePool::addQuad( int texture, int index, Uint8 alpha )
+{
+#if SDL_VERSION_ATLEAST( 2, 0, 18 )
+    float w = (float)gParticleTextures[ texture ].getWidth();
+    float h = (float)gParticleTextures[ texture ].getHeight();
+    float x = mX[ index ];
+    float y = mY[ index ];
+
+    SDL_Vertex vertex;
+    vertex.color.r = 0xFF;
+    vertex.color.g = 0xFF;
+    vertex.color.b = 0xFF;
+    vertex.color.a = alpha;
+
+    //Corners clockwise from the top left
+    std::vector<SDL_Vertex>& batch = mVertices[ texture ];
+    vertex.position.x = x;
+    vertex.position.y = y;
+    vertex.tex_coord.x = 0.f;
+    vertex.tex_coord.y = 0.f;
+    batch.push_back( vertex );
+
+    vertex.position.x = x + w;
+    vertex.tex_coord.x = 1.f;
+    batch.push_back( vertex );
+
+    vertex.position.y = y + h;
+    vertex.tex_coord.y = 1.f;
+    batch.push_back( vertex );
+
+    vertex.position.x = x;
+    vertex.tex_coord.x = 0.f;
+    batch.push_back( vertex );
+#else
+    //No geometry API, draw the particle on its own
+    gParticleTextures[ texture ].setAlpha( alpha );
+    gParticleTextures[ texture ].render( (int)mX[ index ], (int)mY[ index ] );
+#endif
+}
+
+void LParticlePool::render( bool shimmer )
+{
+#if SDL_VERSION_ATLEAST( 2, 0, 18 )
+    for( int i = 0; i < PARTICLE_TEXTURE_TOTAL; ++i )
+    {
+        mVertices[ i ].clear();
+    }
+#endif
+
+    //Colors first, then shimmer over them
+    for( int i = 0; i < mHighWater; ++i )
+    {
+        if( mLife[ i ] > 0.f )
+        {
+            addQuad( mTexture[ i ], i, (Uint8)mAlpha[ i ] );
+        }
+    }
+    if( shimmer )
+    {
+        for( int i = 0; i < mHighWater; ++i )
+        {
+            if( mLife[ i ] > 0.f )
+            {
+                addQuad( PARTICLE_TEXTURE_SHIMMER, i, (Uint8)mAlpha[ i ] );
+            }
+        }
+    }
+
+#if SDL_VERSION_ATLEAST( 2, 0, 18 )
+    //One draw call per texture
+    for( int i = 0; i < PARTICLE_TEXTURE_TOTAL; ++i )
+    {
+        int vertexCount = (int)mVertices[ i ].size();
+        if( vertexCount > 0 )
+        {
+            SDL_RenderGeometry( gRenderer, gParticleTextures[ i ].getTexture(), &mVertices[ i ][ 0 ], vertexCount, &mIndices[ 0 ], vertexCount / 4 * 6 );
+        }
+    }
+#endif
+}
+
+int LParticlePool::getLiveCount()
+{
+    return mLiveCount;
+}
+
+int LParticlePool::getHighWater()
+{
+    return mHighWater;
+}
+
+float LParticlePool::getX( int index )
+{
+    return mX[ index ];
+}
+
+float LParticlePool::getY( int index )
+{
+    return mY[ index ];
+}
+
+Dot::Dot( int particles )
+{
+    //Initialize the offsets
+    mPosX = 0;
+    mPosY = 0;
+
+    //Initialize the velocity
+    mVelX = 0;
+    mVelY = 0;
+
+    //Room for a full lifetime of particles plus one frame of spawns
+    mTargetParticles = particles;
+    mParticles.create( particles + particles / 4 + 4, PARTICLE_LIFETIME );
+    mSpawnDebt = 0.f;
+    mFrame = 0;
+}
+
+void Dot::handleEvent( SDL_Event& e )
+{
+    //If a key was pressed
+    if( e.type == SDL_KEYDOWN && e.key.repeat == 0 )
+    {
+        //Adjust the velocity
+        switch( e.key.keysym.sym )
+        {
+            case SDLK_UP: mVelY -= DOT_VEL; break;
+            case SDLK_DOWN: mVelY += DOT_VEL; break;
+            case SDLK_LEFT: mVelX -= DOT_VEL; break;
+            case SDLK_RIGHT: mVelX += DOT_VEL; break;
+        }
+    }
+    //If a key was released
+    else if( e.type == SDL_KEYUP && e.key.repeat == 0 )
+    {
+        //Adjust the velocity
+        switch( e.key.keysym.sym )
+        {
+            case SDLK_UP: mVelY += DOT_VEL; break;
+            case SDLK_DOWN: mVelY -= DOT_VEL; break;
+            case SDLK_LEFT: mVelX += DOT_VEL; break;
+            case SDLK_RIGHT: mVelX -= DOT_VEL; break;
+        }
+    }
+}
+
+void Dot::move()
+{
+    //Move the dot left or right
+    mPosX += mVelX;
+
+    //If the dot went too far to the left or right
+    if( ( mPosX < 0 ) || ( mPosX + DOT_WIDTH > SCREEN_WIDTH ) )
+    {
+        //Move back
+        mPosX -= mVelX;
+    }
+
+    //Move the dot up or down
+    mPosY += mVelY;
+
+    //If the dot went too far up or down
+    if( ( mPosY < 0 ) || ( mPosY + DOT_HEIGHT > SCREEN_HEIGHT ) )
+    {
+        //Move back
+        mPosY -= mVelY;
+    }
+}
+
+void Dot::update( float dt )
+{
+    //Age the live particles first so their slots are free for this frame's spawns
+    mParticles.integrate( dt );
+
+    //Spawn at the rate that keeps the target count alive
+    mSpawnDebt += mTargetParticles * dt / PARTICLE_LIFETIME;
+    int spawns = (int)mSpawnDebt;
+    mSpawnDebt -= spawns;
+    for( int i = 0; i < spawns; ++i )
+    {
+        //Scatter around the dot like the original particles
+        float x = mPosX - 5 + ( nextRandom() % 25 );
+        float y = mPosY - 5 + ( nextRandom() % 25 );
+        if( !mParticles.spawn( x, y, randomSigned() * PARTICLE_DRIFT, randomSigned() * PARTICLE_DRIFT, nextRandom() % PARTICLE_COLOR_TOTAL ) )
+        {
+            mSpawnDebt = 0.f;
+            break;
+        }
+    }
+}
+
+void Dot::render()
+{
+    //Show the dot
+    gDotTexture.render( mPosX, mPosY );
+
+    //Show particles on top of dot, shimmering every other frame
+    mParticles.render( mFrame % 2 == 0 );
+    ++mFrame;
+}
+
+LParticlePool& Dot::getParticles()
+{
+    return mParticles;
+}
+
+void runParticleBenchmark( int particles )
+{
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    const float dt = 1.f / 60.f;
+
+    //Two identical pools, one integrated with SSE2 and one with plain code
+    LParticlePool pools[ 2 ];
+    Uint64 integrateTicks[ 2 ] = { 0, 0 };
+    for( int p = 0; p < 2; ++p )
+    {
+        pools[ p ].create( particles + particles / 4 + 4, PARTICLE_LIFETIME );
+        gRandomState = 2463534242u;
+
+        float debt = 0.f;
+        for( int frame = 0; frame < BENCHMARK_FRAMES; ++frame )
+        {
+            Uint64 start = SDL_GetPerformanceCounter();
+            pools[ p ].integrate( dt, p == 0 );
+            integrateTicks[ p ] += SDL_GetPerformanceCounter() - start;
+
+            debt += particles * dt / PARTICLE_LIFETIME;
+            int spawns = (int)debt;
+            debt -= spawns;
+            for( int i = 0; i < spawns; ++i )
+            {
+                pools[ p ].spawn( nextRandom() % SCREEN_WIDTH, nextRandom() % SCREEN_HEIGHT,
+                                  randomSigned() * PARTICLE_DRIFT, randomSigned() * PARTICLE_DRIFT, nextRandom() % PARTICLE_COLOR_TOTAL );
+            }
+        }
+    }
+
+    //Both paths must leave every particle in the same place
+    int mismatches = 0;
+    for( int i = 0; i < pools[ 0 ].getHighWater(); ++i )
+    {
+        if( pools[ 0 ].getX( i ) != pools[ 1 ].getX( i ) || pools[ 0 ].getY( i ) != pools[ 1 ].getY( i ) )
+        {
+            ++mismatches;
+        }
+    }
+
+    printf( "%d live particles (%d slots)\n", pools[ 0 ].getLiveCount(), pools[ 0 ].getHighWater() );
+#ifdef __SSE2__
+    printf( "Integrate SSE2:   %.3f ms/frame\n", integrateTicks[ 0 ] * 1000.0 / frequency / BENCHMARK_FRAMES );
+#endif
+    printf( "Integrate scalar: %.3f ms/frame\n", integrateTicks[ 1 ] * 1000.0 / frequency / BENCHMARK_FRAMES );
+    printf( "%d particles differ between paths\n", mismatches );
+
+    //Batch build and submission with shimmer every other frame
+    Uint64 start = SDL_GetPerformanceCounter();
+    for( int frame = 0; frame < BENCHMARK_FRAMES; ++frame )
+    {
+        SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+        SDL_RenderClear( gRenderer );
+        pools[ 0 ].render( frame % 2 == 0 );
+        SDL_RenderPresent( gRenderer );
+    }
+    printf( "Render:           %.3f ms/frame\n", ( SDL_GetPerformanceCounter() - start ) * 1000.0 / frequency / BENCHMARK_FRAMES );
+}
+
+bool init()
+{
+    //Initialization flag
+    bool success = true;
+
+    //Initialize SDL
+    if( SDL_Init( SDL_INIT_VIDEO ) < 0 )
+    {
+        printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+        success = false;
+    }
+    else
+    {
+        //Set texture filtering to linear
+        if( !SDL_SetHint( SDL_HINT_RENDER_SCALE_QUALITY, "1" ) )
+        {
+            printf( "Warning: Linear texture filtering not enabled!" );
+        }
+
+        //Create window
+        gWindow = SDL_CreateWindow( "SDL Tutorial", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN );
+        if( gWindow == NULL )
+        {
+            printf( "Window could not be created! SDL Error: %s\n", SDL_GetError() );
+            success = false;
+        }
+        else
+        {
+            //Create vsynced renderer for window
+            gRenderer = SDL_CreateRenderer( gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC );
+            if( gRenderer == NULL )
+            {
+                printf( "Renderer could not be created! SDL Error: %s\n", SDL_GetError() );
+                success = false;
+            }
+            else
+            {
+                //Initialize renderer color
+                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+
+                //Initialize PNG loading
+                int imgFlags = IMG_INIT_PNG;
+                if( !( IMG_Init( imgFlags ) & imgFlags ) )
+                {
+                    printf( "SDL_image could not initialize! SDL_image Error: %s\n", IMG_GetError() );
+                    success = false;
+                }
+            }
+        }
+    }
+
+    return success;
+}
+
+bool loadMedia()
+{
+    //Loading success flag
+    bool success = true;
+
+    //Load dot texture
+    if( !gDotTexture.loadFromFile( "dot.bmp" ) )
+    {
+        printf( "Failed to load dot texture!\n" );
+        success = false;
+    }
+
+    //Load particle textures
+    const char* paths[ PARTICLE_TEXTURE_TOTAL ] = { "red.bmp", "green.bmp", "blue.bmp", "shimmer.bmp" };
+    for( int i = 0; i < PARTICLE_TEXTURE_TOTAL; ++i )
+    {
+        if( !gParticleTextures[ i ].loadFromFile( paths[ i ] ) )
+        {
+            printf( "Failed to load %s texture!\n", paths[ i ] );
+            success = false;
+        }
+        else
+        {
+            //Particles fade out through alpha
+            gParticleTextures[ i ].setBlendMode( SDL_BLENDMODE_BLEND );
+        }
+    }
+
+    return success;
+}
+
+void close()
+{
+    //Free loaded images
+    gDotTexture.free();
+    for( int i = 0; i < PARTICLE_TEXTURE_TOTAL; ++i )
+    {
+        gParticleTextures[ i ].free();
+    }
+
+    //Destroy window
+    SDL_DestroyRenderer( gRenderer );
+    SDL_DestroyWindow( gWindow );
+    gWindow = NULL;
+    gRenderer = NULL;
+
+    //Quit SDL subsystems
+    IMG_Quit();
+    SDL_Quit();
+}
+
+int main( int argc, char* args[] )
+{
+    //Check for particle count and benchmark options
+    int particles = TOTAL_PARTICLES;
+    bool benchmark = false;
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( args[ i ], "--particles" ) == 0 && i + 1 < argc )
+        {
+            particles = atoi( args[ ++i ] );
+        }
+        else if( strcmp( args[ i ], "--particle-bench" ) == 0 )
+        {
+            benchmark = true;
+            particles = 100000;
+            if( i + 1 < argc && atoi( args[ i + 1 ] ) > 0 )
+            {
+                particles = atoi( args[ ++i ] );
+            }
+        }
+    }
+    if( particles < 1 )
+    {
+        particles = 1;
+    }
+
+    //Start up SDL and create window
+    if( !init() )
+    {
+        printf( "Failed to initialize!\n" );
+    }
+    else
+    {
+        //Load media
+        if( !loadMedia() )
+        {
+            printf( "Failed to load media!\n" );
+        }
+        else if( benchmark )
+        {
+            runParticleBenchmark( particles );
+        }
+        else
+        {
+            //Main loop flag
+            bool quit = false;
+
+            //Event handler
+            SDL_Event e;
+
+            //The dot that will be moving around on the screen
+            Dot dot( particles );
+
+            //Time of the last particle update
+            Uint64 frequency = SDL_GetPerformanceFrequency();
+            Uint64 lastCounter = SDL_GetPerformanceCounter();
+
+            //While application is running
+            while( !quit )
+            {
+                //Handle events on queue
+                while( SDL_PollEvent( &e ) != 0 )
+                {
+                    //User requests quit
+                    if( e.type == SDL_QUIT )
+                    {
+                        quit = true;
+                    }
+
+                    //Handle input for the dot
+                    dot.handleEvent( e );
+                }
+
+                //Move the dot and advance its particles by real time
+                Uint64 now = SDL_GetPerformanceCounter();
+                float dt = (float)( now - lastCounter ) / frequency;
+                lastCounter = now;
+                if( dt > MAX_PARTICLE_STEP )
+                {
+                    dt = MAX_PARTICLE_STEP;
+                }
+                dot.move();
+                dot.update( dt );
+
+                //Clear screen
+                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+                SDL_RenderClear( gRenderer );
+
+                //Render objects
+                dot.render();
+
+                //Update screen
+                SDL_RenderPresent( gRenderer );
+            }
+        }
+    }
+
+    //Free resources and close SDL
+    close();
 
     return 0;
 }
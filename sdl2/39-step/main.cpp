@@ -1,7 +1,967 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
 
-int main(int argc, char* args[]) {
-    puts("Not done yet.");
+//Texture wrapper class
+class LTexture
+{
+    public:
+        //Initializes variables
+        LTexture();
+
+        //Deallocates memory
+        ~LTexture();
+
+        //Loads image at specified path
+        bool loadFromFile( std::string path );
+
+        //Deallocates texture
+        void free();
+
+        //Renders texture at given point
+        void render( int x, int y, SDL_Rect* clip = NULL );
+
+        //Gets image dimensions
+        int getWidth();
+        int getHeight();
+
+    private:
+        //The actual hardware texture
+        SDL_Texture* mTexture;
+
+        //Image dimensions
+        int mWidth;
+        int mHeight;
+};
+
+//Cached render of one chunk of tiles
+struct LChunkSlot
+{
+    //Target texture holding the chunk's tiles
+    SDL_Texture* texture;
+
+    //Chunk held, negative when the slot is empty
+    int chunkX;
+    int chunkY;
+
+    //Whether a tile in the chunk changed since it was drawn
+    bool dirty;
+
+    //Frame the slot was last drawn, for evicting the least recently used
+    Uint32 lastUsed;
+};
+
+//Tile map split into square chunks that are drawn into cached textures
+class LTileMap
+{
+    public:
+        //Initializes variables
+        LTileMap();
+
+        //Deallocates memory
+        ~LTileMap();
+
+        //Allocates a map of the given size in tiles and the chunk cache
+        bool create( int width, int height );
+
+        //Deallocates the map and the chunk cache
+        void free();
+
+        //Fills the map with rooms walled off from each other
+        void generate( Uint32 seed );
+
+        //Gets and sets tile types, setting marks the tile's chunk for redrawing
+        int getTile( int x, int y );
+        void setTile( int x, int y, int type );
+
+        //Gets the map size in pixels
+        int getPixelWidth();
+        int getPixelHeight();
+
+        //Checks whether a box overlaps any wall tile
+        bool touchesWall( const SDL_Rect& box );
+
+        //Draws the part of the map under the camera
+        void render( const SDL_Rect& camera );
+
+        //Drops every cached chunk, e.g. after render targets were lost
+        void invalidateAll();
+
+        //Prints and resets chunk cache statistics
+        void printStats( Uint32 frames );
+
+    private:
+        //Gets the cache slot holding a chunk, drawing it into the least recently used slot if needed
+        LChunkSlot* acquireChunk( int chunkX, int chunkY );
+
+        //Draws a chunk's tiles into a slot's texture
+        void drawChunk( LChunkSlot& slot );
+
+        //Tile types, one byte per tile in rows
+        std::vector<Uint8> mTiles;
+        int mWidth;
+        int mHeight;
+
+        //Cached chunk textures
+        std::vector<LChunkSlot> mSlots;
+        Uint32 mFrame;
+
+        //Statistics
+        Uint32 mChunkDraws;
+        Uint32 mChunkCopies;
+};
+
+//The dot that will move around on the screen
+class Dot
+{
+    public:
+        //The dimensions of the dot
+        static const int DOT_WIDTH = 20;
+        static const int DOT_HEIGHT = 20;
+
+        //Maximum axis velocity of the dot
+        static const int DOT_VEL = 10;
+
+        //Initializes the variables
+        Dot();
+
+        //Places the dot at given point
+        void setPosition( int x, int y );
+
+        //Takes key presses and adjusts the dot's velocity
+        void handleEvent( SDL_Event& e );
+
+        //Moves the dot and check collision against tiles
+        void move( LTileMap& map );
+
+        //Centers the camera over the dot
+        void setCamera( SDL_Rect& camera, LTileMap& map );
+
+        //Shows the dot on the screen
+        void render( SDL_Rect& camera );
+
+    private:
+        //Collision box of the dot
+        SDL_Rect mBox;
+
+        //The velocity of the dot
+        int mVelX, mVelY;
+};
+
+//Screen dimension constants
+const int SCREEN_WIDTH = 640;
+const int SCREEN_HEIGHT = 480;
+
+//Tile constants
+const int TILE_WIDTH = 80;
+const int TILE_HEIGHT = 80;
+const int TOTAL_TILE_SPRITES = 12;
+
+//The different tile sprites
+const int TILE_RED = 0;
+const int TILE_GREEN = 1;
+const int TILE_BLUE = 2;
+const int TILE_CENTER = 3;
+const int TILE_TOP = 4;
+const int TILE_TOPRIGHT = 5;
+const int TILE_RIGHT = 6;
+const int TILE_BOTTOMRIGHT = 7;
+const int TILE_BOTTOM = 8;
+const int TILE_BOTTOMLEFT = 9;
+const int TILE_LEFT = 10;
+const int TILE_TOPLEFT = 11;
+
+//Default map size in tiles
+const int DEFAULT_MAP_WIDTH = 16;
+const int DEFAULT_MAP_HEIGHT = 12;
+
+//Tiles per chunk side, a chunk is as wide as the screen
+const int CHUNK_TILES = 8;
+const int CHUNK_WIDTH = CHUNK_TILES * TILE_WIDTH;
+const int CHUNK_HEIGHT = CHUNK_TILES * TILE_HEIGHT;
+
+//Chunk textures kept around, the screen never needs more than four at once
+const int CHUNK_CACHE_SLOTS = 12;
+
+//Room size in tiles for generated maps
+const int ROOM_WIDTH = 10;
+const int ROOM_HEIGHT = 8;
+
+//Milliseconds between performance reports
+const Uint32 MAP_REPORT_MS = 5000;
+
+//Starts up SDL and creates window
+bool init( bool software );
+
+//Loads media
+bool loadMedia();
+
+//Frees media and shuts down SDL
+void close();
+
+//The window we'll be rendering to
+SDL_Window* gWindow = NULL;
+
+//The window renderer
+SDL_Renderer* gRenderer = NULL;
+
+//Scene textures
+LTexture gDotTexture;
+LTexture gTileTexture;
+SDL_Rect gTileClips[ TOTAL_TILE_SPRITES ];
+
+//The level
+LTileMap gMap;
+
+LTexture::LTexture()
+{
+    //Initialize
+    mTexture = NULL;
+    mWidth = 0;
+    mHeight = 0;
+}
+
+LTexture::~LTexture()
+{
+    //Deallocate
+    free();
+}
+
+bool LTexture::loadFromFile( std::string path )
+{
+    //Get rid of preexisting texture
+    free();
+
+    //The final texture
+    SDL_Texture* newTexture = NULL;
+
+    //Load image at specified path
+    SDL_Surface* loadedSurface = IMG_Load( path.c_str() );
+    if( loadedSurface == NULL )
+    {
+        printf( "Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError() );
+    }
+    else
+    {
+        //Color key image
+        SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 0, 0xFF, 0xFF ) );
+
+        //Create texture from surface pixels
+        newTexture = SDL_CreateTextureFromSurface( gRenderer, loadedSurface );
+        if( newTexture == NULL )
+        {
+            printf( "Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+        }
+        else
+        {
+            //Get image dimensions
+            mWidth = loadedSurface->w;
+            mHeight = loadedSurface->h;
+        }
+
+        //Get rid of old loaded surface
+        SDL_FreeSurface( loadedSurface );
+    }
+
+    //Return success
+    mTexture = newTexture;
+    return mTexture != NULL;
+}
+
+void LTexture::free()
+{
+    //Free texture if it exists
+    if( mTexture != NULL )
+    {
+        SDL_DestroyTexture( mTexture );
+        mTexture = NULL;
+        mWidth = 0;
+        mHeight = 0;
+    }
+}
+
+void LTexture::render( int x, int y, SDL_Rect* clip )
+{
+    //Set rendering space and render to screen
+    SDL_Rect renderQuad = { x, y, mWidth, mHeight };
+
+    //Set clip rendering dimensions
+    if( clip != NULL )
+    {
+        renderQuad.w = clip->w;
+        renderQuad.h = clip->h;
+    }
+
+    //Render to screen
+    SDL_RenderCopy( gRenderer, mTexture, clip, &renderQuad );
+}
+
+int LTexture::getWidth()
+{
+    return mWidth;
+}
+
+int LTexture::getHeight()
+{
+    return mHeight;
+}
+
+LTileMap::LTileMap()
+{
+    //Initialize
+    mWidth = 0;
+    mHeight = 0;
+    mFrame = 0;
+    mChunkDraws = 0;
+    mChunkCopies = 0;
+}
+
+LTileMap::~LTileMap()
+{
+    //Deallocate
+    free();
+}
+
+bool LTileMap::create( int width, int height )
+{
+    //Get rid of preexisting map
+    free();
+
+    mWidth = width;
+    mHeight = height;
+    mTiles.assign( width * height, TILE_RED );
+
+    //Chunks are drawn into render targets
+    if( !SDL_RenderTargetSupported( gRenderer ) )
+    {
+        printf( "Render targets not supported!\n" );
+        return false;
+    }
+
+    //Create the chunk cache
+    mSlots.resize( CHUNK_CACHE_SLOTS );
+    for( int i = 0; i < CHUNK_CACHE_SLOTS; ++i )
+    {
+        LChunkSlot& slot = mSlots[ i ];
+        slot.chunkX = -1;
+        slot.chunkY = -1;
+        slot.dirty = false;
+        slot.lastUsed = 0;
+        slot.texture = SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, CHUNK_WIDTH, CHUNK_HEIGHT );
+        if( slot.texture == NULL )
+        {
+            printf( "Unable to create chunk texture! SDL Error: %s\n", SDL_GetError() );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void LTileMap::free()
+{
+    //Free chunk textures
+    for( size_t i = 0; i < mSlots.size(); ++i )
+    {
+        if( mSlots[ i ].texture != NULL )
+        {
+            SDL_DestroyTexture( mSlots[ i ].texture );
+        }
+    }
+    mSlots.clear();
+
+    mTiles.clear();
+    mWidth = 0;
+    mHeight = 0;
+}
+
+void LTileMap::generate( Uint32 seed )
+{
+    //Xorshift keeps generation fast on maps with millions of tiles
+    Uint32 state = seed != 0 ? seed : 1;
+
+    for( int roomY = 0; roomY * ROOM_HEIGHT < mHeight; ++roomY )
+    {
+        for( int roomX = 0; roomX * ROOM_WIDTH < mWidth; ++roomX )
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            int floor = TILE_RED + state % 3;
+
+            for( int y = 0; y < ROOM_HEIGHT; ++y )
+            {
+                for( int x = 0; x < ROOM_WIDTH; ++x )
+                {
+                    int tileX = roomX * ROOM_WIDTH + x;
+                    int tileY = roomY * ROOM_HEIGHT + y;
+                    if( tileX >= mWidth || tileY >= mHeight )
+                    {
+                        continue;
+                    }
+
+                    //Walls around the room with a doorway in the middle of each side
+                    bool top = y == 0;
+                    bool bottom = y == ROOM_HEIGHT - 1;
+                    bool left = x == 0;
+                    bool right = x == ROOM_WIDTH - 1;
+                    bool doorway = ( ( top || bottom ) && ( x == ROOM_WIDTH / 2 || x == ROOM_WIDTH / 2 - 1 ) )
+                                || ( ( left || right ) && ( y == ROOM_HEIGHT / 2 || y == ROOM_HEIGHT / 2 - 1 ) );
+
+                    int type = floor;
+                    if( doorway )
+                    {
+                        type = floor;
+                    }
+                    else if( top && left )
+                    {
+                        type = TILE_TOPLEFT;
+                    }
+                    else if( top && right )
+                    {
+                        type = TILE_TOPRIGHT;
+                    }
+                    else if( bottom && left )
+                    {
+                        type = TILE_BOTTOMLEFT;
+                    }
+                    else if( bottom && right )
+                    {
+                        type = TILE_BOTTOMRIGHT;
+                    }
+                    else if( top )
+                    {
+                        type = TILE_TOP;
+                    }
+                    else if( bottom )
+                    {
+                        type = TILE_BOTTOM;
+                    }
+                    else if( left )
+                    {
+                        type = TILE_LEFT;
+                    }
+                    else if( right )
+                    {
+                        type = TILE_RIGHT;
+                    }
+
+                    mTiles[ tileY * mWidth + tileX ] = type;
+                }
+            }
+        }
+    }
+
+    invalidateAll();
+}
+
+int LTileMap::getTile( int x, int y )
+{
+    return mTiles[ y * mWidth + x ];
+}
+
+void LTileMap::setTile( int x, int y, int type )
+{
+    if( x < 0 || y < 0 || x >= mWidth || y >= mHeight || mTiles[ y * mWidth + x ] == type )
+    {
+        return;
+    }
+    mTiles[ y * mWidth + x ] = type;
+
+    //Only the chunk holding the tile needs redrawing
+    int chunkX = x / CHUNK_TILES;
+    int chunkY = y / CHUNK_TILES;
+    for( size_t i = 0; i < mSlots.size(); ++i )
+    {
+        if( mSlots[ i ].chunkX == chunkX && mSlots[ i ].chunkY == chunkY )
+        {
+            mSlots[ i ].dirty = true;
+        }
+    }
+}
+
+int LTileMap::getPixelWidth()
+{
+    return mWidth * TILE_WIDTH;
+}
+
+int LTileMap::getPixelHeight()
+{
+    return mHeight * TILE_HEIGHT;
+}
+
+bool LTileMap::touchesWall( const SDL_Rect& box )
+{
+    //Only the tiles under the box, not the whole map
+    int x1 = box.x / TILE_WIDTH;
+    int y1 = box.y / TILE_HEIGHT;
+    int x2 = ( box.x + box.w - 1 ) / TILE_WIDTH;
+    int y2 = ( box.y + box.h - 1 ) / TILE_HEIGHT;
+    for( int y = y1; y <= y2; ++y )
+    {
+        for( int x = x1; x <= x2; ++x )
+        {
+            int type = getTile( x, y );
+            if( type >= TILE_CENTER && type <= TILE_TOPLEFT )
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void LTileMap::invalidateAll()
+{
+    for( size_t i = 0; i < mSlots.size(); ++i )
+    {
+        mSlots[ i ].chunkX = -1;
+        mSlots[ i ].chunkY = -1;
+        mSlots[ i ].dirty = false;
+    }
+}
+
+void LTileMap::drawChunk( LChunkSlot& slot )
+{
+    //Draw into the chunk instead of the screen
+    SDL_Texture* previousTarget = SDL_GetRenderTarget( gRenderer );
+    SDL_SetRenderTarget( gRenderer, slot.texture );
+
+    //Chunks on the map's right and bottom edges may be partly empty
+    SDL_SetRenderDrawColor( gRenderer, 0x00, 0x00, 0x00, 0xFF );
+    SDL_RenderClear( gRenderer );
+
+    int firstX = slot.chunkX * CHUNK_TILES;
+    int firstY = slot.chunkY * CHUNK_TILES;
+    for( int y = 0; y < CHUNK_TILES && firstY + y < mHeight; ++y )
+    {
+        for( int x = 0; x < CHUNK_TILES && firstX + x < mWidth; ++x )
+        {
+            gTileTexture.render( x * TILE_WIDTH, y * TILE_HEIGHT, &gTileClips[ getTile( firstX + x, firstY + y ) ] );
+        }
+    }
+
+    SDL_SetRenderTarget( gRenderer, previousTarget );
+    slot.dirty = false;
+    ++mChunkDraws;
+}
+
+LChunkSlot* LTileMap::acquireChunk( int chunkX, int chunkY )
+{
+    //Reuse the chunk if it is cached, otherwise take the least recently used slot
+    LChunkSlot* slot = NULL;
+    LChunkSlot* oldest = &mSlots[ 0 ];
+    for( size_t i = 0; i < mSlots.size(); ++i )
+    {
+        if( mSlots[ i ].chunkX == chunkX && mSlots[ i ].chunkY == chunkY )
+        {
+            slot = &mSlots[ i ];
+            break;
+        }
+        if( mSlots[ i ].lastUsed < oldest->lastUsed )
+        {
+            oldest = &mSlots[ i ];
+        }
+    }
+
+    if( slot == NULL )
+    {
+        slot = oldest;
+        slot->chunkX = chunkX;
+        slot->chunkY = chunkY;
+        slot->dirty = true;
+    }
+
+    if( slot->dirty )
+    {
+        drawChunk( *slot );
+    }
+    slot->lastUsed = mFrame;
+
+    return slot;
+}
+
+void LTileMap::render( const SDL_Rect& camera )
+{
+    ++mFrame;
+
+    //One copy per chunk under the camera
+    int x1 = camera.x / CHUNK_WIDTH;
+    int y1 = camera.y / CHUNK_HEIGHT;
+    int x2 = ( camera.x + camera.w - 1 ) / CHUNK_WIDTH;
+    int y2 = ( camera.y + camera.h - 1 ) / CHUNK_HEIGHT;
+    for( int chunkY = y1; chunkY <= y2; ++chunkY )
+    {
+        for( int chunkX = x1; chunkX <= x2; ++chunkX )
+        {
+            LChunkSlot* slot = acquireChunk( chunkX, chunkY );
+            SDL_Rect dest = { chunkX * CHUNK_WIDTH - camera.x, chunkY * CHUNK_HEIGHT - camera.y, CHUNK_WIDTH, CHUNK_HEIGHT };
+            SDL_RenderCopy( gRenderer, slot->texture, NULL, &dest );
+            ++mChunkCopies;
+        }
+    }
+}
+
+void LTileMap::printStats( Uint32 frames )
+{
+    if( frames == 0 )
+    {
+        return;
+    }
+
+    printf( "Map %dx%d tiles: %.1f chunk copies/frame, %u chunks drawn\n", mWidth, mHeight, (double)mChunkCopies / frames, mChunkDraws );
+    mChunkCopies = 0;
+    mChunkDraws = 0;
+}
+
+Dot::Dot()
+{
+    //Initialize the collision box
+    mBox.x = 0;
+    mBox.y = 0;
+    mBox.w = DOT_WIDTH;
+    mBox.h = DOT_HEIGHT;
+
+    //Initialize the velocity
+    mVelX = 0;
+    mVelY = 0;
+}
+
+void Dot::setPosition( int x, int y )
+{
+    mBox.x = x;
+    mBox.y = y;
+}
+
+void Dot::handleEvent( SDL_Event& e )
+{
+    //If a key was pressed
+    if( e.type == SDL_KEYDOWN && e.key.repeat == 0 )
+    {
+        //Adjust the velocity
+        switch( e.key.keysym.sym )
+        {
+            case SDLK_UP: mVelY -= DOT_VEL; break;
+            case SDLK_DOWN: mVelY += DOT_VEL; break;
+            case SDLK_LEFT: mVelX -= DOT_VEL; break;
+            case SDLK_RIGHT: mVelX += DOT_VEL; break;
+        }
+    }
+    //If a key was released
+    else if( e.type == SDL_KEYUP && e.key.repeat == 0 )
+    {
+        //Adjust the velocity
+        switch( e.key.keysym.sym )
+        {
+            case SDLK_UP: mVelY += DOT_VEL; break;
+            case SDLK_DOWN: mVelY -= DOT_VEL; break;
+            case SDLK_LEFT: mVelX += DOT_VEL; break;
+            case SDLK_RIGHT: mVelX -= DOT_VEL; break;
+        }
+    }
+}
+
+void Dot::move( LTileMap& map )
+{
+    //Move the dot left or right
+    mBox.x += mVelX;
+
+    //If the dot went too far to the left or right or touched a wall
+    if( ( mBox.x < 0 ) || ( mBox.x + DOT_WIDTH > map.getPixelWidth() ) || map.touchesWall( mBox ) )
+    {
+        //move back
+        mBox.x -= mVelX;
+    }
+
+    //Move the dot up or down
+    mBox.y += mVelY;
+
+    //If the dot went too far up or down or touched a wall
+    if( ( mBox.y < 0 ) || ( mBox.y + DOT_HEIGHT > map.getPixelHeight() ) || map.touchesWall( mBox ) )
+    {
+        //move back
+        mBox.y -= mVelY;
+    }
+}
+
+void Dot::setCamera( SDL_Rect& camera, LTileMap& map )
+{
+    //Center the camera over the dot
+    camera.x = ( mBox.x + DOT_WIDTH / 2 ) - SCREEN_WIDTH / 2;
+    camera.y = ( mBox.y + DOT_HEIGHT / 2 ) - SCREEN_HEIGHT / 2;
+
+    //Keep the camera in bounds
+    if( camera.x > map.getPixelWidth() - camera.w )
+    {
+        camera.x = map.getPixelWidth() - camera.w;
+    }
+    if( camera.y > map.getPixelHeight() - camera.h )
+    {
+        camera.y = map.getPixelHeight() - camera.h;
+    }
+    if( camera.x < 0 )
+    {
+        camera.x = 0;
+    }
+    if( camera.y < 0 )
+    {
+        camera.y = 0;
+    }
+}
+
+void Dot::render( SDL_Rect& camera )
+{
+    //Show the dot
+    gDotTexture.render( mBox.x - camera.x, mBox.y - camera.y );
+}
+
+bool init( bool software )
+{
+    //Initialization flag
+    bool success = true;
+
+    //Initialize SDL
+    if( SDL_Init( SDL_INIT_VIDEO ) < 0 )
+    {
+        printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+        success = false;
+    }
+    else
+    {
+        //Set texture filtering to linear
+        if( !SDL_SetHint( SDL_HINT_RENDER_SCALE_QUALITY, "1" ) )
+        {
+            printf( "Warning: Linear texture filtering not enabled!" );
+        }
+
+        //Create window
+        gWindow = SDL_CreateWindow( "SDL Tutorial", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN );
+        if( gWindow == NULL )
+        {
+            printf( "Window could not be created! SDL Error: %s\n", SDL_GetError() );
+            success = false;
+        }
+        else
+        {
+            //Create vsynced renderer with render targets for the chunk cache
+            Uint32 flags = ( software ? SDL_RENDERER_SOFTWARE : SDL_RENDERER_ACCELERATED ) | SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_TARGETTEXTURE;
+            gRenderer = SDL_CreateRenderer( gWindow, -1, flags );
+            if( gRenderer == NULL )
+            {
+                printf( "Renderer could not be created! SDL Error: %s\n", SDL_GetError() );
+                success = false;
+            }
+            else
+            {
+                //Initialize renderer color
+                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+
+                //Initialize PNG loading
+                int imgFlags = IMG_INIT_PNG;
+                if( !( IMG_Init( imgFlags ) & imgFlags ) )
+                {
+                    printf( "SDL_image could not initialize! SDL_image Error: %s\n", IMG_GetError() );
+                    success = false;
+                }
+            }
+        }
+    }
+
+    return success;
+}
+
+bool loadMedia()
+{
+    //Loading success flag
+    bool success = true;
+
+    //Load dot texture
+    if( !gDotTexture.loadFromFile( "dot.bmp" ) )
+    {
+        printf( "Failed to load dot texture!\n" );
+        success = false;
+    }
+
+    //Load tile texture
+    if( !gTileTexture.loadFromFile( "tiles.png" ) )
+    {
+        printf( "Failed to load tile set texture!\n" );
+        success = false;
+    }
+    else
+    {
+        //Floors in the first column, wall pieces laid out as they join in the other three
+        const int sheet[ TOTAL_TILE_SPRITES ][ 2 ] = {
+            { 0, 0 }, { 0, 1 }, { 0, 2 },
+            { 2, 1 }, { 2, 0 }, { 3, 0 }, { 3, 1 }, { 3, 2 }, { 2, 2 }, { 1, 2 }, { 1, 1 }, { 1, 0 }
+        };
+        for( int i = 0; i < TOTAL_TILE_SPRITES; ++i )
+        {
+            gTileClips[ i ].x = sheet[ i ][ 0 ] * TILE_WIDTH;
+            gTileClips[ i ].y = sheet[ i ][ 1 ] * TILE_HEIGHT;
+            gTileClips[ i ].w = TILE_WIDTH;
+            gTileClips[ i ].h = TILE_HEIGHT;
+        }
+    }
+
+    return success;
+}
+
+void close()
+{
+    //Free the map and its chunk cache
+    gMap.free();
+
+    //Free loaded images
+    gDotTexture.free();
+    gTileTexture.free();
+
+    //Destroy window
+    SDL_DestroyRenderer( gRenderer );
+    SDL_DestroyWindow( gWindow );
+    gWindow = NULL;
+    gRenderer = NULL;
+
+    //Quit SDL subsystems
+    IMG_Quit();
+    SDL_Quit();
+}
+
+int main( int argc, char* args[] )
+{
+    //Check for map size and renderer options
+    int mapWidth = DEFAULT_MAP_WIDTH;
+    int mapHeight = DEFAULT_MAP_HEIGHT;
+    bool software = false;
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( args[ i ], "--map" ) == 0 && i + 2 < argc )
+        {
+            mapWidth = atoi( args[ ++i ] );
+            mapHeight = atoi( args[ ++i ] );
+        }
+        else if( strcmp( args[ i ], "--software" ) == 0 )
+        {
+            software = true;
+        }
+    }
+
+    //The map must at least cover the screen
+    if( mapWidth * TILE_WIDTH < SCREEN_WIDTH )
+    {
+        mapWidth = SCREEN_WIDTH / TILE_WIDTH;
+    }
+    if( mapHeight * TILE_HEIGHT < SCREEN_HEIGHT )
+    {
+        mapHeight = SCREEN_HEIGHT / TILE_HEIGHT;
+    }
+
+    //Start up SDL and create window
+    if( !init( software ) )
+    {
+        printf( "Failed to initialize!\n" );
+    }
+    else
+    {
+        //Load media
+        if( !loadMedia() )
+        {
+            printf( "Failed to load media!\n" );
+        }
+        else if( !gMap.create( mapWidth, mapHeight ) )
+        {
+            printf( "Failed to create tile map!\n" );
+        }
+        else
+        {
+            gMap.generate( 1 );
+
+            //Main loop flag
+            bool quit = false;
+
+            //Event handler
+            SDL_Event e;
+
+            //The dot that will be moving around on the screen, starting inside the first room
+            Dot dot;
+            dot.setPosition( TILE_WIDTH * 2, TILE_HEIGHT * 2 );
+
+            //Level camera
+            SDL_Rect camera = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
+
+            //Frame rate reporting
+            Uint32 frames = 0;
+            Uint32 reportStart = SDL_GetTicks();
+
+            //While application is running
+            while( !quit )
+            {
+                //Handle events on queue
+                while( SDL_PollEvent( &e ) != 0 )
+                {
+                    //User requests quit
+                    if( e.type == SDL_QUIT )
+                    {
+                        quit = true;
+                    }
+                    //Clicking cycles the floor color of the tile under the mouse
+                    else if( e.type == SDL_MOUSEBUTTONDOWN )
+                    {
+                        int tileX = ( camera.x + e.button.x ) / TILE_WIDTH;
+                        int tileY = ( camera.y + e.button.y ) / TILE_HEIGHT;
+                        int type = gMap.getTile( tileX, tileY );
+                        if( type <= TILE_BLUE )
+                        {
+                            gMap.setTile( tileX, tileY, ( type + 1 ) % 3 );
+                        }
+                    }
+                    //Chunk textures are lost when the renderer resets
+                    else if( e.type == SDL_RENDER_TARGETS_RESET || e.type == SDL_RENDER_DEVICE_RESET )
+                    {
+                        gMap.invalidateAll();
+                    }
+
+                    //Handle input for the dot
+                    dot.handleEvent( e );
+                }
+
+                //Move the dot
+                dot.move( gMap );
+                dot.setCamera( camera, gMap );
+
+                //Clear screen
+                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+                SDL_RenderClear( gRenderer );
+
+                //Render level
+                gMap.render( camera );
+
+                //Render dot
+                dot.render( camera );
+
+                //Update screen
+                SDL_RenderPresent( gRenderer );
+
+                //Report frame rate and chunk cache use periodically
+                ++frames;
+                if( SDL_GetTicks() - reportStart >= MAP_REPORT_MS )
+                {
+                    printf( "%.1f FPS\n", frames * 1000.0 / ( SDL_GetTicks() - reportStart ) );
+                    gMap.printStats( frames );
+                    frames = 0;
+                    reportStart = SDL_GetTicks();
+                }
+            }
+        }
+    }
+
+    //Free resources and close SDL
+    close();
 
     return 0;
 }
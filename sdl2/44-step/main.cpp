@@ -1,7 +1,1126 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
 
-int main(int argc, char* args[]) {
-    puts("Not done yet.");
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//Positions and velocities in 16.16 fixed point, integer math rounds the same way on every host
+typedef Sint32 Fixed;
+const int FIXED_ONE = 65536;
+
+//Texture wrapper class
+class LTexture
+{
+    public:
+        //Initializes variables
+        LTexture();
+
+        //Deallocates memory
+        ~LTexture();
+
+        //Loads image at specified path
+        bool loadFromFile( std::string path );
+
+        //Deallocates texture
+        void free();
+
+        //Set color modulation
+        void setColor( Uint8 red, Uint8 green, Uint8 blue );
+
+        //Renders texture at given point
+        void render( int x, int y, SDL_Rect* clip = NULL );
+
+        //Gets image dimensions
+        int getWidth();
+        int getHeight();
+
+    private:
+        //The actual hardware texture
+        SDL_Texture* mTexture;
+
+        //Image dimensions
+        int mWidth;
+        int mHeight;
+};
+
+//Turns performance counter time into whole simulation ticks without losing any remainder
+class LTickClock
+{
+    public:
+        //Initializes variables
+        LTickClock();
+
+        //Starts counting ticks from the given counter value
+        void start( Uint64 frequency, int tickRate, Uint64 counter );
+
+        //Gets the number of ticks due since the last call, dropping any past the per frame limit
+        int advance( Uint64 counter );
+
+        //Gets the number of ticks dropped to catch up
+        Uint64 getDroppedTicks();
+
+    private:
+        //Counter frequency and simulation rate
+        Uint64 mFrequency;
+        Uint64 mTickRate;
+
+        //Counter value at the last call
+        Uint64 mLastCounter;
+
+        //Counter time not yet spent on a tick, scaled by the tick rate so the division is exact
+        Uint64 mRemainder;
+
+        //Ticks dropped to catch up
+        Uint64 mDropped;
+
+        //Most ticks run in one frame at this tick rate
+        Uint64 mMaxTicks;
+};
+
+//Dots bouncing around the screen, one array per axis so each axis integrates as a flat run
+class LEntitySet
+{
+    public:
+        //Places entities with random velocities, converted to pixels per tick
+        void create( int count, int tickRate );
+
+        //Advances every entity by one tick, with SSE2 or plain code
+        void integrate( bool vectorized );
+
+        //Gets the number of entities
+        int getCount();
+
+        //Gets an entity's top left corner
+        Fixed getX( int index );
+        Fixed getY( int index );
+
+        //Folds every position and velocity into a hash
+        Uint64 hash( Uint64 seed );
+
+    private:
+        //Positions and velocities per tick
+        std::vector<Fixed> mX;
+        std::vector<Fixed> mY;
+        std::vector<Fixed> mVelX;
+        std::vector<Fixed> mVelY;
+};
+
+//A change in the dot's velocity, applied at the start of a tick
+struct LInputEvent
+{
+    Uint32 tick;
+    int velX;
+    int velY;
+};
+
+//The dot that will move around on the screen
+class Dot
+{
+    public:
+        //The dimensions of the dot
+        static const int DOT_WIDTH = 20;
+        static const int DOT_HEIGHT = 20;
+
+        //Maximum axis velocity of the dot in pixels per second
+        static const int DOT_VEL = 640;
+
+        //Initializes the variables
+        Dot();
+
+        //Takes key presses and adjusts the dot's velocity
+        void handleEvent( SDL_Event& e );
+
+        //Sets the velocity directly, for replayed input
+        void setVelocity( int velX, int velY );
+
+        //Gets the velocity
+        int getVelX();
+        int getVelY();
+
+        //Moves the dot by one tick
+        void move( int tickRate );
+
+        //Shows the dot on the screen
+        void render();
+
+        //Gets the position
+        Fixed getPosX();
+        Fixed getPosY();
+
+    private:
+        //The X and Y offsets of the dot
+        Fixed mPosX, mPosY;
+
+        //The velocity of the dot
+        int mVelX, mVelY;
+};
+
+//Screen dimension constants
+const int SCREEN_WIDTH = 640;
+const int SCREEN_HEIGHT = 480;
+
+//Furthest a dot's top left corner goes
+const Fixed MAX_POS_X = ( SCREEN_WIDTH - Dot::DOT_WIDTH ) * FIXED_ONE;
+const Fixed MAX_POS_Y = ( SCREEN_HEIGHT - Dot::DOT_HEIGHT ) * FIXED_ONE;
+
+//Default entity count, the most drawn and the speed range in pixels per second
+const int DEFAULT_ENTITIES = 1000;
+const int MAX_DRAWN_ENTITIES = 4000;
+const int MIN_ENTITY_SPEED = 50;
+const int MAX_ENTITY_SPEED = 400;
+
+//Simulation rates, slow enough that one tick never moves a dot further than one bounce
+const int DEFAULT_TICK_RATE = 60;
+const int MIN_TICK_RATE = 10;
+const int MAX_TICK_RATE = 1000;
+
+//Most ticks run to catch up in one frame at the default tick rate, faster rates catch up the same span of time
+const int MAX_TICKS_PER_FRAME = 8;
+
+//Ticks between printed state hashes, so runs can be compared at the same tick
+const Uint32 HASH_INTERVAL_TICKS = 600;
+
+//Seed for entity placement, the same on every host
+const Uint32 ENTITY_SEED = 2463534242u;
+
+//Simulated seconds per determinism check run
+const int CHECK_SECONDS = 60;
+
+//Ticks per integrator benchmark
+const int BENCHMARK_TICKS = 200;
+
+//Milliseconds between performance reports
+const Uint32 MOTION_REPORT_MS = 5000;
+
+//Starts up SDL and creates window
+bool init();
+
+//Loads media
+bool loadMedia();
+
+//Frees media and shuts down SDL
+void close();
+
+//Moves one axis of every entity by a tick, bouncing off 0 and the limit
+void integrateScalar( Fixed* position, Fixed* velocity, int count, Fixed limit );
+#ifdef __SSE2__
+void integrateSSE2( Fixed* position, Fixed* velocity, int count, Fixed limit );
+#endif
+
+//Runs one tick of the whole simulation
+void stepSimulation( Dot& dot, LEntitySet& entities, int tickRate, bool vectorized );
+
+//Hashes the dot and every entity
+Uint64 hashState( Dot& dot, LEntitySet& entities );
+
+//Dot velocity for a scripted session
+void scriptedVelocity( Uint32 tick, int& velX, int& velY );
+
+//Runs a scripted session tick after tick with no host clock, returning the final state hash
+Uint64 runReferenceSession( int tickRate, int entityCount, Uint32 ticks );
+
+//Replays a scripted session on a simulated host and frame rate, returning the final state hash
+Uint64 runCheckSession( Uint64 frequency, int frameRate, int tickRate, int entityCount, bool vectorized, Uint32& ticks );
+
+//Runs scripted sessions on simulated hosts and frame rates and compares their final state
+bool runDeterminismCheck( int tickRate, int entityCount );
+
+//Times both integrators over a large entity array
+void runIntegrateBenchmark( int entityCount, int tickRate );
+
+//Reads a recorded session, returning false if it can't be read
+bool loadRecording( std::string path, int& tickRate, int& entityCount, std::vector<LInputEvent>& events );
+
+//The window we'll be rendering to
+SDL_Window* gWindow = NULL;
+
+//The window renderer
+SDL_Renderer* gRenderer = NULL;
+
+//Scene textures
+LTexture gDotTexture;
+
+//Random state shared by entity placement
+Uint32 gRandomState = ENTITY_SEED;
+
+//Xorshift random numbers
+inline Uint32 nextRandom()
+{
+    gRandomState ^= gRandomState << 13;
+    gRandomState ^= gRandomState >> 17;
+    gRandomState ^= gRandomState << 5;
+    return gRandomState;
+}
+
+//Folds a value into an FNV-1a hash a byte at a time, low byte first so byte order doesn't matter
+inline Uint64 hashFixed( Uint64 hash, Fixed value )
+{
+    Uint32 bits = (Uint32)value;
+    for( int i = 0; i < 4; ++i )
+    {
+        hash ^= ( bits >> ( i * 8 ) ) & 0xFF;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+LTexture::LTexture()
+{
+    //Initialize
+    mTexture = NULL;
+    mWidth = 0;
+    mHeight = 0;
+}
+
+LTexture::~LTexture()
+{
+    //Deallocate
+    free();
+}
+
+bool LTexture::loadFromFile( std::string path )
+{
+    //Get rid of preexisting texture
+    free();
+
+    //The final texture
+    SDL_Texture* newTexture = NULL;
+
+    //Load image at specified path
+    SDL_Surface* loadedSurface = IMG_Load( path.c_str() );
+    if( loadedSurface == NULL )
+    {
+        printf( "Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError() );
+    }
+    else
+    {
+        //Color key image
+        SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 0, 0xFF, 0xFF ) );
+
+        //Create texture from surface pixels
+        newTexture = SDL_CreateTextureFromSurface( gRenderer, loadedSurface );
+        if( newTexture == NULL )
+        {
+            printf( "Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+        }
+        else
+        {
+            //Get image dimensions
+            mWidth = loadedSurface->w;
+            mHeight = loadedSurface->h;
+        }
+
+        //Get rid of old loaded surface
+        SDL_FreeSurface( loadedSurface );
+    }
+
+    //Return success
+    mTexture = newTexture;
+    return mTexture != NULL;
+}
+
+void LTexture::free()
+{
+    //Free texture if it exists
+    if( mTexture != NULL )
+    {
+        SDL_DestroyTexture( mTexture );
+        mTexture = NULL;
+        mWidth = 0;
+        mHeight = 0;
+    }
+}
+
+void LTexture::setColor( Uint8 red, Uint8 green, Uint8 blue )
+{
+    //Modulate texture rgb
+    SDL_SetTextureColorMod( mTexture, red, green, blue );
+}
+
+void LTexture::render( int x, int y, SDL_Rect* clip )
+{
+    //Set rendering space and render to screen
+    SDL_Rect renderQuad = { x, y, mWidth, mHeight };
+
+    //Set clip rendering dimensions
+    if( clip != NULL )
+    {
+        renderQuad.w = clip->w;
+        renderQuad.h = clip->h;
+    }
+
+    //Render to screen
+    SDL_RenderCopy( gRenderer, mTexture, clip, &renderQuad );
+}
+
+int LTexture::getWidth()
+{
+    return mWidth;
+}
+
+int LTexture::getHeight()
+{
+    return mHeight;
+}
+
+LTickClock::LTickClock()
+{
+    //Initialize
+    mFrequency = 1;
+    mTickRate = 1;
+    mLastCounter = 0;
+    mRemainder = 0;
+    mDropped = 0;
+    mMaxTicks = MAX_TICKS_PER_FRAME;
+}
+
+void LTickClock::start( Uint64 frequency, int tickRate, Uint64 counter )
+{
+    mFrequency = frequency;
+    mTickRate = tickRate;
+    mLastCounter = counter;
+    mRemainder = 0;
+    mDropped = 0;
+    mMaxTicks = SDL_max( (Uint64)MAX_TICKS_PER_FRAME, (Uint64)MAX_TICKS_PER_FRAME * tickRate / DEFAULT_TICK_RATE );
+}
+
+int LTickClock::advance( Uint64 counter )
+{
+    //Elapsed counts times the tick rate divided by the frequency is the tick count, with the rest carried
+    mRemainder += ( counter - mLastCounter ) * mTickRate;
+    mLastCounter = counter;
+    Uint64 due = mRemainder / mFrequency;
+    mRemainder -= due * mFrequency;
+
+    //Give up on ticks the simulation can't catch up with
+    if( due > mMaxTicks )
+    {
+        mDropped += due - mMaxTicks;
+        due = mMaxTicks;
+    }
+
+    return (int)due;
+}
+
+Uint64 LTickClock::getDroppedTicks()
+{
+    return mDropped;
+}
+
+void LEntitySet::create( int count, int tickRate )
+{
+    mX.resize( count );
+    mY.resize( count );
+    mVelX.resize( count );
+    mVelY.resize( count );
+
+    for( int i = 0; i < count; ++i )
+    {
+        mX[ i ] = (Fixed)( nextRandom() % (Uint32)MAX_POS_X );
+        mY[ i ] = (Fixed)( nextRandom() % (Uint32)MAX_POS_Y );
+
+        //Whole pixels per second per axis, divided down to a tick in integers
+        int velX = MIN_ENTITY_SPEED + nextRandom() % ( MAX_ENTITY_SPEED - MIN_ENTITY_SPEED );
+        int velY = MIN_ENTITY_SPEED + nextRandom() % ( MAX_ENTITY_SPEED - MIN_ENTITY_SPEED );
+        mVelX[ i ] = ( nextRandom() & 1 ? velX : -velX ) * FIXED_ONE / tickRate;
+        mVelY[ i ] = ( nextRandom() & 1 ? velY : -velY ) * FIXED_ONE / tickRate;
+    }
+}
+
+void integrateScalar( Fixed* position, Fixed* velocity, int count, Fixed limit )
+{
+    for( int i = 0; i < count; ++i )
+    {
+        Fixed p = position[ i ] + velocity[ i ];
+
+        //Mirror back inside and turn around
+        if( p < 0 )
+        {
+            p = -p;
+            velocity[ i ] = -velocity[ i ];
+        }
+        else if( p > limit )
+        {
+            p = limit * 2 - p;
+            velocity[ i ] = -velocity[ i ];
+        }
+
+        position[ i ] = p;
+    }
+}
+
+#ifdef __SSE2__
+void integrateSSE2( Fixed* position, Fixed* velocity, int count, Fixed limit )
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i high = _mm_set1_epi32( limit );
+    const __m128i mirror = _mm_set1_epi32( limit * 2 );
+
+    //Four entities at a time, the same integer operations as the scalar path
+    int i = 0;
+    for( ; i + 4 <= count; i += 4 )
+    {
+        __m128i v = _mm_loadu_si128( (const __m128i*)&velocity[ i ] );
+        __m128i p = _mm_add_epi32( _mm_loadu_si128( (const __m128i*)&position[ i ] ), v );
+
+        //Past zero mirrors to -p, past the limit to limit * 2 - p
+        __m128i below = _mm_cmplt_epi32( p, zero );
+        __m128i above = _mm_cmpgt_epi32( p, high );
+        __m128i bounced = _mm_or_si128( below, above );
+        __m128i mirrored = _mm_sub_epi32( _mm_and_si128( above, mirror ), p );
+        p = _mm_or_si128( _mm_and_si128( bounced, mirrored ), _mm_andnot_si128( bounced, p ) );
+
+        //Negate the velocity where it bounced, ( v ^ -1 ) - -1 is -v
+        v = _mm_sub_epi32( _mm_xor_si128( v, bounced ), bounced );
+
+        _mm_storeu_si128( (__m128i*)&position[ i ], p );
+        _mm_storeu_si128( (__m128i*)&velocity[ i ], v );
+    }
+
+    //Leftovers
+    integrateScalar( position + i, velocity + i, count - i, limit );
+}
+#endif
+
+void LEntitySet::integrate( bool vectorized )
+{
+    int count = getCount();
+    if( count == 0 )
+    {
+        return;
+    }
+
+#ifdef __SSE2__
+    if( vectorized )
+    {
+        integrateSSE2( &mX[ 0 ], &mVelX[ 0 ], count, MAX_POS_X );
+        integrateSSE2( &mY[ 0 ], &mVelY[ 0 ], count, MAX_POS_Y );
+        return;
+    }
+#endif
+
+    integrateScalar( &mX[ 0 ], &mVelX[ 0 ], count, MAX_POS_X );
+    integrateScalar( &mY[ 0 ], &mVelY[ 0 ], count, MAX_POS_Y );
+}
+
+int LEntitySet::getCount()
+{
+    return (int)mX.size();
+}
+
+Fixed LEntitySet::getX( int index )
+{
+    return mX[ index ];
+}
+
+Fixed LEntitySet::getY( int index )
+{
+    return mY[ index ];
+}
+
+Uint64 LEntitySet::hash( Uint64 seed )
+{
+    for( int i = 0; i < getCount(); ++i )
+    {
+        seed = hashFixed( seed, mX[ i ] );
+        seed = hashFixed( seed, mY[ i ] );
+        seed = hashFixed( seed, mVelX[ i ] );
+        seed = hashFixed( seed, mVelY[ i ] );
+    }
+    return seed;
+}
+
+Dot::Dot()
+{
+    //Initialize the offsets
+    mPosX = 0;
+    mPosY = 0;
+
+    //Initialize the velocity
+    mVelX = 0;
+    mVelY = 0;
+}
+
+void Dot::handleEvent( SDL_Event& e )
+{
+    //If a key was pressed
+    if( e.type == SDL_KEYDOWN && e.key.repeat == 0 )
+    {
+        //Adjust the velocity
+        switch( e.key.keysym.sym )
+        {
+            case SDLK_UP: mVelY -= DOT_VEL; break;
+            case SDLK_DOWN: mVelY += DOT_VEL; break;
+            case SDLK_LEFT: mVelX -= DOT_VEL; break;
+            case SDLK_RIGHT: mVelX += DOT_VEL; break;
+        }
+    }
+    //If a key was released
+    else if( e.type == SDL_KEYUP && e.key.repeat == 0 )
+    {
+        //Adjust the velocity
+        switch( e.key.keysym.sym )
+        {
+            case SDLK_UP: mVelY += DOT_VEL; break;
+            case SDLK_DOWN: mVelY -= DOT_VEL; break;
+            case SDLK_LEFT: mVelX += DOT_VEL; break;
+            case SDLK_RIGHT: mVelX -= DOT_VEL; break;
+        }
+    }
+}
+
+void Dot::setVelocity( int velX, int velY )
+{
+    mVelX = velX;
+    mVelY = velY;
+}
+
+int Dot::getVelX()
+{
+    return mVelX;
+}
+
+int Dot::getVelY()
+{
+    return mVelY;
+}
+
+void Dot::move( int tickRate )
+{
+    //Move the dot left or right by a tick's worth, rounded toward zero
+    mPosX += mVelX * FIXED_ONE / tickRate;
+
+    //Keep the dot in bounds
+    if( mPosX < 0 )
+    {
+        mPosX = 0;
+    }
+    else if( mPosX > MAX_POS_X )
+    {
+        mPosX = MAX_POS_X;
+    }
+
+    //Move the dot up or down
+    mPosY += mVelY * FIXED_ONE / tickRate;
+
+    //Keep the dot in bounds
+    if( mPosY < 0 )
+    {
+        mPosY = 0;
+    }
+    else if( mPosY > MAX_POS_Y )
+    {
+        mPosY = MAX_POS_Y;
+    }
+}
+
+void Dot::render()
+{
+    //Show the dot on its whole pixel
+    gDotTexture.render( mPosX / FIXED_ONE, mPosY / FIXED_ONE );
+}
+
+Fixed Dot::getPosX()
+{
+    return mPosX;
+}
+
+Fixed Dot::getPosY()
+{
+    return mPosY;
+}
+
+void stepSimulation( Dot& dot, LEntitySet& entities, int tickRate, bool vectorized )
+{
+    dot.move( tickRate );
+    entities.integrate( vectorized );
+}
+
+Uint64 hashState( Dot& dot, LEntitySet& entities )
+{
+    Uint64 hash = 14695981039346656037ull;
+    hash = hashFixed( hash, dot.getPosX() );
+    hash = hashFixed( hash, dot.getPosY() );
+    return entities.hash( hash );
+}
+
+void scriptedVelocity( Uint32 tick, int& velX, int& velY )
+{
+    //A new direction out of the eight, or a stop, every 45 ticks
+    int direction = ( tick / 45 * 7 ) % 9;
+    velX = ( direction % 3 - 1 ) * Dot::DOT_VEL;
+    velY = ( direction / 3 - 1 ) * Dot::DOT_VEL;
+}
+
+Uint64 runReferenceSession( int tickRate, int entityCount, Uint32 ticks )
+{
+    Dot dot;
+    LEntitySet entities;
+    gRandomState = ENTITY_SEED;
+    entities.create( entityCount, tickRate );
+
+    for( Uint32 tick = 0; tick < ticks; ++tick )
+    {
+        int velX, velY;
+        scriptedVelocity( tick, velX, velY );
+        dot.setVelocity( velX, velY );
+        stepSimulation( dot, entities, tickRate, false );
+    }
+
+    return hashState( dot, entities );
+}
+
+Uint64 runCheckSession( Uint64 frequency, int frameRate, int tickRate, int entityCount, bool vectorized, Uint32& ticks )
+{
+    Dot dot;
+    LEntitySet entities;
+    gRandomState = ENTITY_SEED;
+    entities.create( entityCount, tickRate );
+
+    //Counter values as a host at this frequency would see them, frames jittering by up to a quarter
+    Uint32 jitterState = 88172645u;
+    Uint64 frameLength = frequency / frameRate;
+    Uint64 counter = 0x7FFF0000ull;
+    Uint64 end = counter + frequency * CHECK_SECONDS;
+    LTickClock clock;
+    clock.start( frequency, tickRate, counter );
+
+    ticks = 0;
+    while( counter < end )
+    {
+        jitterState ^= jitterState << 13;
+        jitterState ^= jitterState >> 17;
+        jitterState ^= jitterState << 5;
+        counter += frameLength - frameLength / 4 + jitterState % ( frameLength / 2 + 1 );
+        if( counter > end )
+        {
+            counter = end;
+        }
+
+        int due = clock.advance( counter );
+        for( int t = 0; t < due; ++t )
+        {
+            int velX, velY;
+            scriptedVelocity( ticks, velX, velY );
+            dot.setVelocity( velX, velY );
+            stepSimulation( dot, entities, tickRate, vectorized );
+            ++ticks;
+        }
+    }
+
+    //Dropped ticks would show up as a short tick count
+    return hashState( dot, entities );
+}
+
+bool runDeterminismCheck( int tickRate, int entityCount )
+{
+    //Counter frequencies of common hosts: millisecond timers, the ACPI timer, QueryPerformanceCounter and nanosecond clocks
+    const Uint64 frequencies[] = { 1000ull, 3579545ull, 10000000ull, 1000000000ull };
+    const int frameRates[] = { 24, 60, 144, 165 };
+    const int frequencyTotal = sizeof( frequencies ) / sizeof( frequencies[ 0 ] );
+    const int frameRateTotal = sizeof( frameRates ) / sizeof( frameRates[ 0 ] );
+
+    //Every host should end where the simulation does after exactly the session's ticks
+    Uint32 expectedTicks = (Uint32)( CHECK_SECONDS * tickRate );
+    Uint64 expectedHash = runReferenceSession( tickRate, entityCount, expectedTicks );
+    printf( "Reference: %u ticks, state %016llx\n", expectedTicks, (unsigned long long)expectedHash );
+    bool identical = true;
+    for( int v = 0; v < 2; ++v )
+    {
+        for( int f = 0; f < frequencyTotal; ++f )
+        {
+            for( int r = 0; r < frameRateTotal; ++r )
+            {
+                Uint32 ticks;
+                Uint64 hash = runCheckSession( frequencies[ f ], frameRates[ r ], tickRate, entityCount, v == 0, ticks );
+                bool match = hash == expectedHash && ticks == expectedTicks;
+                identical = identical && match;
+                printf( "%-6s %10llu Hz counter, %3d fps: %u ticks, state %016llx%s\n", v == 0 ? "SSE2" : "scalar",
+                    (unsigned long long)frequencies[ f ], frameRates[ r ], ticks, (unsigned long long)hash, match ? "" : " MISMATCH" );
+            }
+        }
+#ifndef __SSE2__
+        //Without SSE2 both passes run the scalar path
+        break;
+#endif
+    }
+
+    printf( "%d entities, %d s at %d Hz: %s\n", entityCount, CHECK_SECONDS, tickRate, identical ? "all runs identical" : "runs differ" );
+    return identical;
+}
+
+void runIntegrateBenchmark( int entityCount, int tickRate )
+{
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+
+    //Two identical sets, one integrated with SSE2 and one with plain code
+    LEntitySet sets[ 2 ];
+    Uint64 integrateTicks[ 2 ] = { 0, 0 };
+    for( int s = 0; s < 2; ++s )
+    {
+        gRandomState = ENTITY_SEED;
+        sets[ s ].create( entityCount, tickRate );
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        for( int tick = 0; tick < BENCHMARK_TICKS; ++tick )
+        {
+            sets[ s ].integrate( s == 0 );
+        }
+        integrateTicks[ s ] = SDL_GetPerformanceCounter() - start;
+    }
+
+    //Both paths must leave every entity in the same place
+    Uint64 seed = 14695981039346656037ull;
+    printf( "%d entities, %d ticks\n", entityCount, BENCHMARK_TICKS );
+#ifdef __SSE2__
+    printf( "Integrate SSE2:   %.3f ms/tick, %.2f ns/entity\n", integrateTicks[ 0 ] * 1000.0 / frequency / BENCHMARK_TICKS,
+        integrateTicks[ 0 ] * 1e9 / frequency / BENCHMARK_TICKS / entityCount );
+#endif
+    printf( "Integrate scalar: %.3f ms/tick, %.2f ns/entity\n", integrateTicks[ 1 ] * 1000.0 / frequency / BENCHMARK_TICKS,
+        integrateTicks[ 1 ] * 1e9 / frequency / BENCHMARK_TICKS / entityCount );
+    printf( "Paths %s\n", sets[ 0 ].hash( seed ) == sets[ 1 ].hash( seed ) ? "match" : "differ" );
+}
+
+bool loadRecording( std::string path, int& tickRate, int& entityCount, std::vector<LInputEvent>& events )
+{
+    FILE* file = fopen( path.c_str(), "r" );
+    if( file == NULL )
+    {
+        printf( "Unable to open recording %s!\n", path.c_str() );
+        return false;
+    }
+
+    //Session settings, then one velocity change per line
+    bool success = fscanf( file, "%d %d", &tickRate, &entityCount ) == 2;
+    if( !success )
+    {
+        printf( "Recording %s has no header!\n", path.c_str() );
+    }
+
+    LInputEvent event;
+    while( success && fscanf( file, "%u %d %d", &event.tick, &event.velX, &event.velY ) == 3 )
+    {
+        events.push_back( event );
+    }
+
+    fclose( file );
+    return success;
+}
+
+bool init()
+{
+    //Initialization flag
+    bool success = true;
+
+    //Initialize SDL
+    if( SDL_Init( SDL_INIT_VIDEO ) < 0 )
+    {
+        printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+        success = false;
+    }
+    else
+    {
+        //Set texture filtering to linear
+        if( !SDL_SetHint( SDL_HINT_RENDER_SCALE_QUALITY, "1" ) )
+        {
+            printf( "Warning: Linear texture filtering not enabled!" );
+        }
+
+        //Create window
+        gWindow = SDL_CreateWindow( "SDL Tutorial", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN );
+        if( gWindow == NULL )
+        {
+            printf( "Window could not be created! SDL Error: %s\n", SDL_GetError() );
+            success = false;
+        }
+        else
+        {
+            //Create vsynced renderer for window
+            gRenderer = SDL_CreateRenderer( gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC );
+            if( gRenderer == NULL )
+            {
+                printf( "Renderer could not be created! SDL Error: %s\n", SDL_GetError() );
+                success = false;
+            }
+            else
+            {
+                //Initialize renderer color
+                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+
+                //Initialize PNG loading
+                int imgFlags = IMG_INIT_PNG;
+                if( !( IMG_Init( imgFlags ) & imgFlags ) )
+                {
+                    printf( "SDL_image could not initialize! SDL_image Error: %s\n", IMG_GetError() );
+                    success = false;
+                }
+            }
+        }
+    }
+
+    return success;
+}
+
+bool loadMedia()
+{
+    //Loading success flag
+    bool success = true;
+
+    //Load dot texture
+    if( !gDotTexture.loadFromFile( "dot.bmp" ) )
+    {
+        printf( "Failed to load dot texture!\n" );
+        success = false;
+    }
+
+    return success;
+}
+
+void close()
+{
+    //Free loaded images
+    gDotTexture.free();
+
+    //Destroy window
+    SDL_DestroyRenderer( gRenderer );
+    SDL_DestroyWindow( gWindow );
+    gWindow = NULL;
+    gRenderer = NULL;
+
+    //Quit SDL subsystems
+    IMG_Quit();
+    SDL_Quit();
+}
+
+int main( int argc, char* args[] )
+{
+    //Check for simulation, recording and benchmark options
+    int entityCount = DEFAULT_ENTITIES;
+    int tickRate = DEFAULT_TICK_RATE;
+    bool vectorized = true;
+    bool check = false;
+    bool benchmark = false;
+    std::string recordPath;
+    std::string replayPath;
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( args[ i ], "--entities" ) == 0 && i + 1 < argc )
+        {
+            entityCount = atoi( args[ ++i ] );
+        }
+        else if( strcmp( args[ i ], "--tick-rate" ) == 0 && i + 1 < argc )
+        {
+            tickRate = atoi( args[ ++i ] );
+        }
+        else if( strcmp( args[ i ], "--scalar" ) == 0 )
+        {
+            vectorized = false;
+        }
+        else if( strcmp( args[ i ], "--record" ) == 0 && i + 1 < argc )
+        {
+            recordPath = args[ ++i ];
+        }
+        else if( strcmp( args[ i ], "--replay" ) == 0 && i + 1 < argc )
+        {
+            replayPath = args[ ++i ];
+        }
+        else if( strcmp( args[ i ], "--determinism-check" ) == 0 )
+        {
+            check = true;
+        }
+        else if( strcmp( args[ i ], "--integrate-bench" ) == 0 )
+        {
+            benchmark = true;
+            entityCount = 1000000;
+            if( i + 1 < argc && atoi( args[ i + 1 ] ) > 0 )
+            {
+                entityCount = atoi( args[ ++i ] );
+            }
+        }
+    }
+
+    //A replay runs with the settings it was recorded with
+    std::vector<LInputEvent> replayEvents;
+    if( !replayPath.empty() && !loadRecording( replayPath, tickRate, entityCount, replayEvents ) )
+    {
+        return 1;
+    }
+
+    if( entityCount < 0 )
+    {
+        entityCount = 0;
+    }
+    if( tickRate < MIN_TICK_RATE )
+    {
+        tickRate = MIN_TICK_RATE;
+    }
+    else if( tickRate > MAX_TICK_RATE )
+    {
+        tickRate = MAX_TICK_RATE;
+    }
+
+    //The check needs no window
+    if( check )
+    {
+        return runDeterminismCheck( tickRate, entityCount ) ? 0 : 1;
+    }
+
+    //Start up SDL and create window
+    if( !init() )
+    {
+        printf( "Failed to initialize!\n" );
+    }
+    else if( benchmark )
+    {
+        runIntegrateBenchmark( entityCount, tickRate );
+    }
+    else
+    {
+        //Load media
+        if( !loadMedia() )
+        {
+            printf( "Failed to load media!\n" );
+        }
+        else
+        {
+            //Main loop flag
+            bool quit = false;
+
+            //Event handler
+            SDL_Event e;
+
+            //The dot that will be moving around on the screen
+            Dot dot;
+
+            //Everything else that moves, placed the same way on every host
+            LEntitySet entities;
+            gRandomState = ENTITY_SEED;
+            entities.create( entityCount, tickRate );
+
+            //Input recording
+            FILE* recordFile = NULL;
+            if( !recordPath.empty() )
+            {
+                recordFile = fopen( recordPath.c_str(), "w" );
+                if( recordFile == NULL )
+                {
+                    printf( "Unable to write recording %s!\n", recordPath.c_str() );
+                }
+                else
+                {
+                    fprintf( recordFile, "%d %d\n", tickRate, entityCount );
+                }
+            }
+            size_t nextReplayEvent = 0;
+            int recordedVelX = 0;
+            int recordedVelY = 0;
+
+            //Simulation clock
+            Uint64 frequency = SDL_GetPerformanceFrequency();
+            LTickClock clock;
+            clock.start( frequency, tickRate, SDL_GetPerformanceCounter() );
+            Uint32 tick = 0;
+
+            //Performance reporting
+            Uint64 tickTicks = 0;
+            Uint32 reportTicks = 0;
+            Uint32 reportStart = SDL_GetTicks();
+
+            //While application is running
+            while( !quit )
+            {
+                //Handle events on queue
+                while( SDL_PollEvent( &e ) != 0 )
+                {
+                    //User requests quit
+                    if( e.type == SDL_QUIT )
+                    {
+                        quit = true;
+                    }
+
+                    //Handle input for the dot unless it comes from a recording
+                    if( replayPath.empty() )
+                    {
+                        dot.handleEvent( e );
+                    }
+                }
+
+                //Run the ticks that are due, input only ever changes between ticks
+                int due = clock.advance( SDL_GetPerformanceCounter() );
+                for( int t = 0; t < due; ++t )
+                {
+                    Uint64 start = SDL_GetPerformanceCounter();
+                    if( !replayPath.empty() )
+                    {
+                        while( nextReplayEvent < replayEvents.size() && replayEvents[ nextReplayEvent ].tick <= tick )
+                        {
+                            dot.setVelocity( replayEvents[ nextReplayEvent ].velX, replayEvents[ nextReplayEvent ].velY );
+                            ++nextReplayEvent;
+                        }
+                    }
+                    else if( recordFile != NULL && ( dot.getVelX() != recordedVelX || dot.getVelY() != recordedVelY ) )
+                    {
+                        recordedVelX = dot.getVelX();
+                        recordedVelY = dot.getVelY();
+                        fprintf( recordFile, "%u %d %d\n", tick, recordedVelX, recordedVelY );
+                    }
+
+                    stepSimulation( dot, entities, tickRate, vectorized );
+                    tickTicks += SDL_GetPerformanceCounter() - start;
+                    ++tick;
+                    ++reportTicks;
+
+                    //Runs of the same session print the same hash here whatever the frame rate or host
+                    if( tick % HASH_INTERVAL_TICKS == 0 )
+                    {
+                        printf( "Tick %u state %016llx\n", tick, (unsigned long long)hashState( dot, entities ) );
+                    }
+                }
+
+                //Clear screen
+                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+                SDL_RenderClear( gRenderer );
+
+                //Render the entities greyed out and the dot on top
+                gDotTexture.setColor( 0x80, 0x80, 0x80 );
+                for( int i = 0; i < entities.getCount() && i < MAX_DRAWN_ENTITIES; ++i )
+                {
+                    gDotTexture.render( entities.getX( i ) / FIXED_ONE, entities.getY( i ) / FIXED_ONE );
+                }
+                gDotTexture.setColor( 0xFF, 0xFF, 0xFF );
+                dot.render();
+
+                //Update screen
+                SDL_RenderPresent( gRenderer );
+
+                //Report tick cost periodically
+                if( SDL_GetTicks() - reportStart >= MOTION_REPORT_MS && reportTicks > 0 )
+                {
+                    printf( "%d entities at %d Hz (%s): %.3f ms per tick, %u ticks run, %llu dropped\n", entityCount, tickRate,
+                        vectorized ? "SSE2" : "scalar", tickTicks * 1000.0 / frequency / reportTicks, tick,
+                        (unsigned long long)clock.getDroppedTicks() );
+                    tickTicks = 0;
+                    reportTicks = 0;
+                    reportStart = SDL_GetTicks();
+                }
+            }
+
+            //Finish the recording
+            if( recordFile != NULL )
+            {
+                fclose( recordFile );
+            }
+        }
+    }
+
+    //Free resources and close SDL
+    close();
 
     return 0;
 }